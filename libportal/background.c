@@ -28,17 +28,76 @@ typedef struct {
   XdpPortal *portal;
   GTask *task;
   char *status_message;
+  GPtrArray *duplicates; /* GTask, updates that repeated this one */
 } SetStatusCall;
 
+static SetStatusCall *
+set_status_call_new (XdpPortal  *portal,
+                     const char *status_message)
+{
+  SetStatusCall *call;
+
+  call = g_new0 (SetStatusCall, 1);
+  call->portal = g_object_ref (portal);
+  call->status_message = g_strdup (status_message);
+  call->duplicates = g_ptr_array_new_with_free_func (g_object_unref);
+
+  /* Coalesced updates are compared against what was sent last, no
+   * matter whether it was coalesced or not */
+  g_free (portal->background_status_message);
+  portal->background_status_message = g_strdup (status_message);
+  portal->background_status_sent = TRUE;
+  portal->background_status_last_call = call;
+
+  return call;
+}
+
 static void
 set_status_call_free (SetStatusCall *call)
 {
   g_clear_pointer (&call->status_message, g_free);
+  g_clear_pointer (&call->duplicates, g_ptr_array_unref);
   g_clear_object (&call->portal);
   g_clear_object (&call->task);
   g_free (call);
 }
 
+/* Takes ownership of @error */
+static void
+set_status_call_return (SetStatusCall *call,
+                        GError        *error)
+{
+  XdpPortal *portal = call->portal;
+  guint i;
+
+  if (portal->background_status_last_call == call)
+    {
+      portal->background_status_last_call = NULL;
+
+      /* The portal may not have the status, so don't drop the next
+       * update that repeats it */
+      if (error)
+        portal->background_status_sent = FALSE;
+    }
+
+  for (i = 0; i < call->duplicates->len; i++)
+    {
+      GTask *task = g_ptr_array_index (call->duplicates, i);
+
+      if (error)
+        g_task_return_error (task, g_error_copy (error));
+      else
+        g_task_return_boolean (task, TRUE);
+    }
+
+  if (error)
+    g_task_return_error (call->task, error);
+  else
+    g_task_return_boolean (call->task, TRUE);
+
+  set_status_call_free (call);
+}
+
 static void
 set_status_returned (GObject      *object,
                      GAsyncResult *result,
@@ -49,12 +108,7 @@ set_status_returned (GObject      *object,
   g_autoptr(GVariant) ret = NULL;
 
   ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-  if (error)
-    g_task_return_error (call->task, error);
-  else
-    g_task_return_boolean (call->task, TRUE);
-
-  set_status_call_free (call);
+  set_status_call_return (call, error);
 }
 
 static void
@@ -94,8 +148,7 @@ get_background_version_returned (GObject      *object,
   ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
   if (error)
     {
-      g_task_return_error (call->task, error);
-      set_status_call_free (call);
+      set_status_call_return (call, error);
       return;
     }
 
@@ -104,9 +157,9 @@ get_background_version_returned (GObject      *object,
 
   if (call->portal->background_interface_version < 2)
     {
-      g_task_return_new_error (call->task, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
-                               "Background portal does not implement version 2 of the interface");
-      set_status_call_free (call);
+      set_status_call_return (call,
+                              g_error_new (G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+                                           "Background portal does not implement version 2 of the interface"));
       return;
     }
 
@@ -379,6 +432,142 @@ xdp_portal_request_background_finish (XdpPortal *portal,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
+static void flush_background_status (XdpPortal *portal);
+
+static gboolean
+background_status_timeout_cb (gpointer data)
+{
+  XdpPortal *portal = data;
+
+  portal->background_status_timeout = 0;
+  flush_background_status (portal);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_background_status (XdpPortal *portal)
+{
+  gint64 next, now;
+
+  if (!portal->background_status_pending ||
+      portal->background_status_in_flight ||
+      portal->background_status_timeout != 0)
+    return;
+
+  now = g_get_monotonic_time ();
+  next = portal->background_status_sent_time +
+         (gint64) portal->background_status_interval * G_TIME_SPAN_MILLISECOND;
+
+  if (!portal->background_status_sent || next <= now)
+    flush_background_status (portal);
+  else
+    portal->background_status_timeout =
+      g_timeout_add ((next - now + G_TIME_SPAN_MILLISECOND - 1) / G_TIME_SPAN_MILLISECOND,
+                     background_status_timeout_cb, portal);
+}
+
+static void
+coalesced_status_done (GObject      *object,
+                       GAsyncResult *result,
+                       gpointer      data)
+{
+  XdpPortal *portal = XDP_PORTAL (object);
+  g_autoptr(GPtrArray) waiters = data;
+  g_autoptr(GError) error = NULL;
+  guint i;
+
+  portal->background_status_in_flight = FALSE;
+
+  g_task_propagate_boolean (G_TASK (result), &error);
+
+  for (i = 0; i < waiters->len; i++)
+    {
+      GTask *task = g_ptr_array_index (waiters, i);
+
+      if (error)
+        g_task_return_error (task, g_error_copy (error));
+      else
+        g_task_return_boolean (task, TRUE);
+    }
+
+  /* Let the next update through right away, so that a failed one can
+   * be retried without waiting for the interval */
+  if (error)
+    portal->background_status_sent_time = 0;
+
+  schedule_background_status (portal);
+}
+
+static void
+flush_background_status (XdpPortal *portal)
+{
+  SetStatusCall *call;
+  GPtrArray *waiters;
+
+  g_clear_handle_id (&portal->background_status_timeout, g_source_remove);
+
+  if (!portal->background_status_pending)
+    return;
+
+  waiters = g_steal_pointer (&portal->background_status_waiters);
+  portal->background_status_pending = FALSE;
+
+  portal->background_status_sent_time = g_get_monotonic_time ();
+  portal->background_status_in_flight = TRUE;
+
+  call = set_status_call_new (portal, portal->background_status_pending_message);
+  g_clear_pointer (&portal->background_status_pending_message, g_free);
+  call->task = g_task_new (portal, NULL, coalesced_status_done, waiters);
+  g_task_set_source_tag (call->task, flush_background_status);
+
+  if (portal->background_interface_version == 0)
+    get_background_interface_version (call);
+  else
+    set_status (call);
+}
+
+static void
+coalesce_background_status (XdpPortal  *portal,
+                            const char *status_message,
+                            GTask      *task)
+{
+  /* Drop updates that repeat the status the portal already has, or
+   * is being sent. The latter complete along with the call that sends
+   * it. */
+  if (!portal->background_status_pending &&
+      portal->background_status_sent &&
+      g_strcmp0 (status_message, portal->background_status_message) == 0)
+    {
+      SetStatusCall *last_call = portal->background_status_last_call;
+
+      portal->background_status_suppressed++;
+
+      if (last_call)
+        g_ptr_array_add (last_call->duplicates, task);
+      else
+        {
+          g_task_return_boolean (task, TRUE);
+          g_object_unref (task);
+        }
+      return;
+    }
+
+  /* An update that has not been sent yet is replaced */
+  if (portal->background_status_pending)
+    portal->background_status_suppressed++;
+
+  g_free (portal->background_status_pending_message);
+  portal->background_status_pending_message = g_strdup (status_message);
+  portal->background_status_pending = TRUE;
+
+  if (!portal->background_status_waiters)
+    portal->background_status_waiters = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (portal->background_status_waiters, task);
+
+  schedule_background_status (portal);
+}
+
 /**
  * xdp_portal_set_background_status:
  * @portal: a [class@Portal]
@@ -401,9 +590,17 @@ xdp_portal_set_background_status (XdpPortal           *portal,
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
 
-  call = g_new0 (SetStatusCall, 1);
-  call->portal = g_object_ref (portal);
-  call->status_message = g_strdup (status_message);
+  if (portal->background_status_interval > 0)
+    {
+      GTask *task;
+
+      task = g_task_new (portal, cancellable, callback, data);
+      g_task_set_source_tag (task, xdp_portal_set_background_status);
+      coalesce_background_status (portal, status_message, task);
+      return;
+    }
+
+  call = set_status_call_new (portal, status_message);
   call->task = g_task_new (portal, cancellable, callback, data);
   g_task_set_source_tag (call->task, xdp_portal_set_background_status);
 
@@ -434,3 +631,53 @@ xdp_portal_set_background_status_finish (XdpPortal     *portal,
 
   return g_task_propagate_boolean (G_TASK (result), error);
 }
+
+/**
+ * xdp_portal_set_background_status_interval:
+ * @portal: a [class@Portal]
+ * @interval: the minimum time between status updates, in milliseconds,
+ *   or 0 to send every update
+ *
+ * Limits how often [method@Portal.set_background_status] updates the
+ * status with the portal.
+ *
+ * When an interval is set, at most one status update is sent to the
+ * portal per interval. Updates made in between replace each other,
+ * so that only the latest status is sent once the interval has
+ * passed, and updates that repeat the current status are dropped.
+ * Every call still completes, once the status that replaced it has
+ * been sent.
+ *
+ * This is useful for applications that report frequent progress
+ * while running in the background.
+ */
+void
+xdp_portal_set_background_status_interval (XdpPortal *portal,
+                                           guint      interval)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+
+  portal->background_status_interval = interval;
+
+  /* Don't hold back a pending update when coalescing is turned off */
+  if (interval == 0 && !portal->background_status_in_flight)
+    flush_background_status (portal);
+}
+
+/**
+ * xdp_portal_get_background_status_suppressed:
+ * @portal: a [class@Portal]
+ *
+ * Gets the number of background status updates that were not sent to
+ * the portal, because they repeated the current status or were replaced
+ * by a later update. See [method@Portal.set_background_status_interval].
+ *
+ * Returns: the number of suppressed status updates
+ */
+guint
+xdp_portal_get_background_status_suppressed (XdpPortal *portal)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), 0);
+
+  return portal->background_status_suppressed;
+}
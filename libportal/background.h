@@ -64,4 +64,11 @@ gboolean    xdp_portal_set_background_status_finish  (XdpPortal            *port
                                                       GAsyncResult         *result,
                                                       GError              **error);
 
+XDP_PUBLIC
+void        xdp_portal_set_background_status_interval (XdpPortal           *portal,
+                                                       guint                interval);
+
+XDP_PUBLIC
+guint       xdp_portal_get_background_status_suppressed (XdpPortal         *portal);
+
 G_END_DECLS
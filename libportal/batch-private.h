@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XdpBatch XdpBatch;
+
+/* Sends the call for the entry at @index, which must be finished with
+ * _xdp_batch_entry_done(). Returns FALSE, and sets @error unless the
+ * entry succeeded, if the entry was finished without sending a call. */
+typedef gboolean (* XdpBatchSendFunc) (XdpBatch  *batch,
+                                       guint      index,
+                                       gpointer   user_data,
+                                       GError   **error);
+
+/* Called once all entries are finished; @errors holds the error for each
+ * entry that failed, and NULL for the others. */
+typedef void     (* XdpBatchDoneFunc) (GPtrArray *errors,
+                                       gpointer   user_data);
+
+XdpBatch *_xdp_batch_new          (guint             n_entries,
+                                   guint             max_in_flight,
+                                   GCancellable     *cancellable,
+                                   XdpBatchSendFunc  send,
+                                   XdpBatchDoneFunc  done,
+                                   gpointer          user_data);
+
+void      _xdp_batch_set_n_ready  (XdpBatch         *batch,
+                                   guint             n_ready);
+
+void      _xdp_batch_start        (XdpBatch         *batch);
+
+void      _xdp_batch_entry_done   (XdpBatch         *batch,
+                                   guint             index,
+                                   GError           *error);
+
+G_END_DECLS
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include "batch-private.h"
+
+/* Sends one call per entry of a batch request, with a bounded number of
+ * them pending at once. Calls that were sent are never cancelled, since
+ * the portal may have acted on them already and their outcome must be
+ * reported; cancelling the batch only fails the entries not sent yet. */
+struct _XdpBatch {
+  GCancellable *cancellable;
+  XdpBatchSendFunc send;
+  XdpBatchDoneFunc done;
+  gpointer user_data;
+
+  guint n_entries;
+  guint n_ready;
+  guint max_in_flight;
+
+  guint n_started;
+  guint n_in_flight;
+  guint n_finished;
+  gboolean started;
+  gboolean sending;
+
+  GPtrArray *errors;
+};
+
+static void
+error_free_nullable (gpointer data)
+{
+  if (data)
+    g_error_free (data);
+}
+
+XdpBatch *
+_xdp_batch_new (guint             n_entries,
+                guint             max_in_flight,
+                GCancellable     *cancellable,
+                XdpBatchSendFunc  send,
+                XdpBatchDoneFunc  done,
+                gpointer          user_data)
+{
+  XdpBatch *batch;
+
+  g_return_val_if_fail (max_in_flight > 0, NULL);
+
+  batch = g_new0 (XdpBatch, 1);
+  batch->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  batch->send = send;
+  batch->done = done;
+  batch->user_data = user_data;
+  batch->n_entries = n_entries;
+  batch->n_ready = n_entries;
+  batch->max_in_flight = max_in_flight;
+  batch->errors = g_ptr_array_new_full (n_entries, error_free_nullable);
+  g_ptr_array_set_size (batch->errors, n_entries);
+
+  return batch;
+}
+
+static void
+batch_free (XdpBatch *batch)
+{
+  g_clear_object (&batch->cancellable);
+  g_clear_pointer (&batch->errors, g_ptr_array_unref);
+
+  g_free (batch);
+}
+
+static void
+batch_next (XdpBatch *batch)
+{
+  GPtrArray *errors;
+
+  /* Entries finished from within send() are picked up by the loop */
+  if (batch->sending)
+    return;
+
+  batch->sending = TRUE;
+
+  while (batch->n_in_flight < batch->max_in_flight &&
+         batch->n_started < batch->n_ready)
+    {
+      guint index = batch->n_started++;
+      GError *error = NULL;
+
+      if (g_cancellable_set_error_if_cancelled (batch->cancellable, &error))
+        {
+          g_ptr_array_index (batch->errors, index) = error;
+          batch->n_finished++;
+          continue;
+        }
+
+      batch->n_in_flight++;
+
+      if (!batch->send (batch, index, batch->user_data, &error))
+        {
+          g_ptr_array_index (batch->errors, index) = error;
+          batch->n_in_flight--;
+          batch->n_finished++;
+        }
+    }
+
+  batch->sending = FALSE;
+
+  if (batch->n_finished < batch->n_entries)
+    return;
+
+  errors = g_steal_pointer (&batch->errors);
+  batch->done (errors, batch->user_data);
+  batch_free (batch);
+}
+
+/* Limits the entries sent so far to the first @n_ready ones, for callers
+ * that prepare the entries while the batch is running. */
+void
+_xdp_batch_set_n_ready (XdpBatch *batch,
+                        guint     n_ready)
+{
+  g_return_if_fail (n_ready >= batch->n_started && n_ready <= batch->n_entries);
+
+  batch->n_ready = n_ready;
+
+  if (batch->started)
+    batch_next (batch);
+}
+
+void
+_xdp_batch_start (XdpBatch *batch)
+{
+  batch->started = TRUE;
+  batch_next (batch);
+}
+
+/* Takes ownership of @error, which is NULL if the entry succeeded. May
+ * free @batch, if this was the last entry. */
+void
+_xdp_batch_entry_done (XdpBatch *batch,
+                       guint     index,
+                       GError   *error)
+{
+  g_return_if_fail (index < batch->n_started);
+  g_return_if_fail (batch->n_in_flight > 0);
+
+  g_ptr_array_index (batch->errors, index) = error;
+
+  batch->n_in_flight--;
+  batch->n_finished++;
+
+  batch_next (batch);
+}
@@ -24,12 +24,192 @@
 #include "session-private.h"
 #include "portal-private.h"
 
+static void
+set_camera_present (XdpPortal *portal,
+                    gboolean   camera_present)
+{
+  gboolean changed;
+
+  changed = portal->camera_present != !!camera_present;
+
+  portal->camera_present_known = TRUE;
+  portal->camera_present = !!camera_present;
+
+  if (changed)
+    xdp_portal_notify_camera_present (portal);
+}
+
+static void
+camera_present_returned (GObject      *object,
+                         GAsyncResult *result,
+                         gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  XdpPortal *portal = g_task_get_source_object (task);
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GVariant) prop = NULL;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (!ret)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_variant_get (ret, "(v)", &prop);
+  set_camera_present (portal, g_variant_get_boolean (prop));
+
+  g_task_return_boolean (task, portal->camera_present);
+}
+
+static void
+fetch_camera_present (XdpPortal           *portal,
+                      gpointer             source_tag,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             data)
+{
+  GTask *task;
+
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, source_tag);
+
+  g_dbus_connection_call (portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.DBus.Properties",
+                          "Get",
+                          g_variant_new ("(ss)", "org.freedesktop.portal.Camera", "IsCameraPresent"),
+                          G_VARIANT_TYPE ("(v)"),
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          cancellable,
+                          camera_present_returned,
+                          task);
+}
+
+static void
+camera_present_refetched (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      data)
+{
+  g_autoptr(GError) error = NULL;
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error) && error)
+    g_warning ("Failed to get IsCameraPresent property: %s", error->message);
+}
+
+static void
+camera_properties_changed (GDBusConnection *bus,
+                           const char      *sender_name,
+                           const char      *object_path,
+                           const char      *interface_name,
+                           const char      *signal_name,
+                           GVariant        *parameters,
+                           gpointer         data)
+{
+  XdpPortal *portal = data;
+  g_autoptr(GVariant) changed = NULL;
+  g_autofree const char **invalidated = NULL;
+  const char *interface;
+  gboolean camera_present;
+
+  g_variant_get (parameters, "(&s@a{sv}^a&s)", &interface, &changed, &invalidated);
+
+  if (g_strcmp0 (interface, "org.freedesktop.portal.Camera") != 0)
+    return;
+
+  if (g_variant_lookup (changed, "IsCameraPresent", "b", &camera_present))
+    set_camera_present (portal, camera_present);
+  else if (g_strv_contains (invalidated, "IsCameraPresent"))
+    fetch_camera_present (portal, camera_properties_changed, NULL, camera_present_refetched, NULL);
+}
+
+static void
+ensure_camera_properties_connection (XdpPortal *portal)
+{
+  if (portal->camera_properties_changed_signal == 0)
+    portal->camera_properties_changed_signal =
+      g_dbus_connection_signal_subscribe (portal->bus,
+                                          PORTAL_BUS_NAME,
+                                          "org.freedesktop.DBus.Properties",
+                                          "PropertiesChanged",
+                                          PORTAL_OBJECT_PATH,
+                                          "org.freedesktop.portal.Camera",
+                                          G_DBUS_SIGNAL_FLAGS_NONE,
+                                          camera_properties_changed,
+                                          portal,
+                                          NULL);
+}
+
+/**
+ * xdp_portal_fetch_camera_present:
+ * @portal: a [class@Portal]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Fetches whether any camera is present, and starts tracking changes.
+ *
+ * Once the value has been fetched, the [property@Portal:camera-present]
+ * property is kept current, and notifies when cameras are plugged in
+ * or removed. [method@Portal.is_camera_present] then returns the
+ * cached value without contacting the portal.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Portal.fetch_camera_present_finish] to get the results.
+ */
+void
+xdp_portal_fetch_camera_present (XdpPortal           *portal,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             data)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+
+  /* Subscribe first, so that no change is missed */
+  ensure_camera_properties_connection (portal);
+
+  fetch_camera_present (portal, xdp_portal_fetch_camera_present,
+                        cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_fetch_camera_present_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes the camera presence request.
+ *
+ * Returns: `TRUE` if the system has cameras, `FALSE` if it doesn't
+ *   or if @error is set
+ */
+gboolean
+xdp_portal_fetch_camera_present_finish (XdpPortal     *portal,
+                                        GAsyncResult  *result,
+                                        GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_fetch_camera_present, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * xdp_portal_is_camera_present:
  * @portal: a [class@Portal]
  *
  * Returns whether any camera are present.
  *
+ * The first call blocks while the value is fetched from the portal.
+ * After that, the value is tracked and this returns right away.
+ * Use [method@Portal.fetch_camera_present] to avoid blocking, and
+ * the [property@Portal:camera-present] property to be notified of
+ * changes.
+ *
  * Returns: `TRUE` if the system has cameras
  */
 gboolean
@@ -41,6 +221,11 @@ xdp_portal_is_camera_present (XdpPortal *portal)
 
   g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
 
+  if (portal->camera_present_known)
+    return portal->camera_present;
+
+  ensure_camera_properties_connection (portal);
+
   ret = g_dbus_connection_call_sync (portal->bus,
                                      PORTAL_BUS_NAME,
                                      PORTAL_OBJECT_PATH,
@@ -59,8 +244,9 @@ xdp_portal_is_camera_present (XdpPortal *portal)
     }
 
   g_variant_get (ret, "(v)", &prop);
+  set_camera_present (portal, g_variant_get_boolean (prop));
 
-  return g_variant_get_boolean (prop);
+  return portal->camera_present;
 }
 
 typedef struct {
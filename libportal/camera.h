@@ -26,6 +26,17 @@ G_BEGIN_DECLS
 XDP_PUBLIC
 gboolean  xdp_portal_is_camera_present   (XdpPortal            *portal);
 
+XDP_PUBLIC
+void      xdp_portal_fetch_camera_present        (XdpPortal           *portal,
+                                                  GCancellable        *cancellable,
+                                                  GAsyncReadyCallback  callback,
+                                                  gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_portal_fetch_camera_present_finish (XdpPortal           *portal,
+                                                  GAsyncResult        *result,
+                                                  GError             **error);
+
 typedef enum {
   XDP_CAMERA_FLAG_NONE = 0
 } XdpCameraFlags;
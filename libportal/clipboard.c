@@ -19,12 +19,507 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib-unix.h>
 #include <gio/gunixfdlist.h>
 
 #include "clipboard.h"
+#include "glib-backports.h"
+#include "memfd-private.h"
 #include "portal-private.h"
 #include "session-private.h"
 
+/* Upper bound for a single sendfile() call, so that a cancelled transfer
+ * is noticed in a timely manner even for large selections. */
+#define SELECTION_TRANSFER_CHUNK_SIZE (1024 * 1024)
+
+typedef struct {
+  GBytes *bytes;
+  XdpSelectionContentFunc func;
+  gpointer user_data;
+  GDestroyNotify destroy;
+
+  /* Sealed memfd holding the content, created on the first transfer */
+  int fd;
+} SelectionContent;
+
+typedef struct {
+  XdpSession *session;
+  unsigned int serial;
+  XdpSelectionTransferState state;
+  GCancellable *cancellable;
+  guint timeout_id;
+  gboolean timed_out;
+  int content_fd;
+  int pipe_fd;
+  guint64 bytes_written;
+} SelectionTransfer;
+
+static void
+selection_content_free (SelectionContent *content)
+{
+  g_clear_pointer (&content->bytes, g_bytes_unref);
+  if (content->destroy)
+    content->destroy (content->user_data);
+  g_clear_fd (&content->fd, NULL);
+  g_free (content);
+}
+
+static void
+selection_transfer_free (SelectionTransfer *transfer)
+{
+  g_clear_handle_id (&transfer->timeout_id, g_source_remove);
+  g_clear_object (&transfer->cancellable);
+  g_clear_fd (&transfer->content_fd, NULL);
+  g_clear_fd (&transfer->pipe_fd, NULL);
+
+  /* Transfers handled by the application don't keep the session alive */
+  if (transfer->state != XDP_SELECTION_TRANSFER_STATE_DELEGATED)
+    g_object_unref (transfer->session);
+
+  g_free (transfer);
+}
+
+void
+_xdp_session_drop_selection_transfers (XdpSession *session)
+{
+  GHashTableIter iter;
+  SelectionTransfer *transfer;
+
+  if (!session->selection_transfers)
+    return;
+
+  /* Only delegated transfers can be left at this point, all others hold
+   * a reference on the session. */
+  g_hash_table_iter_init (&iter, session->selection_transfers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &transfer))
+    {
+      g_hash_table_iter_remove (&iter);
+      selection_transfer_free (transfer);
+    }
+}
+
+static void
+send_selection_write_done (XdpSession   *session,
+                           unsigned int  serial,
+                           gboolean      success)
+{
+  g_dbus_connection_call (session->portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.portal.Clipboard",
+                          "SelectionWriteDone",
+                          g_variant_new ("(oub)",
+                                         session->id,
+                                         serial,
+                                         success),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1, NULL, NULL, NULL);
+}
+
+static void
+track_selection_transfer (XdpSession        *session,
+                          SelectionTransfer *transfer)
+{
+  if (!session->selection_transfers)
+    session->selection_transfers = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_insert (session->selection_transfers,
+                       GUINT_TO_POINTER (transfer->serial), transfer);
+}
+
+static void
+account_selection_transfer (XdpSession        *session,
+                            SelectionTransfer *transfer,
+                            gboolean           success)
+{
+  if (transfer->state == XDP_SELECTION_TRANSFER_STATE_ACTIVE)
+    {
+      g_assert (session->n_active_selection_transfers > 0);
+
+      session->n_active_selection_transfers--;
+      if (session->n_active_selection_transfers == 0)
+        session->selection_busy_time += g_get_monotonic_time () - session->selection_busy_since;
+    }
+
+  session->selection_bytes_transferred += transfer->bytes_written;
+
+  if (success)
+    session->n_selection_transfers_completed++;
+  else
+    session->n_selection_transfers_failed++;
+}
+
+void
+_xdp_session_clear_selection_contents (XdpSession *session)
+{
+  /* Transfers that are already in flight keep their own reference to
+   * the sealed memfd, so they can complete with the old content. */
+  if (session->selection_contents)
+    g_hash_table_remove_all (session->selection_contents);
+}
+
+static int
+selection_content_ensure_fd (XdpSession        *session,
+                             const char        *mime_type,
+                             SelectionContent  *content,
+                             GError           **error)
+{
+  g_autoptr(GBytes) bytes = NULL;
+  g_autofd int fd = -1;
+
+  if (content->fd != -1)
+    return content->fd;
+
+  if (content->bytes)
+    bytes = g_bytes_ref (content->bytes);
+  else
+    bytes = content->func (session, mime_type, content->user_data);
+
+  if (!bytes)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                   "No selection content available for %s", mime_type);
+      return -1;
+    }
+
+  fd = _xdp_memfd_new_from_bytes ("xdp-selection", bytes, error);
+  if (fd == -1)
+    return -1;
+
+  if (!_xdp_memfd_seal (fd, error))
+    return -1;
+
+  content->fd = g_steal_fd (&fd);
+
+  /* Once the content lives in the memfd there is no need to keep a
+   * second copy around. */
+  g_clear_pointer (&content->bytes, g_bytes_unref);
+
+  return content->fd;
+}
+
+static void process_selection_transfer_queue (XdpSession *session);
+
+static void
+finish_selection_transfer (SelectionTransfer *transfer,
+                           gboolean           success)
+{
+  XdpSession *session = transfer->session;
+
+  g_hash_table_remove (session->selection_transfers,
+                       GUINT_TO_POINTER (transfer->serial));
+  g_clear_handle_id (&transfer->timeout_id, g_source_remove);
+
+  if (transfer->timed_out)
+    g_warning ("Selection transfer %u timed out", transfer->serial);
+
+  account_selection_transfer (session, transfer, success);
+
+  /* Close our end of the pipe first, so the reader sees EOF */
+  g_clear_fd (&transfer->pipe_fd, NULL);
+  send_selection_write_done (session, transfer->serial, success);
+
+  process_selection_transfer_queue (session);
+
+  selection_transfer_free (transfer);
+}
+
+static gboolean
+wait_for_pipe (int            fd,
+               GCancellable  *cancellable,
+               GError       **error)
+{
+  GPollFD fds[2];
+  int n_fds = 1;
+
+  fds[0].fd = fd;
+  fds[0].events = G_IO_OUT | G_IO_HUP | G_IO_ERR;
+  fds[0].revents = 0;
+
+  if (g_cancellable_make_pollfd (cancellable, &fds[1]))
+    n_fds++;
+
+  while (g_poll (fds, n_fds, -1) == -1 && errno == EINTR)
+    ;
+
+  if (n_fds > 1)
+    g_cancellable_release_fd (cancellable);
+
+  return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+static void
+write_selection_thread (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  SelectionTransfer *transfer = task_data;
+  GError *error = NULL;
+  struct stat st;
+  off_t offset = 0;
+
+  if (fstat (transfer->content_fd, &st) == -1)
+    {
+      int saved_errno = errno;
+
+      g_task_return_new_error (task, G_IO_ERROR,
+                               g_io_error_from_errno (saved_errno),
+                               "fstat: %s", g_strerror (saved_errno));
+      return;
+    }
+
+  /* The pipe is non-blocking, so that we can keep an eye on the
+   * cancellable while the reader is slow to drain it. */
+  if (!g_unix_set_fd_nonblocking (transfer->pipe_fd, TRUE, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* sendfile() with an explicit offset leaves the file offset of the
+   * shared memfd alone, so concurrent transfers don't interfere. */
+  while (offset < st.st_size)
+    {
+      ssize_t n;
+
+      if (g_task_return_error_if_cancelled (task))
+        return;
+
+      n = sendfile (transfer->pipe_fd, transfer->content_fd, &offset,
+                    MIN (st.st_size - offset, SELECTION_TRANSFER_CHUNK_SIZE));
+      if (n == -1)
+        {
+          int saved_errno = errno;
+
+          if (saved_errno == EINTR)
+            continue;
+
+          if (saved_errno == EAGAIN)
+            {
+              if (!wait_for_pipe (transfer->pipe_fd, cancellable, &error))
+                {
+                  g_task_return_error (task, error);
+                  return;
+                }
+              continue;
+            }
+
+          g_task_return_new_error (task, G_IO_ERROR,
+                                   g_io_error_from_errno (saved_errno),
+                                   "sendfile: %s", g_strerror (saved_errno));
+          return;
+        }
+
+      if (n == 0)
+        break;
+
+      transfer->bytes_written += n;
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+selection_written (GObject      *object,
+                   GAsyncResult *result,
+                   gpointer      data)
+{
+  SelectionTransfer *transfer = data;
+  g_autoptr(GError) error = NULL;
+  gboolean success;
+
+  success = g_task_propagate_boolean (G_TASK (result), &error);
+  if (!success && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    g_warning ("Failed to transfer selection: %s", error->message);
+
+  finish_selection_transfer (transfer, success);
+}
+
+static void
+selection_write_returned (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      data)
+{
+  SelectionTransfer *transfer = data;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GTask) task = NULL;
+  int fd_out;
+
+  ret = g_dbus_connection_call_with_unix_fd_list_finish (G_DBUS_CONNECTION (object),
+                                                         &fd_list,
+                                                         result,
+                                                         &error);
+  if (!ret)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to write selection: %s", error->message);
+      finish_selection_transfer (transfer, FALSE);
+      return;
+    }
+
+  g_variant_get (ret, "(h)", &fd_out);
+
+  transfer->pipe_fd = g_unix_fd_list_get (fd_list, fd_out, &error);
+  if (transfer->pipe_fd == -1)
+    {
+      g_warning ("Failed to write selection: %s", error->message);
+      finish_selection_transfer (transfer, FALSE);
+      return;
+    }
+
+  task = g_task_new (transfer->session, transfer->cancellable,
+                     selection_written, transfer);
+  g_task_set_source_tag (task, selection_write_returned);
+  g_task_set_task_data (task, transfer, NULL);
+  g_task_run_in_thread (task, write_selection_thread);
+}
+
+static gboolean
+selection_transfer_timed_out (gpointer data)
+{
+  SelectionTransfer *transfer = data;
+
+  transfer->timeout_id = 0;
+
+  if (transfer->state == XDP_SELECTION_TRANSFER_STATE_DELEGATED)
+    {
+      XdpSession *session = transfer->session;
+
+      g_warning ("Selection transfer %u was not completed in time", transfer->serial);
+
+      g_hash_table_remove (session->selection_transfers,
+                           GUINT_TO_POINTER (transfer->serial));
+      account_selection_transfer (session, transfer, FALSE);
+      send_selection_write_done (session, transfer->serial, FALSE);
+      selection_transfer_free (transfer);
+    }
+  else
+    {
+      /* The transfer finishes with a cancellation error */
+      transfer->timed_out = TRUE;
+      g_cancellable_cancel (transfer->cancellable);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+arm_selection_transfer_timeout (XdpSession        *session,
+                                SelectionTransfer *transfer)
+{
+  if (session->selection_transfer_timeout == 0)
+    return;
+
+  transfer->timeout_id = g_timeout_add (session->selection_transfer_timeout,
+                                        selection_transfer_timed_out,
+                                        transfer);
+}
+
+static void
+begin_selection_transfer (XdpSession        *session,
+                          SelectionTransfer *transfer)
+{
+  if (session->n_active_selection_transfers == 0)
+    session->selection_busy_since = g_get_monotonic_time ();
+  session->n_active_selection_transfers++;
+
+  transfer->state = XDP_SELECTION_TRANSFER_STATE_ACTIVE;
+  arm_selection_transfer_timeout (session, transfer);
+
+  g_dbus_connection_call_with_unix_fd_list (session->portal->bus,
+                                            PORTAL_BUS_NAME,
+                                            PORTAL_OBJECT_PATH,
+                                            "org.freedesktop.portal.Clipboard",
+                                            "SelectionWrite",
+                                            g_variant_new ("(ou)",
+                                                           session->id,
+                                                           transfer->serial),
+                                            G_VARIANT_TYPE ("(h)"),
+                                            G_DBUS_CALL_FLAGS_NONE,
+                                            -1,
+                                            NULL,
+                                            transfer->cancellable,
+                                            selection_write_returned,
+                                            transfer);
+}
+
+static void
+process_selection_transfer_queue (XdpSession *session)
+{
+  while (session->n_active_selection_transfers < session->max_selection_transfers &&
+         !g_queue_is_empty (&session->selection_transfer_queue))
+    begin_selection_transfer (session,
+                              g_queue_pop_head (&session->selection_transfer_queue));
+}
+
+static void
+start_selection_transfer (XdpSession       *session,
+                          SelectionContent *content,
+                          const char       *mime_type,
+                          unsigned int      serial)
+{
+  g_autoptr(GError) error = NULL;
+  SelectionTransfer *transfer;
+  int fd;
+
+  fd = selection_content_ensure_fd (session, mime_type, content, &error);
+  if (fd == -1)
+    {
+      g_warning ("Failed to provide selection content: %s", error->message);
+      session->n_selection_transfers_failed++;
+      send_selection_write_done (session, serial, FALSE);
+      return;
+    }
+
+  transfer = g_new0 (SelectionTransfer, 1);
+  transfer->session = g_object_ref (session);
+  transfer->serial = serial;
+  transfer->state = XDP_SELECTION_TRANSFER_STATE_QUEUED;
+  transfer->cancellable = g_cancellable_new ();
+  transfer->pipe_fd = -1;
+  transfer->content_fd = fcntl (fd, F_DUPFD_CLOEXEC, 3);
+  if (transfer->content_fd == -1)
+    {
+      g_warning ("Failed to provide selection content: %s", g_strerror (errno));
+      selection_transfer_free (transfer);
+      session->n_selection_transfers_failed++;
+      send_selection_write_done (session, serial, FALSE);
+      return;
+    }
+
+  track_selection_transfer (session, transfer);
+
+  g_queue_push_tail (&session->selection_transfer_queue, transfer);
+  process_selection_transfer_queue (session);
+}
+
+static void
+delegate_selection_transfer (XdpSession   *session,
+                             unsigned int  serial)
+{
+  SelectionTransfer *transfer;
+
+  transfer = g_new0 (SelectionTransfer, 1);
+  transfer->session = session;
+  transfer->serial = serial;
+  transfer->state = XDP_SELECTION_TRANSFER_STATE_DELEGATED;
+  transfer->content_fd = -1;
+  transfer->pipe_fd = -1;
+
+  track_selection_transfer (session, transfer);
+  arm_selection_transfer_timeout (session, transfer);
+}
+
 static void
 on_selection_owner_changed (GDBusConnection *bus,
                             const char *sender_name,
@@ -51,6 +546,8 @@ on_selection_owner_changed (GDBusConnection *bus,
   g_variant_lookup (variant, "mime_types", "^a&s", &mime_types);
 
   session->is_selection_owned_by_session = session_is_owner;
+  if (!session_is_owner)
+    _xdp_session_clear_selection_contents (session);
   g_clear_pointer (&session->selection_mime_types, g_strfreev);
   session->selection_mime_types = g_strdupv ((GStrv) mime_types);
 
@@ -69,16 +566,28 @@ on_selection_transfer (GDBusConnection *bus,
 {
   XdpPortal *portal = data;
   XdpSession *session;
+  SelectionContent *content = NULL;
   const char *session_handle = NULL;
   const char *mime_type = NULL;
   unsigned int serial = 0;
 
-  g_variant_get (parameters, "(osu)", &session_handle, &mime_type, &serial);
+  g_variant_get (parameters, "(&o&su)", &session_handle, &mime_type, &serial);
 
   session = xdp_portal_lookup_session (portal, session_handle);
   if (!session)
     return;
 
+  if (session->selection_contents)
+    content = g_hash_table_lookup (session->selection_contents, mime_type);
+
+  if (content)
+    {
+      start_selection_transfer (session, content, mime_type, serial);
+      return;
+    }
+
+  delegate_selection_transfer (session, serial);
+
   g_signal_emit_by_name (session, "selection-transfer",
                          mime_type, serial);
 }
@@ -280,24 +789,40 @@ xdp_session_selection_write (XdpSession *session,
  *
  * Notify whether a clipboard selection write operation associated with the
  * passed serial was successful or not.
+ *
+ * Serials that are no longer pending, for example because the transfer
+ * timed out, are ignored.
  */
 void
 xdp_session_selection_write_done (XdpSession   *session,
                                   unsigned int  serial,
                                   gboolean      success)
 {
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.Clipboard",
-                          "SelectionWriteDone",
-                          g_variant_new ("(oub)",
-                                         session->id,
-                                         serial,
-                                         success),
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1, NULL, NULL, NULL);
+  SelectionTransfer *transfer = NULL;
+
+  if (session->selection_transfers)
+    transfer = g_hash_table_lookup (session->selection_transfers,
+                                    GUINT_TO_POINTER (serial));
+
+  /* The transfer may have timed out already, in which case the portal
+   * has been told about it and the serial is no longer valid */
+  if (transfer == NULL)
+    {
+      g_warning ("Selection transfer %u is not pending", serial);
+      return;
+    }
+
+  if (transfer->state != XDP_SELECTION_TRANSFER_STATE_DELEGATED)
+    {
+      g_warning ("Selection transfer %u is handled by libportal", serial);
+      return;
+    }
+
+  g_hash_table_remove (session->selection_transfers, GUINT_TO_POINTER (serial));
+  account_selection_transfer (session, transfer, success);
+  selection_transfer_free (transfer);
+
+  send_selection_write_done (session, serial, success);
 }
 
 /**
@@ -347,3 +872,219 @@ xdp_session_selection_read (XdpSession *session,
 
   return g_unix_fd_list_get (fd_list, fd_out, NULL);
 }
+
+/**
+ * xdp_session_set_selection_content:
+ * @session: a [class@Session]
+ * @mime_type: the mime type the content is provided in
+ * @content: (nullable): the content, or %NULL to remove it
+ *
+ * Stores @content as the clipboard selection content for @mime_type.
+ *
+ * Transfer requests for a mime type that has content stored are answered
+ * by libportal itself, without emitting [signal@Session::selection-transfer].
+ * The content is copied into sealed shared memory on the first request and
+ * reused for all subsequent ones, so repeated pastes don't cost another copy.
+ *
+ * The stored content is dropped when another client takes ownership of
+ * the selection, or when [method@Session.clear_selection_content] is called.
+ * The mime types still need to be advertised with
+ * [method@Session.set_selection].
+ */
+void
+xdp_session_set_selection_content (XdpSession *session,
+                                   const char *mime_type,
+                                   GBytes     *content)
+{
+  SelectionContent *selection_content;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (mime_type != NULL);
+
+  if (!content)
+    {
+      if (session->selection_contents)
+        g_hash_table_remove (session->selection_contents, mime_type);
+      return;
+    }
+
+  if (!session->selection_contents)
+    session->selection_contents =
+      g_hash_table_new_full (g_str_hash, g_str_equal,
+                             g_free, (GDestroyNotify) selection_content_free);
+
+  selection_content = g_new0 (SelectionContent, 1);
+  selection_content->bytes = g_bytes_ref (content);
+  selection_content->fd = -1;
+
+  g_hash_table_replace (session->selection_contents,
+                        g_strdup (mime_type), selection_content);
+}
+
+/**
+ * xdp_session_set_selection_content_func:
+ * @session: a [class@Session]
+ * @mime_type: the mime type the content is provided in
+ * @func: (scope notified) (closure user_data) (destroy destroy): function
+ *   producing the content
+ * @user_data: data to pass to @func
+ * @destroy: (nullable): function to free @user_data
+ *
+ * Like [method@Session.set_selection_content], but the content is only
+ * produced by calling @func when it is first requested. This avoids the
+ * cost of serializing formats that are never pasted.
+ *
+ * @func is called at most once; its result is kept until the content is
+ * dropped.
+ */
+void
+xdp_session_set_selection_content_func (XdpSession              *session,
+                                        const char              *mime_type,
+                                        XdpSelectionContentFunc  func,
+                                        gpointer                 user_data,
+                                        GDestroyNotify           destroy)
+{
+  SelectionContent *selection_content;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (mime_type != NULL);
+  g_return_if_fail (func != NULL);
+
+  if (!session->selection_contents)
+    session->selection_contents =
+      g_hash_table_new_full (g_str_hash, g_str_equal,
+                             g_free, (GDestroyNotify) selection_content_free);
+
+  selection_content = g_new0 (SelectionContent, 1);
+  selection_content->func = func;
+  selection_content->user_data = user_data;
+  selection_content->destroy = destroy;
+  selection_content->fd = -1;
+
+  g_hash_table_replace (session->selection_contents,
+                        g_strdup (mime_type), selection_content);
+}
+
+/**
+ * xdp_session_clear_selection_content:
+ * @session: a [class@Session]
+ *
+ * Drops all content stored with [method@Session.set_selection_content]
+ * and [method@Session.set_selection_content_func]. Transfers that are
+ * already in progress are not affected.
+ */
+void
+xdp_session_clear_selection_content (XdpSession *session)
+{
+  g_return_if_fail (XDP_IS_SESSION (session));
+
+  _xdp_session_clear_selection_contents (session);
+}
+
+/**
+ * xdp_session_set_selection_transfer_limits:
+ * @session: a [class@Session]
+ * @max_active: the maximum number of transfers to run at the same time
+ * @timeout: timeout for a single transfer in milliseconds, or 0
+ *
+ * Configures how transfers of content stored with
+ * [method@Session.set_selection_content] are scheduled.
+ *
+ * At most @max_active transfers write to their requesters concurrently;
+ * further requests are queued and started in order as earlier ones finish.
+ * A transfer that takes longer than @timeout is aborted and reported as
+ * failed. The timeout also applies to transfers handled by the application
+ * through [signal@Session::selection-transfer]: if
+ * [method@Session.selection_write_done] is not called in time, the transfer
+ * is reported as failed on the application's behalf.
+ *
+ * By default, 4 transfers run concurrently and there is no timeout.
+ */
+void
+xdp_session_set_selection_transfer_limits (XdpSession   *session,
+                                           unsigned int  max_active,
+                                           unsigned int  timeout)
+{
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (max_active > 0);
+
+  session->max_selection_transfers = max_active;
+  session->selection_transfer_timeout = timeout;
+
+  process_selection_transfer_queue (session);
+}
+
+/**
+ * xdp_session_get_selection_transfer_state:
+ * @session: a [class@Session]
+ * @serial: the serial number of a transfer
+ *
+ * Gets the state of the clipboard selection transfer with the given serial.
+ *
+ * Returns: the state of the transfer, or %XDP_SELECTION_TRANSFER_STATE_NONE
+ *   if the transfer is not known or has already finished
+ */
+XdpSelectionTransferState
+xdp_session_get_selection_transfer_state (XdpSession   *session,
+                                          unsigned int  serial)
+{
+  SelectionTransfer *transfer = NULL;
+
+  g_return_val_if_fail (XDP_IS_SESSION (session), XDP_SELECTION_TRANSFER_STATE_NONE);
+
+  if (session->selection_transfers)
+    transfer = g_hash_table_lookup (session->selection_transfers,
+                                    GUINT_TO_POINTER (serial));
+
+  return transfer ? transfer->state : XDP_SELECTION_TRANSFER_STATE_NONE;
+}
+
+/**
+ * xdp_session_get_selection_transfer_stats:
+ * @session: a [class@Session]
+ * @n_queued: (out) (optional): return location for the number of queued transfers
+ * @n_active: (out) (optional): return location for the number of running transfers
+ * @n_completed: (out) (optional): return location for the number of successful transfers
+ * @n_failed: (out) (optional): return location for the number of failed transfers
+ * @bytes_transferred: (out) (optional): return location for the number of bytes
+ *   written by libportal
+ * @throughput: (out) (optional): return location for the average throughput in
+ *   bytes per second
+ *
+ * Gets statistics about the clipboard selection transfers of @session.
+ *
+ * The throughput is measured over the time during which at least one transfer
+ * was running, so idle periods don't lower it.
+ */
+void
+xdp_session_get_selection_transfer_stats (XdpSession   *session,
+                                          unsigned int *n_queued,
+                                          unsigned int *n_active,
+                                          unsigned int *n_completed,
+                                          unsigned int *n_failed,
+                                          guint64      *bytes_transferred,
+                                          double       *throughput)
+{
+  gint64 busy_time;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+
+  busy_time = session->selection_busy_time;
+  if (session->n_active_selection_transfers > 0)
+    busy_time += g_get_monotonic_time () - session->selection_busy_since;
+
+  if (n_queued)
+    *n_queued = g_queue_get_length (&session->selection_transfer_queue);
+  if (n_active)
+    *n_active = session->n_active_selection_transfers;
+  if (n_completed)
+    *n_completed = session->n_selection_transfers_completed;
+  if (n_failed)
+    *n_failed = session->n_selection_transfers_failed;
+  if (bytes_transferred)
+    *bytes_transferred = session->selection_bytes_transferred;
+  if (throughput)
+    *throughput = busy_time > 0
+                ? session->selection_bytes_transferred * (double) G_USEC_PER_SEC / busy_time
+                : 0.0;
+}
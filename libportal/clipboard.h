@@ -24,6 +24,38 @@
 
 G_BEGIN_DECLS
 
+/**
+ * XdpSelectionTransferState:
+ * @XDP_SELECTION_TRANSFER_STATE_NONE: the transfer is unknown or finished
+ * @XDP_SELECTION_TRANSFER_STATE_QUEUED: the transfer waits for a free slot
+ * @XDP_SELECTION_TRANSFER_STATE_ACTIVE: libportal is writing the content
+ * @XDP_SELECTION_TRANSFER_STATE_DELEGATED: the application is expected to
+ *   write the content and call [method@Session.selection_write_done]
+ *
+ * The state of a clipboard selection transfer.
+ */
+typedef enum {
+  XDP_SELECTION_TRANSFER_STATE_NONE,
+  XDP_SELECTION_TRANSFER_STATE_QUEUED,
+  XDP_SELECTION_TRANSFER_STATE_ACTIVE,
+  XDP_SELECTION_TRANSFER_STATE_DELEGATED,
+} XdpSelectionTransferState;
+
+/**
+ * XdpSelectionContentFunc:
+ * @session: the [class@Session]
+ * @mime_type: the requested mime type
+ * @user_data: the data passed to [method@Session.set_selection_content_func]
+ *
+ * Produces the clipboard selection content for @mime_type.
+ *
+ * Returns: (transfer full) (nullable): the content, or %NULL if it
+ *   cannot be provided
+ */
+typedef GBytes * (* XdpSelectionContentFunc) (XdpSession *session,
+                                              const char *mime_type,
+                                              gpointer    user_data);
+
 XDP_PUBLIC
 void            xdp_session_request_clipboard           (XdpSession    *session);
 
@@ -53,4 +85,38 @@ XDP_PUBLIC
 int             xdp_session_selection_read              (XdpSession    *session,
                                                          const char    *mime_type);
 
+XDP_PUBLIC
+void            xdp_session_set_selection_content       (XdpSession    *session,
+                                                         const char    *mime_type,
+                                                         GBytes        *content);
+
+XDP_PUBLIC
+void            xdp_session_set_selection_content_func  (XdpSession              *session,
+                                                         const char              *mime_type,
+                                                         XdpSelectionContentFunc  func,
+                                                         gpointer                 user_data,
+                                                         GDestroyNotify           destroy);
+
+XDP_PUBLIC
+void            xdp_session_clear_selection_content     (XdpSession    *session);
+
+XDP_PUBLIC
+void            xdp_session_set_selection_transfer_limits (XdpSession  *session,
+                                                           unsigned int max_active,
+                                                           unsigned int timeout);
+
+XDP_PUBLIC
+XdpSelectionTransferState
+                xdp_session_get_selection_transfer_state (XdpSession   *session,
+                                                          unsigned int  serial);
+
+XDP_PUBLIC
+void            xdp_session_get_selection_transfer_stats (XdpSession   *session,
+                                                          unsigned int *n_queued,
+                                                          unsigned int *n_active,
+                                                          unsigned int *n_completed,
+                                                          unsigned int *n_failed,
+                                                          guint64      *bytes_transferred,
+                                                          double       *throughput);
+
 G_END_DECLS
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include "dynamic-launcher.h"
+#include "batch-private.h"
 #include "portal-private.h"
 
 #define GNU_SOURCE 1
@@ -591,3 +592,731 @@ xdp_portal_dynamic_launcher_launch (XdpPortal   *portal,
                                      NULL, error);
   return (ret != NULL);
 }
+
+static void
+launcher_call_returned (GObject      *object,
+                        GAsyncResult *result,
+                        gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  GError *error = NULL;
+  GVariant *ret;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (ret)
+    g_task_return_pointer (task, ret, (GDestroyNotify) g_variant_unref);
+  else
+    g_task_return_error (task, error);
+}
+
+static void
+launcher_call (XdpPortal           *portal,
+               const char          *method,
+               GVariant            *parameters,
+               const GVariantType  *reply_type,
+               gpointer             source_tag,
+               GCancellable        *cancellable,
+               GAsyncReadyCallback  callback,
+               gpointer             data)
+{
+  GTask *task;
+
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, source_tag);
+
+  g_dbus_connection_call (portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.portal.DynamicLauncher",
+                          method,
+                          parameters,
+                          reply_type,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          cancellable,
+                          launcher_call_returned,
+                          task);
+}
+
+static GVariant *
+install_parameters (const char *token,
+                    const char *desktop_file_id,
+                    const char *desktop_entry)
+{
+  GVariantBuilder opt_builder;
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  return g_variant_new ("(sssa{sv})",
+                        token,
+                        desktop_file_id,
+                        desktop_entry,
+                        &opt_builder);
+}
+
+static GVariant *
+uninstall_parameters (const char *desktop_file_id)
+{
+  GVariantBuilder opt_builder;
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  return g_variant_new ("(sa{sv})",
+                        desktop_file_id,
+                        &opt_builder);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_request_install_token_async:
+ * @portal: a [class@Portal]
+ * @name: the name for the launcher
+ * @icon_v: a #GBytesIcon as returned by g_icon_serialize(). Must be a png or jpeg no larger than 512x512, or an svg
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Asynchronous version of [method@Portal.dynamic_launcher_request_install_token].
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_request_install_token_finish] to get the
+ * token.
+ */
+void
+xdp_portal_dynamic_launcher_request_install_token_async (XdpPortal           *portal,
+                                                         const char          *name,
+                                                         GVariant            *icon_v,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         gpointer             data)
+{
+  GVariantBuilder opt_builder;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (name != NULL && *name != '\0');
+  g_return_if_fail (g_variant_is_of_type (icon_v, G_VARIANT_TYPE ("(sv)")));
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  launcher_call (portal,
+                 "RequestInstallToken",
+                 g_variant_new ("(sva{sv})", name, icon_v, &opt_builder),
+                 G_VARIANT_TYPE ("(s)"),
+                 xdp_portal_dynamic_launcher_request_install_token_async,
+                 cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_request_install_token_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes the install token request.
+ *
+ * Returns: (transfer full): a token that can be passed to
+ *   [method@Portal.dynamic_launcher_install], or %NULL with @error set
+ */
+char *
+xdp_portal_dynamic_launcher_request_install_token_finish (XdpPortal     *portal,
+                                                          GAsyncResult  *result,
+                                                          GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  char *token = NULL;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_request_install_token_async, NULL);
+
+  ret = g_task_propagate_pointer (G_TASK (result), error);
+  if (ret == NULL)
+    return NULL;
+
+  g_variant_get (ret, "(s)", &token);
+  return token;
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_async:
+ * @portal: a [class@Portal]
+ * @token: a token acquired via a [method@Portal.dynamic_launcher_request_install_token] or [method@Portal.dynamic_launcher_prepare_install] call
+ * @desktop_file_id: the .desktop file name to be used
+ * @desktop_entry: the key-file to be used for the contents of the .desktop file
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Asynchronous version of [method@Portal.dynamic_launcher_install].
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_install_finish] to get the result.
+ */
+void
+xdp_portal_dynamic_launcher_install_async (XdpPortal           *portal,
+                                           const char          *token,
+                                           const char          *desktop_file_id,
+                                           const char          *desktop_entry,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             data)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (token != NULL && *token != '\0');
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+  g_return_if_fail (desktop_entry != NULL && *desktop_entry != '\0');
+
+  launcher_call (portal,
+                 "Install",
+                 install_parameters (token, desktop_file_id, desktop_entry),
+                 NULL,
+                 xdp_portal_dynamic_launcher_install_async,
+                 cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes the install request.
+ *
+ * Returns: %TRUE if the installation was successful, %FALSE with @error set
+ *   otherwise
+ */
+gboolean
+xdp_portal_dynamic_launcher_install_finish (XdpPortal     *portal,
+                                            GAsyncResult  *result,
+                                            GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_install_async, FALSE);
+
+  ret = g_task_propagate_pointer (G_TASK (result), error);
+  return (ret != NULL);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Asynchronous version of [method@Portal.dynamic_launcher_uninstall].
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_uninstall_finish] to get the result.
+ */
+void
+xdp_portal_dynamic_launcher_uninstall_async (XdpPortal           *portal,
+                                             const char          *desktop_file_id,
+                                             GCancellable        *cancellable,
+                                             GAsyncReadyCallback  callback,
+                                             gpointer             data)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  launcher_call (portal,
+                 "Uninstall",
+                 uninstall_parameters (desktop_file_id),
+                 NULL,
+                 xdp_portal_dynamic_launcher_uninstall_async,
+                 cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes the uninstall request.
+ *
+ * Returns: %TRUE if the uninstallation was successful, %FALSE with @error set
+ *   otherwise
+ */
+gboolean
+xdp_portal_dynamic_launcher_uninstall_finish (XdpPortal     *portal,
+                                              GAsyncResult  *result,
+                                              GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_uninstall_async, FALSE);
+
+  ret = g_task_propagate_pointer (G_TASK (result), error);
+  return (ret != NULL);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_desktop_entry_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Asynchronous version of [method@Portal.dynamic_launcher_get_desktop_entry].
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_get_desktop_entry_finish] to get the
+ * contents of the desktop file.
+ */
+void
+xdp_portal_dynamic_launcher_get_desktop_entry_async (XdpPortal           *portal,
+                                                     const char          *desktop_file_id,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             data)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  launcher_call (portal,
+                 "GetDesktopEntry",
+                 g_variant_new ("(s)", desktop_file_id),
+                 G_VARIANT_TYPE ("(s)"),
+                 xdp_portal_dynamic_launcher_get_desktop_entry_async,
+                 cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_desktop_entry_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes the desktop entry request.
+ *
+ * Returns: (transfer full): the contents of the desktop file, or %NULL with
+ *   @error set
+ */
+char *
+xdp_portal_dynamic_launcher_get_desktop_entry_finish (XdpPortal     *portal,
+                                                      GAsyncResult  *result,
+                                                      GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  char *contents = NULL;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_get_desktop_entry_async, NULL);
+
+  ret = g_task_propagate_pointer (G_TASK (result), error);
+  if (ret == NULL)
+    return NULL;
+
+  g_variant_get (ret, "(s)", &contents);
+  return contents;
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_icon_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Asynchronous version of [method@Portal.dynamic_launcher_get_icon].
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_get_icon_finish] to get the icon.
+ */
+void
+xdp_portal_dynamic_launcher_get_icon_async (XdpPortal           *portal,
+                                            const char          *desktop_file_id,
+                                            GCancellable        *cancellable,
+                                            GAsyncReadyCallback  callback,
+                                            gpointer             data)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  launcher_call (portal,
+                 "GetIcon",
+                 g_variant_new ("(s)", desktop_file_id),
+                 G_VARIANT_TYPE ("(vsu)"),
+                 xdp_portal_dynamic_launcher_get_icon_async,
+                 cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_icon_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @out_icon_format: (nullable): return location for icon format string, one of "png", "jpeg", "svg"
+ * @out_icon_size: (nullable): return location for icon size
+ * @error: return location for a #GError
+ *
+ * Finishes the icon request.
+ *
+ * Returns: (transfer full): the icon in a format recognized by g_icon_deserialize(),
+ *   or %NULL with @error set
+ */
+GVariant *
+xdp_portal_dynamic_launcher_get_icon_finish (XdpPortal     *portal,
+                                             GAsyncResult  *result,
+                                             char         **out_icon_format,
+                                             guint         *out_icon_size,
+                                             GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GVariant) icon_v = NULL;
+  g_autofree char *icon_format = NULL;
+  guint icon_size;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_get_icon_async, NULL);
+
+  ret = g_task_propagate_pointer (G_TASK (result), error);
+  if (ret == NULL)
+    return NULL;
+
+  g_variant_get (ret, "(vsu)", &icon_v, &icon_format, &icon_size);
+
+  if (out_icon_format)
+    *out_icon_format = g_steal_pointer (&icon_format);
+  if (out_icon_size)
+    *out_icon_size = icon_size;
+
+  return g_steal_pointer (&icon_v);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_launch_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @activation_token: (nullable): the activation token, see the "XDG activation" section of the wayland-protocols docs
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Asynchronous version of [method@Portal.dynamic_launcher_launch].
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_launch_finish] to get the result.
+ */
+void
+xdp_portal_dynamic_launcher_launch_async (XdpPortal           *portal,
+                                          const char          *desktop_file_id,
+                                          const char          *activation_token,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             data)
+{
+  GVariantBuilder opt_builder;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  if (activation_token != NULL && *activation_token != '\0')
+    g_variant_builder_add (&opt_builder, "{sv}", "activation_token", g_variant_new_string (activation_token));
+
+  launcher_call (portal,
+                 "Launch",
+                 g_variant_new ("(sa{sv})", desktop_file_id, &opt_builder),
+                 NULL,
+                 xdp_portal_dynamic_launcher_launch_async,
+                 cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_launch_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes the launch request.
+ *
+ * Returns: %TRUE if the launch was successful, %FALSE with @error set
+ *   otherwise
+ */
+gboolean
+xdp_portal_dynamic_launcher_launch_finish (XdpPortal     *portal,
+                                           GAsyncResult  *result,
+                                           GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_launch_async, FALSE);
+
+  ret = g_task_propagate_pointer (G_TASK (result), error);
+  return (ret != NULL);
+}
+
+/* Largest number of batched calls to have pending at once */
+#define MAX_BATCH_CALLS_IN_FLIGHT 8
+
+typedef struct {
+  XdpPortal *portal;
+  GTask *task;
+  XdpBatch *batch;
+  const char *method;
+  GPtrArray *parameters; /* GVariant */
+} BatchCall;
+
+typedef struct {
+  BatchCall *call;
+  guint index;
+} BatchJob;
+
+static void
+batch_call_free (BatchCall *call)
+{
+  g_object_unref (call->portal);
+  g_object_unref (call->task);
+  g_ptr_array_unref (call->parameters);
+
+  g_free (call);
+}
+
+static void
+batch_returned (GObject      *object,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  BatchJob *job = data;
+  BatchCall *call = job->call;
+  guint index = job->index;
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+
+  g_free (job);
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+
+  _xdp_batch_entry_done (call->batch, index, error);
+}
+
+static gboolean
+batch_send (XdpBatch  *batch,
+            guint      index,
+            gpointer   data,
+            GError   **error)
+{
+  BatchCall *call = data;
+  BatchJob *job;
+
+  job = g_new0 (BatchJob, 1);
+  job->call = call;
+  job->index = index;
+
+  /* Not cancelled once sent, so that the result reports whether the
+   * launcher was installed or uninstalled */
+  g_dbus_connection_call (call->portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.portal.DynamicLauncher",
+                          call->method,
+                          g_ptr_array_index (call->parameters, index),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          batch_returned,
+                          job);
+
+  return TRUE;
+}
+
+static void
+batch_done (GPtrArray *errors,
+            gpointer   data)
+{
+  BatchCall *call = data;
+
+  g_task_return_pointer (call->task, errors, (GDestroyNotify) g_ptr_array_unref);
+  batch_call_free (call);
+}
+
+static void
+batch_start (XdpPortal           *portal,
+             const char          *method,
+             GPtrArray           *parameters,
+             gpointer             source_tag,
+             GCancellable        *cancellable,
+             GAsyncReadyCallback  callback,
+             gpointer             data)
+{
+  BatchCall *call;
+
+  call = g_new0 (BatchCall, 1);
+  call->portal = g_object_ref (portal);
+  call->method = method;
+  call->parameters = parameters;
+
+  call->task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (call->task, source_tag);
+  /* Per-entry errors are reported in the result, including cancellation */
+  g_task_set_check_cancellable (call->task, FALSE);
+
+  call->batch = _xdp_batch_new (parameters->len,
+                                MAX_BATCH_CALLS_IN_FLIGHT,
+                                cancellable,
+                                batch_send,
+                                batch_done,
+                                call);
+  _xdp_batch_start (call->batch);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_many:
+ * @portal: a [class@Portal]
+ * @tokens: (array zero-terminated): the tokens for each launcher, as for
+ *   [method@Portal.dynamic_launcher_install]
+ * @desktop_file_ids: (array zero-terminated): the .desktop file names to be used
+ * @desktop_entries: (array zero-terminated): the key-files to be used for the
+ *   contents of the .desktop files
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Installs several launchers, like calling
+ * [method@Portal.dynamic_launcher_install] for each element of the
+ * arrays, which must have the same length.
+ *
+ * The calls are pipelined, with a few of them pending at once, instead
+ * of waiting for each launcher to be installed before installing the
+ * next one. The request completes when all of them have been handled.
+ * Cancelling it stops installing further launchers; the results of the
+ * calls that were already sent are still reported.
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_install_many_finish] to get the results.
+ */
+void
+xdp_portal_dynamic_launcher_install_many (XdpPortal           *portal,
+                                          const char * const  *tokens,
+                                          const char * const  *desktop_file_ids,
+                                          const char * const  *desktop_entries,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             data)
+{
+  GPtrArray *parameters;
+  guint n, i;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (tokens != NULL);
+  g_return_if_fail (desktop_file_ids != NULL);
+  g_return_if_fail (desktop_entries != NULL);
+
+  n = g_strv_length ((char **) tokens);
+  g_return_if_fail (g_strv_length ((char **) desktop_file_ids) == n);
+  g_return_if_fail (g_strv_length ((char **) desktop_entries) == n);
+
+  parameters = g_ptr_array_new_full (n, (GDestroyNotify) g_variant_unref);
+  for (i = 0; i < n; i++)
+    g_ptr_array_add (parameters,
+                     g_variant_ref_sink (install_parameters (tokens[i],
+                                                             desktop_file_ids[i],
+                                                             desktop_entries[i])));
+
+  batch_start (portal, "Install", parameters,
+               xdp_portal_dynamic_launcher_install_many,
+               cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_many_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes the batch install request.
+ *
+ * Returns: (transfer full) (element-type GError): the result of each
+ *   installation, in the order of the arguments; the element for each
+ *   launcher that could not be installed holds the reason, the others
+ *   are `NULL`
+ */
+GPtrArray *
+xdp_portal_dynamic_launcher_install_many_finish (XdpPortal     *portal,
+                                                 GAsyncResult  *result,
+                                                 GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_install_many, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_many:
+ * @portal: a [class@Portal]
+ * @desktop_file_ids: (array zero-terminated): the .desktop file names
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Uninstalls several launchers, like calling
+ * [method@Portal.dynamic_launcher_uninstall] for each element of
+ * @desktop_file_ids.
+ *
+ * The calls are pipelined in the same way as
+ * [method@Portal.dynamic_launcher_install_many].
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.dynamic_launcher_uninstall_many_finish] to get the results.
+ */
+void
+xdp_portal_dynamic_launcher_uninstall_many (XdpPortal           *portal,
+                                            const char * const  *desktop_file_ids,
+                                            GCancellable        *cancellable,
+                                            GAsyncReadyCallback  callback,
+                                            gpointer             data)
+{
+  GPtrArray *parameters;
+  guint n, i;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_ids != NULL);
+
+  n = g_strv_length ((char **) desktop_file_ids);
+
+  parameters = g_ptr_array_new_full (n, (GDestroyNotify) g_variant_unref);
+  for (i = 0; i < n; i++)
+    g_ptr_array_add (parameters,
+                     g_variant_ref_sink (uninstall_parameters (desktop_file_ids[i])));
+
+  batch_start (portal, "Uninstall", parameters,
+               xdp_portal_dynamic_launcher_uninstall_many,
+               cancellable, callback, data);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_many_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes the batch uninstall request.
+ *
+ * Returns: (transfer full) (element-type GError): the result of each
+ *   uninstallation, in the order of the arguments; the element for each
+ *   launcher that could not be uninstalled holds the reason, the others
+ *   are `NULL`
+ */
+GPtrArray *
+xdp_portal_dynamic_launcher_uninstall_many_finish (XdpPortal     *portal,
+                                                   GAsyncResult  *result,
+                                                   GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_dynamic_launcher_uninstall_many, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
@@ -27,7 +27,9 @@
 
 #include <glib/gstdio.h>
 #include <gio/gunixfdlist.h>
+#include <gio/gunixoutputstream.h>
 
+#include "memfd-private.h"
 #include "portal-private.h"
 #include "email.h"
 
@@ -35,6 +37,21 @@
 #define O_PATH 0
 #endif
 
+typedef enum {
+  ATTACHMENT_PATH,
+  ATTACHMENT_BYTES,
+  ATTACHMENT_STREAM,
+} AttachmentType;
+
+typedef struct {
+  AttachmentType type;
+  char *path;
+  GBytes *bytes;
+  GInputStream *stream;
+  int fd;
+  GError *error;
+} Attachment;
+
 typedef struct {
   XdpPortal *portal;
   XdpParent *parent;
@@ -44,13 +61,38 @@ typedef struct {
   char **bcc;
   char *subject;
   char *body;
-  char **attachments;
+  GPtrArray *attachments;
+  gboolean attachments_ready;
+  guint n_pending_attachments;
   guint signal_id;
   GTask *task;
   char *request_path;
   gulong cancelled_id;
 } EmailCall;
 
+static void
+attachment_free (Attachment *attachment)
+{
+  g_free (attachment->path);
+  g_clear_pointer (&attachment->bytes, g_bytes_unref);
+  g_clear_object (&attachment->stream);
+  g_clear_fd (&attachment->fd, NULL);
+  g_clear_error (&attachment->error);
+  g_free (attachment);
+}
+
+static Attachment *
+attachment_new (AttachmentType type)
+{
+  Attachment *attachment;
+
+  attachment = g_new0 (Attachment, 1);
+  attachment->type = type;
+  attachment->fd = -1;
+
+  return attachment;
+}
+
 static void
 email_call_free (EmailCall *call)
 {
@@ -76,7 +118,7 @@ email_call_free (EmailCall *call)
   g_strfreev (call->bcc);
   g_free (call->subject);
   g_free (call->body);
-  g_strfreev (call->attachments);
+  g_ptr_array_unref (call->attachments);
 
   g_free (call);
 }
@@ -163,6 +205,153 @@ call_returned (GObject *object,
     }
 }
 
+static void
+get_email_version_returned (GObject      *object,
+                            GAsyncResult *result,
+                            gpointer      data)
+{
+  g_autoptr(GVariant) version_variant = NULL;
+  g_autoptr(GVariant) ret = NULL;
+  EmailCall *call = data;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (error)
+    {
+      g_task_return_error (call->task, error);
+      email_call_free (call);
+      return;
+    }
+
+  g_variant_get_child (ret, 0, "v", &version_variant);
+  call->portal->email_interface_version = g_variant_get_uint32 (version_variant);
+
+  compose_email (call);
+}
+
+static void
+get_email_interface_version (EmailCall *call)
+{
+  g_dbus_connection_call (call->portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.DBus.Properties",
+                          "Get",
+                          g_variant_new ("(ss)", "org.freedesktop.portal.Email", "version"),
+                          G_VARIANT_TYPE ("(v)"),
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          g_task_get_cancellable (call->task),
+                          get_email_version_returned,
+                          call);
+}
+
+/* Runs in a worker thread. Each attachment is handled by a thread of
+ * its own, so that slow files or streams don't hold up the others. */
+static void
+prepare_attachment_in_thread (GTask        *task,
+                              gpointer      source_object,
+                              gpointer      task_data,
+                              GCancellable *cancellable)
+{
+  Attachment *attachment = task_data;
+  g_autofd int fd = -1;
+
+  switch (attachment->type)
+    {
+    case ATTACHMENT_PATH:
+      fd = g_open (attachment->path, O_PATH | O_CLOEXEC);
+      if (fd == -1)
+        g_warning ("Failed to open %s, skipping", attachment->path);
+      break;
+
+    case ATTACHMENT_BYTES:
+      fd = _xdp_memfd_new_from_bytes ("libportal-attachment", attachment->bytes, &attachment->error);
+      break;
+
+    case ATTACHMENT_STREAM:
+      fd = _xdp_memfd_new ("libportal-attachment", &attachment->error);
+      if (fd != -1)
+        {
+          g_autoptr(GOutputStream) memfd_stream = NULL;
+
+          memfd_stream = g_unix_output_stream_new (fd, FALSE);
+          if (g_output_stream_splice (memfd_stream,
+                                      attachment->stream,
+                                      G_OUTPUT_STREAM_SPLICE_NONE,
+                                      cancellable,
+                                      &attachment->error) == -1)
+            g_clear_fd (&fd, NULL);
+        }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  if (fd != -1 &&
+      attachment->type != ATTACHMENT_PATH &&
+      !_xdp_memfd_seal (fd, &attachment->error))
+    g_clear_fd (&fd, NULL);
+
+  attachment->fd = g_steal_fd (&fd);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+attachment_prepared (GObject      *object,
+                     GAsyncResult *result,
+                     gpointer      data)
+{
+  EmailCall *call = data;
+  guint i;
+
+  if (--call->n_pending_attachments > 0)
+    return;
+
+  if (g_task_return_error_if_cancelled (call->task))
+    {
+      email_call_free (call);
+      return;
+    }
+
+  for (i = 0; i < call->attachments->len; i++)
+    {
+      Attachment *attachment = g_ptr_array_index (call->attachments, i);
+
+      if (attachment->error)
+        {
+          g_task_return_error (call->task, g_steal_pointer (&attachment->error));
+          email_call_free (call);
+          return;
+        }
+    }
+
+  call->attachments_ready = TRUE;
+  compose_email (call);
+}
+
+static void
+prepare_attachments (EmailCall *call)
+{
+  GCancellable *cancellable = g_task_get_cancellable (call->task);
+  guint i;
+
+  call->n_pending_attachments = call->attachments->len;
+
+  for (i = 0; i < call->attachments->len; i++)
+    {
+      g_autoptr(GTask) task = NULL;
+
+      task = g_task_new (NULL, cancellable, attachment_prepared, call);
+      g_task_set_source_tag (task, prepare_attachments);
+      g_task_set_task_data (task, g_ptr_array_index (call->attachments, i), NULL);
+      g_task_set_check_cancellable (task, FALSE);
+      g_task_run_in_thread (task, prepare_attachment_in_thread);
+    }
+}
+
 static void
 compose_email (EmailCall *call)
 {
@@ -170,10 +359,7 @@ compose_email (EmailCall *call)
   g_autofree char *token = NULL;
   g_autoptr(GUnixFDList) fd_list = NULL;
   GCancellable *cancellable;
-  g_autoptr(GVariant) ret = NULL;
-  g_autoptr(GVariant) v = NULL;
   guint version;
-  g_autoptr(GError) error = NULL;
 
   if (call->parent_handle == NULL)
     {
@@ -181,21 +367,19 @@ compose_email (EmailCall *call)
       return;
     }
 
-  ret = g_dbus_connection_call_sync (call->portal->bus,
-                                     PORTAL_BUS_NAME,
-                                     PORTAL_OBJECT_PATH,
-                                     "org.freedesktop.DBus.Properties",
-                                     "Get",
-                                     g_variant_new ("(ss)", "org.freedesktop.portal.Email", "version"),
-                                     G_VARIANT_TYPE ("(v)"),
-                                     0,
-                                     G_MAXINT,
-                                     NULL,
-                                     &error);
-  if (!ret)
-    g_warning ("%s", error->message);
-  g_variant_get (ret, "(v)", &v);
-  g_variant_get (v, "u", &version);
+  if (call->portal->email_interface_version == 0)
+    {
+      get_email_interface_version (call);
+      return;
+    }
+
+  if (!call->attachments_ready && call->attachments->len > 0)
+    {
+      prepare_attachments (call);
+      return;
+    }
+
+  version = call->portal->email_interface_version;
 
   token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
   call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
@@ -235,30 +419,28 @@ compose_email (EmailCall *call)
     g_variant_builder_add (&options, "{sv}", "subject", g_variant_new_string (call->subject));
   if (call->body)
     g_variant_builder_add (&options, "{sv}", "body", g_variant_new_string (call->body));
-  if (call->attachments)
+  if (call->attachments->len > 0)
     {
       GVariantBuilder attach_fds;
-      int i;
+      guint i;
 
       fd_list = g_unix_fd_list_new ();
       g_variant_builder_init (&attach_fds, G_VARIANT_TYPE ("ah"));
 
-      for (i = 0; call->attachments[i]; i++)
+      for (i = 0; i < call->attachments->len; i++)
         {
+          Attachment *attachment = g_ptr_array_index (call->attachments, i);
           g_autoptr(GError) error = NULL;
-          g_autofd int fd = -1;
           int fd_in;
 
-          fd = g_open (call->attachments[i], O_PATH | O_CLOEXEC);
-          if (fd == -1)
-            {
-              g_warning ("Failed to open %s, skipping", call->attachments[i]);
-              continue;
-            }
-          fd_in = g_unix_fd_list_append (fd_list, fd, &error);
+          /* Files that couldn't be opened are skipped */
+          if (attachment->fd == -1)
+            continue;
+
+          fd_in = g_unix_fd_list_append (fd_list, attachment->fd, &error);
           if (error)
             {
-              g_warning ("Failed to add %s to request, skipping: %s", call->attachments[i], error->message);
+              g_warning ("Failed to add attachment to request, skipping: %s", error->message);
               continue;
             }
           g_variant_builder_add (&attach_fds, "h", fd_in);
@@ -282,6 +464,21 @@ compose_email (EmailCall *call)
                                             call);
 }
 
+static void
+add_path_attachments (EmailCall         *call,
+                      const char *const *paths)
+{
+  guint i;
+
+  for (i = 0; paths && paths[i]; i++)
+    {
+      Attachment *attachment = attachment_new (ATTACHMENT_PATH);
+
+      attachment->path = g_strdup (paths[i]);
+      g_ptr_array_add (call->attachments, attachment);
+    }
+}
+
 /**
  * xdp_portal_compose_email:
  * @portal: a [class@Portal]
@@ -333,7 +530,8 @@ xdp_portal_compose_email (XdpPortal *portal,
   call->bcc = g_strdupv ((char **)bcc);
   call->subject = g_strdup (subject);
   call->body = g_strdup (body);
-  call->attachments = g_strdupv ((char **)attachments);
+  call->attachments = g_ptr_array_new_with_free_func ((GDestroyNotify) attachment_free);
+  add_path_attachments (call, attachments);
   call->task = g_task_new (portal, cancellable, callback, data);
   g_task_set_source_tag (call->task, xdp_portal_compose_email);
 
@@ -361,3 +559,118 @@ xdp_portal_compose_email_finish (XdpPortal *portal,
 
   return g_task_propagate_boolean (G_TASK (result), error);
 }
+
+/**
+ * xdp_portal_compose_email_full:
+ * @portal: a [class@Portal]
+ * @parent: (nullable): parent window information
+ * @addresses: (array zero-terminated=1) (nullable): the email addresses to send to
+ * @cc: (array zero-terminated=1) (nullable): the email addresses to cc
+ * @bcc: (array zero-terminated=1) (nullable): the email addresses to bcc
+ * @subject: (nullable): the subject for the email
+ * @body: (nullable): the body for the email
+ * @attachments: (array zero-terminated=1) (nullable): an array of paths for files to attach
+ * @attachment_bytes: (element-type GBytes) (nullable): contents of additional
+ *   attachments
+ * @attachment_streams: (element-type GInputStream) (nullable): streams with
+ *   the contents of additional attachments
+ * @flags: options for this call
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Presents a window that lets the user compose an email, like
+ * [method@Portal.compose_email], with attachments that can also be
+ * held in memory.
+ *
+ * The contents of @attachment_bytes and @attachment_streams are copied
+ * into sealed memory files, so they never have to be written to disk.
+ * The streams are read from worker threads and must not be used until
+ * the request is done; they are not closed. All attachments are
+ * prepared in parallel.
+ *
+ * Unlike files that cannot be opened, which are skipped, failing to
+ * read an in-memory attachment makes the request fail.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Portal.compose_email_full_finish] to get the results.
+ */
+void
+xdp_portal_compose_email_full (XdpPortal           *portal,
+                               XdpParent           *parent,
+                               const char *const   *addresses,
+                               const char *const   *cc,
+                               const char *const   *bcc,
+                               const char          *subject,
+                               const char          *body,
+                               const char *const   *attachments,
+                               GPtrArray           *attachment_bytes,
+                               GPtrArray           *attachment_streams,
+                               XdpEmailFlags        flags,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             data)
+{
+  EmailCall *call;
+  guint i;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (flags == XDP_EMAIL_FLAG_NONE);
+
+  call = g_new0 (EmailCall, 1);
+  call->portal = g_object_ref (portal);
+  if (parent)
+    call->parent = xdp_parent_copy (parent);
+  else
+    call->parent_handle = g_strdup ("");
+  call->addresses = g_strdupv ((char**)addresses);
+  call->cc = g_strdupv ((char **)cc);
+  call->bcc = g_strdupv ((char **)bcc);
+  call->subject = g_strdup (subject);
+  call->body = g_strdup (body);
+  call->attachments = g_ptr_array_new_with_free_func ((GDestroyNotify) attachment_free);
+  add_path_attachments (call, attachments);
+
+  for (i = 0; attachment_bytes && i < attachment_bytes->len; i++)
+    {
+      Attachment *attachment = attachment_new (ATTACHMENT_BYTES);
+
+      attachment->bytes = g_bytes_ref (g_ptr_array_index (attachment_bytes, i));
+      g_ptr_array_add (call->attachments, attachment);
+    }
+
+  for (i = 0; attachment_streams && i < attachment_streams->len; i++)
+    {
+      Attachment *attachment = attachment_new (ATTACHMENT_STREAM);
+
+      attachment->stream = g_object_ref (g_ptr_array_index (attachment_streams, i));
+      g_ptr_array_add (call->attachments, attachment);
+    }
+
+  call->task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (call->task, xdp_portal_compose_email_full);
+
+  compose_email (call);
+}
+
+/**
+ * xdp_portal_compose_email_full_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes the compose-email request.
+ *
+ * Returns: `TRUE` if the request was handled successfully
+ */
+gboolean
+xdp_portal_compose_email_full_finish (XdpPortal     *portal,
+                                      GAsyncResult  *result,
+                                      GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_compose_email_full, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -46,4 +46,25 @@ gboolean   xdp_portal_compose_email_finish (XdpPortal            *portal,
                                             GAsyncResult         *result,
                                             GError              **error);
 
+XDP_PUBLIC
+void       xdp_portal_compose_email_full   (XdpPortal            *portal,
+                                            XdpParent            *parent,
+                                            const char *const    *addresses,
+                                            const char *const    *cc,
+                                            const char *const    *bcc,
+                                            const char           *subject,
+                                            const char           *body,
+                                            const char *const    *attachments,
+                                            GPtrArray            *attachment_bytes,
+                                            GPtrArray            *attachment_streams,
+                                            XdpEmailFlags         flags,
+                                            GCancellable         *cancellable,
+                                            GAsyncReadyCallback   callback,
+                                            gpointer              data);
+
+XDP_PUBLIC
+gboolean   xdp_portal_compose_email_full_finish (XdpPortal       *portal,
+                                                 GAsyncResult    *result,
+                                                 GError         **error);
+
 G_END_DECLS
@@ -0,0 +1,660 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <math.h>
+
+#include "geofence.h"
+#include "location-private.h"
+#include "portal-private.h"
+
+/**
+ * XdpGeofence
+ *
+ * Client-side geofencing on top of the location portal.
+ *
+ * A [class@Geofence] tracks a set of circular or polygonal regions and
+ * tells whether the location reported by the [class@Portal] enters,
+ * leaves or stays in them. Location monitoring itself must be started
+ * separately with [method@Portal.location_monitor_start].
+ *
+ * Regions are indexed in a grid of fixed size cells, so the cost of
+ * handling a location update depends on the number of regions near
+ * the location, not on the total number of regions.
+ */
+
+/* Size of a grid cell, in degrees (about 5.5 km in latitude) */
+#define GRID_CELL_SIZE 0.05
+
+/* Regions spanning more cells than this are tested for every update
+ * instead of being added to every cell they touch. */
+#define MAX_INDEXED_CELLS 256
+
+/* Meters per degree of latitude */
+#define METERS_PER_DEGREE (XDP_EARTH_RADIUS * G_PI / 180.0)
+
+typedef enum {
+  FENCE_CIRCLE,
+  FENCE_POLYGON,
+} FenceType;
+
+typedef struct {
+  XdpGeofence *geofence;
+  guint id;
+  FenceType type;
+
+  /* Circle */
+  double latitude;
+  double longitude;
+  double radius;
+
+  /* Polygon, as interleaved latitude/longitude pairs */
+  double *points;
+  gsize n_points;
+
+  /* Bounding box */
+  double min_latitude;
+  double max_latitude;
+  double min_longitude;
+  double max_longitude;
+  gboolean indexed;
+
+  gboolean inside;
+  guint dwell_timeout_id;
+} Fence;
+
+struct _XdpGeofence {
+  GObject parent_instance;
+
+  XdpPortal *portal;
+
+  guint next_id;
+  GHashTable *fences; /* id -> Fence */
+  GHashTable *grid; /* cell -> GPtrArray of Fence */
+  GPtrArray *unindexed;
+  GHashTable *inside; /* Fence set */
+
+  guint dwell_time;
+};
+
+enum {
+  ENTERED,
+  EXITED,
+  DWELL,
+  LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL];
+
+G_DEFINE_TYPE (XdpGeofence, xdp_geofence, G_TYPE_OBJECT)
+
+static void
+fence_free (Fence *fence)
+{
+  g_clear_handle_id (&fence->dwell_timeout_id, g_source_remove);
+  g_free (fence->points);
+  g_free (fence);
+}
+
+/* Number of grid cells around the globe */
+#define GRID_CELLS_PER_TURN ((gint64) (360.0 / GRID_CELL_SIZE + 0.5))
+
+static gint64
+grid_index (double degrees)
+{
+  return (gint64) floor (degrees / GRID_CELL_SIZE);
+}
+
+/* Maps longitude indices beyond ±180° back onto the globe, so that
+ * regions crossing the antimeridian land in the cells of both sides */
+static gint64
+grid_wrap_longitude_index (gint64 longitude_index)
+{
+  gint64 half = GRID_CELLS_PER_TURN / 2;
+  gint64 wrapped = (longitude_index + half) % GRID_CELLS_PER_TURN;
+
+  if (wrapped < 0)
+    wrapped += GRID_CELLS_PER_TURN;
+
+  return wrapped - half;
+}
+
+static gint64
+grid_cell (gint64 latitude_index,
+           gint64 longitude_index)
+{
+  longitude_index = grid_wrap_longitude_index (longitude_index);
+
+  /* Shift as unsigned, since the indices are negative south and west */
+  return (gint64) (((guint64) latitude_index << 32) | (guint32) longitude_index);
+}
+
+static void
+grid_insert (XdpGeofence *geofence,
+             gint64       cell,
+             Fence       *fence)
+{
+  GPtrArray *fences;
+
+  fences = g_hash_table_lookup (geofence->grid, &cell);
+  if (!fences)
+    {
+      fences = g_ptr_array_new ();
+      g_hash_table_insert (geofence->grid, g_memdup2 (&cell, sizeof (cell)), fences);
+    }
+
+  g_ptr_array_add (fences, fence);
+}
+
+static void
+grid_remove (XdpGeofence *geofence,
+             gint64       cell,
+             Fence       *fence)
+{
+  GPtrArray *fences;
+
+  fences = g_hash_table_lookup (geofence->grid, &cell);
+  if (!fences)
+    return;
+
+  g_ptr_array_remove_fast (fences, fence);
+  if (fences->len == 0)
+    g_hash_table_remove (geofence->grid, &cell);
+}
+
+static void
+index_fence (XdpGeofence *geofence,
+             Fence       *fence,
+             gboolean     add)
+{
+  gint64 min_lat = grid_index (fence->min_latitude);
+  gint64 max_lat = grid_index (fence->max_latitude);
+  gint64 min_lon = grid_index (fence->min_longitude);
+  gint64 max_lon = grid_index (fence->max_longitude);
+  gint64 lat, lon;
+
+  if (add)
+    fence->indexed = max_lon - min_lon < GRID_CELLS_PER_TURN &&
+                     (max_lat - min_lat + 1) * (max_lon - min_lon + 1) <= MAX_INDEXED_CELLS;
+
+  if (!fence->indexed)
+    {
+      if (add)
+        g_ptr_array_add (geofence->unindexed, fence);
+      else
+        g_ptr_array_remove_fast (geofence->unindexed, fence);
+      return;
+    }
+
+  for (lat = min_lat; lat <= max_lat; lat++)
+    for (lon = min_lon; lon <= max_lon; lon++)
+      {
+        if (add)
+          grid_insert (geofence, grid_cell (lat, lon), fence);
+        else
+          grid_remove (geofence, grid_cell (lat, lon), fence);
+      }
+}
+
+static gboolean
+fence_contains_longitude (Fence  *fence,
+                          double  longitude)
+{
+  /* Bounding boxes of circles may extend past ±180° */
+  return (longitude >= fence->min_longitude && longitude <= fence->max_longitude) ||
+         (longitude + 360.0 >= fence->min_longitude && longitude + 360.0 <= fence->max_longitude) ||
+         (longitude - 360.0 >= fence->min_longitude && longitude - 360.0 <= fence->max_longitude);
+}
+
+static gboolean
+fence_contains (Fence  *fence,
+                double  latitude,
+                double  longitude)
+{
+  gboolean inside = FALSE;
+  gsize i, j;
+
+  if (latitude < fence->min_latitude || latitude > fence->max_latitude ||
+      !fence_contains_longitude (fence, longitude))
+    return FALSE;
+
+  if (fence->type == FENCE_CIRCLE)
+    return _xdp_location_distance (fence->latitude, fence->longitude,
+                                   latitude, longitude) <= fence->radius;
+
+  /* Ray casting; polygons are treated as planar in latitude/longitude */
+  for (i = 0, j = fence->n_points - 1; i < fence->n_points; j = i++)
+    {
+      double lat_i = fence->points[2 * i];
+      double lon_i = fence->points[2 * i + 1];
+      double lat_j = fence->points[2 * j];
+      double lon_j = fence->points[2 * j + 1];
+
+      if ((lat_i > latitude) != (lat_j > latitude) &&
+          longitude < (lon_j - lon_i) * (latitude - lat_i) / (lat_j - lat_i) + lon_i)
+        inside = !inside;
+    }
+
+  return inside;
+}
+
+static gboolean
+dwell_timeout_cb (gpointer data)
+{
+  Fence *fence = data;
+
+  fence->dwell_timeout_id = 0;
+  g_signal_emit (fence->geofence, signals[DWELL], 0, fence->id);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+set_fence_inside (XdpGeofence *geofence,
+                  Fence       *fence,
+                  gboolean     inside)
+{
+  if (fence->inside == inside)
+    return;
+
+  fence->inside = inside;
+
+  if (inside)
+    {
+      g_hash_table_add (geofence->inside, fence);
+      if (geofence->dwell_time > 0)
+        fence->dwell_timeout_id = g_timeout_add (geofence->dwell_time, dwell_timeout_cb, fence);
+      g_signal_emit (geofence, signals[ENTERED], 0, fence->id);
+    }
+  else
+    {
+      g_hash_table_remove (geofence->inside, fence);
+      g_clear_handle_id (&fence->dwell_timeout_id, g_source_remove);
+      g_signal_emit (geofence, signals[EXITED], 0, fence->id);
+    }
+}
+
+static void
+location_fix_cb (XdpPortal      *portal,
+                 XdpLocationFix *fix,
+                 XdpGeofence    *geofence)
+{
+  xdp_geofence_update (geofence, fix);
+}
+
+static void
+location_fixes_cb (XdpPortal   *portal,
+                   GPtrArray   *fixes,
+                   XdpGeofence *geofence)
+{
+  guint i;
+
+  for (i = 0; i < fixes->len; i++)
+    xdp_geofence_update (geofence, g_ptr_array_index (fixes, i));
+}
+
+static void
+xdp_geofence_finalize (GObject *object)
+{
+  XdpGeofence *geofence = XDP_GEOFENCE (object);
+
+  g_clear_pointer (&geofence->inside, g_hash_table_unref);
+  g_clear_pointer (&geofence->grid, g_hash_table_unref);
+  g_clear_pointer (&geofence->unindexed, g_ptr_array_unref);
+  g_clear_pointer (&geofence->fences, g_hash_table_unref);
+  g_clear_object (&geofence->portal);
+
+  G_OBJECT_CLASS (xdp_geofence_parent_class)->finalize (object);
+}
+
+static void
+xdp_geofence_class_init (XdpGeofenceClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = xdp_geofence_finalize;
+
+  /**
+   * XdpGeofence::entered:
+   * @geofence: the [class@Geofence]
+   * @id: the ID of the region
+   *
+   * Emitted when the location moves into a region.
+   */
+  signals[ENTERED] =
+    g_signal_new ("entered",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  G_TYPE_UINT);
+
+  /**
+   * XdpGeofence::exited:
+   * @geofence: the [class@Geofence]
+   * @id: the ID of the region
+   *
+   * Emitted when the location moves out of a region.
+   */
+  signals[EXITED] =
+    g_signal_new ("exited",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  G_TYPE_UINT);
+
+  /**
+   * XdpGeofence::dwell:
+   * @geofence: the [class@Geofence]
+   * @id: the ID of the region
+   *
+   * Emitted when the location has stayed inside a region for the time
+   * set with [method@Geofence.set_dwell_time].
+   */
+  signals[DWELL] =
+    g_signal_new ("dwell",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  G_TYPE_UINT);
+}
+
+static void
+xdp_geofence_init (XdpGeofence *geofence)
+{
+  geofence->next_id = 1;
+  geofence->fences = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) fence_free);
+  geofence->grid = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                          g_free, (GDestroyNotify) g_ptr_array_unref);
+  geofence->unindexed = g_ptr_array_new ();
+  geofence->inside = g_hash_table_new (NULL, NULL);
+}
+
+/**
+ * xdp_geofence_new:
+ * @portal: a [class@Portal]
+ *
+ * Creates a new [class@Geofence] that follows the location updates
+ * of @portal.
+ *
+ * Returns: (transfer full): the new [class@Geofence]
+ */
+XdpGeofence *
+xdp_geofence_new (XdpPortal *portal)
+{
+  XdpGeofence *geofence;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+
+  geofence = g_object_new (XDP_TYPE_GEOFENCE, NULL);
+  geofence->portal = g_object_ref (portal);
+
+  g_signal_connect_object (portal, "location-fix",
+                           G_CALLBACK (location_fix_cb), geofence, 0);
+  g_signal_connect_object (portal, "location-fixes",
+                           G_CALLBACK (location_fixes_cb), geofence, 0);
+
+  return geofence;
+}
+
+static guint
+add_fence (XdpGeofence *geofence,
+           Fence       *fence)
+{
+  fence->geofence = geofence;
+  fence->id = geofence->next_id++;
+
+  g_hash_table_insert (geofence->fences, GUINT_TO_POINTER (fence->id), fence);
+  index_fence (geofence, fence, TRUE);
+
+  return fence->id;
+}
+
+/**
+ * xdp_geofence_add_circle:
+ * @geofence: a [class@Geofence]
+ * @latitude: the latitude of the center, in degrees
+ * @longitude: the longitude of the center, in degrees
+ * @radius: the radius, in meters
+ *
+ * Adds a circular region. The region may cross the antimeridian.
+ *
+ * Returns: the ID of the region
+ */
+guint
+xdp_geofence_add_circle (XdpGeofence *geofence,
+                         double       latitude,
+                         double       longitude,
+                         double       radius)
+{
+  Fence *fence;
+  double delta_latitude;
+  double delta_longitude;
+
+  g_return_val_if_fail (XDP_IS_GEOFENCE (geofence), 0);
+  g_return_val_if_fail (radius > 0, 0);
+
+  delta_latitude = radius / METERS_PER_DEGREE;
+  /* Avoid blowing up the bounding box close to the poles */
+  delta_longitude = delta_latitude / MAX (cos (latitude * G_PI / 180.0), 0.01);
+
+  fence = g_new0 (Fence, 1);
+  fence->type = FENCE_CIRCLE;
+  fence->latitude = latitude;
+  fence->longitude = longitude;
+  fence->radius = radius;
+  fence->min_latitude = latitude - delta_latitude;
+  fence->max_latitude = latitude + delta_latitude;
+  fence->min_longitude = longitude - MIN (delta_longitude, 180.0);
+  fence->max_longitude = longitude + MIN (delta_longitude, 180.0);
+
+  return add_fence (geofence, fence);
+}
+
+/**
+ * xdp_geofence_add_polygon:
+ * @geofence: a [class@Geofence]
+ * @coordinates: (array length=n_coordinates): the corners of the polygon,
+ *   as latitude and longitude pairs in degrees
+ * @n_coordinates: the number of elements in @coordinates
+ *
+ * Adds a polygonal region.
+ *
+ * The polygon is closed implicitly and must not cross the antimeridian.
+ *
+ * Returns: the ID of the region
+ */
+guint
+xdp_geofence_add_polygon (XdpGeofence  *geofence,
+                          const double *coordinates,
+                          gsize         n_coordinates)
+{
+  Fence *fence;
+  gsize i;
+
+  g_return_val_if_fail (XDP_IS_GEOFENCE (geofence), 0);
+  g_return_val_if_fail (coordinates != NULL, 0);
+  g_return_val_if_fail (n_coordinates >= 6 && n_coordinates % 2 == 0, 0);
+
+  fence = g_new0 (Fence, 1);
+  fence->type = FENCE_POLYGON;
+  fence->points = g_memdup2 (coordinates, n_coordinates * sizeof (double));
+  fence->n_points = n_coordinates / 2;
+  fence->min_latitude = fence->max_latitude = coordinates[0];
+  fence->min_longitude = fence->max_longitude = coordinates[1];
+
+  for (i = 1; i < fence->n_points; i++)
+    {
+      fence->min_latitude = MIN (fence->min_latitude, coordinates[2 * i]);
+      fence->max_latitude = MAX (fence->max_latitude, coordinates[2 * i]);
+      fence->min_longitude = MIN (fence->min_longitude, coordinates[2 * i + 1]);
+      fence->max_longitude = MAX (fence->max_longitude, coordinates[2 * i + 1]);
+    }
+
+  return add_fence (geofence, fence);
+}
+
+/**
+ * xdp_geofence_remove:
+ * @geofence: a [class@Geofence]
+ * @id: the ID of a region
+ *
+ * Removes a region. No [signal@Geofence::exited] signal is emitted
+ * for it.
+ *
+ * Returns: `TRUE` if the region was found
+ */
+gboolean
+xdp_geofence_remove (XdpGeofence *geofence,
+                     guint        id)
+{
+  Fence *fence;
+
+  g_return_val_if_fail (XDP_IS_GEOFENCE (geofence), FALSE);
+
+  fence = g_hash_table_lookup (geofence->fences, GUINT_TO_POINTER (id));
+  if (!fence)
+    return FALSE;
+
+  index_fence (geofence, fence, FALSE);
+  g_hash_table_remove (geofence->inside, fence);
+  g_hash_table_remove (geofence->fences, GUINT_TO_POINTER (id));
+
+  return TRUE;
+}
+
+/**
+ * xdp_geofence_is_inside:
+ * @geofence: a [class@Geofence]
+ * @id: the ID of a region
+ *
+ * Returns whether the last known location is inside the region.
+ *
+ * Returns: `TRUE` if the location is inside the region
+ */
+gboolean
+xdp_geofence_is_inside (XdpGeofence *geofence,
+                        guint        id)
+{
+  Fence *fence;
+
+  g_return_val_if_fail (XDP_IS_GEOFENCE (geofence), FALSE);
+
+  fence = g_hash_table_lookup (geofence->fences, GUINT_TO_POINTER (id));
+
+  return fence != NULL && fence->inside;
+}
+
+/**
+ * xdp_geofence_set_dwell_time:
+ * @geofence: a [class@Geofence]
+ * @dwell_time: the dwell time, in milliseconds, or 0
+ *
+ * Sets how long the location has to stay inside a region before
+ * [signal@Geofence::dwell] is emitted. A value of 0, the default,
+ * disables the signal.
+ *
+ * The new value applies to regions entered from now on.
+ */
+void
+xdp_geofence_set_dwell_time (XdpGeofence *geofence,
+                             guint        dwell_time)
+{
+  g_return_if_fail (XDP_IS_GEOFENCE (geofence));
+
+  geofence->dwell_time = dwell_time;
+}
+
+/**
+ * xdp_geofence_update:
+ * @geofence: a [class@Geofence]
+ * @fix: a [struct@LocationFix]
+ *
+ * Checks the regions against @fix and emits the resulting signals.
+ *
+ * This is called automatically for the location updates of the
+ * [class@Portal] the geofence was created for, but can also be used
+ * to feed locations from other sources.
+ */
+void
+xdp_geofence_update (XdpGeofence          *geofence,
+                     const XdpLocationFix *fix)
+{
+  g_autoptr(GArray) candidates = NULL;
+  g_autoptr(GArray) exited = NULL;
+  g_autoptr(XdpGeofence) self = NULL;
+  GHashTableIter iter;
+  GPtrArray *fences;
+  Fence *fence;
+  gint64 cell;
+  guint i;
+
+  g_return_if_fail (XDP_IS_GEOFENCE (geofence));
+  g_return_if_fail (fix != NULL);
+
+  /* Signal handlers may drop the last reference */
+  self = g_object_ref (geofence);
+
+  /* Regions are tracked by ID, since signal handlers may remove them
+   * while the signals are being emitted */
+  candidates = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  cell = grid_cell (grid_index (fix->latitude), grid_index (fix->longitude));
+  fences = g_hash_table_lookup (geofence->grid, &cell);
+  for (i = 0; fences && i < fences->len; i++)
+    g_array_append_val (candidates, ((Fence *) g_ptr_array_index (fences, i))->id);
+  for (i = 0; i < geofence->unindexed->len; i++)
+    g_array_append_val (candidates, ((Fence *) g_ptr_array_index (geofence->unindexed, i))->id);
+
+  /* Only regions we are currently in can be left, and only regions
+   * indexed in the cell of the new location can be entered. */
+  exited = g_array_new (FALSE, FALSE, sizeof (guint));
+  g_hash_table_iter_init (&iter, geofence->inside);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &fence, NULL))
+    {
+      if (!fence_contains (fence, fix->latitude, fix->longitude))
+        g_array_append_val (exited, fence->id);
+    }
+
+  for (i = 0; i < exited->len; i++)
+    {
+      fence = g_hash_table_lookup (geofence->fences,
+                                   GUINT_TO_POINTER (g_array_index (exited, guint, i)));
+      if (fence)
+        set_fence_inside (geofence, fence, FALSE);
+    }
+
+  for (i = 0; i < candidates->len; i++)
+    {
+      fence = g_hash_table_lookup (geofence->fences,
+                                   GUINT_TO_POINTER (g_array_index (candidates, guint, i)));
+
+      if (fence && !fence->inside && fence_contains (fence, fix->latitude, fix->longitude))
+        set_fence_inside (geofence, fence, TRUE);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/types.h>
+#include <libportal/location.h>
+
+G_BEGIN_DECLS
+
+#define XDP_TYPE_GEOFENCE (xdp_geofence_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpGeofence, xdp_geofence, XDP, GEOFENCE, GObject)
+
+XDP_PUBLIC
+XdpGeofence * xdp_geofence_new             (XdpPortal            *portal);
+
+XDP_PUBLIC
+guint         xdp_geofence_add_circle      (XdpGeofence          *geofence,
+                                            double                latitude,
+                                            double                longitude,
+                                            double                radius);
+
+XDP_PUBLIC
+guint         xdp_geofence_add_polygon     (XdpGeofence          *geofence,
+                                            const double         *coordinates,
+                                            gsize                 n_coordinates);
+
+XDP_PUBLIC
+gboolean      xdp_geofence_remove          (XdpGeofence          *geofence,
+                                            guint                 id);
+
+XDP_PUBLIC
+gboolean      xdp_geofence_is_inside       (XdpGeofence          *geofence,
+                                            guint                 id);
+
+XDP_PUBLIC
+void          xdp_geofence_set_dwell_time  (XdpGeofence          *geofence,
+                                            guint                 dwell_time);
+
+XDP_PUBLIC
+void          xdp_geofence_update          (XdpGeofence          *geofence,
+                                            const XdpLocationFix *fix);
+
+G_END_DECLS
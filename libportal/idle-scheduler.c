@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include "idle-scheduler.h"
+#include "portal-private.h"
+
+/**
+ * XdpIdleScheduler
+ *
+ * Runs deferrable work while the user is away.
+ *
+ * A [class@IdleScheduler] queues background work such as indexing,
+ * cache compaction or prefetching, and only runs it while the
+ * screensaver is active. The work is paused as soon as the user
+ * returns, and resumed the next time the session becomes idle.
+ *
+ * The idle state is taken from the session state reported by the
+ * [class@Portal], so session monitoring must be started separately
+ * with [method@Portal.session_monitor_start].
+ *
+ * Work items run one after another, in the order they were added,
+ * one slice per main loop iteration at low priority.
+ */
+
+typedef struct {
+  guint id;
+  XdpIdleWorkFunc func;
+  gpointer user_data;
+  GDestroyNotify destroy;
+} IdleWork;
+
+struct _XdpIdleScheduler {
+  GObject parent_instance;
+
+  XdpPortal *portal;
+
+  guint next_id;
+  GQueue work; /* IdleWork */
+  IdleWork *running;
+
+  gboolean idle;
+  guint dispatch_id;
+};
+
+enum {
+  PROP_0,
+  PROP_IDLE,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+G_DEFINE_TYPE (XdpIdleScheduler, xdp_idle_scheduler, G_TYPE_OBJECT)
+
+static void
+idle_work_free (IdleWork *work)
+{
+  if (work->destroy)
+    work->destroy (work->user_data);
+  g_free (work);
+}
+
+static void update_dispatch (XdpIdleScheduler *scheduler);
+
+static gboolean
+dispatch_work (gpointer data)
+{
+  XdpIdleScheduler *scheduler = data;
+  g_autoptr(XdpIdleScheduler) ref = g_object_ref (scheduler);
+  IdleWork *work;
+  gboolean more;
+
+  work = g_queue_peek_head (&scheduler->work);
+  if (!work || !scheduler->idle)
+    {
+      scheduler->dispatch_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  scheduler->running = work;
+  more = work->func (work->user_data);
+  scheduler->running = NULL;
+
+  /* The work item may have removed itself while running */
+  if (work->id == 0 || !more)
+    {
+      g_queue_remove (&scheduler->work, work);
+      idle_work_free (work);
+    }
+
+  if (g_queue_is_empty (&scheduler->work) || !scheduler->idle)
+    {
+      scheduler->dispatch_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+update_dispatch (XdpIdleScheduler *scheduler)
+{
+  gboolean wanted = scheduler->idle && !g_queue_is_empty (&scheduler->work);
+
+  if (wanted && scheduler->dispatch_id == 0)
+    scheduler->dispatch_id = g_idle_add_full (G_PRIORITY_LOW, dispatch_work, scheduler, NULL);
+  else if (!wanted && scheduler->dispatch_id != 0)
+    g_clear_handle_id (&scheduler->dispatch_id, g_source_remove);
+}
+
+static void
+set_idle (XdpIdleScheduler *scheduler,
+          gboolean          idle)
+{
+  if (scheduler->idle == idle)
+    return;
+
+  scheduler->idle = idle;
+  update_dispatch (scheduler);
+
+  g_object_notify_by_pspec (G_OBJECT (scheduler), properties[PROP_IDLE]);
+}
+
+static void
+session_state_changed_cb (XdpPortal            *portal,
+                          gboolean              screensaver_active,
+                          XdpLoginSessionState  session_state,
+                          XdpIdleScheduler     *scheduler)
+{
+  /* Don't start new work while the session is ending */
+  set_idle (scheduler, screensaver_active && session_state == XDP_LOGIN_SESSION_RUNNING);
+}
+
+static void
+xdp_idle_scheduler_get_property (GObject    *object,
+                                 guint       prop_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  XdpIdleScheduler *scheduler = XDP_IDLE_SCHEDULER (object);
+
+  switch (prop_id)
+    {
+    case PROP_IDLE:
+      g_value_set_boolean (value, scheduler->idle);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+xdp_idle_scheduler_finalize (GObject *object)
+{
+  XdpIdleScheduler *scheduler = XDP_IDLE_SCHEDULER (object);
+
+  g_clear_handle_id (&scheduler->dispatch_id, g_source_remove);
+  g_queue_clear_full (&scheduler->work, (GDestroyNotify) idle_work_free);
+  g_clear_object (&scheduler->portal);
+
+  G_OBJECT_CLASS (xdp_idle_scheduler_parent_class)->finalize (object);
+}
+
+static void
+xdp_idle_scheduler_class_init (XdpIdleSchedulerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = xdp_idle_scheduler_finalize;
+  object_class->get_property = xdp_idle_scheduler_get_property;
+
+  /**
+   * XdpIdleScheduler:idle:
+   *
+   * Whether the session is currently idle, and queued work is allowed
+   * to run.
+   */
+  properties[PROP_IDLE] =
+    g_param_spec_boolean ("idle", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+xdp_idle_scheduler_init (XdpIdleScheduler *scheduler)
+{
+  scheduler->next_id = 1;
+  g_queue_init (&scheduler->work);
+}
+
+/**
+ * xdp_idle_scheduler_new:
+ * @portal: a [class@Portal]
+ *
+ * Creates a new [class@IdleScheduler] that follows the session state
+ * reported by @portal.
+ *
+ * Returns: (transfer full): the new [class@IdleScheduler]
+ */
+XdpIdleScheduler *
+xdp_idle_scheduler_new (XdpPortal *portal)
+{
+  XdpIdleScheduler *scheduler;
+  gboolean screensaver_active;
+  XdpLoginSessionState session_state;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+
+  scheduler = g_object_new (XDP_TYPE_IDLE_SCHEDULER, NULL);
+  scheduler->portal = g_object_ref (portal);
+
+  xdp_portal_get_session_state (portal, &screensaver_active, &session_state);
+  scheduler->idle = screensaver_active && session_state == XDP_LOGIN_SESSION_RUNNING;
+
+  g_signal_connect_object (portal, "session-state-changed",
+                           G_CALLBACK (session_state_changed_cb), scheduler, 0);
+
+  return scheduler;
+}
+
+/**
+ * xdp_idle_scheduler_add:
+ * @scheduler: a [class@IdleScheduler]
+ * @func: (scope notified) (closure user_data) (destroy destroy): the
+ *   function that performs the work
+ * @user_data: data to pass to @func
+ * @destroy: (nullable): destroy notify for @user_data
+ *
+ * Queues deferrable work.
+ *
+ * @func is called repeatedly while the session is idle, until it
+ * returns %G_SOURCE_REMOVE or the work is removed with
+ * [method@IdleScheduler.remove].
+ *
+ * Returns: the ID of the work item
+ */
+guint
+xdp_idle_scheduler_add (XdpIdleScheduler *scheduler,
+                        XdpIdleWorkFunc   func,
+                        gpointer          user_data,
+                        GDestroyNotify    destroy)
+{
+  IdleWork *work;
+
+  g_return_val_if_fail (XDP_IS_IDLE_SCHEDULER (scheduler), 0);
+  g_return_val_if_fail (func != NULL, 0);
+
+  work = g_new0 (IdleWork, 1);
+  work->id = scheduler->next_id++;
+  if (scheduler->next_id == 0)
+    scheduler->next_id = 1;
+  work->func = func;
+  work->user_data = user_data;
+  work->destroy = destroy;
+
+  g_queue_push_tail (&scheduler->work, work);
+  update_dispatch (scheduler);
+
+  return work->id;
+}
+
+/**
+ * xdp_idle_scheduler_remove:
+ * @scheduler: a [class@IdleScheduler]
+ * @id: the ID of the work item
+ *
+ * Removes queued work. This may be called from within the work function.
+ *
+ * Returns: %TRUE if the work item was found
+ */
+gboolean
+xdp_idle_scheduler_remove (XdpIdleScheduler *scheduler,
+                           guint             id)
+{
+  GList *l;
+
+  g_return_val_if_fail (XDP_IS_IDLE_SCHEDULER (scheduler), FALSE);
+
+  for (l = scheduler->work.head; l; l = l->next)
+    {
+      IdleWork *work = l->data;
+
+      if (work->id != id)
+        continue;
+
+      /* Freed by the dispatcher once the function returns */
+      if (work == scheduler->running)
+        {
+          work->id = 0;
+          return TRUE;
+        }
+
+      g_queue_delete_link (&scheduler->work, l);
+      idle_work_free (work);
+      update_dispatch (scheduler);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/**
+ * xdp_idle_scheduler_is_idle:
+ * @scheduler: a [class@IdleScheduler]
+ *
+ * Gets whether the session is idle, and queued work is allowed to run.
+ *
+ * Returns: %TRUE if the session is idle
+ */
+gboolean
+xdp_idle_scheduler_is_idle (XdpIdleScheduler *scheduler)
+{
+  g_return_val_if_fail (XDP_IS_IDLE_SCHEDULER (scheduler), FALSE);
+
+  return scheduler->idle;
+}
+
+/**
+ * xdp_idle_scheduler_get_n_pending:
+ * @scheduler: a [class@IdleScheduler]
+ *
+ * Gets the number of queued work items that have not finished yet.
+ *
+ * Returns: the number of pending work items
+ */
+guint
+xdp_idle_scheduler_get_n_pending (XdpIdleScheduler *scheduler)
+{
+  g_return_val_if_fail (XDP_IS_IDLE_SCHEDULER (scheduler), 0);
+
+  return g_queue_get_length (&scheduler->work);
+}
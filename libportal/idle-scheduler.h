@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/types.h>
+
+G_BEGIN_DECLS
+
+#define XDP_TYPE_IDLE_SCHEDULER (xdp_idle_scheduler_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpIdleScheduler, xdp_idle_scheduler, XDP, IDLE_SCHEDULER, GObject)
+
+/**
+ * XdpIdleWorkFunc:
+ * @user_data: the data passed to [method@IdleScheduler.add]
+ *
+ * Performs one slice of deferrable work. Each call should only take
+ * a short amount of time, so that the work can be paused promptly
+ * when the user returns.
+ *
+ * Returns: %G_SOURCE_CONTINUE if there is more work to do, or
+ *   %G_SOURCE_REMOVE when the work is finished
+ */
+typedef gboolean (* XdpIdleWorkFunc) (gpointer user_data);
+
+XDP_PUBLIC
+XdpIdleScheduler * xdp_idle_scheduler_new     (XdpPortal        *portal);
+
+XDP_PUBLIC
+guint              xdp_idle_scheduler_add     (XdpIdleScheduler *scheduler,
+                                               XdpIdleWorkFunc   func,
+                                               gpointer          user_data,
+                                               GDestroyNotify    destroy);
+
+XDP_PUBLIC
+gboolean           xdp_idle_scheduler_remove  (XdpIdleScheduler *scheduler,
+                                               guint             id);
+
+XDP_PUBLIC
+gboolean           xdp_idle_scheduler_is_idle (XdpIdleScheduler *scheduler);
+
+XDP_PUBLIC
+guint              xdp_idle_scheduler_get_n_pending (XdpIdleScheduler *scheduler);
+
+G_END_DECLS
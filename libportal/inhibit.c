@@ -33,6 +33,7 @@ typedef struct {
   char *reason;
   GTask *task;
   int id;
+  gboolean coalesced;
 } InhibitCall;
 
 static void
@@ -85,7 +86,8 @@ call_returned (GObject *object,
     {
       g_clear_signal_handler (&call->cancelled_id, g_task_get_cancellable (call->task));
 
-      g_hash_table_remove (call->portal->inhibit_handles, GINT_TO_POINTER (call->id));
+      if (!call->coalesced)
+        g_hash_table_remove (call->portal->inhibit_handles, GINT_TO_POINTER (call->id));
       g_task_return_error (call->task, error);
       inhibit_call_free (call);
     }
@@ -109,15 +111,22 @@ response_received (GDBusConnection *bus,
   g_variant_get (parameters, "(u@a{sv})", &response, &ret);
 
   if (response == 0)
-    g_task_return_int (call->task, call->id);
+    {
+      if (call->coalesced)
+        g_task_return_pointer (call->task, g_strdup (call->request_path), g_free);
+      else
+        g_task_return_int (call->task, call->id);
+    }
   else if (response == 1)
     {
-      g_hash_table_remove (call->portal->inhibit_handles, GINT_TO_POINTER (call->id));
+      if (!call->coalesced)
+        g_hash_table_remove (call->portal->inhibit_handles, GINT_TO_POINTER (call->id));
       g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Account call canceled user");
     }
   else
     {
-      g_hash_table_remove (call->portal->inhibit_handles, GINT_TO_POINTER (call->id));
+      if (!call->coalesced)
+        g_hash_table_remove (call->portal->inhibit_handles, GINT_TO_POINTER (call->id));
       g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "Account call failed");
     }
 
@@ -174,7 +183,8 @@ do_inhibit (InhibitCall *call)
                                                         call,
                                                         NULL);
 
-  g_hash_table_insert (call->portal->inhibit_handles, GINT_TO_POINTER (call->id), g_strdup (call->request_path));
+  if (!call->coalesced)
+    g_hash_table_insert (call->portal->inhibit_handles, GINT_TO_POINTER (call->id), g_strdup (call->request_path));
 
   cancellable = g_task_get_cancellable (call->task);
   if (cancellable)
@@ -198,6 +208,224 @@ do_inhibit (InhibitCall *call)
                           call);
 }
 
+static void
+close_inhibit_request (XdpPortal  *portal,
+                       const char *request_path)
+{
+  g_dbus_connection_call (portal->bus,
+                          PORTAL_BUS_NAME,
+                          request_path,
+                          REQUEST_INTERFACE,
+                          "Close",
+                          g_variant_new ("()"),
+                          G_VARIANT_TYPE_UNIT,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          G_MAXINT,
+                          NULL, NULL, NULL);
+}
+
+static XdpInhibitFlags
+get_effective_inhibit_flags (XdpPortal *portal)
+{
+  XdpInhibitFlags flags = 0;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (portal->inhibit_flag_counts); i++)
+    {
+      if (portal->inhibit_flag_counts[i] > 0)
+        flags |= 1 << i;
+    }
+
+  return flags;
+}
+
+static void
+add_inhibit_holder (XdpPortal       *portal,
+                    int              id,
+                    XdpInhibitFlags  flags)
+{
+  guint i;
+
+  g_hash_table_insert (portal->inhibit_holders, GINT_TO_POINTER (id), GUINT_TO_POINTER (flags));
+
+  for (i = 0; i < G_N_ELEMENTS (portal->inhibit_flag_counts); i++)
+    {
+      if (flags & (1 << i))
+        portal->inhibit_flag_counts[i]++;
+    }
+}
+
+static gboolean
+remove_inhibit_holder (XdpPortal *portal,
+                       int        id)
+{
+  gpointer value;
+  XdpInhibitFlags flags;
+  guint i;
+
+  if (!g_hash_table_steal_extended (portal->inhibit_holders, GINT_TO_POINTER (id), NULL, &value))
+    return FALSE;
+
+  flags = GPOINTER_TO_UINT (value);
+  for (i = 0; i < G_N_ELEMENTS (portal->inhibit_flag_counts); i++)
+    {
+      if (flags & (1 << i))
+        portal->inhibit_flag_counts[i]--;
+    }
+
+  return TRUE;
+}
+
+/* Completes the inhibit requests that are covered by the current
+ * portal inhibition, and fails the others if @error is set. */
+static void
+complete_inhibit_waiters (XdpPortal    *portal,
+                          const GError *error)
+{
+  GList *l = portal->coalesced_inhibit_waiters;
+
+  while (l)
+    {
+      GList *next = l->next;
+      GTask *task = l->data;
+      int id = GPOINTER_TO_INT (g_task_get_task_data (task));
+      XdpInhibitFlags flags;
+
+      flags = GPOINTER_TO_UINT (g_hash_table_lookup (portal->inhibit_holders, GINT_TO_POINTER (id)));
+
+      if ((flags & ~portal->coalesced_inhibit_flags) == 0)
+        {
+          /* Nobody will ever uninhibit an ID the caller doesn't get */
+          if (g_task_return_error_if_cancelled (task))
+            remove_inhibit_holder (portal, id);
+          else
+            g_task_return_int (task, id);
+        }
+      else if (error)
+        {
+          remove_inhibit_holder (portal, id);
+          g_task_return_error (task, g_error_copy (error));
+        }
+      else
+        {
+          l = next;
+          continue;
+        }
+
+      g_object_unref (task);
+      portal->coalesced_inhibit_waiters = g_list_delete_link (portal->coalesced_inhibit_waiters, l);
+      l = next;
+    }
+}
+
+static void update_coalesced_inhibition (XdpPortal *portal);
+
+static void
+coalesced_inhibit_done (GObject      *object,
+                        GAsyncResult *result,
+                        gpointer      data)
+{
+  XdpPortal *portal = XDP_PORTAL (object);
+  g_autoptr(GError) error = NULL;
+  g_autofree char *old_handle = NULL;
+  char *handle;
+
+  portal->coalesced_inhibit_busy = FALSE;
+
+  handle = g_task_propagate_pointer (G_TASK (result), &error);
+  if (handle)
+    {
+      /* Make before break: the new inhibition is in place before the
+       * old one goes away, so there is no window without it. */
+      old_handle = g_steal_pointer (&portal->coalesced_inhibit_handle);
+      portal->coalesced_inhibit_handle = handle;
+      portal->coalesced_inhibit_flags = portal->coalesced_inhibit_pending;
+
+      if (old_handle)
+        close_inhibit_request (portal, old_handle);
+    }
+  else
+    g_warning ("Failed to update inhibition: %s", error->message);
+
+  portal->coalesced_inhibit_pending = 0;
+  complete_inhibit_waiters (portal, error);
+
+  if (portal->coalesced_inhibit_dirty)
+    {
+      portal->coalesced_inhibit_dirty = FALSE;
+      update_coalesced_inhibition (portal);
+    }
+}
+
+static void
+update_coalesced_inhibition (XdpPortal *portal)
+{
+  XdpInhibitFlags flags;
+  InhibitCall *call;
+
+  /* Only one request is in flight at a time; the union is recomputed
+   * once it completes. */
+  if (portal->coalesced_inhibit_busy)
+    {
+      portal->coalesced_inhibit_dirty = TRUE;
+      return;
+    }
+
+  flags = get_effective_inhibit_flags (portal);
+
+  if (flags == portal->coalesced_inhibit_flags)
+    {
+      complete_inhibit_waiters (portal, NULL);
+      return;
+    }
+
+  if (flags == 0)
+    {
+      g_autofree char *handle = g_steal_pointer (&portal->coalesced_inhibit_handle);
+
+      portal->coalesced_inhibit_flags = 0;
+      if (handle)
+        close_inhibit_request (portal, handle);
+      return;
+    }
+
+  portal->coalesced_inhibit_busy = TRUE;
+  portal->coalesced_inhibit_pending = flags;
+
+  call = g_new0 (InhibitCall, 1);
+  call->portal = g_object_ref (portal);
+  call->parent_handle = g_strdup ("");
+  call->inhibit = flags;
+  call->reason = g_strdup (portal->inhibit_reason);
+  call->coalesced = TRUE;
+  call->task = g_task_new (portal, NULL, coalesced_inhibit_done, NULL);
+  g_task_set_source_tag (call->task, update_coalesced_inhibition);
+
+  do_inhibit (call);
+}
+
+static void
+coalesced_inhibit (XdpPortal       *portal,
+                   const char      *reason,
+                   XdpInhibitFlags  flags,
+                   GTask           *task)
+{
+  int id = portal->next_inhibit_id;
+
+  if (reason)
+    {
+      g_free (portal->inhibit_reason);
+      portal->inhibit_reason = g_strdup (reason);
+    }
+
+  add_inhibit_holder (portal, id, flags);
+
+  g_task_set_task_data (task, GINT_TO_POINTER (id), NULL);
+  portal->coalesced_inhibit_waiters = g_list_append (portal->coalesced_inhibit_waiters, task);
+
+  update_coalesced_inhibition (portal);
+}
+
 /**
  * xdp_portal_session_inhibit:
  * @portal: a [class@Portal]
@@ -240,6 +468,16 @@ xdp_portal_session_inhibit (XdpPortal            *portal,
   if (portal->next_inhibit_id < 0)
     portal->next_inhibit_id = 1;
 
+  if (portal->inhibit_coalescing)
+    {
+      GTask *task;
+
+      task = g_task_new (portal, cancellable, callback, data);
+      g_task_set_source_tag (task, xdp_portal_session_inhibit);
+      coalesced_inhibit (portal, reason, flags, task);
+      return;
+    }
+
   call = g_new0 (InhibitCall, 1);
   call->portal = g_object_ref (portal);
   if (parent)
@@ -298,6 +536,18 @@ xdp_portal_session_uninhibit (XdpPortal *portal,
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail (id > 0);
 
+  if (portal->inhibit_coalescing)
+    {
+      if (!remove_inhibit_holder (portal, id))
+        {
+          g_warning ("No inhibit handle found");
+          return;
+        }
+
+      update_coalesced_inhibition (portal);
+      return;
+    }
+
   if (portal->inhibit_handles == NULL ||
       !g_hash_table_steal_extended (portal->inhibit_handles,
                                     GINT_TO_POINTER (id),
@@ -320,6 +570,41 @@ xdp_portal_session_uninhibit (XdpPortal *portal,
                           NULL, NULL, NULL);
 }
 
+/**
+ * xdp_portal_set_inhibit_coalescing:
+ * @portal: a [class@Portal]
+ * @coalescing: whether to coalesce inhibitions
+ *
+ * Makes @portal share a single portal inhibition among all callers
+ * of [method@Portal.session_inhibit].
+ *
+ * In coalescing mode, each inhibit request is only counted locally.
+ * The portal is asked to inhibit the union of the flags of all active
+ * requests, and is only called again when that union changes. The new
+ * inhibition is established before the previous one is removed, so
+ * that there is no gap in between.
+ *
+ * The shared inhibition is not associated with a parent window, and
+ * uses the reason of the most recent request that passed one.
+ *
+ * The mode can only be changed while no inhibition is active.
+ */
+void
+xdp_portal_set_inhibit_coalescing (XdpPortal *portal,
+                                   gboolean   coalescing)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (portal->inhibit_handles == NULL ||
+                    g_hash_table_size (portal->inhibit_handles) == 0);
+  g_return_if_fail (portal->inhibit_holders == NULL ||
+                    g_hash_table_size (portal->inhibit_holders) == 0);
+
+  portal->inhibit_coalescing = !!coalescing;
+
+  if (coalescing && portal->inhibit_holders == NULL)
+    portal->inhibit_holders = g_hash_table_new (NULL, NULL);
+}
+
 typedef struct {
   XdpPortal *portal;
   XdpParent *parent;
@@ -380,6 +665,10 @@ session_state_changed (GDBusConnection *bus,
   g_variant_lookup (state, "screensaver-active", "b", &screensaver_active);
   g_variant_lookup (state, "session-state", "u", &session_state);
 
+  portal->session_state_known = TRUE;
+  portal->screensaver_active = screensaver_active;
+  portal->session_state = session_state;
+
   g_signal_emit_by_name (portal, "session-state-changed",
                          screensaver_active,
                          session_state);
@@ -635,6 +924,43 @@ xdp_portal_session_monitor_stop (XdpPortal *portal)
                               NULL, 0, -1, NULL, NULL, NULL);
       g_clear_pointer (&portal->session_monitor_handle, g_free);
     }
+
+  portal->session_state_known = FALSE;
+}
+
+/**
+ * xdp_portal_get_session_state:
+ * @portal: a [class@Portal]
+ * @screensaver_active: (out) (optional): return location for whether
+ *   the screensaver is active
+ * @session_state: (out) (optional): return location for the state of
+ *   the login session
+ *
+ * Gets the session state last reported by the
+ * [signal@Portal::session-state-changed] signal.
+ *
+ * The state is only known while session monitoring is active, see
+ * [method@Portal.session_monitor_start], and after the portal has
+ * reported it at least once. Otherwise, the screensaver is assumed
+ * to be inactive and the session to be running.
+ *
+ * Returns: %TRUE if the state has been reported by the portal
+ */
+gboolean
+xdp_portal_get_session_state (XdpPortal            *portal,
+                              gboolean             *screensaver_active,
+                              XdpLoginSessionState *session_state)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+
+  if (screensaver_active)
+    *screensaver_active = portal->session_state_known && portal->screensaver_active;
+
+  if (session_state)
+    *session_state = portal->session_state_known ? portal->session_state
+                                                 : XDP_LOGIN_SESSION_RUNNING;
+
+  return portal->session_state_known;
 }
 
 /**
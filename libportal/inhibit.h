@@ -57,6 +57,10 @@ XDP_PUBLIC
 void       xdp_portal_session_uninhibit           (XdpPortal            *portal,
                                                    int                   id);
 
+XDP_PUBLIC
+void       xdp_portal_set_inhibit_coalescing      (XdpPortal            *portal,
+                                                   gboolean              coalescing);
+
 /**
  * XdpLoginSessionState:
  * @XDP_LOGIN_SESSION_RUNNING: the session is running
@@ -97,4 +101,9 @@ void       xdp_portal_session_monitor_stop               (XdpPortal
 XDP_PUBLIC
 void       xdp_portal_session_monitor_query_end_response (XdpPortal               *portal);
 
+XDP_PUBLIC
+gboolean   xdp_portal_get_session_state                  (XdpPortal               *portal,
+                                                          gboolean                *screensaver_active,
+                                                          XdpLoginSessionState    *session_state);
+
 G_END_DECLS
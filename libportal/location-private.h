@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/location.h>
+
+G_BEGIN_DECLS
+
+/* Mean earth radius, in meters */
+#define XDP_EARTH_RADIUS 6371008.8
+
+double _xdp_location_distance (double latitude1,
+                               double longitude1,
+                               double latitude2,
+                               double longitude2);
+
+void   _xdp_portal_flush_last_known_location (XdpPortal *portal);
+
+G_END_DECLS
@@ -19,9 +19,299 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
 #include "location.h"
+#include "location-private.h"
 #include "portal-private.h"
 
+G_DEFINE_BOXED_TYPE (XdpLocationFix, xdp_location_fix, xdp_location_fix_copy, xdp_location_fix_free)
+
+/**
+ * xdp_location_fix_copy:
+ * @fix: a [struct@LocationFix]
+ *
+ * Copies @fix into a new [struct@LocationFix].
+ *
+ * Returns: (transfer full): a copy of @fix
+ */
+XdpLocationFix *
+xdp_location_fix_copy (const XdpLocationFix *fix)
+{
+  XdpLocationFix *copy;
+
+  copy = g_memdup2 (fix, sizeof (XdpLocationFix));
+  copy->description = g_strdup (fix->description);
+
+  return copy;
+}
+
+/**
+ * xdp_location_fix_free:
+ * @fix: a [struct@LocationFix]
+ *
+ * Frees @fix.
+ */
+void
+xdp_location_fix_free (XdpLocationFix *fix)
+{
+  g_free (fix->description);
+  g_free (fix);
+}
+
+static XdpLocationFix *
+location_fix_new_from_variant (GVariant *variant)
+{
+  XdpLocationFix *fix;
+  GVariantIter iter;
+  const char *key;
+  GVariant *value;
+
+  fix = g_new0 (XdpLocationFix, 1);
+  fix->altitude = -G_MAXDOUBLE;
+  fix->speed = -G_MAXDOUBLE;
+  fix->heading = -G_MAXDOUBLE;
+
+  /* Walk the dictionary once instead of looking up every key in turn */
+  g_variant_iter_init (&iter, variant);
+  while (g_variant_iter_next (&iter, "{&sv}", &key, &value))
+    {
+      if (strcmp (key, "Latitude") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE))
+        fix->latitude = g_variant_get_double (value);
+      else if (strcmp (key, "Longitude") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE))
+        fix->longitude = g_variant_get_double (value);
+      else if (strcmp (key, "Accuracy") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE))
+        fix->accuracy = g_variant_get_double (value);
+      else if (strcmp (key, "Altitude") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE))
+        fix->altitude = g_variant_get_double (value);
+      else if (strcmp (key, "Speed") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE))
+        fix->speed = g_variant_get_double (value);
+      else if (strcmp (key, "Heading") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE))
+        fix->heading = g_variant_get_double (value);
+      else if (strcmp (key, "Description") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE_STRING))
+        fix->description = g_variant_dup_string (value, NULL);
+      else if (strcmp (key, "Timestamp") == 0 && g_variant_is_of_type (value, G_VARIANT_TYPE ("(tt)")))
+        {
+          guint64 seconds, microseconds;
+
+          g_variant_get (value, "(tt)", &seconds, &microseconds);
+          fix->timestamp_s = seconds;
+          fix->timestamp_us = microseconds;
+        }
+
+      g_variant_unref (value);
+    }
+
+  return fix;
+}
+
+/* Great-circle distance between two points, in meters */
+double
+_xdp_location_distance (double latitude1,
+                        double longitude1,
+                        double latitude2,
+                        double longitude2)
+{
+  double lat1 = latitude1 * G_PI / 180.0;
+  double lat2 = latitude2 * G_PI / 180.0;
+  double dlat = lat2 - lat1;
+  double dlon = (longitude2 - longitude1) * G_PI / 180.0;
+  double h;
+
+  h = sin (dlat / 2) * sin (dlat / 2) +
+      cos (lat1) * cos (lat2) * sin (dlon / 2) * sin (dlon / 2);
+
+  return 2 * XDP_EARTH_RADIUS * asin (MIN (1.0, sqrt (h)));
+}
+
+/* Writes of the cached location are coalesced over this many seconds */
+#define LAST_KNOWN_LOCATION_SAVE_DELAY 5
+
+#define LAST_KNOWN_LOCATION_FORMAT "(ddddddstt)"
+
+static char *
+get_last_known_location_path (void)
+{
+  g_autofree char *app = _xdp_get_app_storage_name ();
+
+  return g_build_filename (g_get_user_cache_dir (), "libportal", app, "last-location", NULL);
+}
+
+static XdpLocationFix *
+load_last_known_location (void)
+{
+  g_autofree char *path = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) variant = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  XdpLocationFix *fix;
+  const char *description;
+  char *contents;
+  gsize length;
+
+  path = get_last_known_location_path ();
+  if (!g_file_get_contents (path, &contents, &length, &error))
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_debug ("Failed to load last known location: %s", error->message);
+      return NULL;
+    }
+
+  bytes = g_bytes_new_take (contents, length);
+  variant = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (LAST_KNOWN_LOCATION_FORMAT),
+                                                          bytes, FALSE));
+  if (!g_variant_is_normal_form (variant))
+    {
+      g_debug ("Ignoring corrupt last known location in %s", path);
+      return NULL;
+    }
+
+  fix = g_new0 (XdpLocationFix, 1);
+  g_variant_get (variant, LAST_KNOWN_LOCATION_FORMAT,
+                 &fix->latitude, &fix->longitude, &fix->altitude,
+                 &fix->accuracy, &fix->speed, &fix->heading,
+                 &description, &fix->timestamp_s, &fix->timestamp_us);
+  if (*description != '\0')
+    fix->description = g_strdup (description);
+
+  return fix;
+}
+
+static void
+queue_last_known_location_write (GBytes *contents)
+{
+  g_autofree char *path = get_last_known_location_path ();
+
+  _xdp_queue_file_write (path, contents);
+}
+
+static void
+save_last_known_location (XdpLocationFix *fix)
+{
+  g_autoptr(GVariant) variant = NULL;
+  g_autoptr(GBytes) contents = NULL;
+
+  variant = g_variant_ref_sink (g_variant_new (LAST_KNOWN_LOCATION_FORMAT,
+                                               fix->latitude, fix->longitude, fix->altitude,
+                                               fix->accuracy, fix->speed, fix->heading,
+                                               fix->description ? fix->description : "",
+                                               fix->timestamp_s, fix->timestamp_us));
+  contents = g_variant_get_data_as_bytes (variant);
+
+  queue_last_known_location_write (contents);
+}
+
+void
+_xdp_portal_flush_last_known_location (XdpPortal *portal)
+{
+  if (portal->last_known_location_save_id == 0)
+    return;
+
+  g_clear_handle_id (&portal->last_known_location_save_id, g_source_remove);
+  save_last_known_location (portal->last_known_location);
+}
+
+static gboolean
+save_last_known_location_cb (gpointer data)
+{
+  XdpPortal *portal = data;
+
+  portal->last_known_location_save_id = 0;
+  save_last_known_location (portal->last_known_location);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+update_last_known_location (XdpPortal            *portal,
+                            const XdpLocationFix *fix)
+{
+  g_clear_pointer (&portal->last_known_location, xdp_location_fix_free);
+  portal->last_known_location = xdp_location_fix_copy (fix);
+  portal->last_known_location_loaded = TRUE;
+
+  if (portal->last_known_location_persisted &&
+      portal->last_known_location_save_id == 0)
+    portal->last_known_location_save_id =
+      g_timeout_add_seconds (LAST_KNOWN_LOCATION_SAVE_DELAY,
+                             save_last_known_location_cb,
+                             portal);
+}
+
+static gint64
+location_fix_get_time (const XdpLocationFix *fix)
+{
+  return fix->timestamp_s * G_USEC_PER_SEC + fix->timestamp_us;
+}
+
+/* Time between the last delivered fix and @fix, in microseconds. Not
+ * all portals send a Timestamp, so fall back to when the fixes were
+ * received. */
+static gint64
+location_fix_get_interval (XdpPortal            *portal,
+                           const XdpLocationFix *fix,
+                           gint64                received)
+{
+  XdpLocationFix *last = portal->last_location_fix;
+
+  if (location_fix_get_time (fix) == 0 || location_fix_get_time (last) == 0)
+    return received - portal->last_location_fix_received;
+
+  return location_fix_get_time (fix) - location_fix_get_time (last);
+}
+
+static gboolean
+location_fix_passes_filter (XdpPortal            *portal,
+                            const XdpLocationFix *fix,
+                            gint64                received)
+{
+  XdpLocationFix *last = portal->last_location_fix;
+
+  if (portal->location_max_accuracy > 0 && fix->accuracy > portal->location_max_accuracy)
+    return FALSE;
+
+  if (last == NULL)
+    return TRUE;
+
+  if (portal->location_min_interval > 0 &&
+      location_fix_get_interval (portal, fix, received) < (gint64) portal->location_min_interval * 1000)
+    return FALSE;
+
+  if (portal->location_min_distance > 0 &&
+      _xdp_location_distance (last->latitude, last->longitude,
+                              fix->latitude, fix->longitude) < portal->location_min_distance)
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+flush_location_batch (XdpPortal *portal)
+{
+  g_autoptr(GPtrArray) fixes = NULL;
+
+  g_clear_handle_id (&portal->location_batch_timeout, g_source_remove);
+
+  if (portal->location_batch == NULL || portal->location_batch->len == 0)
+    return;
+
+  fixes = g_steal_pointer (&portal->location_batch);
+  g_signal_emit_by_name (portal, "location-fixes", fixes);
+}
+
+static gboolean
+location_batch_timeout_cb (gpointer data)
+{
+  XdpPortal *portal = data;
+
+  portal->location_batch_timeout = 0;
+  flush_location_batch (portal);
+
+  return G_SOURCE_REMOVE;
+}
 
 typedef struct {
   XdpPortal *portal;
@@ -110,26 +400,42 @@ location_updated (GDBusConnection *bus,
 {
   XdpPortal *portal = data;
   g_autoptr(GVariant) variant = NULL;
+  g_autoptr(XdpLocationFix) fix = NULL;
   const char *handle = NULL;
-  double latitude, longitude, altitude;
-  double accuracy, speed, heading;
-  const char *description = NULL;
-  gint64 timestamp_s, timestamp_ms;
-
-  g_variant_get (parameters, "(o@a{sv})", &handle, &variant);
-  g_variant_lookup (variant, "Latitude", "d", &latitude);
-  g_variant_lookup (variant, "Longitude", "d", &longitude);
-  g_variant_lookup (variant, "Accuracy", "d", &accuracy);
-  g_variant_lookup (variant, "Altitude", "d", &altitude);
-  g_variant_lookup (variant, "Speed", "d", &speed);
-  g_variant_lookup (variant, "Heading", "d", &heading);
-  g_variant_lookup (variant, "Description", "&s", &description);
-  g_variant_lookup (variant, "Timestamp", "(tt)", &timestamp_s, &timestamp_ms);
+  gint64 received;
+
+  g_variant_get (parameters, "(&o@a{sv})", &handle, &variant);
+
+  received = g_get_monotonic_time ();
+  fix = location_fix_new_from_variant (variant);
+  update_last_known_location (portal, fix);
+
+  if (!location_fix_passes_filter (portal, fix, received))
+    return;
+
+  g_clear_pointer (&portal->last_location_fix, xdp_location_fix_free);
+  portal->last_location_fix = xdp_location_fix_copy (fix);
+  portal->last_location_fix_received = received;
+
+  if (portal->location_batch_interval > 0)
+    {
+      if (portal->location_batch == NULL)
+        portal->location_batch = g_ptr_array_new_with_free_func ((GDestroyNotify) xdp_location_fix_free);
 
+      g_ptr_array_add (portal->location_batch, g_steal_pointer (&fix));
+
+      if (portal->location_batch_timeout == 0)
+        portal->location_batch_timeout = g_timeout_add (portal->location_batch_interval,
+                                                        location_batch_timeout_cb,
+                                                        portal);
+      return;
+    }
+
+  g_signal_emit_by_name (portal, "location-fix", fix);
   g_signal_emit_by_name (portal, "location-updated",
-                         latitude, longitude, altitude,
-                         accuracy, speed, heading,
-                         description, timestamp_s, timestamp_ms);
+                         fix->latitude, fix->longitude, fix->altitude,
+                         fix->accuracy, fix->speed, fix->heading,
+                         fix->description, fix->timestamp_s, fix->timestamp_us);
 }
 
 static void
@@ -416,4 +722,174 @@ xdp_portal_location_monitor_stop (XdpPortal *portal)
       g_dbus_connection_signal_unsubscribe (portal->bus, portal->location_updated_signal);
       portal->location_updated_signal = 0;
     }
+
+  flush_location_batch (portal);
+  g_clear_pointer (&portal->last_location_fix, xdp_location_fix_free);
+  _xdp_portal_flush_last_known_location (portal);
+}
+
+/**
+ * xdp_portal_get_last_known_location:
+ * @portal: a [class@Portal]
+ *
+ * Gets the most recent location received from the location portal.
+ *
+ * Unless disabled with [method@Portal.set_last_known_location_persisted],
+ * the location is kept in the cache directory of the application, so it
+ * is available immediately, even before [method@Portal.location_monitor_start]
+ * delivered its first update, and across restarts of the application.
+ * Check the timestamp and accuracy of the returned fix to decide whether it
+ * is still useful.
+ *
+ * Returns: (transfer full) (nullable): the last known location, or `NULL`
+ *   if no location was ever received
+ */
+XdpLocationFix *
+xdp_portal_get_last_known_location (XdpPortal *portal)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+
+  if (!portal->last_known_location_loaded)
+    {
+      if (portal->last_known_location_persisted)
+        portal->last_known_location = load_last_known_location ();
+      portal->last_known_location_loaded = TRUE;
+    }
+
+  if (portal->last_known_location == NULL)
+    return NULL;
+
+  return xdp_location_fix_copy (portal->last_known_location);
+}
+
+/**
+ * xdp_portal_location_monitor_set_filter:
+ * @portal: a [class@Portal]
+ * @min_distance: minimum distance from the previous location, in meters, or 0
+ * @min_interval: minimum time since the previous location, in milliseconds, or 0
+ * @max_accuracy: largest acceptable accuracy radius, in meters, or 0
+ *
+ * Filters the location updates delivered by @portal.
+ *
+ * Updates that are less than @min_distance away or less than @min_interval
+ * apart from the previously delivered one are dropped, as are updates whose
+ * accuracy is worse than @max_accuracy. A value of 0 disables the
+ * respective check.
+ *
+ * Unlike the thresholds passed to [method@Portal.location_monitor_start],
+ * the filter is applied by libportal and can be changed at any time without
+ * restarting the monitor.
+ */
+void
+xdp_portal_location_monitor_set_filter (XdpPortal *portal,
+                                        double     min_distance,
+                                        guint      min_interval,
+                                        double     max_accuracy)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (min_distance >= 0);
+  g_return_if_fail (max_accuracy >= 0);
+
+  portal->location_min_distance = min_distance;
+  portal->location_min_interval = min_interval;
+  portal->location_max_accuracy = max_accuracy;
+}
+
+/**
+ * xdp_portal_location_monitor_set_batch_interval:
+ * @portal: a [class@Portal]
+ * @interval: the batch interval, in milliseconds, or 0
+ *
+ * Switches location delivery to batched mode.
+ *
+ * In batched mode, location updates are collected and handed over at
+ * most once per @interval with the [signal@Portal::location-fixes]
+ * signal, instead of emitting [signal@Portal::location-fix] and
+ * [signal@Portal::location-updated] for every update.
+ *
+ * Passing 0 delivers any pending updates and returns to per-update
+ * delivery.
+ */
+void
+xdp_portal_location_monitor_set_batch_interval (XdpPortal *portal,
+                                                guint      interval)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+
+  if (portal->location_batch_interval == interval)
+    return;
+
+  /* Deliver what was collected under the old interval */
+  flush_location_batch (portal);
+
+  portal->location_batch_interval = interval;
+}
+
+/**
+ * xdp_portal_set_last_known_location_persisted:
+ * @portal: a [class@Portal]
+ * @persisted: whether to keep the last known location on disk
+ *
+ * Sets whether the last known location is kept in the cache directory
+ * of the application. It is by default.
+ *
+ * When disabled, the location is only remembered for the lifetime of
+ * @portal, and a location that was stored before is removed.
+ */
+void
+xdp_portal_set_last_known_location_persisted (XdpPortal *portal,
+                                              gboolean   persisted)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+
+  persisted = !!persisted;
+  if (portal->last_known_location_persisted == persisted)
+    return;
+
+  portal->last_known_location_persisted = persisted;
+
+  if (persisted)
+    {
+      if (portal->last_known_location)
+        save_last_known_location (portal->last_known_location);
+    }
+  else
+    {
+      g_clear_handle_id (&portal->last_known_location_save_id, g_source_remove);
+      queue_last_known_location_write (NULL);
+    }
+}
+
+/**
+ * xdp_portal_get_last_known_location_persisted:
+ * @portal: a [class@Portal]
+ *
+ * Gets whether the last known location is kept on disk.
+ *
+ * Returns: `TRUE` if the last known location is kept on disk
+ */
+gboolean
+xdp_portal_get_last_known_location_persisted (XdpPortal *portal)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+
+  return portal->last_known_location_persisted;
+}
+
+/**
+ * xdp_portal_clear_last_known_location:
+ * @portal: a [class@Portal]
+ *
+ * Forgets the last known location, and removes it from disk.
+ */
+void
+xdp_portal_clear_last_known_location (XdpPortal *portal)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+
+  g_clear_handle_id (&portal->last_known_location_save_id, g_source_remove);
+  g_clear_pointer (&portal->last_known_location, xdp_location_fix_free);
+  portal->last_known_location_loaded = TRUE;
+
+  queue_last_known_location_write (NULL);
 }
@@ -48,6 +48,47 @@ typedef enum {
   XDP_LOCATION_MONITOR_FLAG_NONE = 0
 } XdpLocationMonitorFlags;
 
+typedef struct _XdpLocationFix XdpLocationFix;
+
+/**
+ * XdpLocationFix:
+ * @latitude: the latitude, in degrees
+ * @longitude: the longitude, in degrees
+ * @altitude: the altitude, in meters, or `-G_MAXDOUBLE` if unknown
+ * @accuracy: the accuracy, in meters
+ * @speed: the speed, in meters per second, or `-G_MAXDOUBLE` if unknown
+ * @heading: the heading, in degrees, or `-G_MAXDOUBLE` if unknown
+ * @description: (nullable): the description
+ * @timestamp_s: the timestamp seconds since the Unix epoch
+ * @timestamp_us: the microseconds fraction of the timestamp
+ *
+ * A single location update, as reported by the location portal.
+ */
+struct _XdpLocationFix {
+  double latitude;
+  double longitude;
+  double altitude;
+  double accuracy;
+  double speed;
+  double heading;
+  char *description;
+  gint64 timestamp_s;
+  gint64 timestamp_us;
+};
+
+#define XDP_TYPE_LOCATION_FIX (xdp_location_fix_get_type ())
+
+XDP_PUBLIC
+GType            xdp_location_fix_get_type (void) G_GNUC_CONST;
+
+XDP_PUBLIC
+XdpLocationFix * xdp_location_fix_copy     (const XdpLocationFix *fix);
+
+XDP_PUBLIC
+void             xdp_location_fix_free     (XdpLocationFix       *fix);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (XdpLocationFix, xdp_location_fix_free)
+
 XDP_PUBLIC
 void     xdp_portal_location_monitor_start        (XdpPortal                *portal,
                                                    XdpParent                *parent,
@@ -67,4 +108,27 @@ gboolean xdp_portal_location_monitor_start_finish (XdpPortal                *por
 XDP_PUBLIC
 void     xdp_portal_location_monitor_stop         (XdpPortal                *portal);
 
+XDP_PUBLIC
+XdpLocationFix * xdp_portal_get_last_known_location (XdpPortal          *portal);
+
+XDP_PUBLIC
+void     xdp_portal_set_last_known_location_persisted (XdpPortal    *portal,
+                                                       gboolean      persisted);
+
+XDP_PUBLIC
+gboolean xdp_portal_get_last_known_location_persisted (XdpPortal    *portal);
+
+XDP_PUBLIC
+void     xdp_portal_clear_last_known_location      (XdpPortal       *portal);
+
+XDP_PUBLIC
+void     xdp_portal_location_monitor_set_filter   (XdpPortal                *portal,
+                                                   double                    min_distance,
+                                                   guint                     min_interval,
+                                                   double                    max_accuracy);
+
+XDP_PUBLIC
+void     xdp_portal_location_monitor_set_batch_interval (XdpPortal          *portal,
+                                                         guint               interval);
+
 G_END_DECLS
@@ -24,14 +24,13 @@
 
 #include "config.h"
 
-#define _GNU_SOURCE
-#include <sys/mman.h>
 #include <fcntl.h>
 
 #include <glib/gstdio.h>
 #include <gio/gunixfdlist.h>
 #include <gio/gunixoutputstream.h>
 
+#include "memfd-private.h"
 #include "notification.h"
 #include "portal-private.h"
 
@@ -72,69 +71,6 @@ ensure_action_invoked_connection (XdpPortal *portal)
                                            NULL);
 }
 
-static int
-bytes_to_memfd (const gchar  *name,
-                GBytes       *bytes,
-                GError      **error)
-{
-  g_autofd int fd = -1;
-  gconstpointer bytes_data;
-  gpointer shm;
-  gsize bytes_len;
-
-  fd = memfd_create (name, MFD_ALLOW_SEALING);
-  if (fd == -1)
-    {
-      int saved_errno = errno;
-
-      g_set_error (error,
-                   G_IO_ERROR,
-                   g_io_error_from_errno (saved_errno),
-                   "memfd_create: %s", g_strerror (saved_errno));
-      return -1;
-    }
-
-  bytes_data = g_bytes_get_data (bytes, &bytes_len);
-
-  if (ftruncate (fd, bytes_len) == -1)
-    {
-      int saved_errno = errno;
-
-      g_set_error (error,
-                   G_IO_ERROR,
-                   g_io_error_from_errno (saved_errno),
-                   "ftruncate: %s", g_strerror (saved_errno));
-      return -1;
-    }
-
-  shm = mmap (NULL, bytes_len, PROT_WRITE, MAP_SHARED, fd, 0);
-  if (shm == MAP_FAILED)
-    {
-      int saved_errno = errno;
-
-      g_set_error (error,
-                   G_IO_ERROR,
-                   g_io_error_from_errno (saved_errno),
-                   "mmap: %s", g_strerror (saved_errno));
-      return -1;
-    }
-
-  memcpy (shm, bytes_data, bytes_len);
-
-  if (munmap (shm, bytes_len) == -1)
-    {
-      int saved_errno = errno;
-
-      g_set_error (error,
-                   G_IO_ERROR,
-                   g_io_error_from_errno (saved_errno),
-                   "munmap: %s", g_strerror (saved_errno));
-      return -1;
-    }
-
-  return g_steal_fd (&fd);
-}
-
 typedef struct {
   GUnixFDList *fd_list;
   GVariantBuilder *builder;
@@ -306,7 +242,7 @@ parse_media (GVariant            *media,
 
       bytes = g_variant_get_data_as_bytes (value);
 
-      fd = bytes_to_memfd ("notification-media", bytes, &error);
+      fd = _xdp_memfd_new_from_bytes ("notification-media", bytes, &error);
       if (fd == -1)
         {
           g_task_return_error (task, g_steal_pointer (&error));
@@ -326,17 +262,13 @@ parse_media (GVariant            *media,
         }
       else
         {
+          g_autoptr(GError) error = NULL;
           g_autofd int fd = -1;
 
-          fd = memfd_create ("notification-media", MFD_ALLOW_SEALING);
+          fd = _xdp_memfd_new ("notification-media", &error);
           if (fd == -1)
             {
-              int saved_errno = errno;
-
-              g_task_return_new_error (task,
-                                       G_IO_ERROR,
-                                       g_io_error_from_errno (saved_errno),
-                                       "memfd_create: %s", g_strerror (saved_errno));
+              g_task_return_error (task, g_steal_pointer (&error));
               return;
             }
 
@@ -0,0 +1,1719 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pipewire/pipewire.h>
+#include <spa/param/video/format-utils.h>
+#include <spa/utils/result.h>
+
+#include "portal-pipewire.h"
+
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
+#define MAX_RING_SIZE 32
+
+#define MAX_DAMAGE_RECTS 32
+#define DAMAGE_TILE_SIZE 64
+
+#define MAX_CURSOR_SIZE 256
+/* Cursor bitmaps come in 32-bit RGB formats */
+#define CURSOR_BYTES_PER_PIXEL 4
+#define CURSOR_META_SIZE(width, height) \
+  (sizeof (struct spa_meta_cursor) + sizeof (struct spa_meta_bitmap) + (width) * (height) * CURSOR_BYTES_PER_PIXEL)
+
+/**
+ * XdpPipewireFrame
+ *
+ * A video frame received by a [class@PipewireReceiver].
+ *
+ * The frame gives direct access to the PipeWire buffer it was received
+ * in; nothing is copied. As long as the application holds a reference,
+ * the buffer is leased to it and the producer cannot reuse it, so
+ * frames should be released as soon as they have been consumed.
+ *
+ * The buffer can be taken back by PipeWire before the frame is released,
+ * e.g. when the stream is renegotiated or the receiver is destroyed.
+ * After that, [method@PipewireFrame.is_valid] returns %FALSE and the
+ * accessors for the buffer contents return empty values.
+ */
+struct _XdpPipewireFrame {
+  grefcount ref_count;
+
+  XdpPipewireReceiver *receiver;
+  struct pw_buffer *buffer;
+
+  guint64 sequence;
+  gint64 pts;
+  gint64 arrival_time;
+
+  guint32 format;
+  guint width;
+  guint height;
+  guint64 modifier;
+
+  /* NULL if the damage is unknown */
+  GArray *damage;
+
+  gboolean has_cursor;
+  XdpPipewireRect cursor_rect;
+  gint32 cursor_hotspot_x;
+  gint32 cursor_hotspot_y;
+  GBytes *cursor_bitmap;
+  guint cursor_bitmap_width;
+  guint cursor_bitmap_height;
+  gint32 cursor_bitmap_stride;
+  guint32 cursor_bitmap_format;
+};
+
+/**
+ * XdpPipewireReceiver
+ *
+ * Receives video frames from a PipeWire node.
+ *
+ * A [class@PipewireReceiver] takes care of connecting to the PipeWire
+ * remote handed out by the ScreenCast and Camera portals, negotiating
+ * the video format and the buffer types, and queueing the frames as
+ * they come in. Both shared memory and DMA-BUF buffers are accepted;
+ * only buffers with implicit modifiers are negotiated.
+ *
+ * Received frames are kept in a ring of bounded size. When the ring is
+ * full, the oldest frame is dropped and its buffer is handed back to
+ * the producer, so a slow consumer always sees the most recent frames
+ * instead of falling further and further behind. The
+ * [signal@PipewireReceiver::frame-ready] signal is emitted when new
+ * frames have been queued; use [method@PipewireReceiver.acquire_frame]
+ * to take them from the ring.
+ *
+ * Each frame carries the regions that changed since the previous
+ * frame and the cursor position, when the producer provides them; see
+ * [method@PipewireFrame.get_damage] and [method@PipewireFrame.get_cursor].
+ *
+ * The PipeWire loop is dispatched from the thread-default main context
+ * of the thread that created the receiver, and frames must be released
+ * from that thread as well.
+ */
+struct _XdpPipewireReceiver {
+  GObject parent_instance;
+
+  GSource *source;
+  struct pw_context *context;
+  struct pw_core *core;
+  struct spa_hook core_listener;
+  struct pw_stream *stream;
+  struct spa_hook stream_listener;
+
+  guint32 node_id;
+  guint ring_size;
+
+  struct spa_video_info_raw format;
+  gboolean has_modifier;
+
+  /* A copy of the last frame, for computing the damage when the
+   * producer does not provide it */
+  gboolean damage_fallback;
+  guint8 *reference;
+  guint reference_width;
+  guint reference_height;
+  gint32 reference_stride;
+  guint32 reference_format;
+
+  /* Cursor bitmaps are only sent when they change */
+  GBytes *cursor_bitmap;
+  guint cursor_bitmap_width;
+  guint cursor_bitmap_height;
+  gint32 cursor_bitmap_stride;
+  guint32 cursor_bitmap_format;
+
+  /* Frames waiting to be acquired, oldest first */
+  GQueue ring;
+  /* struct pw_buffer -> XdpPipewireFrame, for all frames that hold a
+   * buffer, whether they are in the ring or leased to the application */
+  GHashTable *frames;
+
+  enum pw_stream_state state;
+  gboolean streaming;
+  gboolean frames_pending;
+  GError *pending_error;
+
+  guint64 next_sequence;
+  guint64 n_received;
+  guint64 n_dropped;
+  gint64 last_arrival;
+  gint64 total_interval;
+  gint64 max_interval;
+};
+
+enum {
+  PROP_0,
+  PROP_STREAMING,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+enum {
+  FRAME_READY,
+  ERROR,
+  LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL];
+
+G_DEFINE_BOXED_TYPE (XdpPipewireFrame, xdp_pipewire_frame,
+                     xdp_pipewire_frame_ref, xdp_pipewire_frame_unref)
+
+G_DEFINE_TYPE (XdpPipewireReceiver, xdp_pipewire_receiver, G_TYPE_OBJECT)
+
+static struct spa_data *
+frame_get_data (XdpPipewireFrame *frame)
+{
+  if (frame->buffer == NULL || frame->buffer->buffer->n_datas == 0)
+    return NULL;
+
+  return &frame->buffer->buffer->datas[0];
+}
+
+/* The chunk is filled in by the producer, so keep it within the
+ * mapped memory no matter what it says */
+static const guint8 *
+data_get_chunk (struct spa_data *data,
+                gsize           *size)
+{
+  guint32 offset;
+
+  *size = 0;
+
+  if (data->data == NULL || data->maxsize == 0)
+    return NULL;
+
+  offset = data->chunk->offset % data->maxsize;
+  *size = MIN (data->chunk->size, data->maxsize - offset);
+
+  return SPA_PTROFF (data->data, offset, const guint8);
+}
+
+/**
+ * xdp_pipewire_frame_ref:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Increases the reference count of @frame.
+ *
+ * Returns: (transfer full): @frame
+ */
+XdpPipewireFrame *
+xdp_pipewire_frame_ref (XdpPipewireFrame *frame)
+{
+  g_return_val_if_fail (frame != NULL, NULL);
+
+  g_ref_count_inc (&frame->ref_count);
+
+  return frame;
+}
+
+/**
+ * xdp_pipewire_frame_unref:
+ * @frame: (transfer full): a [struct@PipewireFrame]
+ *
+ * Decreases the reference count of @frame. When the last reference is
+ * dropped, the buffer is handed back to the producer.
+ */
+void
+xdp_pipewire_frame_unref (XdpPipewireFrame *frame)
+{
+  g_return_if_fail (frame != NULL);
+
+  if (!g_ref_count_dec (&frame->ref_count))
+    return;
+
+  if (frame->buffer)
+    {
+      XdpPipewireReceiver *receiver = frame->receiver;
+
+      g_hash_table_remove (receiver->frames, frame->buffer);
+      pw_stream_queue_buffer (receiver->stream, frame->buffer);
+    }
+
+  g_clear_pointer (&frame->damage, g_array_unref);
+  g_clear_pointer (&frame->cursor_bitmap, g_bytes_unref);
+  g_free (frame);
+}
+
+/**
+ * xdp_pipewire_frame_is_valid:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns whether the buffer of @frame is still available.
+ *
+ * Returns: %TRUE if the frame contents can be accessed
+ */
+gboolean
+xdp_pipewire_frame_is_valid (XdpPipewireFrame *frame)
+{
+  g_return_val_if_fail (frame != NULL, FALSE);
+
+  return frame->buffer != NULL;
+}
+
+/**
+ * xdp_pipewire_frame_get_sequence:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the sequence number of @frame. Sequence numbers are assigned
+ * by the receiver in the order the frames arrive, including the frames
+ * that were dropped, so gaps indicate dropped frames.
+ *
+ * Returns: the sequence number
+ */
+guint64
+xdp_pipewire_frame_get_sequence (XdpPipewireFrame *frame)
+{
+  g_return_val_if_fail (frame != NULL, 0);
+
+  return frame->sequence;
+}
+
+/**
+ * xdp_pipewire_frame_get_pts:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the presentation timestamp the producer attached to @frame.
+ *
+ * Returns: the timestamp in nanoseconds, or -1 if the producer did
+ *   not provide one
+ */
+gint64
+xdp_pipewire_frame_get_pts (XdpPipewireFrame *frame)
+{
+  g_return_val_if_fail (frame != NULL, -1);
+
+  return frame->pts;
+}
+
+/**
+ * xdp_pipewire_frame_get_arrival_time:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the time at which @frame was received, in the time base of
+ * g_get_monotonic_time().
+ *
+ * Returns: the arrival time, in microseconds
+ */
+gint64
+xdp_pipewire_frame_get_arrival_time (XdpPipewireFrame *frame)
+{
+  g_return_val_if_fail (frame != NULL, 0);
+
+  return frame->arrival_time;
+}
+
+/**
+ * xdp_pipewire_frame_get_format:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the pixel format of @frame, as a `spa_video_format` value.
+ * Only 32-bit RGB formats are negotiated.
+ *
+ * Returns: the pixel format
+ */
+guint32
+xdp_pipewire_frame_get_format (XdpPipewireFrame *frame)
+{
+  g_return_val_if_fail (frame != NULL, 0);
+
+  return frame->format;
+}
+
+/**
+ * xdp_pipewire_frame_get_size:
+ * @frame: a [struct@PipewireFrame]
+ * @width: (out) (optional): return location for the width
+ * @height: (out) (optional): return location for the height
+ *
+ * Obtains the size of @frame, in pixels.
+ */
+void
+xdp_pipewire_frame_get_size (XdpPipewireFrame *frame,
+                             guint            *width,
+                             guint            *height)
+{
+  g_return_if_fail (frame != NULL);
+
+  if (width)
+    *width = frame->width;
+  if (height)
+    *height = frame->height;
+}
+
+/**
+ * xdp_pipewire_frame_is_dmabuf:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns whether @frame is stored in a DMA-BUF. The contents of such
+ * frames cannot be accessed with [method@PipewireFrame.get_data]; import
+ * the file descriptor instead.
+ *
+ * Returns: %TRUE if the frame is a DMA-BUF
+ */
+gboolean
+xdp_pipewire_frame_is_dmabuf (XdpPipewireFrame *frame)
+{
+  struct spa_data *data;
+
+  g_return_val_if_fail (frame != NULL, FALSE);
+
+  data = frame_get_data (frame);
+
+  return data != NULL && data->type == SPA_DATA_DmaBuf;
+}
+
+/**
+ * xdp_pipewire_frame_get_modifier:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the DRM format modifier of a DMA-BUF frame.
+ *
+ * Returns: the modifier, or `DRM_FORMAT_MOD_INVALID` if the layout of
+ *   the buffer is implicit
+ */
+guint64
+xdp_pipewire_frame_get_modifier (XdpPipewireFrame *frame)
+{
+  g_return_val_if_fail (frame != NULL, DRM_FORMAT_MOD_INVALID);
+
+  return frame->modifier;
+}
+
+/**
+ * xdp_pipewire_frame_get_fd:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the file descriptor that backs @frame. The file descriptor
+ * is owned by PipeWire and is only valid while @frame is valid.
+ *
+ * Returns: the file descriptor, or -1 if the frame is not backed by
+ *   a memfd or a DMA-BUF
+ */
+int
+xdp_pipewire_frame_get_fd (XdpPipewireFrame *frame)
+{
+  struct spa_data *data;
+
+  g_return_val_if_fail (frame != NULL, -1);
+
+  data = frame_get_data (frame);
+  if (data == NULL ||
+      (data->type != SPA_DATA_MemFd && data->type != SPA_DATA_DmaBuf))
+    return -1;
+
+  return data->fd;
+}
+
+/**
+ * xdp_pipewire_frame_get_offset:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the offset of the first pixel of @frame in its file descriptor.
+ *
+ * Returns: the offset, in bytes
+ */
+guint32
+xdp_pipewire_frame_get_offset (XdpPipewireFrame *frame)
+{
+  struct spa_data *data;
+
+  g_return_val_if_fail (frame != NULL, 0);
+
+  data = frame_get_data (frame);
+  if (data == NULL)
+    return 0;
+
+  return data->chunk->offset;
+}
+
+/**
+ * xdp_pipewire_frame_get_stride:
+ * @frame: a [struct@PipewireFrame]
+ *
+ * Returns the distance between two rows of @frame.
+ *
+ * Returns: the stride, in bytes
+ */
+gint32
+xdp_pipewire_frame_get_stride (XdpPipewireFrame *frame)
+{
+  struct spa_data *data;
+
+  g_return_val_if_fail (frame != NULL, 0);
+
+  data = frame_get_data (frame);
+  if (data == NULL)
+    return 0;
+
+  return data->chunk->stride;
+}
+
+/**
+ * xdp_pipewire_frame_get_data:
+ * @frame: a [struct@PipewireFrame]
+ * @size: (out) (optional): return location for the size of the data
+ *
+ * Returns the pixels of @frame, mapped into memory. The data is owned
+ * by PipeWire and is only valid while @frame is valid.
+ *
+ * Returns: (array length=size) (nullable) (transfer none): the pixels,
+ *   or %NULL if the frame is not mapped, e.g. because it is a DMA-BUF
+ */
+const guint8 *
+xdp_pipewire_frame_get_data (XdpPipewireFrame *frame,
+                             gsize            *size)
+{
+  struct spa_data *data;
+  const guint8 *chunk;
+  gsize chunk_size;
+
+  g_return_val_if_fail (frame != NULL, NULL);
+
+  if (size)
+    *size = 0;
+
+  data = frame_get_data (frame);
+  if (data == NULL)
+    return NULL;
+
+  chunk = data_get_chunk (data, &chunk_size);
+  if (size)
+    *size = chunk_size;
+
+  return chunk;
+}
+
+/**
+ * xdp_pipewire_frame_get_damage:
+ * @frame: a [struct@PipewireFrame]
+ * @rects: (out) (array length=n_rects) (transfer none) (optional): return
+ *   location for the damaged rectangles
+ * @n_rects: (out) (optional): return location for the number of rectangles
+ *
+ * Obtains the parts of @frame that changed since the previous frame.
+ *
+ * The damage is taken from the metadata of the producer. If there is
+ * none, it is computed by comparing the frame with the previous one
+ * when [method@PipewireReceiver.set_damage_fallback] was enabled. The
+ * damage of dropped frames is added to the frame that follows them, so
+ * the damage is always relative to the previous frame that was acquired.
+ *
+ * Frames that only update the cursor have no damage.
+ *
+ * Returns: %TRUE if the damage is known, %FALSE if the whole frame must
+ *   be considered damaged
+ */
+gboolean
+xdp_pipewire_frame_get_damage (XdpPipewireFrame       *frame,
+                               const XdpPipewireRect **rects,
+                               guint                  *n_rects)
+{
+  g_return_val_if_fail (frame != NULL, FALSE);
+
+  if (rects)
+    *rects = NULL;
+  if (n_rects)
+    *n_rects = 0;
+
+  if (frame->damage == NULL)
+    return FALSE;
+
+  if (rects)
+    *rects = (const XdpPipewireRect *) frame->damage->data;
+  if (n_rects)
+    *n_rects = frame->damage->len;
+
+  return TRUE;
+}
+
+/**
+ * xdp_pipewire_frame_get_cursor:
+ * @frame: a [struct@PipewireFrame]
+ * @rect: (out caller-allocates) (optional): return location for the area
+ *   covered by the cursor
+ * @hotspot_x: (out) (optional): return location for the X coordinate of
+ *   the hotspot, relative to @rect
+ * @hotspot_y: (out) (optional): return location for the Y coordinate of
+ *   the hotspot, relative to @rect
+ *
+ * Obtains the position of the cursor at the time @frame was produced.
+ *
+ * Cursor metadata is only sent for screencasts that were started with
+ * %XDP_CURSOR_MODE_METADATA.
+ *
+ * Returns: %TRUE if the cursor is visible in the stream
+ */
+gboolean
+xdp_pipewire_frame_get_cursor (XdpPipewireFrame *frame,
+                               XdpPipewireRect  *rect,
+                               gint32           *hotspot_x,
+                               gint32           *hotspot_y)
+{
+  g_return_val_if_fail (frame != NULL, FALSE);
+
+  if (rect)
+    *rect = frame->cursor_rect;
+  if (hotspot_x)
+    *hotspot_x = frame->cursor_hotspot_x;
+  if (hotspot_y)
+    *hotspot_y = frame->cursor_hotspot_y;
+
+  return frame->has_cursor;
+}
+
+/**
+ * xdp_pipewire_frame_get_cursor_bitmap:
+ * @frame: a [struct@PipewireFrame]
+ * @width: (out) (optional): return location for the width of the bitmap
+ * @height: (out) (optional): return location for the height of the bitmap
+ * @stride: (out) (optional): return location for the stride of the bitmap
+ * @format: (out) (optional): return location for the pixel format of
+ *   the bitmap, as a `spa_video_format` value
+ *
+ * Obtains the image of the cursor at the time @frame was produced.
+ * The same [struct@GLib.Bytes] is returned as long as the cursor image
+ * does not change.
+ *
+ * Returns: (transfer none) (nullable): the cursor image, or %NULL
+ */
+GBytes *
+xdp_pipewire_frame_get_cursor_bitmap (XdpPipewireFrame *frame,
+                                      guint            *width,
+                                      guint            *height,
+                                      gint32           *stride,
+                                      guint32          *format)
+{
+  g_return_val_if_fail (frame != NULL, NULL);
+
+  if (width)
+    *width = frame->cursor_bitmap_width;
+  if (height)
+    *height = frame->cursor_bitmap_height;
+  if (stride)
+    *stride = frame->cursor_bitmap_stride;
+  if (format)
+    *format = frame->cursor_bitmap_format;
+
+  return frame->cursor_bitmap;
+}
+
+/* The PipeWire loop is driven from a GSource, so that all stream
+ * callbacks run on the thread that owns the receiver */
+typedef struct {
+  GSource base;
+  struct pw_loop *loop;
+} PipewireSource;
+
+static gboolean
+pipewire_source_dispatch (GSource     *source,
+                          GSourceFunc  callback,
+                          gpointer     user_data)
+{
+  PipewireSource *pipewire_source = (PipewireSource *) source;
+  int result;
+
+  result = pw_loop_iterate (pipewire_source->loop, 0);
+  if (result < 0)
+    g_warning ("pw_loop_iterate() failed: %s", spa_strerror (result));
+
+  if (callback)
+    return callback (user_data);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+pipewire_source_finalize (GSource *source)
+{
+  PipewireSource *pipewire_source = (PipewireSource *) source;
+
+  pw_loop_leave (pipewire_source->loop);
+  pw_loop_destroy (pipewire_source->loop);
+}
+
+static GSourceFuncs pipewire_source_funcs = {
+  NULL,
+  NULL,
+  pipewire_source_dispatch,
+  pipewire_source_finalize,
+};
+
+/* Signals are emitted once the loop iteration is over rather than from
+ * the PipeWire callbacks, so that handlers are free to release frames
+ * or drop the receiver */
+static gboolean
+flush_events (gpointer data)
+{
+  g_autoptr(XdpPipewireReceiver) receiver = g_object_ref (data);
+  gboolean streaming;
+
+  streaming = receiver->state == PW_STREAM_STATE_STREAMING;
+  if (receiver->streaming != streaming)
+    {
+      receiver->streaming = streaming;
+      g_object_notify_by_pspec (G_OBJECT (receiver), properties[PROP_STREAMING]);
+    }
+
+  if (receiver->pending_error)
+    {
+      g_autoptr(GError) error = g_steal_pointer (&receiver->pending_error);
+
+      g_signal_emit (receiver, signals[ERROR], 0, error);
+    }
+
+  if (receiver->frames_pending)
+    {
+      receiver->frames_pending = FALSE;
+      g_signal_emit (receiver, signals[FRAME_READY], 0);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+set_pending_error (XdpPipewireReceiver *receiver,
+                   const char          *message)
+{
+  if (receiver->pending_error)
+    return;
+
+  receiver->pending_error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED,
+                                         "PipeWire stream failed: %s",
+                                         message ? message : "unknown error");
+}
+
+static void
+on_core_error (void       *data,
+               uint32_t    id,
+               int         seq,
+               int         res,
+               const char *message)
+{
+  XdpPipewireReceiver *receiver = data;
+
+  if (id == PW_ID_CORE)
+    set_pending_error (receiver, message);
+}
+
+static const struct pw_core_events core_events = {
+  PW_VERSION_CORE_EVENTS,
+  .error = on_core_error,
+};
+
+static void
+on_stream_state_changed (void                 *data,
+                         enum pw_stream_state  old,
+                         enum pw_stream_state  state,
+                         const char           *error)
+{
+  XdpPipewireReceiver *receiver = data;
+
+  receiver->state = state;
+
+  if (state == PW_STREAM_STATE_ERROR)
+    set_pending_error (receiver, error);
+}
+
+static void
+on_stream_param_changed (void                 *data,
+                         uint32_t              id,
+                         const struct spa_pod *param)
+{
+  XdpPipewireReceiver *receiver = data;
+  uint8_t params_buffer[1024];
+  struct spa_pod_builder builder = SPA_POD_BUILDER_INIT (params_buffer, sizeof (params_buffer));
+  const struct spa_pod *params[4];
+  uint32_t media_type;
+  uint32_t media_subtype;
+  int data_types;
+  int n_buffers;
+
+  if (param == NULL || id != SPA_PARAM_Format)
+    return;
+
+  if (spa_format_parse (param, &media_type, &media_subtype) < 0 ||
+      media_type != SPA_MEDIA_TYPE_video ||
+      media_subtype != SPA_MEDIA_SUBTYPE_raw)
+    return;
+
+  spa_zero (receiver->format);
+  if (spa_format_video_raw_parse (param, &receiver->format) < 0)
+    return;
+
+  receiver->has_modifier = spa_pod_find_prop (param, NULL, SPA_FORMAT_VIDEO_modifier) != NULL;
+
+  if (receiver->has_modifier)
+    data_types = 1 << SPA_DATA_DmaBuf;
+  else
+    data_types = (1 << SPA_DATA_MemFd) | (1 << SPA_DATA_MemPtr);
+
+  /* Every frame in the ring holds on to a buffer, so leave a few more
+   * for the producer to render into and for frames leased out */
+  n_buffers = receiver->ring_size + 3;
+
+  params[0] = spa_pod_builder_add_object (&builder,
+                                          SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers,
+                                          SPA_PARAM_BUFFERS_buffers, SPA_POD_CHOICE_RANGE_Int (n_buffers, 2, MAX_RING_SIZE + 3),
+                                          SPA_PARAM_BUFFERS_dataType, SPA_POD_CHOICE_FLAGS_Int (data_types));
+  params[1] = spa_pod_builder_add_object (&builder,
+                                          SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+                                          SPA_PARAM_META_type, SPA_POD_Id (SPA_META_Header),
+                                          SPA_PARAM_META_size, SPA_POD_Int (sizeof (struct spa_meta_header)));
+  params[2] = spa_pod_builder_add_object (&builder,
+                                          SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+                                          SPA_PARAM_META_type, SPA_POD_Id (SPA_META_VideoDamage),
+                                          SPA_PARAM_META_size, SPA_POD_CHOICE_RANGE_Int (sizeof (struct spa_meta_region) * MAX_DAMAGE_RECTS,
+                                                                                         sizeof (struct spa_meta_region),
+                                                                                         sizeof (struct spa_meta_region) * MAX_DAMAGE_RECTS));
+  params[3] = spa_pod_builder_add_object (&builder,
+                                          SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+                                          SPA_PARAM_META_type, SPA_POD_Id (SPA_META_Cursor),
+                                          SPA_PARAM_META_size, SPA_POD_CHOICE_RANGE_Int (CURSOR_META_SIZE (64, 64),
+                                                                                         CURSOR_META_SIZE (1, 1),
+                                                                                         CURSOR_META_SIZE (MAX_CURSOR_SIZE, MAX_CURSOR_SIZE)));
+
+  pw_stream_update_params (receiver->stream, params, G_N_ELEMENTS (params));
+}
+
+static void
+on_stream_remove_buffer (void             *data,
+                         struct pw_buffer *buffer)
+{
+  XdpPipewireReceiver *receiver = data;
+  XdpPipewireFrame *frame;
+
+  frame = g_hash_table_lookup (receiver->frames, buffer);
+  if (frame == NULL)
+    return;
+
+  g_hash_table_remove (receiver->frames, buffer);
+  frame->buffer = NULL;
+
+  if (g_queue_remove (&receiver->ring, frame))
+    xdp_pipewire_frame_unref (frame);
+}
+
+static gboolean
+buffer_is_corrupted (struct pw_buffer *buffer)
+{
+  struct spa_meta_header *header;
+
+  if (buffer->buffer->n_datas == 0 ||
+      (buffer->buffer->datas[0].chunk->flags & SPA_CHUNK_FLAG_CORRUPTED))
+    return TRUE;
+
+  header = spa_buffer_find_meta_data (buffer->buffer, SPA_META_Header, sizeof (*header));
+
+  return header != NULL && (header->flags & SPA_META_HEADER_FLAG_CORRUPTED);
+}
+
+/* Rectangles are added row by row; a rectangle that continues one
+ * from the row above with the same columns is merged into it */
+static void
+add_damage_rect (GArray *damage,
+                 gint32  x,
+                 gint32  y,
+                 guint32 width,
+                 guint32 height)
+{
+  XdpPipewireRect rect = { x, y, width, height };
+  guint i;
+
+  for (i = damage->len; i > 0; i--)
+    {
+      XdpPipewireRect *previous = &g_array_index (damage, XdpPipewireRect, i - 1);
+
+      if (previous->y + (gint32) previous->height < y)
+        break;
+
+      if (previous->x == x &&
+          previous->width == width &&
+          previous->y + (gint32) previous->height == y)
+        {
+          previous->height += height;
+          return;
+        }
+    }
+
+  g_array_append_val (damage, rect);
+}
+
+/* Too many rectangles cost the encoder more than they save */
+static void
+compact_damage (GArray *damage)
+{
+  XdpPipewireRect bounds;
+  gint32 x2, y2;
+  guint i;
+
+  if (damage->len <= MAX_DAMAGE_RECTS)
+    return;
+
+  bounds = g_array_index (damage, XdpPipewireRect, 0);
+  x2 = bounds.x + bounds.width;
+  y2 = bounds.y + bounds.height;
+
+  for (i = 1; i < damage->len; i++)
+    {
+      XdpPipewireRect *rect = &g_array_index (damage, XdpPipewireRect, i);
+
+      bounds.x = MIN (bounds.x, rect->x);
+      bounds.y = MIN (bounds.y, rect->y);
+      x2 = MAX (x2, rect->x + (gint32) rect->width);
+      y2 = MAX (y2, rect->y + (gint32) rect->height);
+    }
+
+  bounds.width = x2 - bounds.x;
+  bounds.height = y2 - bounds.y;
+
+  g_array_set_size (damage, 1);
+  g_array_index (damage, XdpPipewireRect, 0) = bounds;
+}
+
+static GArray *
+read_damage_meta (struct pw_buffer *buffer)
+{
+  struct spa_meta *meta;
+  struct spa_meta_region *region;
+  GArray *damage;
+
+  meta = spa_buffer_find_meta (buffer->buffer, SPA_META_VideoDamage);
+  if (meta == NULL)
+    return NULL;
+
+  damage = g_array_new (FALSE, FALSE, sizeof (XdpPipewireRect));
+
+  spa_meta_for_each (region, meta)
+    {
+      XdpPipewireRect rect;
+
+      if (!spa_meta_region_is_valid (region))
+        break;
+
+      rect.x = region->region.position.x;
+      rect.y = region->region.position.y;
+      rect.width = region->region.size.width;
+      rect.height = region->region.size.height;
+      g_array_append_val (damage, rect);
+    }
+
+  compact_damage (damage);
+
+  return damage;
+}
+
+/* Compares the frame with the previous one in tiles, and keeps the
+ * reference copy up to date as it goes. memcmp() is vectorized by the
+ * C library, so this runs at memory bandwidth on unchanged tiles. */
+static GArray *
+compute_damage (XdpPipewireReceiver *receiver,
+                XdpPipewireFrame    *frame,
+                const guint8        *pixels,
+                gsize                size,
+                gint32               stride)
+{
+  GArray *damage;
+  gsize row_size = (gsize) frame->width * 4;
+  gsize frame_size;
+  guint tile_x, tile_y;
+
+  if (frame->width == 0 || frame->height == 0 ||
+      stride <= 0 || (gsize) stride < row_size)
+    return NULL;
+
+  /* The padding after the last row need not be part of the buffer */
+  frame_size = (gsize) stride * (frame->height - 1) + row_size;
+  if (size < frame_size)
+    return NULL;
+
+  damage = g_array_new (FALSE, FALSE, sizeof (XdpPipewireRect));
+
+  if (receiver->reference == NULL ||
+      receiver->reference_width != frame->width ||
+      receiver->reference_height != frame->height ||
+      receiver->reference_stride != stride ||
+      receiver->reference_format != frame->format)
+    {
+      g_free (receiver->reference);
+      receiver->reference = g_memdup2 (pixels, frame_size);
+      receiver->reference_width = frame->width;
+      receiver->reference_height = frame->height;
+      receiver->reference_stride = stride;
+      receiver->reference_format = frame->format;
+
+      add_damage_rect (damage, 0, 0, frame->width, frame->height);
+      return damage;
+    }
+
+  for (tile_y = 0; tile_y < frame->height; tile_y += DAMAGE_TILE_SIZE)
+    {
+      guint tile_height = MIN (DAMAGE_TILE_SIZE, frame->height - tile_y);
+      gint64 run_start = -1;
+
+      for (tile_x = 0; tile_x < frame->width; tile_x += DAMAGE_TILE_SIZE)
+        {
+          gsize tile_size = (gsize) MIN (DAMAGE_TILE_SIZE, frame->width - tile_x) * 4;
+          gboolean dirty = FALSE;
+          guint y;
+
+          for (y = tile_y; y < tile_y + tile_height; y++)
+            {
+              gsize offset = (gsize) y * stride + (gsize) tile_x * 4;
+
+              if (!dirty && memcmp (receiver->reference + offset, pixels + offset, tile_size) != 0)
+                dirty = TRUE;
+
+              if (dirty)
+                memcpy (receiver->reference + offset, pixels + offset, tile_size);
+            }
+
+          if (dirty && run_start < 0)
+            {
+              run_start = tile_x;
+            }
+          else if (!dirty && run_start >= 0)
+            {
+              add_damage_rect (damage, run_start, tile_y, tile_x - run_start, tile_height);
+              run_start = -1;
+            }
+        }
+
+      if (run_start >= 0)
+        add_damage_rect (damage, run_start, tile_y, frame->width - run_start, tile_height);
+    }
+
+  compact_damage (damage);
+
+  return damage;
+}
+
+static void
+read_cursor_meta (XdpPipewireReceiver *receiver,
+                  XdpPipewireFrame    *frame,
+                  struct pw_buffer    *buffer)
+{
+  struct spa_meta *meta;
+  struct spa_meta_cursor *cursor;
+  struct spa_meta_bitmap *bitmap;
+
+  meta = spa_buffer_find_meta (buffer->buffer, SPA_META_Cursor);
+  if (meta == NULL || meta->size < sizeof (*cursor))
+    return;
+
+  cursor = meta->data;
+  if (!spa_meta_cursor_is_valid (cursor))
+    return;
+
+  /* The producer fills in the offsets and sizes; the bitmap must lie
+   * within the meta region */
+  if (cursor->bitmap_offset >= sizeof (*cursor) &&
+      (guint64) cursor->bitmap_offset + sizeof (*bitmap) <= meta->size)
+    {
+      bitmap = SPA_PTROFF (cursor, cursor->bitmap_offset, struct spa_meta_bitmap);
+
+      if (bitmap->size.width > 0 && bitmap->size.height > 0 &&
+          bitmap->offset >= sizeof (*bitmap) && bitmap->stride > 0 &&
+          (guint64) bitmap->stride >= (guint64) bitmap->size.width * CURSOR_BYTES_PER_PIXEL &&
+          (guint64) cursor->bitmap_offset + bitmap->offset +
+          (guint64) bitmap->stride * bitmap->size.height <= meta->size)
+        {
+          g_clear_pointer (&receiver->cursor_bitmap, g_bytes_unref);
+          receiver->cursor_bitmap = g_bytes_new (SPA_PTROFF (bitmap, bitmap->offset, void),
+                                                 (gsize) bitmap->stride * bitmap->size.height);
+          receiver->cursor_bitmap_width = bitmap->size.width;
+          receiver->cursor_bitmap_height = bitmap->size.height;
+          receiver->cursor_bitmap_stride = bitmap->stride;
+          receiver->cursor_bitmap_format = bitmap->format;
+        }
+    }
+
+  frame->has_cursor = TRUE;
+  frame->cursor_hotspot_x = cursor->hotspot.x;
+  frame->cursor_hotspot_y = cursor->hotspot.y;
+  frame->cursor_rect.x = cursor->position.x - cursor->hotspot.x;
+  frame->cursor_rect.y = cursor->position.y - cursor->hotspot.y;
+  frame->cursor_rect.width = receiver->cursor_bitmap_width;
+  frame->cursor_rect.height = receiver->cursor_bitmap_height;
+
+  if (receiver->cursor_bitmap)
+    frame->cursor_bitmap = g_bytes_ref (receiver->cursor_bitmap);
+  frame->cursor_bitmap_width = receiver->cursor_bitmap_width;
+  frame->cursor_bitmap_height = receiver->cursor_bitmap_height;
+  frame->cursor_bitmap_stride = receiver->cursor_bitmap_stride;
+  frame->cursor_bitmap_format = receiver->cursor_bitmap_format;
+}
+
+static void
+read_damage (XdpPipewireReceiver *receiver,
+             XdpPipewireFrame    *frame,
+             struct pw_buffer    *buffer)
+{
+  struct spa_data *data = &buffer->buffer->datas[0];
+  const guint8 *chunk;
+  gsize chunk_size;
+
+  /* Buffers without contents only carry a cursor update */
+  if (data->type != SPA_DATA_DmaBuf && data->chunk->size == 0)
+    {
+      frame->damage = g_array_new (FALSE, FALSE, sizeof (XdpPipewireRect));
+      return;
+    }
+
+  frame->damage = read_damage_meta (buffer);
+  if (frame->damage)
+    {
+      /* The reference goes stale as soon as a frame is not compared */
+      g_clear_pointer (&receiver->reference, g_free);
+      return;
+    }
+
+  chunk = data_get_chunk (data, &chunk_size);
+  if (receiver->damage_fallback && chunk != NULL)
+    frame->damage = compute_damage (receiver, frame, chunk, chunk_size,
+                                    data->chunk->stride);
+  else
+    g_clear_pointer (&receiver->reference, g_free);
+}
+
+/* The damage of a dropped frame is carried over to the one after it,
+ * so that consumers do not miss any change */
+static void
+drop_frame (XdpPipewireReceiver *receiver,
+            XdpPipewireFrame    *dropped,
+            XdpPipewireFrame    *next)
+{
+  receiver->n_dropped++;
+
+  if (next->damage)
+    {
+      if (dropped->damage)
+        {
+          guint i;
+
+          for (i = 0; i < dropped->damage->len; i++)
+            g_array_append_val (next->damage, g_array_index (dropped->damage, XdpPipewireRect, i));
+
+          compact_damage (next->damage);
+        }
+      else
+        {
+          g_clear_pointer (&next->damage, g_array_unref);
+        }
+    }
+
+  xdp_pipewire_frame_unref (dropped);
+}
+
+static void
+receive_buffer (XdpPipewireReceiver *receiver,
+                struct pw_buffer    *buffer)
+{
+  XdpPipewireFrame *frame;
+  struct spa_meta_header *header;
+  gint64 now = g_get_monotonic_time ();
+
+  frame = g_new0 (XdpPipewireFrame, 1);
+  g_ref_count_init (&frame->ref_count);
+  frame->receiver = receiver;
+  frame->buffer = buffer;
+  frame->sequence = receiver->next_sequence++;
+  frame->arrival_time = now;
+  frame->format = receiver->format.format;
+  frame->width = receiver->format.size.width;
+  frame->height = receiver->format.size.height;
+  frame->modifier = receiver->has_modifier ? receiver->format.modifier : DRM_FORMAT_MOD_INVALID;
+
+  header = spa_buffer_find_meta_data (buffer->buffer, SPA_META_Header, sizeof (*header));
+  frame->pts = header ? header->pts : -1;
+
+  read_damage (receiver, frame, buffer);
+  read_cursor_meta (receiver, frame, buffer);
+
+  if (receiver->n_received > 0)
+    {
+      gint64 interval = now - receiver->last_arrival;
+
+      receiver->total_interval += interval;
+      receiver->max_interval = MAX (receiver->max_interval, interval);
+    }
+  receiver->last_arrival = now;
+  receiver->n_received++;
+
+  g_hash_table_insert (receiver->frames, buffer, frame);
+
+  g_queue_push_tail (&receiver->ring, frame);
+
+  if (g_queue_get_length (&receiver->ring) > receiver->ring_size)
+    {
+      XdpPipewireFrame *dropped = g_queue_pop_head (&receiver->ring);
+
+      drop_frame (receiver, dropped, g_queue_peek_head (&receiver->ring));
+    }
+
+  receiver->frames_pending = TRUE;
+}
+
+static void
+on_stream_process (void *data)
+{
+  XdpPipewireReceiver *receiver = data;
+  struct pw_buffer *buffer;
+
+  while ((buffer = pw_stream_dequeue_buffer (receiver->stream)) != NULL)
+    {
+      if (buffer_is_corrupted (buffer))
+        pw_stream_queue_buffer (receiver->stream, buffer);
+      else
+        receive_buffer (receiver, buffer);
+    }
+}
+
+static const struct pw_stream_events stream_events = {
+  PW_VERSION_STREAM_EVENTS,
+  .state_changed = on_stream_state_changed,
+  .param_changed = on_stream_param_changed,
+  .remove_buffer = on_stream_remove_buffer,
+  .process = on_stream_process,
+};
+
+static const struct spa_pod *
+build_format_param (struct spa_pod_builder *builder,
+                    gboolean                dmabuf)
+{
+  struct spa_pod_frame pod_frame;
+
+  spa_pod_builder_push_object (builder, &pod_frame, SPA_TYPE_OBJECT_Format, SPA_PARAM_EnumFormat);
+  spa_pod_builder_add (builder,
+                       SPA_FORMAT_mediaType, SPA_POD_Id (SPA_MEDIA_TYPE_video),
+                       SPA_FORMAT_mediaSubtype, SPA_POD_Id (SPA_MEDIA_SUBTYPE_raw),
+                       SPA_FORMAT_VIDEO_format, SPA_POD_CHOICE_ENUM_Id (5,
+                                                                        SPA_VIDEO_FORMAT_BGRx,
+                                                                        SPA_VIDEO_FORMAT_BGRx,
+                                                                        SPA_VIDEO_FORMAT_RGBx,
+                                                                        SPA_VIDEO_FORMAT_BGRA,
+                                                                        SPA_VIDEO_FORMAT_RGBA),
+                       SPA_FORMAT_VIDEO_size, SPA_POD_CHOICE_RANGE_Rectangle (&SPA_RECTANGLE (1920, 1080),
+                                                                              &SPA_RECTANGLE (1, 1),
+                                                                              &SPA_RECTANGLE (16384, 16384)),
+                       SPA_FORMAT_VIDEO_framerate, SPA_POD_CHOICE_RANGE_Fraction (&SPA_FRACTION (0, 1),
+                                                                                  &SPA_FRACTION (0, 1),
+                                                                                  &SPA_FRACTION (1000, 1)),
+                       0);
+
+  if (dmabuf)
+    {
+      spa_pod_builder_prop (builder, SPA_FORMAT_VIDEO_modifier, SPA_POD_PROP_FLAG_MANDATORY);
+      spa_pod_builder_long (builder, DRM_FORMAT_MOD_INVALID);
+    }
+
+  return spa_pod_builder_pop (builder, &pod_frame);
+}
+
+static void
+xdp_pipewire_receiver_dispose (GObject *object)
+{
+  XdpPipewireReceiver *receiver = XDP_PIPEWIRE_RECEIVER (object);
+  GHashTableIter iter;
+  XdpPipewireFrame *frame;
+
+  /* Frames that are still leased out outlive the stream */
+  g_hash_table_iter_init (&iter, receiver->frames);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &frame))
+    frame->buffer = NULL;
+  g_hash_table_remove_all (receiver->frames);
+
+  g_queue_clear_full (&receiver->ring, (GDestroyNotify) xdp_pipewire_frame_unref);
+
+  if (receiver->stream)
+    {
+      spa_hook_remove (&receiver->stream_listener);
+      g_clear_pointer (&receiver->stream, pw_stream_destroy);
+    }
+
+  if (receiver->core)
+    {
+      spa_hook_remove (&receiver->core_listener);
+      g_clear_pointer (&receiver->core, pw_core_disconnect);
+    }
+
+  g_clear_pointer (&receiver->context, pw_context_destroy);
+
+  if (receiver->source)
+    {
+      g_source_destroy (receiver->source);
+      g_clear_pointer (&receiver->source, g_source_unref);
+    }
+
+  G_OBJECT_CLASS (xdp_pipewire_receiver_parent_class)->dispose (object);
+}
+
+static void
+xdp_pipewire_receiver_finalize (GObject *object)
+{
+  XdpPipewireReceiver *receiver = XDP_PIPEWIRE_RECEIVER (object);
+
+  g_clear_pointer (&receiver->frames, g_hash_table_unref);
+  g_clear_error (&receiver->pending_error);
+  g_clear_pointer (&receiver->reference, g_free);
+  g_clear_pointer (&receiver->cursor_bitmap, g_bytes_unref);
+
+  G_OBJECT_CLASS (xdp_pipewire_receiver_parent_class)->finalize (object);
+}
+
+static void
+xdp_pipewire_receiver_get_property (GObject    *object,
+                                    guint       property_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+  XdpPipewireReceiver *receiver = XDP_PIPEWIRE_RECEIVER (object);
+
+  switch (property_id)
+    {
+    case PROP_STREAMING:
+      g_value_set_boolean (value, receiver->streaming);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+xdp_pipewire_receiver_class_init (XdpPipewireReceiverClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = xdp_pipewire_receiver_dispose;
+  object_class->finalize = xdp_pipewire_receiver_finalize;
+  object_class->get_property = xdp_pipewire_receiver_get_property;
+
+  /**
+   * XdpPipewireReceiver:streaming:
+   *
+   * Whether the stream has been negotiated and frames are flowing.
+   */
+  properties[PROP_STREAMING] =
+    g_param_spec_boolean ("streaming", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+
+  /**
+   * XdpPipewireReceiver::frame-ready:
+   * @receiver: the [class@PipewireReceiver]
+   *
+   * Emitted when new frames have been queued. Several frames may have
+   * arrived since the last emission.
+   */
+  signals[FRAME_READY] =
+    g_signal_new ("frame-ready",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 0);
+
+  /**
+   * XdpPipewireReceiver::error:
+   * @receiver: the [class@PipewireReceiver]
+   * @error: the reason for the failure
+   *
+   * Emitted when the connection to PipeWire or the stream failed. No
+   * more frames are received after that.
+   */
+  signals[ERROR] =
+    g_signal_new ("error",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  G_TYPE_ERROR);
+}
+
+static void
+xdp_pipewire_receiver_init (XdpPipewireReceiver *receiver)
+{
+  g_queue_init (&receiver->ring);
+  receiver->frames = g_hash_table_new (NULL, NULL);
+  receiver->state = PW_STREAM_STATE_UNCONNECTED;
+}
+
+static XdpPipewireReceiver *
+receiver_new (int          fd,
+              guint32      node_id,
+              guint        ring_size,
+              const char  *role,
+              GError     **error)
+{
+  g_autoptr(XdpPipewireReceiver) receiver = NULL;
+  PipewireSource *pipewire_source;
+  struct pw_loop *loop;
+  uint8_t params_buffer[1024];
+  struct spa_pod_builder builder = SPA_POD_BUILDER_INIT (params_buffer, sizeof (params_buffer));
+  const struct spa_pod *params[2];
+  int result;
+
+  pw_init (NULL, NULL);
+
+  receiver = g_object_new (XDP_TYPE_PIPEWIRE_RECEIVER, NULL);
+  receiver->node_id = node_id;
+  receiver->ring_size = CLAMP (ring_size, 1, MAX_RING_SIZE);
+
+  loop = pw_loop_new (NULL);
+  if (loop == NULL)
+    {
+      int saved_errno = errno;
+
+      if (fd != -1)
+        close (fd);
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                   "Failed to create PipeWire loop: %s", g_strerror (saved_errno));
+      return NULL;
+    }
+
+  pipewire_source = (PipewireSource *) g_source_new (&pipewire_source_funcs, sizeof (PipewireSource));
+  pipewire_source->loop = loop;
+  receiver->source = (GSource *) pipewire_source;
+  g_source_add_unix_fd (receiver->source, pw_loop_get_fd (loop), G_IO_IN | G_IO_ERR);
+  g_source_set_callback (receiver->source, flush_events, receiver, NULL);
+  pw_loop_enter (loop);
+  g_source_attach (receiver->source, g_main_context_get_thread_default ());
+
+  receiver->context = pw_context_new (loop, NULL, 0);
+  if (receiver->context == NULL)
+    {
+      int saved_errno = errno;
+
+      if (fd != -1)
+        close (fd);
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                   "Failed to create PipeWire context: %s", g_strerror (saved_errno));
+      return NULL;
+    }
+
+  /* The core takes ownership of the file descriptor */
+  if (fd != -1)
+    receiver->core = pw_context_connect_fd (receiver->context, fd, NULL, 0);
+  else
+    receiver->core = pw_context_connect (receiver->context, NULL, 0);
+
+  if (receiver->core == NULL)
+    {
+      int saved_errno = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                   "Failed to connect to PipeWire: %s", g_strerror (saved_errno));
+      return NULL;
+    }
+
+  pw_core_add_listener (receiver->core, &receiver->core_listener, &core_events, receiver);
+
+  receiver->stream = pw_stream_new (receiver->core,
+                                    "libportal",
+                                    pw_properties_new (PW_KEY_MEDIA_TYPE, "Video",
+                                                       PW_KEY_MEDIA_CATEGORY, "Capture",
+                                                       PW_KEY_MEDIA_ROLE, role,
+                                                       NULL));
+  if (receiver->stream == NULL)
+    {
+      int saved_errno = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                   "Failed to create PipeWire stream: %s", g_strerror (saved_errno));
+      return NULL;
+    }
+
+  pw_stream_add_listener (receiver->stream, &receiver->stream_listener, &stream_events, receiver);
+
+  /* DMA-BUF is preferred, shared memory is the fallback */
+  params[0] = build_format_param (&builder, TRUE);
+  params[1] = build_format_param (&builder, FALSE);
+
+  result = pw_stream_connect (receiver->stream,
+                              PW_DIRECTION_INPUT,
+                              node_id,
+                              PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS,
+                              params, G_N_ELEMENTS (params));
+  if (result < 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-result),
+                   "Failed to connect to PipeWire node %u: %s", node_id, spa_strerror (result));
+      return NULL;
+    }
+
+  return g_steal_pointer (&receiver);
+}
+
+/**
+ * xdp_pipewire_receiver_new:
+ * @fd: (transfer full): a file descriptor for a PipeWire remote, or -1
+ *   to connect to the default PipeWire instance
+ * @node_id: the id of the node to receive frames from
+ * @ring_size: the maximum number of frames to queue
+ * @error: return location for an error
+ *
+ * Creates a [class@PipewireReceiver] that receives frames from @node_id.
+ *
+ * The receiver takes ownership of @fd, also on failure. Passing -1 is
+ * mostly useful for testing, e.g. against a node created with
+ * `gst-launch-1.0 videotestsrc ! pipewiresink`.
+ *
+ * Returns: (transfer full): the new [class@PipewireReceiver], or %NULL
+ */
+XdpPipewireReceiver *
+xdp_pipewire_receiver_new (int          fd,
+                           guint32      node_id,
+                           guint        ring_size,
+                           GError     **error)
+{
+  g_return_val_if_fail (ring_size > 0, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return receiver_new (fd, node_id, ring_size, "Screen", error);
+}
+
+/**
+ * xdp_pipewire_receiver_new_for_session:
+ * @session: an active screencast or remote desktop [class@Session]
+ * @stream: the index of the stream in [method@Session.get_streams]
+ * @ring_size: the maximum number of frames to queue
+ * @error: return location for an error
+ *
+ * Creates a [class@PipewireReceiver] for one of the streams of @session.
+ * This opens a new PipeWire remote for the session.
+ *
+ * Returns: (transfer full): the new [class@PipewireReceiver], or %NULL
+ */
+XdpPipewireReceiver *
+xdp_pipewire_receiver_new_for_session (XdpSession  *session,
+                                       guint        stream,
+                                       guint        ring_size,
+                                       GError     **error)
+{
+  GVariant *streams;
+  guint32 node_id;
+  int fd;
+
+  g_return_val_if_fail (XDP_IS_SESSION (session), NULL);
+  g_return_val_if_fail (ring_size > 0, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  streams = xdp_session_get_streams (session);
+  if (streams == NULL || stream >= g_variant_n_children (streams))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                   "Session has no stream %u", stream);
+      return NULL;
+    }
+
+  g_variant_get_child (streams, stream, "(u@a{sv})", &node_id, NULL);
+
+  fd = xdp_session_open_pipewire_remote (session);
+  if (fd == -1)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to open PipeWire remote");
+      return NULL;
+    }
+
+  return receiver_new (fd, node_id, ring_size, "Screen", error);
+}
+
+/**
+ * xdp_pipewire_receiver_new_for_camera:
+ * @portal: a [class@Portal]
+ * @node_id: the id of the camera node, or `PW_ID_ANY` (0xffffffff) to
+ *   let the session manager pick a camera
+ * @ring_size: the maximum number of frames to queue
+ * @error: return location for an error
+ *
+ * Creates a [class@PipewireReceiver] for a camera. Camera access must
+ * have been granted with [method@Portal.access_camera] before.
+ *
+ * Returns: (transfer full): the new [class@PipewireReceiver], or %NULL
+ */
+XdpPipewireReceiver *
+xdp_pipewire_receiver_new_for_camera (XdpPortal  *portal,
+                                      guint32     node_id,
+                                      guint       ring_size,
+                                      GError    **error)
+{
+  int fd;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (ring_size > 0, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  fd = xdp_portal_open_pipewire_remote_for_camera (portal);
+  if (fd == -1)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to open PipeWire remote for the camera");
+      return NULL;
+    }
+
+  return receiver_new (fd, node_id, ring_size, "Camera", error);
+}
+
+/**
+ * xdp_pipewire_receiver_get_node_id:
+ * @receiver: a [class@PipewireReceiver]
+ *
+ * Returns the id of the node that @receiver was connected to.
+ *
+ * Returns: the node id
+ */
+guint32
+xdp_pipewire_receiver_get_node_id (XdpPipewireReceiver *receiver)
+{
+  g_return_val_if_fail (XDP_IS_PIPEWIRE_RECEIVER (receiver), PW_ID_ANY);
+
+  return receiver->node_id;
+}
+
+/**
+ * xdp_pipewire_receiver_is_streaming:
+ * @receiver: a [class@PipewireReceiver]
+ *
+ * Returns the value of [property@PipewireReceiver:streaming].
+ *
+ * Returns: %TRUE if frames are flowing
+ */
+gboolean
+xdp_pipewire_receiver_is_streaming (XdpPipewireReceiver *receiver)
+{
+  g_return_val_if_fail (XDP_IS_PIPEWIRE_RECEIVER (receiver), FALSE);
+
+  return receiver->streaming;
+}
+
+/**
+ * xdp_pipewire_receiver_get_n_queued:
+ * @receiver: a [class@PipewireReceiver]
+ *
+ * Returns the number of frames waiting to be acquired.
+ *
+ * Returns: the number of queued frames
+ */
+guint
+xdp_pipewire_receiver_get_n_queued (XdpPipewireReceiver *receiver)
+{
+  g_return_val_if_fail (XDP_IS_PIPEWIRE_RECEIVER (receiver), 0);
+
+  return g_queue_get_length (&receiver->ring);
+}
+
+/**
+ * xdp_pipewire_receiver_acquire_frame:
+ * @receiver: a [class@PipewireReceiver]
+ *
+ * Takes the oldest frame from the ring. The buffer of the frame is
+ * leased to the caller until the frame is released with
+ * [method@PipewireFrame.unref].
+ *
+ * Returns: (transfer full) (nullable): the frame, or %NULL if no frame
+ *   is queued
+ */
+XdpPipewireFrame *
+xdp_pipewire_receiver_acquire_frame (XdpPipewireReceiver *receiver)
+{
+  g_return_val_if_fail (XDP_IS_PIPEWIRE_RECEIVER (receiver), NULL);
+
+  return g_queue_pop_head (&receiver->ring);
+}
+
+/**
+ * xdp_pipewire_receiver_get_stats:
+ * @receiver: a [class@PipewireReceiver]
+ * @n_received: (out) (optional): return location for the number of
+ *   frames received
+ * @n_dropped: (out) (optional): return location for the number of
+ *   frames dropped because the ring was full
+ * @n_leased: (out) (optional): return location for the number of
+ *   frames currently held by the application
+ * @mean_interval: (out) (optional): return location for the mean time
+ *   between two frames, in microseconds
+ * @max_interval: (out) (optional): return location for the longest
+ *   time between two frames, in microseconds
+ *
+ * Obtains statistics about the frames received by @receiver.
+ */
+void
+xdp_pipewire_receiver_get_stats (XdpPipewireReceiver *receiver,
+                                 guint64             *n_received,
+                                 guint64             *n_dropped,
+                                 guint               *n_leased,
+                                 gint64              *mean_interval,
+                                 gint64              *max_interval)
+{
+  g_return_if_fail (XDP_IS_PIPEWIRE_RECEIVER (receiver));
+
+  if (n_received)
+    *n_received = receiver->n_received;
+  if (n_dropped)
+    *n_dropped = receiver->n_dropped;
+  if (n_leased)
+    *n_leased = g_hash_table_size (receiver->frames) - g_queue_get_length (&receiver->ring);
+  if (mean_interval)
+    *mean_interval = receiver->n_received > 1 ? receiver->total_interval / (gint64) (receiver->n_received - 1) : 0;
+  if (max_interval)
+    *max_interval = receiver->max_interval;
+}
+
+/**
+ * xdp_pipewire_receiver_set_damage_fallback:
+ * @receiver: a [class@PipewireReceiver]
+ * @enabled: whether to compute the damage of frames without damage metadata
+ *
+ * Enables or disables computing the damage on the CPU for frames that
+ * the producer sent without damage metadata.
+ *
+ * The damage is found by comparing each frame with a copy of the
+ * previous one, in tiles of 64×64 pixels. This only works for frames
+ * in shared memory, and costs one frame worth of memory.
+ */
+void
+xdp_pipewire_receiver_set_damage_fallback (XdpPipewireReceiver *receiver,
+                                           gboolean             enabled)
+{
+  g_return_if_fail (XDP_IS_PIPEWIRE_RECEIVER (receiver));
+
+  receiver->damage_fallback = !!enabled;
+
+  if (!receiver->damage_fallback)
+    g_clear_pointer (&receiver->reference, g_free);
+}
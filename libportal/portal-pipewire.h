@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/portal.h>
+
+G_BEGIN_DECLS
+
+/**
+ * XdpPipewireRect:
+ * @x: the X coordinate of the top left corner
+ * @y: the Y coordinate of the top left corner
+ * @width: the width
+ * @height: the height
+ *
+ * A rectangle in the pixel coordinates of a [struct@PipewireFrame].
+ */
+typedef struct {
+  gint32 x;
+  gint32 y;
+  guint32 width;
+  guint32 height;
+} XdpPipewireRect;
+
+#define XDP_TYPE_PIPEWIRE_FRAME (xdp_pipewire_frame_get_type ())
+
+typedef struct _XdpPipewireFrame XdpPipewireFrame;
+
+XDP_PUBLIC
+GType              xdp_pipewire_frame_get_type         (void) G_GNUC_CONST;
+
+XDP_PUBLIC
+XdpPipewireFrame * xdp_pipewire_frame_ref              (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+void               xdp_pipewire_frame_unref            (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+gboolean           xdp_pipewire_frame_is_valid         (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+guint64            xdp_pipewire_frame_get_sequence     (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+gint64             xdp_pipewire_frame_get_pts          (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+gint64             xdp_pipewire_frame_get_arrival_time (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+guint32            xdp_pipewire_frame_get_format       (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+void               xdp_pipewire_frame_get_size         (XdpPipewireFrame *frame,
+                                                        guint            *width,
+                                                        guint            *height);
+
+XDP_PUBLIC
+gboolean           xdp_pipewire_frame_is_dmabuf        (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+guint64            xdp_pipewire_frame_get_modifier     (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+int                xdp_pipewire_frame_get_fd           (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+guint32            xdp_pipewire_frame_get_offset       (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+gint32             xdp_pipewire_frame_get_stride       (XdpPipewireFrame *frame);
+
+XDP_PUBLIC
+const guint8 *     xdp_pipewire_frame_get_data         (XdpPipewireFrame *frame,
+                                                        gsize            *size);
+
+XDP_PUBLIC
+gboolean           xdp_pipewire_frame_get_damage       (XdpPipewireFrame       *frame,
+                                                        const XdpPipewireRect **rects,
+                                                        guint                  *n_rects);
+
+XDP_PUBLIC
+gboolean           xdp_pipewire_frame_get_cursor       (XdpPipewireFrame *frame,
+                                                        XdpPipewireRect  *rect,
+                                                        gint32           *hotspot_x,
+                                                        gint32           *hotspot_y);
+
+XDP_PUBLIC
+GBytes *           xdp_pipewire_frame_get_cursor_bitmap (XdpPipewireFrame *frame,
+                                                         guint            *width,
+                                                         guint            *height,
+                                                         gint32           *stride,
+                                                         guint32          *format);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (XdpPipewireFrame, xdp_pipewire_frame_unref)
+
+#define XDP_TYPE_PIPEWIRE_RECEIVER (xdp_pipewire_receiver_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpPipewireReceiver, xdp_pipewire_receiver, XDP, PIPEWIRE_RECEIVER, GObject)
+
+XDP_PUBLIC
+XdpPipewireReceiver * xdp_pipewire_receiver_new             (int          fd,
+                                                            guint32      node_id,
+                                                            guint        ring_size,
+                                                            GError     **error);
+
+XDP_PUBLIC
+XdpPipewireReceiver * xdp_pipewire_receiver_new_for_session (XdpSession  *session,
+                                                            guint        stream,
+                                                            guint        ring_size,
+                                                            GError     **error);
+
+XDP_PUBLIC
+XdpPipewireReceiver * xdp_pipewire_receiver_new_for_camera  (XdpPortal   *portal,
+                                                            guint32      node_id,
+                                                            guint        ring_size,
+                                                            GError     **error);
+
+XDP_PUBLIC
+guint32               xdp_pipewire_receiver_get_node_id     (XdpPipewireReceiver *receiver);
+
+XDP_PUBLIC
+gboolean              xdp_pipewire_receiver_is_streaming    (XdpPipewireReceiver *receiver);
+
+XDP_PUBLIC
+guint                 xdp_pipewire_receiver_get_n_queued    (XdpPipewireReceiver *receiver);
+
+XDP_PUBLIC
+XdpPipewireFrame *    xdp_pipewire_receiver_acquire_frame   (XdpPipewireReceiver *receiver);
+
+XDP_PUBLIC
+void                  xdp_pipewire_receiver_get_stats       (XdpPipewireReceiver *receiver,
+                                                            guint64             *n_received,
+                                                            guint64             *n_dropped,
+                                                            guint               *n_leased,
+                                                            gint64              *mean_interval,
+                                                            gint64              *max_interval);
+
+XDP_PUBLIC
+void                  xdp_pipewire_receiver_set_damage_fallback (XdpPipewireReceiver *receiver,
+                                                                gboolean             enabled);
+
+G_END_DECLS
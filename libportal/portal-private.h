@@ -19,6 +19,9 @@
 
 #pragma once
 
+#include <libportal/inhibit.h>
+#include <libportal/location.h>
+
 #include "glib-backports.h"
 #include "parent-private.h"
 #include "portal-helpers.h"
@@ -37,9 +40,29 @@ struct _XdpPortal {
   GHashTable *inhibit_handles;
   char *session_monitor_handle;
   guint state_changed_signal;
+  gboolean session_state_known;
+  gboolean screensaver_active;
+  XdpLoginSessionState session_state;
+
+  /* inhibit coalescing */
+  gboolean inhibit_coalescing;
+  GHashTable *inhibit_holders; /* id -> XdpInhibitFlags */
+  guint inhibit_flag_counts[4];
+  char *inhibit_reason;
+  XdpInhibitFlags coalesced_inhibit_flags;
+  char *coalesced_inhibit_handle;
+  XdpInhibitFlags coalesced_inhibit_pending;
+  gboolean coalesced_inhibit_busy;
+  gboolean coalesced_inhibit_dirty;
+  GList *coalesced_inhibit_waiters; /* GTask */
 
   /* spawn */
   guint spawn_exited_signal;
+  GHashTable *spawn_pids; /* pids spawned by us that are still running */
+  GHashTable *spawn_waiters; /* pid -> GPtrArray of SpawnWaiter */
+  GHashTable *spawn_exit_statuses; /* pid -> exit status */
+  GHashTable *spawn_subprocesses; /* pid -> XdpSubprocess */
+  GQueue spawn_exit_order;
 
   /* updates */
   char *update_monitor_handle;
@@ -49,6 +72,18 @@ struct _XdpPortal {
   /* location */
   char *location_monitor_handle;
   guint location_updated_signal;
+  XdpLocationFix *last_location_fix; /* last delivered fix */
+  gint64 last_location_fix_received; /* monotonic time */
+  double location_min_distance;
+  guint location_min_interval;
+  double location_max_accuracy;
+  guint location_batch_interval;
+  GPtrArray *location_batch;
+  guint location_batch_timeout;
+  XdpLocationFix *last_known_location;
+  gboolean last_known_location_loaded;
+  gboolean last_known_location_persisted;
+  guint last_known_location_save_id;
 
   /* notification */
   guint action_invoked_signal;
@@ -58,9 +93,29 @@ struct _XdpPortal {
   /* screencast */
   guint screencast_interface_version;
   guint remote_desktop_interface_version;
+  gboolean restore_token_vault_enabled;
+
+  /* camera */
+  guint camera_properties_changed_signal;
+  gboolean camera_present_known;
+  gboolean camera_present;
+
+  /* email */
+  guint email_interface_version;
 
   /* background */
   guint background_interface_version;
+  guint background_status_interval;
+  gboolean background_status_sent;
+  char *background_status_message; /* last message sent */
+  gpointer background_status_last_call; /* SetStatusCall, while in flight */
+  gboolean background_status_pending;
+  char *background_status_pending_message;
+  GPtrArray *background_status_waiters;
+  gboolean background_status_in_flight;
+  gint64 background_status_sent_time;
+  guint background_status_timeout;
+  guint background_status_suppressed;
 
   /* clipboard */
   guint selection_owner_changed_signal;
@@ -72,6 +127,17 @@ struct _XdpPortal {
 
 const char * portal_get_bus_name (void);
 
+char *       _xdp_get_app_storage_name (void);
+
+void         _xdp_queue_file_write     (const char *path,
+                                        GBytes     *contents);
+
+void         _xdp_wait_file_writes     (void);
+
+void         _xdp_flush_restore_token_vault (void);
+
+void xdp_portal_notify_camera_present (XdpPortal *portal);
+
 void xdp_portal_add_session (XdpPortal  *portal,
                              XdpSession *session);
 
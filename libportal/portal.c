@@ -24,6 +24,7 @@
 
 #include "config.h"
 
+#include "location-private.h"
 #include "portal-helpers.h"
 #include "portal-private.h"
 #include "portal-enums.h"
@@ -39,6 +40,8 @@
 #endif
 #include <stdio.h>
 
+#include <glib/gstdio.h>
+
 const char *
 portal_get_bus_name (void)
 {
@@ -53,6 +56,120 @@ portal_get_bus_name (void)
   return busname;
 }
 
+/* Name under which files of this application are kept in the shared
+ * per-user directories, so that unsandboxed applications don't see
+ * each other's data */
+char *
+_xdp_get_app_storage_name (void)
+{
+  GApplication *application = g_application_get_default ();
+  const char *name = NULL;
+  char *canon;
+
+  if (application)
+    name = g_application_get_application_id (application);
+  if (name == NULL)
+    name = g_get_prgname ();
+  if (name == NULL || *name == '\0')
+    name = "unknown";
+
+  canon = g_strcanon (g_strdup (name),
+                      G_CSET_A_2_Z G_CSET_a_2_z G_CSET_DIGITS "-_.",
+                      '_');
+  if (canon[0] == '.')
+    canon[0] = '_';
+
+  return canon;
+}
+
+typedef struct {
+  char *path;
+  GBytes *contents; /* NULL to remove the file */
+} FileWrite;
+
+static GMutex file_writes_lock;
+static GCond file_writes_cond;
+static guint n_file_writes;
+
+static void
+write_file_in_thread (gpointer data,
+                      gpointer user_data)
+{
+  FileWrite *write = data;
+  g_autofree char *dir = NULL;
+  g_autoptr(GError) error = NULL;
+
+  if (write->contents == NULL)
+    {
+      if (g_unlink (write->path) == -1 && errno != ENOENT)
+        g_debug ("Failed to remove %s: %s", write->path, g_strerror (errno));
+      goto out;
+    }
+
+  dir = g_path_get_dirname (write->path);
+  if (g_mkdir_with_parents (dir, 0700) == -1)
+    {
+      g_debug ("Failed to create %s: %s", dir, g_strerror (errno));
+      goto out;
+    }
+
+  if (!g_file_set_contents_full (write->path,
+                                 g_bytes_get_data (write->contents, NULL),
+                                 g_bytes_get_size (write->contents),
+                                 G_FILE_SET_CONTENTS_CONSISTENT,
+                                 0600,
+                                 &error))
+    g_debug ("Failed to save %s: %s", write->path, error->message);
+
+out:
+  g_free (write->path);
+  g_clear_pointer (&write->contents, g_bytes_unref);
+  g_free (write);
+
+  g_mutex_lock (&file_writes_lock);
+  if (--n_file_writes == 0)
+    g_cond_broadcast (&file_writes_cond);
+  g_mutex_unlock (&file_writes_lock);
+}
+
+/* Replaces the file at @path with @contents, or removes it if @contents
+ * is NULL, without blocking the caller. The writes are done by a single
+ * thread in the order they were queued, so the last one for a file wins. */
+void
+_xdp_queue_file_write (const char *path,
+                       GBytes     *contents)
+{
+  static GThreadPool *writer = NULL;
+  FileWrite *write;
+
+  if (g_once_init_enter_pointer (&writer))
+    g_once_init_leave_pointer (&writer, g_thread_pool_new (write_file_in_thread, NULL,
+                                                           1, FALSE, NULL));
+
+  write = g_new0 (FileWrite, 1);
+  write->path = g_strdup (path);
+  write->contents = contents ? g_bytes_ref (contents) : NULL;
+
+  g_mutex_lock (&file_writes_lock);
+  n_file_writes++;
+  g_mutex_unlock (&file_writes_lock);
+
+  g_thread_pool_push (writer, write, NULL);
+}
+
+/* Blocks until all queued writes have hit the disk. Used on teardown,
+ * since the process may exit right afterwards and the writer thread
+ * would be killed with state that can't be recovered, such as a
+ * single-use restore token. */
+void
+_xdp_wait_file_writes (void)
+{
+  g_mutex_lock (&file_writes_lock);
+  while (n_file_writes > 0)
+    g_cond_wait (&file_writes_cond, &file_writes_lock);
+  g_mutex_unlock (&file_writes_lock);
+}
+
 /**
  * XdpPortal
  *
@@ -71,11 +188,22 @@ enum {
   UPDATE_AVAILABLE,
   UPDATE_PROGRESS,
   LOCATION_UPDATED,
+  LOCATION_FIX,
+  LOCATION_FIXES,
   NOTIFICATION_ACTION_INVOKED,
   LAST_SIGNAL
 };
 
 static guint signals[LAST_SIGNAL];
+
+enum {
+  PROP_0,
+  PROP_CAMERA_PRESENT,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
 static void xdp_portal_initable_iface_init (GInitableIface  *iface);
 
 G_DEFINE_TYPE_WITH_CODE (XdpPortal, xdp_portal, G_TYPE_OBJECT,
@@ -92,6 +220,9 @@ xdp_portal_finalize (GObject *object)
   /* inhibit */
   if (portal->inhibit_handles)
     g_hash_table_unref (portal->inhibit_handles);
+  g_clear_pointer (&portal->inhibit_holders, g_hash_table_unref);
+  g_clear_pointer (&portal->inhibit_reason, g_free);
+  g_clear_pointer (&portal->coalesced_inhibit_handle, g_free);
 
   if (portal->state_changed_signal)
     g_dbus_connection_signal_unsubscribe (portal->bus, portal->state_changed_signal);
@@ -101,6 +232,11 @@ xdp_portal_finalize (GObject *object)
   /* spawn */
   if (portal->spawn_exited_signal)
     g_dbus_connection_signal_unsubscribe (portal->bus, portal->spawn_exited_signal);
+  g_clear_pointer (&portal->spawn_pids, g_hash_table_unref);
+  g_clear_pointer (&portal->spawn_waiters, g_hash_table_unref);
+  g_clear_pointer (&portal->spawn_exit_statuses, g_hash_table_unref);
+  g_clear_pointer (&portal->spawn_subprocesses, g_hash_table_unref);
+  g_queue_clear (&portal->spawn_exit_order);
 
   /* updates */
   if (portal->update_available_signal)
@@ -113,6 +249,26 @@ xdp_portal_finalize (GObject *object)
   if (portal->location_updated_signal)
     g_dbus_connection_signal_unsubscribe (portal->bus, portal->location_updated_signal);
   g_free (portal->location_monitor_handle);
+  g_clear_handle_id (&portal->location_batch_timeout, g_source_remove);
+  g_clear_pointer (&portal->location_batch, g_ptr_array_unref);
+  g_clear_pointer (&portal->last_location_fix, xdp_location_fix_free);
+  _xdp_portal_flush_last_known_location (portal);
+  g_clear_pointer (&portal->last_known_location, xdp_location_fix_free);
+
+  /* screencast */
+  _xdp_flush_restore_token_vault ();
+
+  _xdp_wait_file_writes ();
+
+  /* background */
+  g_clear_handle_id (&portal->background_status_timeout, g_source_remove);
+  g_clear_pointer (&portal->background_status_message, g_free);
+  g_clear_pointer (&portal->background_status_pending_message, g_free);
+  g_clear_pointer (&portal->background_status_waiters, g_ptr_array_unref);
+
+  /* camera */
+  if (portal->camera_properties_changed_signal)
+    g_dbus_connection_signal_unsubscribe (portal->bus, portal->camera_properties_changed_signal);
 
   /* notification */
   if (portal->action_invoked_signal)
@@ -136,12 +292,49 @@ xdp_portal_finalize (GObject *object)
   G_OBJECT_CLASS (xdp_portal_parent_class)->finalize (object);
 }
 
+static void
+xdp_portal_get_property (GObject    *object,
+                         guint       prop_id,
+                         GValue     *value,
+                         GParamSpec *pspec)
+{
+  XdpPortal *portal = XDP_PORTAL (object);
+
+  switch (prop_id)
+    {
+    case PROP_CAMERA_PRESENT:
+      g_value_set_boolean (value, portal->camera_present);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
 static void
 xdp_portal_class_init (XdpPortalClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->finalize = xdp_portal_finalize;
+  object_class->get_property = xdp_portal_get_property;
+
+  /**
+   * XdpPortal:camera-present:
+   *
+   * Whether any camera is present.
+   *
+   * The value is only known once it has been fetched with
+   * [method@Portal.fetch_camera_present] or
+   * [method@Portal.is_camera_present]. From then on, it is kept
+   * current as cameras are plugged in or removed.
+   */
+  properties[PROP_CAMERA_PRESENT] =
+    g_param_spec_boolean ("camera-present", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
 
   /**
    * XdpPortal::spawn-exited:
@@ -272,6 +465,47 @@ xdp_portal_class_init (XdpPortalClass *klass)
                   G_TYPE_INT64,
                   G_TYPE_INT64);
 
+  /**
+   * XdpPortal::location-fix:
+   * @portal: the [class@Portal]
+   * @fix: the new location
+   *
+   * Emitted when location monitoring is enabled and the location changes.
+   *
+   * This carries the same information as [signal@Portal::location-updated],
+   * after the filters set with [method@Portal.location_monitor_set_filter]
+   * have been applied. It is not emitted in batched mode, see
+   * [method@Portal.location_monitor_set_batch_interval].
+   */
+  signals[LOCATION_FIX] =
+    g_signal_new ("location-fix",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  XDP_TYPE_LOCATION_FIX | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * XdpPortal::location-fixes:
+   * @portal: the [class@Portal]
+   * @fixes: (element-type XdpLocationFix): the locations received
+   *   during the last batch interval, oldest first
+   *
+   * Emitted once per batch interval when location monitoring is
+   * enabled in batched mode and the location changed.
+   */
+  signals[LOCATION_FIXES] =
+    g_signal_new ("location-fixes",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  G_TYPE_PTR_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE);
+
   /**
    * XdpPortal::notification-action-invoked:
    * @portal: the [class@Portal]
@@ -323,6 +557,12 @@ xdp_portal_init (XdpPortal *portal)
   int i;
 
   portal->sessions = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+  portal->spawn_pids = g_hash_table_new (NULL, NULL);
+  portal->spawn_waiters = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_ptr_array_unref);
+  portal->spawn_exit_statuses = g_hash_table_new (NULL, NULL);
+  portal->spawn_subprocesses = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  g_queue_init (&portal->spawn_exit_order);
+  portal->last_known_location_persisted = TRUE;
 
   /* g_bus_get_sync() returns a singleton. In the test suite we may restart
    * the session bus, so we have to manually connect to the new bus */
@@ -401,6 +641,12 @@ xdp_portal_new (void)
   return portal;
 }
 
+void
+xdp_portal_notify_camera_present (XdpPortal *portal)
+{
+  g_object_notify_by_pspec (G_OBJECT (portal), properties[PROP_CAMERA_PRESENT]);
+}
+
 void
 xdp_portal_add_session (XdpPortal  *portal,
                         XdpSession *session)
@@ -27,6 +27,8 @@
 #include <libportal/dynamic-launcher.h>
 #include <libportal/email.h>
 #include <libportal/filechooser.h>
+#include <libportal/geofence.h>
+#include <libportal/idle-scheduler.h>
 #include <libportal/inhibit.h>
 #include <libportal/inputcapture.h>
 #include <libportal/location.h>
@@ -36,9 +38,13 @@
 #include <libportal/print.h>
 #include <libportal/remote.h>
 #include <libportal/screenshot.h>
+#include <libportal/screenshot-scheduler.h>
 #include <libportal/session.h>
+#include <libportal/session-pool.h>
 #include <libportal/settings.h>
 #include <libportal/spawn.h>
+#include <libportal/spawn-pool.h>
+#include <libportal/subprocess.h>
 #include <libportal/trash.h>
 #include <libportal/types.h>
 #include <libportal/updates.h>
@@ -20,16 +20,19 @@
 #include "config.h"
 
 #include "print.h"
+#include "memfd-private.h"
 #include "portal-private.h"
 
 #define GNU_SOURCE 1
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <errno.h>
 #include <fcntl.h>
 
 #include <glib/gstdio.h>
 #include <gio/gunixfdlist.h>
+#include <gio/gunixoutputstream.h>
 
 #ifndef O_PATH
 #define O_PATH 0
@@ -45,6 +48,8 @@ typedef struct {
   GVariant *page_setup;
   guint token;
   char *file;
+  GUnixFDList *fd_list;
+  int memfd;
   guint signal_id;
   GTask *task;
   char *request_path;
@@ -77,6 +82,8 @@ print_call_free (PrintCall *call)
   if (call->page_setup)
     g_variant_unref (call->page_setup);
   g_free (call->file);
+  g_clear_object (&call->fd_list);
+  g_clear_fd (&call->memfd, NULL);
 
   g_free (call);
 }
@@ -181,6 +188,27 @@ do_print (PrintCall *call)
       return;
     }
 
+  if (!call->is_prepare && call->fd_list == NULL)
+    {
+      int fd;
+
+      fd = g_open (call->file, O_PATH | O_CLOEXEC);
+      if (fd == -1)
+        {
+          int saved_errno = errno;
+
+          g_task_return_new_error (call->task,
+                                   G_IO_ERROR,
+                                   g_io_error_from_errno (saved_errno),
+                                   "Failed to open '%s': %s",
+                                   call->file, g_strerror (saved_errno));
+          print_call_free (call);
+          return;
+        }
+
+      call->fd_list = g_unix_fd_list_new_from_array (&fd, 1);
+    }
+
   token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
   call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
   call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
@@ -223,19 +251,7 @@ do_print (PrintCall *call)
                             call);
   else
     {
-      g_autoptr(GUnixFDList) fd_list = NULL;
-      int fd, fd_in;
-
-      fd = g_open (call->file, O_PATH | O_CLOEXEC);
-      if (fd == -1)
-        {
-          g_warning ("Failed to open '%s'", call->file);
-          return;
-        }
-
-      fd_list = g_unix_fd_list_new_from_array (&fd, 1);
-      fd = -1;
-      fd_in = 0;
+      int fd_in = 0;
 
       g_dbus_connection_call_with_unix_fd_list (call->portal->bus,
                                                 PORTAL_BUS_NAME,
@@ -250,7 +266,7 @@ do_print (PrintCall *call)
                                                 NULL,
                                                 G_DBUS_CALL_FLAGS_NONE,
                                                 -1,
-                                                fd_list,
+                                                call->fd_list,
                                                 cancellable,
                                                 call_returned,
                                                 call);
@@ -298,6 +314,7 @@ xdp_portal_prepare_print (XdpPortal *portal,
     call->parent_handle = g_strdup ("");
   call->title = g_strdup (title);
   call->is_prepare = TRUE;
+  call->memfd = -1;
   call->settings = settings ? g_variant_ref (settings) : NULL;
   call->page_setup = page_setup ? g_variant_ref (page_setup) : NULL;
   call->task = g_task_new (portal, cancellable, callback, data);
@@ -382,6 +399,7 @@ xdp_portal_print_file (XdpPortal *portal,
   call->is_prepare = FALSE;
   call->token = token;
   call->file = g_strdup (file);
+  call->memfd = -1;
   call->task = g_task_new (portal, cancellable, callback, data);
   g_task_set_source_tag (call->task, xdp_portal_print_file);
 
@@ -409,3 +427,217 @@ xdp_portal_print_file_finish (XdpPortal *portal,
 
   return g_task_propagate_boolean (G_TASK (result), error);
 }
+
+static PrintCall *
+print_call_new (XdpPortal           *portal,
+                XdpParent           *parent,
+                const char          *title,
+                guint                token,
+                GCancellable        *cancellable,
+                GAsyncReadyCallback  callback,
+                gpointer             data)
+{
+  PrintCall *call;
+
+  call = g_new0 (PrintCall, 1);
+  call->portal = g_object_ref (portal);
+  if (parent)
+    call->parent = xdp_parent_copy (parent);
+  else
+    call->parent_handle = g_strdup ("");
+  call->title = g_strdup (title);
+  call->is_prepare = FALSE;
+  call->token = token;
+  call->memfd = -1;
+  call->task = g_task_new (portal, cancellable, callback, data);
+
+  return call;
+}
+
+/**
+ * xdp_portal_print_bytes:
+ * @portal: a [class@Portal]
+ * @parent: (nullable): parent window information
+ * @title: tile for the print dialog
+ * @token: token that was returned by a previous [method@Portal.prepare_print] call, or 0
+ * @document: the contents of the document to print
+ * @flags: options for this call
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Prints a document that is held in memory.
+ *
+ * This works like [method@Portal.print_file], but the document is
+ * handed to the portal in a sealed memory file, so it never has to
+ * be written to disk.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Portal.print_bytes_finish] to get the results.
+ */
+void
+xdp_portal_print_bytes (XdpPortal           *portal,
+                        XdpParent           *parent,
+                        const char          *title,
+                        guint                token,
+                        GBytes              *document,
+                        XdpPrintFlags        flags,
+                        GCancellable        *cancellable,
+                        GAsyncReadyCallback  callback,
+                        gpointer             data)
+{
+  g_autoptr(GError) error = NULL;
+  g_autofd int fd = -1;
+  PrintCall *call;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (document != NULL);
+  g_return_if_fail (flags == XDP_PRINT_FLAG_NONE);
+
+  fd = _xdp_memfd_new_from_bytes ("libportal-print", document, &error);
+  if (fd == -1 || !_xdp_memfd_seal (fd, &error))
+    {
+      g_task_report_error (portal, callback, data, xdp_portal_print_bytes,
+                           g_steal_pointer (&error));
+      return;
+    }
+
+  call = print_call_new (portal, parent, title, token, cancellable, callback, data);
+  call->fd_list = g_unix_fd_list_new_from_array (&fd, 1);
+  fd = -1;
+  g_task_set_source_tag (call->task, xdp_portal_print_bytes);
+
+  do_print (call);
+}
+
+/**
+ * xdp_portal_print_bytes_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes the print request.
+ *
+ * Returns: `TRUE` if the request was successful
+ */
+gboolean
+xdp_portal_print_bytes_finish (XdpPortal     *portal,
+                               GAsyncResult  *result,
+                               GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_print_bytes, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+document_spliced (GObject      *object,
+                  GAsyncResult *result,
+                  gpointer      data)
+{
+  PrintCall *call = data;
+  GError *error = NULL;
+
+  if (g_output_stream_splice_finish (G_OUTPUT_STREAM (object), result, &error) == -1 ||
+      !_xdp_memfd_seal (call->memfd, &error))
+    {
+      /* The parent has not been exported yet */
+      g_clear_pointer (&call->parent, xdp_parent_free);
+
+      g_task_return_error (call->task, error);
+      print_call_free (call);
+      return;
+    }
+
+  call->fd_list = g_unix_fd_list_new_from_array (&call->memfd, 1);
+  call->memfd = -1;
+
+  do_print (call);
+}
+
+/**
+ * xdp_portal_print_stream:
+ * @portal: a [class@Portal]
+ * @parent: (nullable): parent window information
+ * @title: tile for the print dialog
+ * @token: token that was returned by a previous [method@Portal.prepare_print] call, or 0
+ * @document: a stream with the contents of the document to print
+ * @flags: options for this call
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Prints a document that is read from @document.
+ *
+ * The stream is read asynchronously into a sealed memory file, which
+ * is then handed to the portal like in [method@Portal.print_bytes].
+ * @document is not closed.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Portal.print_stream_finish] to get the results.
+ */
+void
+xdp_portal_print_stream (XdpPortal           *portal,
+                         XdpParent           *parent,
+                         const char          *title,
+                         guint                token,
+                         GInputStream        *document,
+                         XdpPrintFlags        flags,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             data)
+{
+  g_autoptr(GOutputStream) memfd_stream = NULL;
+  g_autoptr(GError) error = NULL;
+  PrintCall *call;
+  int fd;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (G_IS_INPUT_STREAM (document));
+  g_return_if_fail (flags == XDP_PRINT_FLAG_NONE);
+
+  fd = _xdp_memfd_new ("libportal-print", &error);
+  if (fd == -1)
+    {
+      g_task_report_error (portal, callback, data, xdp_portal_print_stream,
+                           g_steal_pointer (&error));
+      return;
+    }
+
+  call = print_call_new (portal, parent, title, token, cancellable, callback, data);
+  call->memfd = fd;
+  g_task_set_source_tag (call->task, xdp_portal_print_stream);
+
+  memfd_stream = g_unix_output_stream_new (call->memfd, FALSE);
+  g_output_stream_splice_async (memfd_stream,
+                                document,
+                                G_OUTPUT_STREAM_SPLICE_NONE,
+                                G_PRIORITY_DEFAULT,
+                                cancellable,
+                                document_spliced,
+                                call);
+}
+
+/**
+ * xdp_portal_print_stream_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes the print request.
+ *
+ * Returns: `TRUE` if the request was successful
+ */
+gboolean
+xdp_portal_print_stream_finish (XdpPortal     *portal,
+                                GAsyncResult  *result,
+                                GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_print_stream, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -59,4 +59,36 @@ gboolean xdp_portal_print_file_finish             (XdpPortal            *portal,
                                                    GAsyncResult         *result,
                                                    GError              **error);
 
+XDP_PUBLIC
+void      xdp_portal_print_bytes                  (XdpPortal            *portal,
+                                                   XdpParent            *parent,
+                                                   const char           *title,
+                                                   guint                 token,
+                                                   GBytes               *document,
+                                                   XdpPrintFlags         flags,
+                                                   GCancellable         *cancellable,
+                                                   GAsyncReadyCallback   callback,
+                                                   gpointer              data);
+
+XDP_PUBLIC
+gboolean xdp_portal_print_bytes_finish            (XdpPortal            *portal,
+                                                   GAsyncResult         *result,
+                                                   GError              **error);
+
+XDP_PUBLIC
+void      xdp_portal_print_stream                 (XdpPortal            *portal,
+                                                   XdpParent            *parent,
+                                                   const char           *title,
+                                                   guint                 token,
+                                                   GInputStream         *document,
+                                                   XdpPrintFlags         flags,
+                                                   GCancellable         *cancellable,
+                                                   GAsyncReadyCallback   callback,
+                                                   gpointer              data);
+
+XDP_PUBLIC
+gboolean xdp_portal_print_stream_finish           (XdpPortal            *portal,
+                                                   GAsyncResult         *result,
+                                                   GError              **error);
+
 G_END_DECLS
@@ -23,6 +23,7 @@
 
 #include "remote.h"
 #include "portal-private.h"
+#include "session-pool-private.h"
 #include "session-private.h"
 
 typedef struct {
@@ -34,6 +35,7 @@ typedef struct {
   XdpCursorMode cursor_mode;
   XdpPersistMode persist_mode;
   char *restore_token;
+  char *vault_key;
   gboolean multiple;
   guint signal_id;
   GTask *task;
@@ -41,6 +43,139 @@ typedef struct {
   gulong cancelled_id;
 } CreateCall;
 
+#define RESTORE_TOKEN_KEY "token"
+
+/* The vault belongs to the application, so all portals in the process
+ * share one copy of it. It is read once, and written from a thread
+ * when the main loop is idle. */
+static GKeyFile *restore_token_vault;
+static guint restore_token_vault_save_id;
+
+static char *
+get_restore_token_vault_path (void)
+{
+  g_autofree char *app = _xdp_get_app_storage_name ();
+
+  return g_build_filename (g_get_user_data_dir (), "libportal", app, "restore-tokens", NULL);
+}
+
+static GKeyFile *
+get_restore_token_vault (void)
+{
+  g_autofree char *path = NULL;
+  g_autoptr(GError) error = NULL;
+
+  if (restore_token_vault)
+    return restore_token_vault;
+
+  restore_token_vault = g_key_file_new ();
+
+  path = get_restore_token_vault_path ();
+  if (!g_key_file_load_from_file (restore_token_vault, path, G_KEY_FILE_NONE, &error) &&
+      !g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+    g_debug ("Ignoring unreadable restore token vault %s: %s", path, error->message);
+
+  return restore_token_vault;
+}
+
+static void
+save_restore_token_vault (void)
+{
+  g_autofree char *path = NULL;
+  g_autoptr(GBytes) contents = NULL;
+  char *data;
+  gsize length;
+
+  data = g_key_file_to_data (restore_token_vault, &length, NULL);
+  contents = g_bytes_new_take (data, length);
+
+  path = get_restore_token_vault_path ();
+  _xdp_queue_file_write (path, contents);
+}
+
+static gboolean
+save_restore_token_vault_cb (gpointer data)
+{
+  restore_token_vault_save_id = 0;
+  save_restore_token_vault ();
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+_xdp_flush_restore_token_vault (void)
+{
+  if (restore_token_vault_save_id == 0)
+    return;
+
+  g_clear_handle_id (&restore_token_vault_save_id, g_source_remove);
+  save_restore_token_vault ();
+}
+
+/* Tokens are only valid for the same kind of selection, so they are
+ * stored per session type, source types and device types */
+static char *
+get_restore_token_vault_key (XdpSessionType type,
+                             XdpOutputType  outputs,
+                             XdpDeviceType  devices)
+{
+  return g_strdup_printf ("%s outputs=%u devices=%u",
+                          type == XDP_SESSION_REMOTE_DESKTOP ? "remote-desktop" : "screencast",
+                          outputs, devices);
+}
+
+static char *
+lookup_restore_token (const char *key)
+{
+  return g_key_file_get_string (get_restore_token_vault (), key, RESTORE_TOKEN_KEY, NULL);
+}
+
+/* Restore tokens are single-use; every started session hands out a new
+ * one, which replaces the previous one */
+static void
+rotate_restore_token (const char *key,
+                      const char *token)
+{
+  GKeyFile *vault = get_restore_token_vault ();
+  g_autofree char *old_token = NULL;
+
+  old_token = g_key_file_get_string (vault, key, RESTORE_TOKEN_KEY, NULL);
+  if (g_strcmp0 (old_token, token) == 0)
+    return;
+
+  if (token)
+    g_key_file_set_string (vault, key, RESTORE_TOKEN_KEY, token);
+  else
+    g_key_file_remove_group (vault, key, NULL);
+
+  if (restore_token_vault_save_id == 0)
+    restore_token_vault_save_id = g_idle_add (save_restore_token_vault_cb, NULL);
+}
+
+static void
+create_call_use_vault (CreateCall *call)
+{
+  if (!call->portal->restore_token_vault_enabled ||
+      call->persist_mode == XDP_PERSIST_MODE_NONE)
+    return;
+
+  call->vault_key = get_restore_token_vault_key (call->type, call->outputs, call->devices);
+
+  if (call->restore_token == NULL)
+    call->restore_token = lookup_restore_token (call->vault_key);
+}
+
+static XdpSession *
+create_call_new_session (CreateCall *call)
+{
+  XdpSession *session;
+
+  session = _xdp_session_new (call->portal, call->id, call->type);
+  session->restore_token_vault_key = g_strdup (call->vault_key);
+
+  return session;
+}
+
 static void
 create_call_free (CreateCall *call)
 {
@@ -51,6 +186,7 @@ create_call_free (CreateCall *call)
 
   g_free (call->request_path);
   g_free (call->restore_token);
+  g_free (call->vault_key);
 
   g_object_unref (call->portal);
   g_object_unref (call->task);
@@ -79,10 +215,7 @@ sources_selected (GDBusConnection *bus,
 
   if (response == 0)
     {
-      XdpSession *session;
-
-      session = _xdp_session_new (call->portal, call->id, call->type);
-      g_task_return_pointer (call->task, session, g_object_unref);
+      g_task_return_pointer (call->task, create_call_new_session (call), g_object_unref);
     }
   else if (response == 1)
     g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Screencast SelectSources() canceled");
@@ -183,7 +316,7 @@ devices_selected (GDBusConnection *bus,
       else
         {
           g_clear_signal_handler (&call->cancelled_id, g_task_get_cancellable (call->task));
-          g_task_return_pointer (call->task, _xdp_session_new (call->portal, call->id, call->type), g_object_unref);
+          g_task_return_pointer (call->task, create_call_new_session (call), g_object_unref);
           create_call_free (call);
         }
     }
@@ -440,6 +573,10 @@ get_remote_desktop_interface_version (CreateCall *call)
  *
  * Creates a session for a screencast.
  *
+ * If @restore_token is %NULL and the restore token vault is enabled, a
+ * token from the vault is used; see
+ * [method@Portal.set_restore_token_vault_enabled].
+ *
  * When the request is done, @callback will be called. You can then
  * call [method@Portal.create_screencast_session_finish] to get the results.
  */
@@ -470,6 +607,8 @@ xdp_portal_create_screencast_session (XdpPortal *portal,
   call->multiple = (flags & XDP_SCREENCAST_FLAG_MULTIPLE) != 0;
   call->task = g_task_new (portal, cancellable, callback, data);
 
+  create_call_use_vault (call);
+
   if (portal->screencast_interface_version == 0)
     get_screencast_interface_version (call);
   else
@@ -550,6 +689,10 @@ xdp_portal_create_remote_desktop_session (XdpPortal *portal,
  *
  * Creates a session for remote desktop.
  *
+ * If @restore_token is %NULL and the restore token vault is enabled, a
+ * token from the vault is used; see
+ * [method@Portal.set_restore_token_vault_enabled].
+ *
  * When the request is done, @callback will be called. You can then
  * call [method@Portal.create_remote_desktop_session_finish] to get the results.
  */
@@ -581,6 +724,8 @@ xdp_portal_create_remote_desktop_session_full (XdpPortal *portal,
   call->multiple = (flags & XDP_REMOTE_DESKTOP_FLAG_MULTIPLE) != 0;
   call->task = g_task_new (portal, cancellable, callback, data);
 
+  create_call_use_vault (call);
+
   if (portal->remote_desktop_interface_version == 0)
     get_remote_desktop_interface_version (call);
   else
@@ -608,6 +753,72 @@ xdp_portal_create_remote_desktop_session_finish (XdpPortal *portal,
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+/**
+ * xdp_portal_set_restore_token_vault_enabled:
+ * @portal: a [class@Portal]
+ * @enabled: whether to store restore tokens
+ *
+ * Enables or disables the restore token vault.
+ *
+ * When the vault is enabled, sessions created with a persist mode other
+ * than %XDP_PERSIST_MODE_NONE keep their restore token on disk, and it
+ * is passed on automatically when a session with the same session type,
+ * source types and device types is created later without a restore
+ * token. This lets the user skip the selection dialog when the
+ * application reconnects, also across restarts.
+ *
+ * Each time such a session is started, the token in the vault is
+ * replaced by the new one handed out by the portal. The tokens are
+ * stored in the user data directory, separately for each application
+ * ID, or for the program name if there is no [class@Gio.Application].
+ */
+void
+xdp_portal_set_restore_token_vault_enabled (XdpPortal *portal,
+                                            gboolean   enabled)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+
+  portal->restore_token_vault_enabled = !!enabled;
+}
+
+/**
+ * xdp_portal_get_restore_token_vault_enabled:
+ * @portal: a [class@Portal]
+ *
+ * Returns whether the restore token vault is enabled.
+ *
+ * Returns: %TRUE if restore tokens are stored
+ */
+gboolean
+xdp_portal_get_restore_token_vault_enabled (XdpPortal *portal)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+
+  return portal->restore_token_vault_enabled;
+}
+
+/**
+ * xdp_portal_clear_restore_token_vault:
+ * @portal: a [class@Portal]
+ *
+ * Removes all restore tokens from the vault, so that the next session
+ * of each kind shows the selection dialog again.
+ */
+void
+xdp_portal_clear_restore_token_vault (XdpPortal *portal)
+{
+  g_autofree char *path = NULL;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+
+  g_clear_handle_id (&restore_token_vault_save_id, g_source_remove);
+  g_clear_pointer (&restore_token_vault, g_key_file_unref);
+  restore_token_vault = g_key_file_new ();
+
+  path = get_restore_token_vault_path ();
+  _xdp_queue_file_write (path, NULL);
+}
+
 
 typedef struct {
   XdpPortal *portal;
@@ -644,6 +855,35 @@ start_call_free (StartCall *call)
   g_free (call);
 }
 
+static void
+session_apply_start_results (XdpSession *session,
+                             GVariant   *ret)
+{
+  guint32 devices;
+  GVariant *streams;
+  g_autoptr(XdpSessionPool) pool = NULL;
+
+  if (!g_variant_lookup (ret, "persist_mode", "u", &session->persist_mode))
+    session->persist_mode = XDP_PERSIST_MODE_NONE;
+  if (!g_variant_lookup (ret, "restore_token", "s", &session->restore_token))
+    session->restore_token = NULL;
+  if (g_variant_lookup (ret, "devices", "u", &devices))
+    _xdp_session_set_devices (session, devices);
+  if (g_variant_lookup (ret, "streams", "@a(ua{sv})", &streams))
+    _xdp_session_set_streams (session, streams);
+  g_variant_lookup (ret, "clipboard_enabled", "b",
+                    &session->is_clipboard_enabled);
+
+  if (session->restore_token_vault_key)
+    rotate_restore_token (session->restore_token_vault_key,
+                          session->persist_mode != XDP_PERSIST_MODE_NONE ?
+                          session->restore_token : NULL);
+
+  pool = g_weak_ref_get (&session->restore_token_pool);
+  if (pool)
+    _xdp_session_pool_restore_token_used (pool, session);
+}
+
 static void
 session_started (GDBusConnection *bus,
                  const char *sender_name,
@@ -666,20 +906,7 @@ session_started (GDBusConnection *bus,
 
   if (response == 0)
     {
-      guint32 devices;
-      GVariant *streams;
-
-      if (!g_variant_lookup (ret, "persist_mode", "u", &call->session->persist_mode))
-        call->session->persist_mode = XDP_PERSIST_MODE_NONE;
-      if (!g_variant_lookup (ret, "restore_token", "s", &call->session->restore_token))
-        call->session->restore_token = NULL;
-      if (g_variant_lookup (ret, "devices", "u", &devices))
-        _xdp_session_set_devices (call->session, devices);
-      if (g_variant_lookup (ret, "streams", "@a(ua{sv})", &streams))
-        _xdp_session_set_streams (call->session, streams);
-      g_variant_lookup (ret, "clipboard_enabled", "b",
-                        &call->session->is_clipboard_enabled);
-
+      session_apply_start_results (call->session, ret);
       g_task_return_boolean (call->task, TRUE);
     }
   else if (response == 1)
@@ -832,123 +1059,797 @@ xdp_session_start_finish (XdpSession *session,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
-/**
- * xdp_session_open_pipewire_remote:
- * @session: a [class@Session]
- *
- * Opens a file descriptor to the pipewire remote where the screencast
- * streams are available.
- *
- * The file descriptor should be used to create a pw_remote object, by using
- * pw_remote_connect_fd(). Only the screencast stream nodes will be available
- * from this pipewire node.
- *
- * Returns: the file descriptor
- */
-int
-xdp_session_open_pipewire_remote (XdpSession *session)
+typedef enum {
+  ESTABLISH_CREATE_SESSION,
+  ESTABLISH_SELECT_DEVICES,
+  ESTABLISH_SELECT_SOURCES,
+  ESTABLISH_START,
+  N_ESTABLISH_STEPS
+} EstablishStep;
+
+static const char * const establish_step_names[N_ESTABLISH_STEPS] = {
+  "CreateSession",
+  "SelectDevices",
+  "SelectSources",
+  "Start",
+};
+
+typedef struct {
+  XdpPortal *portal;
+  GTask *task;
+  XdpSession *session;
+  XdpSessionType type;
+  XdpDeviceType devices;
+  XdpOutputType outputs;
+  XdpCursorMode cursor_mode;
+  XdpPersistMode persist_mode;
+  char *restore_token;
+  char *vault_key;
+  gboolean multiple;
+  XdpParent *parent;
+  char *parent_handle;
+  char *session_id;
+  char *session_token;
+
+  gboolean needed[N_ESTABLISH_STEPS];
+  char *tokens[N_ESTABLISH_STEPS];
+  char *request_paths[N_ESTABLISH_STEPS];
+  guint signal_ids[N_ESTABLISH_STEPS];
+
+  EstablishStep next_step;
+  gboolean in_flight;
+  guint n_pending_versions;
+  gboolean finished;
+  gulong cancelled_id;
+
+  gint64 start_time;
+  gint64 step_times[N_ESTABLISH_STEPS];
+  gint64 versions_time;
+  gint64 parent_time;
+} EstablishCall;
+
+static void
+establish_call_free (EstablishCall *call)
 {
-  GVariantBuilder options;
-  g_autoptr(GError) error = NULL;
-  g_autoptr(GVariant) ret = NULL;
-  g_autoptr(GUnixFDList) fd_list = NULL;
-  int fd_out;
+  guint i;
 
-  g_return_val_if_fail (XDP_IS_SESSION (session), -1);
+  for (i = 0; i < N_ESTABLISH_STEPS; i++)
+    {
+      g_free (call->tokens[i]);
+      g_free (call->request_paths[i]);
+    }
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  ret = g_dbus_connection_call_with_unix_fd_list_sync (session->portal->bus,
-                                                       PORTAL_BUS_NAME,
-                                                       PORTAL_OBJECT_PATH,
-                                                       "org.freedesktop.portal.ScreenCast",
-                                                       "OpenPipeWireRemote",
-                                                       g_variant_new ("(oa{sv})", session->id, &options),
-                                                       G_VARIANT_TYPE ("(h)"),
-                                                       G_DBUS_CALL_FLAGS_NONE,
-                                                       -1,
-                                                       NULL,
-                                                       &fd_list,
-                                                       NULL,
-                                                       &error);
-  if (ret == NULL)
+  if (call->parent)
+    xdp_parent_free (call->parent);
+  g_free (call->parent_handle);
+  g_free (call->session_id);
+  g_free (call->session_token);
+  g_free (call->restore_token);
+  g_free (call->vault_key);
+  g_clear_object (&call->session);
+  g_object_unref (call->portal);
+
+  g_free (call);
+}
+
+static void
+establish_cleanup (EstablishCall *call)
+{
+  guint i;
+
+  call->finished = TRUE;
+
+  for (i = 0; i < N_ESTABLISH_STEPS; i++)
     {
-      g_warning ("Failed to get pipewire fd: %s", error->message);
-      return -1;
+      if (call->signal_ids[i])
+        g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_ids[i]);
+      call->signal_ids[i] = 0;
     }
 
-  g_variant_get (ret, "(h)", &fd_out);
+  g_clear_signal_handler (&call->cancelled_id, g_task_get_cancellable (call->task));
 
-  return g_unix_fd_list_get (fd_list, fd_out, NULL);
+  if (call->parent && call->parent_handle)
+    call->parent->parent_unexport (call->parent);
 }
 
-static inline gboolean
-is_active_remote_desktop_session (XdpSession    *session,
-                                  XdpDeviceType  required_device)
+static void
+establish_fail (EstablishCall *call,
+                GError        *error)
 {
-  return XDP_IS_SESSION (session) &&
-         session->type == XDP_SESSION_REMOTE_DESKTOP &&
-         session->state == XDP_SESSION_ACTIVE &&
-         !session->uses_eis &&
-         (session->devices & required_device) != 0;
+  GTask *task = call->task;
+
+  establish_cleanup (call);
+
+  /* The session was never handed out, so nobody else can close it */
+  if (call->session)
+    xdp_session_close (call->session);
+
+  g_task_return_error (task, error);
+  g_object_unref (task);
 }
 
-/**
- * xdp_session_connect_to_eis
- * @session: a [class@Session]
- * @error: return location for a #GError pointer
- *
- * Connect this XdpRemoteDesktopSession to an EIS implementation and return the fd.
- * This fd can be passed into ei_setup_backend_fd(). See the libei
- * documentation for details.
- *
- * This call must be issued before xdp_session_start(). If successful, all input
- * event emulation must be handled via the EIS connection and calls to
- * xdp_session_pointer_motion() etc. are silently ignored.
- *
- * Returns: the file descriptor to the EIS implementation
- */
-int
-xdp_session_connect_to_eis (XdpSession  *session,
-                            GError     **error)
+static GVariant *
+establish_get_timings (EstablishCall *call)
 {
-  XdpPortal *portal = session->portal;
-  GVariantBuilder options;
-  g_autoptr(GVariant) ret = NULL;
-  g_autoptr(GUnixFDList) fd_list = NULL;
-  int fd_out = -1;
+  GVariantBuilder timings;
+  guint i;
 
-  if (portal->remote_desktop_interface_version < 2)
+  g_variant_builder_init (&timings, G_VARIANT_TYPE ("a(sx)"));
+
+  if (call->versions_time)
+    g_variant_builder_add (&timings, "(sx)", "version", call->versions_time);
+  if (call->parent_time)
+    g_variant_builder_add (&timings, "(sx)", "parent", call->parent_time);
+
+  for (i = 0; i < N_ESTABLISH_STEPS; i++)
     {
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Not supported by the portal interface");
-      return -1;
+      if (call->needed[i])
+        g_variant_builder_add (&timings, "(sx)", establish_step_names[i], call->step_times[i]);
     }
-  else if (session->type != XDP_SESSION_REMOTE_DESKTOP)
+
+  g_variant_builder_add (&timings, "(sx)", "total", g_get_monotonic_time () - call->start_time);
+
+  return g_variant_ref_sink (g_variant_builder_end (&timings));
+}
+
+static void
+establish_step_returned (GObject      *object,
+                         GAsyncResult *result,
+                         gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  EstablishCall *call = g_task_get_task_data (task);
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (call->finished)
     {
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is not a Remote Desktop session");
-      return -1;
+      g_clear_error (&error);
+      return;
     }
-  else if (xdp_session_get_session_state (session) != XDP_SESSION_ACTIVE)
+
+  if (error)
+    establish_fail (call, error);
+}
+
+static void
+establish_send_step (EstablishCall *call)
+{
+  EstablishStep step = call->next_step;
+  GVariantBuilder options;
+  const char *interface;
+  const char *method = establish_step_names[step];
+  GVariant *parameters = NULL;
+  gboolean remote_desktop = call->type == XDP_SESSION_REMOTE_DESKTOP;
+  gboolean persist_options = FALSE;
+
+  interface = remote_desktop && step != ESTABLISH_SELECT_SOURCES ?
+              "org.freedesktop.portal.RemoteDesktop" :
+              "org.freedesktop.portal.ScreenCast";
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (call->tokens[step]));
+
+  switch (step)
     {
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session has not been started");
-      return -1;
+    case ESTABLISH_CREATE_SESSION:
+      g_variant_builder_add (&options, "{sv}", "session_handle_token", g_variant_new_string (call->session_token));
+      parameters = g_variant_new ("(a{sv})", &options);
+      break;
+
+    case ESTABLISH_SELECT_DEVICES:
+      g_variant_builder_add (&options, "{sv}", "types", g_variant_new_uint32 (call->devices));
+      persist_options = call->portal->remote_desktop_interface_version >= 2;
+      break;
+
+    case ESTABLISH_SELECT_SOURCES:
+      g_variant_builder_add (&options, "{sv}", "types", g_variant_new_uint32 (call->outputs));
+      g_variant_builder_add (&options, "{sv}", "multiple", g_variant_new_boolean (call->multiple));
+      g_variant_builder_add (&options, "{sv}", "cursor_mode", g_variant_new_uint32 (call->cursor_mode));
+      persist_options = call->portal->screencast_interface_version >= 4;
+      break;
+
+    case ESTABLISH_START:
+      parameters = g_variant_new ("(osa{sv})", call->session_id, call->parent_handle, &options);
+      break;
+
+    default:
+      g_assert_not_reached ();
     }
-  else if (session->uses_eis)
+
+  if (step == ESTABLISH_SELECT_DEVICES || step == ESTABLISH_SELECT_SOURCES)
     {
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is already connected to EIS");
-      return -1;
+      if (persist_options)
+        {
+          g_variant_builder_add (&options, "{sv}", "persist_mode", g_variant_new_uint32 (call->persist_mode));
+          if (call->restore_token)
+            g_variant_builder_add (&options, "{sv}", "restore_token", g_variant_new_string (call->restore_token));
+        }
+      parameters = g_variant_new ("(oa{sv})", call->session_id, &options);
     }
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  call->in_flight = TRUE;
+  call->step_times[step] = g_get_monotonic_time ();
 
-  ret = g_dbus_connection_call_with_unix_fd_list_sync (portal->bus,
-                                                       PORTAL_BUS_NAME,
-                                                       PORTAL_OBJECT_PATH,
-                                                       "org.freedesktop.portal.RemoteDesktop",
-                                                       "ConnectToEIS",
-                                                       g_variant_new ("(oa{sv})",
-                                                                      session->id,
-                                                                      &options),
-                                                       NULL,
+  g_dbus_connection_call (call->portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          interface,
+                          method,
+                          parameters,
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          g_task_get_cancellable (call->task),
+                          establish_step_returned,
+                          g_object_ref (call->task));
+}
+
+/* Sends the next step as soon as everything it depends on is there:
+ * the response of the previous step, the interface versions for the
+ * selection steps and the parent handle for Start */
+static void
+establish_advance (EstablishCall *call)
+{
+  if (call->in_flight || call->finished)
+    return;
+
+  while (call->next_step < N_ESTABLISH_STEPS && !call->needed[call->next_step])
+    call->next_step++;
+
+  if (call->next_step == N_ESTABLISH_STEPS)
+    {
+      GTask *task = call->task;
+
+      call->session->setup_timings = establish_get_timings (call);
+      establish_cleanup (call);
+      g_task_return_pointer (task, g_steal_pointer (&call->session), g_object_unref);
+      g_object_unref (task);
+      return;
+    }
+
+  if (call->next_step != ESTABLISH_CREATE_SESSION && call->n_pending_versions > 0)
+    return;
+
+  if (call->next_step == ESTABLISH_START && call->parent_handle == NULL)
+    return;
+
+  establish_send_step (call);
+}
+
+static void
+establish_response_received (GDBusConnection *bus,
+                             const char      *sender_name,
+                             const char      *object_path,
+                             const char      *interface_name,
+                             const char      *signal_name,
+                             GVariant        *parameters,
+                             gpointer         data)
+{
+  EstablishCall *call = data;
+  EstablishStep step = call->next_step;
+  g_autoptr(GVariant) ret = NULL;
+  guint32 response;
+
+  if (!call->in_flight || g_strcmp0 (object_path, call->request_paths[step]) != 0)
+    return;
+
+  call->in_flight = FALSE;
+  call->step_times[step] = g_get_monotonic_time () - call->step_times[step];
+
+  g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_ids[step]);
+  call->signal_ids[step] = 0;
+
+  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
+  if (response != 0)
+    {
+      establish_fail (call, g_error_new (G_IO_ERROR,
+                                         response == 1 ? G_IO_ERROR_CANCELLED : G_IO_ERROR_FAILED,
+                                         "%s %s",
+                                         establish_step_names[step],
+                                         response == 1 ? "canceled" : "failed"));
+      return;
+    }
+
+  if (step == ESTABLISH_CREATE_SESSION)
+    {
+      call->session = _xdp_session_new (call->portal, call->session_id, call->type);
+      call->session->restore_token_vault_key = g_strdup (call->vault_key);
+    }
+  else if (step == ESTABLISH_START)
+    {
+      _xdp_session_set_session_state (call->session, XDP_SESSION_ACTIVE);
+      session_apply_start_results (call->session, ret);
+    }
+
+  call->next_step++;
+  establish_advance (call);
+}
+
+static gboolean
+establish_version_finish (GObject       *object,
+                          GAsyncResult  *result,
+                          EstablishCall *call,
+                          guint         *version)
+{
+  g_autoptr(GVariant) version_variant = NULL;
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (call->finished)
+    {
+      g_clear_error (&error);
+      return FALSE;
+    }
+
+  if (error)
+    {
+      establish_fail (call, error);
+      return FALSE;
+    }
+
+  g_variant_get_child (ret, 0, "v", &version_variant);
+  *version = g_variant_get_uint32 (version_variant);
+
+  if (--call->n_pending_versions == 0)
+    call->versions_time = g_get_monotonic_time () - call->start_time;
+
+  return TRUE;
+}
+
+static void
+establish_screencast_version_returned (GObject      *object,
+                                       GAsyncResult *result,
+                                       gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  EstablishCall *call = g_task_get_task_data (task);
+
+  if (establish_version_finish (object, result, call, &call->portal->screencast_interface_version))
+    establish_advance (call);
+}
+
+static void
+establish_remote_desktop_version_returned (GObject      *object,
+                                           GAsyncResult *result,
+                                           gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  EstablishCall *call = g_task_get_task_data (task);
+
+  if (establish_version_finish (object, result, call, &call->portal->remote_desktop_interface_version))
+    establish_advance (call);
+}
+
+static void
+establish_get_version (EstablishCall       *call,
+                       const char          *interface,
+                       GAsyncReadyCallback  callback)
+{
+  call->n_pending_versions++;
+
+  g_dbus_connection_call (call->portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.DBus.Properties",
+                          "Get",
+                          g_variant_new ("(ss)", interface, "version"),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          g_task_get_cancellable (call->task),
+                          callback,
+                          g_object_ref (call->task));
+}
+
+static void
+establish_parent_exported (XdpParent  *parent,
+                           const char *handle,
+                           gpointer    data)
+{
+  g_autoptr(GTask) task = data;
+  EstablishCall *call = g_task_get_task_data (task);
+
+  if (call->finished)
+    {
+      parent->parent_unexport (parent);
+      return;
+    }
+
+  call->parent_handle = g_strdup (handle);
+  call->parent_time = g_get_monotonic_time () - call->start_time;
+
+  establish_advance (call);
+}
+
+static void
+establish_cancelled_cb (GCancellable *cancellable,
+                        gpointer      data)
+{
+  EstablishCall *call = data;
+
+  if (call->in_flight)
+    g_dbus_connection_call (call->portal->bus,
+                            PORTAL_BUS_NAME,
+                            call->request_paths[call->next_step],
+                            REQUEST_INTERFACE,
+                            "Close",
+                            NULL,
+                            NULL,
+                            G_DBUS_CALL_FLAGS_NONE,
+                            -1,
+                            NULL, NULL, NULL);
+
+  establish_fail (call, g_error_new (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                     "Session setup canceled"));
+}
+
+static void
+establish_session (XdpPortal           *portal,
+                   XdpSessionType       type,
+                   XdpParent           *parent,
+                   XdpDeviceType        devices,
+                   XdpOutputType        outputs,
+                   gboolean             multiple,
+                   XdpCursorMode        cursor_mode,
+                   XdpPersistMode       persist_mode,
+                   const char          *restore_token,
+                   GCancellable        *cancellable,
+                   GAsyncReadyCallback  callback,
+                   gpointer             data,
+                   gpointer             source_tag)
+{
+  EstablishCall *call;
+  guint i;
+
+  call = g_new0 (EstablishCall, 1);
+  call->portal = g_object_ref (portal);
+  call->type = type;
+  call->devices = devices;
+  call->outputs = outputs;
+  call->multiple = multiple;
+  call->cursor_mode = cursor_mode;
+  call->persist_mode = persist_mode;
+  call->restore_token = g_strdup (restore_token);
+  call->start_time = g_get_monotonic_time ();
+  call->task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (call->task, source_tag);
+  g_task_set_task_data (call->task, call, (GDestroyNotify) establish_call_free);
+
+  if (g_task_return_error_if_cancelled (call->task))
+    {
+      g_object_unref (call->task);
+      return;
+    }
+
+  if (portal->restore_token_vault_enabled && persist_mode != XDP_PERSIST_MODE_NONE)
+    {
+      call->vault_key = get_restore_token_vault_key (type, outputs, devices);
+      if (call->restore_token == NULL)
+        call->restore_token = lookup_restore_token (call->vault_key);
+    }
+
+  call->needed[ESTABLISH_CREATE_SESSION] = TRUE;
+  call->needed[ESTABLISH_SELECT_DEVICES] = type == XDP_SESSION_REMOTE_DESKTOP;
+  call->needed[ESTABLISH_SELECT_SOURCES] = type == XDP_SESSION_SCREENCAST || outputs != XDP_OUTPUT_NONE;
+  call->needed[ESTABLISH_START] = TRUE;
+
+  /* All request paths are known up front, so every response is already
+   * being listened for by the time its request is sent */
+  for (i = 0; i < N_ESTABLISH_STEPS; i++)
+    {
+      if (!call->needed[i])
+        continue;
+
+      call->tokens[i] = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
+      call->request_paths[i] = g_strconcat (REQUEST_PATH_PREFIX, portal->sender, "/", call->tokens[i], NULL);
+      call->signal_ids[i] = g_dbus_connection_signal_subscribe (portal->bus,
+                                                                PORTAL_BUS_NAME,
+                                                                REQUEST_INTERFACE,
+                                                                "Response",
+                                                                call->request_paths[i],
+                                                                NULL,
+                                                                G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+                                                                establish_response_received,
+                                                                call,
+                                                                NULL);
+    }
+
+  call->session_token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
+  call->session_id = g_strconcat (SESSION_PATH_PREFIX, portal->sender, "/", call->session_token, NULL);
+
+  if (cancellable)
+    call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (establish_cancelled_cb), call);
+
+  /* The interface versions and the parent handle are only needed by
+   * later steps, so they are fetched while the session is created */
+  if (type == XDP_SESSION_REMOTE_DESKTOP && portal->remote_desktop_interface_version == 0)
+    establish_get_version (call, "org.freedesktop.portal.RemoteDesktop",
+                           establish_remote_desktop_version_returned);
+  if (call->needed[ESTABLISH_SELECT_SOURCES] && portal->screencast_interface_version == 0)
+    establish_get_version (call, "org.freedesktop.portal.ScreenCast",
+                           establish_screencast_version_returned);
+
+  if (parent)
+    {
+      call->parent = xdp_parent_copy (parent);
+      call->parent->parent_export (call->parent, establish_parent_exported, g_object_ref (call->task));
+    }
+  else
+    {
+      call->parent_handle = g_strdup ("");
+    }
+
+  establish_advance (call);
+}
+
+/**
+ * xdp_portal_establish_screencast_session: (finish-func xdp_portal_establish_session_finish)
+ * @portal: a [class@Portal]
+ * @parent: (nullable): parent window information
+ * @outputs: which kinds of source to offer in the dialog
+ * @flags: options for this call
+ * @cursor_mode: the cursor mode of the session
+ * @persist_mode: the persist mode of the session
+ * @restore_token: (nullable): the token of a previous screencast session to restore
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Creates and starts a screencast session in one go.
+ *
+ * This is equivalent to [method@Portal.create_screencast_session]
+ * followed by [method@Session.start], but all the portal responses are
+ * subscribed to up front, and the interface version and the parent
+ * window are resolved while the session is being created. Each request
+ * is sent as soon as the response to the previous one arrives.
+ *
+ * The time taken by each step is available from
+ * [method@Session.get_setup_timings].
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Portal.establish_session_finish] to get the results.
+ */
+void
+xdp_portal_establish_screencast_session (XdpPortal           *portal,
+                                         XdpParent           *parent,
+                                         XdpOutputType        outputs,
+                                         XdpScreencastFlags   flags,
+                                         XdpCursorMode        cursor_mode,
+                                         XdpPersistMode       persist_mode,
+                                         const char          *restore_token,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             data)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail ((flags & ~(XDP_SCREENCAST_FLAG_MULTIPLE)) == 0);
+
+  establish_session (portal, XDP_SESSION_SCREENCAST, parent,
+                     XDP_DEVICE_NONE, outputs,
+                     (flags & XDP_SCREENCAST_FLAG_MULTIPLE) != 0,
+                     cursor_mode, persist_mode, restore_token,
+                     cancellable, callback, data,
+                     xdp_portal_establish_screencast_session);
+}
+
+/**
+ * xdp_portal_establish_remote_desktop_session: (finish-func xdp_portal_establish_session_finish)
+ * @portal: a [class@Portal]
+ * @parent: (nullable): parent window information
+ * @devices: which kinds of input devices to offer in the dialog
+ * @outputs: which kinds of source to offer in the dialog
+ * @flags: options for this call
+ * @cursor_mode: the cursor mode of the session
+ * @persist_mode: the persist mode of the session
+ * @restore_token: (nullable): the token of a previous remote desktop session to restore
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Creates and starts a remote desktop session in one go.
+ *
+ * See [method@Portal.establish_screencast_session] for details.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Portal.establish_session_finish] to get the results.
+ */
+void
+xdp_portal_establish_remote_desktop_session (XdpPortal             *portal,
+                                             XdpParent             *parent,
+                                             XdpDeviceType          devices,
+                                             XdpOutputType          outputs,
+                                             XdpRemoteDesktopFlags  flags,
+                                             XdpCursorMode          cursor_mode,
+                                             XdpPersistMode         persist_mode,
+                                             const char            *restore_token,
+                                             GCancellable          *cancellable,
+                                             GAsyncReadyCallback    callback,
+                                             gpointer               data)
+{
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail ((flags & ~(XDP_REMOTE_DESKTOP_FLAG_MULTIPLE)) == 0);
+
+  establish_session (portal, XDP_SESSION_REMOTE_DESKTOP, parent,
+                     devices, outputs,
+                     (flags & XDP_REMOTE_DESKTOP_FLAG_MULTIPLE) != 0,
+                     cursor_mode, persist_mode, restore_token,
+                     cancellable, callback, data,
+                     xdp_portal_establish_remote_desktop_session);
+}
+
+/**
+ * xdp_portal_establish_session_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes a session setup started with
+ * [method@Portal.establish_screencast_session] or
+ * [method@Portal.establish_remote_desktop_session].
+ *
+ * Returns: (transfer full): an active [class@Session]
+ */
+XdpSession *
+xdp_portal_establish_session_finish (XdpPortal     *portal,
+                                     GAsyncResult  *result,
+                                     GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_establish_screencast_session ||
+                        g_task_get_source_tag (G_TASK (result)) == xdp_portal_establish_remote_desktop_session, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * xdp_session_get_setup_timings:
+ * @session: a [class@Session]
+ *
+ * Obtains how long each step of the setup of @session took, for
+ * sessions created with [method@Portal.establish_screencast_session]
+ * or [method@Portal.establish_remote_desktop_session].
+ *
+ * The information in the returned [struct@GLib.Variant] has the format
+ * `a(sx)`: the name of each step, in the order they were taken, and its
+ * duration in microseconds. The steps are the portal methods, e.g.
+ * `CreateSession` or `Start`, measured from sending the request to
+ * receiving its response. They are followed by `total`, the time for
+ * the whole setup. If the interface versions had to be looked up, or a
+ * parent window had to be exported, the time until that was done is
+ * given first as `version` and `parent`; these overlap with the other
+ * steps.
+ *
+ * Returns: (transfer none) (nullable): the step durations, or %NULL
+ */
+GVariant *
+xdp_session_get_setup_timings (XdpSession *session)
+{
+  g_return_val_if_fail (XDP_IS_SESSION (session), NULL);
+
+  return session->setup_timings;
+}
+
+/**
+ * xdp_session_open_pipewire_remote:
+ * @session: a [class@Session]
+ *
+ * Opens a file descriptor to the pipewire remote where the screencast
+ * streams are available.
+ *
+ * The file descriptor should be used to create a pw_remote object, by using
+ * pw_remote_connect_fd(). Only the screencast stream nodes will be available
+ * from this pipewire node.
+ *
+ * Returns: the file descriptor
+ */
+int
+xdp_session_open_pipewire_remote (XdpSession *session)
+{
+  GVariantBuilder options;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  int fd_out;
+
+  g_return_val_if_fail (XDP_IS_SESSION (session), -1);
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  ret = g_dbus_connection_call_with_unix_fd_list_sync (session->portal->bus,
+                                                       PORTAL_BUS_NAME,
+                                                       PORTAL_OBJECT_PATH,
+                                                       "org.freedesktop.portal.ScreenCast",
+                                                       "OpenPipeWireRemote",
+                                                       g_variant_new ("(oa{sv})", session->id, &options),
+                                                       G_VARIANT_TYPE ("(h)"),
+                                                       G_DBUS_CALL_FLAGS_NONE,
+                                                       -1,
+                                                       NULL,
+                                                       &fd_list,
+                                                       NULL,
+                                                       &error);
+  if (ret == NULL)
+    {
+      g_warning ("Failed to get pipewire fd: %s", error->message);
+      return -1;
+    }
+
+  g_variant_get (ret, "(h)", &fd_out);
+
+  return g_unix_fd_list_get (fd_list, fd_out, NULL);
+}
+
+static inline gboolean
+is_active_remote_desktop_session (XdpSession    *session,
+                                  XdpDeviceType  required_device)
+{
+  return XDP_IS_SESSION (session) &&
+         session->type == XDP_SESSION_REMOTE_DESKTOP &&
+         session->state == XDP_SESSION_ACTIVE &&
+         !session->uses_eis &&
+         (session->devices & required_device) != 0;
+}
+
+/**
+ * xdp_session_connect_to_eis
+ * @session: a [class@Session]
+ * @error: return location for a #GError pointer
+ *
+ * Connect this XdpRemoteDesktopSession to an EIS implementation and return the fd.
+ * This fd can be passed into ei_setup_backend_fd(). See the libei
+ * documentation for details.
+ *
+ * This call must be issued before xdp_session_start(). If successful, all input
+ * event emulation must be handled via the EIS connection and calls to
+ * xdp_session_pointer_motion() etc. are silently ignored.
+ *
+ * Returns: the file descriptor to the EIS implementation
+ */
+int
+xdp_session_connect_to_eis (XdpSession  *session,
+                            GError     **error)
+{
+  XdpPortal *portal = session->portal;
+  GVariantBuilder options;
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  int fd_out = -1;
+
+  if (portal->remote_desktop_interface_version < 2)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Not supported by the portal interface");
+      return -1;
+    }
+  else if (session->type != XDP_SESSION_REMOTE_DESKTOP)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is not a Remote Desktop session");
+      return -1;
+    }
+  else if (xdp_session_get_session_state (session) != XDP_SESSION_ACTIVE)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session has not been started");
+      return -1;
+    }
+  else if (session->uses_eis)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is already connected to EIS");
+      return -1;
+    }
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+
+  ret = g_dbus_connection_call_with_unix_fd_list_sync (portal->bus,
+                                                       PORTAL_BUS_NAME,
+                                                       PORTAL_OBJECT_PATH,
+                                                       "org.freedesktop.portal.RemoteDesktop",
+                                                       "ConnectToEIS",
+                                                       g_variant_new ("(oa{sv})",
+                                                                      session->id,
+                                                                      &options),
+                                                       NULL,
                                                        G_DBUS_CALL_FLAGS_NONE,
                                                        -1,
                                                        NULL,
@@ -1155,6 +2056,266 @@ xdp_session_keyboard_key (XdpSession *session,
                           NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
 }
 
+#define KEYSYM_TAB     0xff09
+#define KEYSYM_RETURN  0xff0d
+#define KEYSYM_SHIFT_L 0xffe1
+
+typedef struct {
+  guint32 keysym;
+  XdpKeyState state;
+  gboolean end_of_key;
+} TypeTextEvent;
+
+typedef struct {
+  GArray *events; /* TypeTextEvent */
+  guint next;
+  guint delay;
+  gboolean shift_pressed;
+} TypeTextCall;
+
+static void
+type_text_call_free (TypeTextCall *call)
+{
+  g_array_unref (call->events);
+  g_free (call);
+}
+
+static void
+type_text_add_event (GArray      *events,
+                     guint32      keysym,
+                     XdpKeyState  state,
+                     gboolean     end_of_key)
+{
+  TypeTextEvent event = { keysym, state, end_of_key };
+
+  g_array_append_val (events, event);
+}
+
+/* Keysyms of Latin-1 characters are their code points; everything else
+ * uses the Unicode keysym range. */
+static gboolean
+type_text_get_keysym (gunichar  c,
+                      guint32  *keysym)
+{
+  if (c == '\n' || c == '\r')
+    *keysym = KEYSYM_RETURN;
+  else if (c == '\t')
+    *keysym = KEYSYM_TAB;
+  else if ((c >= 0x20 && c < 0x7f) || (c >= 0xa0 && c <= 0xff))
+    *keysym = c;
+  else if (c > 0xff && g_unichar_isdefined (c) && !g_unichar_iscntrl (c))
+    *keysym = 0x01000000 | c;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+type_text_send_key (XdpSession          *session,
+                    const TypeTextEvent *event,
+                    GAsyncReadyCallback  callback,
+                    gpointer             data)
+{
+  GVariantBuilder options;
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  g_dbus_connection_call (session->portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.portal.RemoteDesktop",
+                          "NotifyKeyboardKeysym",
+                          g_variant_new ("(oa{sv}iu)", session->id, &options, event->keysym, event->state),
+                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, callback, data);
+}
+
+static void
+type_text_done (GObject      *object,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+
+  /* Calls on the portal are processed in order, so the reply to the
+   * last one means that all keys have been handled */
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (ret == NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+static gboolean
+type_text_send_next (gpointer data)
+{
+  GTask *task = data;
+  XdpSession *session = g_task_get_source_object (task);
+  TypeTextCall *call = g_task_get_task_data (task);
+
+  if (session->state != XDP_SESSION_ACTIVE)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CLOSED,
+                               "Session was closed while typing");
+      return G_SOURCE_REMOVE;
+    }
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      /* Don't leave a modifier stuck */
+      if (call->shift_pressed)
+        {
+          TypeTextEvent event = { KEYSYM_SHIFT_L, XDP_KEY_RELEASED, FALSE };
+
+          type_text_send_key (session, &event, NULL, NULL);
+        }
+      return G_SOURCE_REMOVE;
+    }
+
+  while (call->next < call->events->len)
+    {
+      const TypeTextEvent *event = &g_array_index (call->events, TypeTextEvent, call->next++);
+
+      if (event->keysym == KEYSYM_SHIFT_L)
+        call->shift_pressed = event->state == XDP_KEY_PRESSED;
+
+      if (call->next == call->events->len)
+        {
+          type_text_send_key (session, event, type_text_done, g_object_ref (task));
+          break;
+        }
+
+      type_text_send_key (session, event, NULL, NULL);
+
+      if (event->end_of_key && call->delay > 0)
+        {
+          g_autoptr(GSource) source = g_timeout_source_new (call->delay);
+
+          g_task_attach_source (task, source, type_text_send_next);
+          break;
+        }
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * xdp_session_type_text:
+ * @session: a remote desktop [class@Session]
+ * @text: the UTF-8 text to type
+ * @delay: the delay between two keys, in milliseconds
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Types @text by pressing and releasing the keysym of each character.
+ *
+ * Latin-1 characters, newlines and tabs map to their usual keysyms, and
+ * other characters to Unicode keysyms. Shift is held down around
+ * upper case letters; any other modifiers needed to produce a keysym
+ * are up to the compositor. Control characters other than newlines
+ * and tabs cannot be typed.
+ *
+ * The keys are sent without waiting for each other. If @delay is not
+ * zero, each key is sent @delay milliseconds after the previous one.
+ * When @cancellable is cancelled, typing stops after the current key.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Session.type_text_finish] to get the results.
+ *
+ * May only be called on a remote desktop session
+ * with `XDP_DEVICE_KEYBOARD` access.
+ */
+void
+xdp_session_type_text (XdpSession          *session,
+                       const char          *text,
+                       guint                delay,
+                       GCancellable        *cancellable,
+                       GAsyncReadyCallback  callback,
+                       gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+  TypeTextCall *call;
+  gboolean shift = FALSE;
+  const char *p;
+
+  g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_KEYBOARD));
+  g_return_if_fail (text != NULL);
+  g_return_if_fail (g_utf8_validate (text, -1, NULL));
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_session_type_text);
+
+  call = g_new0 (TypeTextCall, 1);
+  call->events = g_array_new (FALSE, FALSE, sizeof (TypeTextEvent));
+  call->delay = delay;
+  g_task_set_task_data (task, call, (GDestroyNotify) type_text_call_free);
+
+  for (p = text; *p; p = g_utf8_next_char (p))
+    {
+      gunichar c = g_utf8_get_char (p);
+      gboolean upper;
+      guint32 keysym;
+
+      /* CRLF is a single line break */
+      if (c == '\r' && p[1] == '\n')
+        continue;
+
+      if (!type_text_get_keysym (c, &keysym))
+        {
+          g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                   "Cannot type character U+%04X", c);
+          return;
+        }
+
+      /* Consecutive upper case letters share a single Shift press */
+      upper = g_unichar_isupper (c) && g_unichar_tolower (c) != c;
+      if (upper != shift)
+        {
+          type_text_add_event (call->events, KEYSYM_SHIFT_L,
+                               upper ? XDP_KEY_PRESSED : XDP_KEY_RELEASED, FALSE);
+          shift = upper;
+        }
+
+      type_text_add_event (call->events, keysym, XDP_KEY_PRESSED, FALSE);
+      type_text_add_event (call->events, keysym, XDP_KEY_RELEASED, TRUE);
+    }
+
+  if (shift)
+    type_text_add_event (call->events, KEYSYM_SHIFT_L, XDP_KEY_RELEASED, FALSE);
+
+  if (call->events->len == 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  type_text_send_next (task);
+}
+
+/**
+ * xdp_session_type_text_finish:
+ * @session: a [class@Session]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes the type-text request.
+ *
+ * Returns: `TRUE` if all of the text was typed
+ */
+gboolean
+xdp_session_type_text_finish (XdpSession    *session,
+                              GAsyncResult  *result,
+                              GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_SESSION (session), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, session), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_session_type_text, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * xdp_session_touch_down:
  * @session: a [class@Session]
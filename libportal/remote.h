@@ -166,6 +166,46 @@ XdpSession *xdp_portal_create_remote_desktop_session_finish (XdpPortal
                                                              GAsyncResult           *result,
                                                              GError                **error);
 
+XDP_PUBLIC
+void        xdp_portal_establish_screencast_session         (XdpPortal              *portal,
+                                                             XdpParent              *parent,
+                                                             XdpOutputType           outputs,
+                                                             XdpScreencastFlags      flags,
+                                                             XdpCursorMode           cursor_mode,
+                                                             XdpPersistMode          persist_mode,
+                                                             const char             *restore_token,
+                                                             GCancellable           *cancellable,
+                                                             GAsyncReadyCallback     callback,
+                                                             gpointer                data);
+
+XDP_PUBLIC
+void        xdp_portal_establish_remote_desktop_session     (XdpPortal              *portal,
+                                                             XdpParent              *parent,
+                                                             XdpDeviceType           devices,
+                                                             XdpOutputType           outputs,
+                                                             XdpRemoteDesktopFlags   flags,
+                                                             XdpCursorMode           cursor_mode,
+                                                             XdpPersistMode          persist_mode,
+                                                             const char             *restore_token,
+                                                             GCancellable           *cancellable,
+                                                             GAsyncReadyCallback     callback,
+                                                             gpointer                data);
+
+XDP_PUBLIC
+XdpSession *xdp_portal_establish_session_finish             (XdpPortal              *portal,
+                                                             GAsyncResult           *result,
+                                                             GError                **error);
+
+XDP_PUBLIC
+void        xdp_portal_set_restore_token_vault_enabled      (XdpPortal              *portal,
+                                                             gboolean                enabled);
+
+XDP_PUBLIC
+gboolean    xdp_portal_get_restore_token_vault_enabled      (XdpPortal              *portal);
+
+XDP_PUBLIC
+void        xdp_portal_clear_restore_token_vault            (XdpPortal              *portal);
+
 XDP_PUBLIC
 XdpSessionState xdp_session_get_session_state (XdpSession *session);
 
@@ -190,6 +230,9 @@ XdpDeviceType   xdp_session_get_devices       (XdpSession *session);
 XDP_PUBLIC
 GVariant *      xdp_session_get_streams       (XdpSession *session);
 
+XDP_PUBLIC
+GVariant *      xdp_session_get_setup_timings (XdpSession *session);
+
 XDP_PUBLIC
 int       xdp_session_connect_to_eis    (XdpSession  *session,
                                          GError     **error);
@@ -265,6 +308,19 @@ void      xdp_session_keyboard_key   (XdpSession *session,
                                       int         key,
                                       XdpKeyState state);
 
+XDP_PUBLIC
+void      xdp_session_type_text      (XdpSession          *session,
+                                      const char          *text,
+                                      guint                delay,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_session_type_text_finish (XdpSession    *session,
+                                        GAsyncResult  *result,
+                                        GError       **error);
+
 XDP_PUBLIC
 void      xdp_session_touch_down     (XdpSession *session,
                                       guint       stream,
@@ -0,0 +1,531 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+
+#include <glib/gstdio.h>
+
+#include "screenshot-scheduler.h"
+#include "portal-private.h"
+
+/**
+ * XdpScreenshotScheduler
+ *
+ * Takes non-interactive screenshots at a fixed interval.
+ *
+ * A [class@ScreenshotScheduler] is meant for periodic captures, such
+ * as monitoring a kiosk. Captures are scheduled against the time the
+ * scheduler was started, so the interval does not drift with the time
+ * each capture takes.
+ *
+ * At most one screenshot request is pending at a time. If the portal
+ * has not answered the previous request when the next capture is due,
+ * that capture is skipped rather than queued.
+ *
+ * All requests share a single subscription to the portal responses,
+ * and no parent window is used.
+ *
+ * The portal saves each screenshot to a file. To avoid accumulating
+ * them, use [method@ScreenshotScheduler.set_remove_files] to have the
+ * files removed once they have been opened.
+ */
+
+struct _XdpScreenshotScheduler {
+  GObject parent_instance;
+
+  XdpPortal *portal;
+  gint64 interval; /* microseconds */
+
+  GSource *timer;
+  gint64 next_capture;
+
+  guint response_signal;
+  char *request_path;
+  gint64 request_time;
+  guint generation;
+
+  gboolean remove_files;
+
+  guint n_captured;
+  guint n_skipped;
+  guint n_failed;
+  gint64 last_latency;
+  gint64 total_latency;
+  gint64 max_latency;
+};
+
+enum {
+  CAPTURED,
+  FAILED,
+  LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL];
+
+G_DEFINE_TYPE (XdpScreenshotScheduler, xdp_screenshot_scheduler, G_TYPE_OBJECT)
+
+static void
+capture_failed (XdpScreenshotScheduler *scheduler,
+                GError                 *error)
+{
+  scheduler->n_failed++;
+  g_signal_emit (scheduler, signals[FAILED], 0, error);
+}
+
+static void
+response_received (GDBusConnection *bus,
+                   const char      *sender_name,
+                   const char      *object_path,
+                   const char      *interface_name,
+                   const char      *signal_name,
+                   GVariant        *parameters,
+                   gpointer         data)
+{
+  XdpScreenshotScheduler *scheduler = data;
+  g_autoptr(XdpScreenshotScheduler) ref = NULL;
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GFile) file = NULL;
+  g_autofree char *path = NULL;
+  const char *uri = NULL;
+  guint32 response;
+  gint64 latency;
+  int fd;
+
+  if (g_strcmp0 (object_path, scheduler->request_path) != 0)
+    return;
+
+  ref = g_object_ref (scheduler);
+  g_clear_pointer (&scheduler->request_path, g_free);
+
+  latency = g_get_monotonic_time () - scheduler->request_time;
+
+  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
+  if (response != 0)
+    {
+      error = g_error_new (G_IO_ERROR,
+                           response == 1 ? G_IO_ERROR_CANCELLED : G_IO_ERROR_FAILED,
+                           "Screenshot failed");
+      capture_failed (scheduler, error);
+      return;
+    }
+
+  g_variant_lookup (ret, "uri", "&s", &uri);
+  if (uri)
+    {
+      file = g_file_new_for_uri (uri);
+      path = g_file_get_path (file);
+    }
+
+  if (!path)
+    {
+      error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED, "Screenshot not received");
+      capture_failed (scheduler, error);
+      return;
+    }
+
+  fd = g_open (path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    {
+      int saved_errno = errno;
+
+      error = g_error_new (G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                           "Failed to open '%s': %s", path, g_strerror (saved_errno));
+      capture_failed (scheduler, error);
+      return;
+    }
+
+  /* The image stays readable through @fd */
+  if (scheduler->remove_files && g_unlink (path) == -1)
+    {
+      int saved_errno = errno;
+
+      g_warning ("Failed to remove '%s': %s", path, g_strerror (saved_errno));
+    }
+
+  scheduler->n_captured++;
+  scheduler->last_latency = latency;
+  scheduler->total_latency += latency;
+  scheduler->max_latency = MAX (scheduler->max_latency, latency);
+
+  g_signal_emit (scheduler, signals[CAPTURED], 0, fd, uri, latency);
+
+  g_close (fd, NULL);
+}
+
+typedef struct {
+  XdpScreenshotScheduler *scheduler;
+  guint generation;
+} CaptureCall;
+
+static void
+screenshot_returned (GObject      *object,
+                     GAsyncResult *result,
+                     gpointer      data)
+{
+  CaptureCall *call = data;
+  g_autoptr(XdpScreenshotScheduler) scheduler = call->scheduler;
+  guint generation = call->generation;
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GError) error = NULL;
+
+  g_free (call);
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+
+  /* The scheduler was stopped, or has moved on to another request */
+  if (generation != scheduler->generation)
+    return;
+
+  if (error)
+    {
+      g_clear_pointer (&scheduler->request_path, g_free);
+      capture_failed (scheduler, error);
+    }
+}
+
+static void
+capture (XdpScreenshotScheduler *scheduler)
+{
+  XdpPortal *portal = scheduler->portal;
+  GVariantBuilder options;
+  g_autofree char *token = NULL;
+  CaptureCall *call;
+
+  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
+  scheduler->request_path = g_strconcat (REQUEST_PATH_PREFIX, portal->sender, "/", token, NULL);
+  scheduler->request_time = g_get_monotonic_time ();
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
+  g_variant_builder_add (&options, "{sv}", "interactive", g_variant_new_boolean (FALSE));
+
+  call = g_new0 (CaptureCall, 1);
+  call->scheduler = g_object_ref (scheduler);
+  call->generation = ++scheduler->generation;
+
+  g_dbus_connection_call (portal->bus,
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.portal.Screenshot",
+                          "Screenshot",
+                          g_variant_new ("(sa{sv})", "", &options),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          screenshot_returned,
+                          call);
+}
+
+/* A source that only fires at its ready time, so that the deadlines
+ * can be set in absolute terms */
+static gboolean
+timer_source_dispatch (GSource     *source,
+                       GSourceFunc  callback,
+                       gpointer     user_data)
+{
+  return callback (user_data);
+}
+
+static GSourceFuncs timer_source_funcs = {
+  NULL,
+  NULL,
+  timer_source_dispatch,
+  NULL,
+};
+
+static gboolean
+timer_dispatch (gpointer data)
+{
+  XdpScreenshotScheduler *scheduler = data;
+  gint64 now = g_get_monotonic_time ();
+
+  if (scheduler->request_path)
+    scheduler->n_skipped++;
+  else
+    capture (scheduler);
+
+  /* Captures stay aligned to the start time. Ticks that were missed
+   * entirely, e.g. because the main loop was busy, are skipped too. */
+  scheduler->next_capture += scheduler->interval;
+  if (scheduler->next_capture <= now)
+    {
+      gint64 missed = (now - scheduler->next_capture) / scheduler->interval + 1;
+
+      scheduler->n_skipped += missed;
+      scheduler->next_capture += missed * scheduler->interval;
+    }
+
+  g_source_set_ready_time (scheduler->timer, scheduler->next_capture);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+xdp_screenshot_scheduler_finalize (GObject *object)
+{
+  XdpScreenshotScheduler *scheduler = XDP_SCREENSHOT_SCHEDULER (object);
+
+  xdp_screenshot_scheduler_stop (scheduler);
+
+  if (scheduler->response_signal)
+    g_dbus_connection_signal_unsubscribe (scheduler->portal->bus, scheduler->response_signal);
+
+  g_clear_object (&scheduler->portal);
+
+  G_OBJECT_CLASS (xdp_screenshot_scheduler_parent_class)->finalize (object);
+}
+
+static void
+xdp_screenshot_scheduler_class_init (XdpScreenshotSchedulerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = xdp_screenshot_scheduler_finalize;
+
+  /**
+   * XdpScreenshotScheduler::captured:
+   * @scheduler: the [class@ScreenshotScheduler]
+   * @fd: a read-only file descriptor for the image
+   * @uri: the URI of the image file
+   * @latency: the time it took to take the screenshot, in microseconds
+   *
+   * Emitted when a screenshot has been taken.
+   *
+   * @fd is closed when the signal emission ends; use dup() to keep it.
+   */
+  signals[CAPTURED] =
+    g_signal_new ("captured",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 3,
+                  G_TYPE_INT,
+                  G_TYPE_STRING,
+                  G_TYPE_INT64);
+
+  /**
+   * XdpScreenshotScheduler::failed:
+   * @scheduler: the [class@ScreenshotScheduler]
+   * @error: the reason for the failure
+   *
+   * Emitted when a screenshot could not be taken.
+   */
+  signals[FAILED] =
+    g_signal_new ("failed",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  G_TYPE_ERROR);
+}
+
+static void
+xdp_screenshot_scheduler_init (XdpScreenshotScheduler *scheduler)
+{
+}
+
+/**
+ * xdp_screenshot_scheduler_new:
+ * @portal: a [class@Portal]
+ * @interval: the time between captures, in milliseconds
+ *
+ * Creates a new [class@ScreenshotScheduler]. Use
+ * [method@ScreenshotScheduler.start] to start taking screenshots.
+ *
+ * Returns: (transfer full): the new [class@ScreenshotScheduler]
+ */
+XdpScreenshotScheduler *
+xdp_screenshot_scheduler_new (XdpPortal *portal,
+                              guint      interval)
+{
+  XdpScreenshotScheduler *scheduler;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (interval > 0, NULL);
+
+  scheduler = g_object_new (XDP_TYPE_SCREENSHOT_SCHEDULER, NULL);
+  scheduler->portal = g_object_ref (portal);
+  scheduler->interval = (gint64) interval * G_TIME_SPAN_MILLISECOND;
+
+  return scheduler;
+}
+
+/**
+ * xdp_screenshot_scheduler_start:
+ * @scheduler: a [class@ScreenshotScheduler]
+ *
+ * Takes a screenshot right away, and then one per interval until
+ * [method@ScreenshotScheduler.stop] is called.
+ */
+void
+xdp_screenshot_scheduler_start (XdpScreenshotScheduler *scheduler)
+{
+  g_return_if_fail (XDP_IS_SCREENSHOT_SCHEDULER (scheduler));
+
+  if (scheduler->timer)
+    return;
+
+  if (scheduler->response_signal == 0)
+    scheduler->response_signal =
+      g_dbus_connection_signal_subscribe (scheduler->portal->bus,
+                                          PORTAL_BUS_NAME,
+                                          REQUEST_INTERFACE,
+                                          "Response",
+                                          NULL,
+                                          NULL,
+                                          G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+                                          response_received,
+                                          scheduler,
+                                          NULL);
+
+  scheduler->next_capture = g_get_monotonic_time ();
+
+  scheduler->timer = g_source_new (&timer_source_funcs, sizeof (GSource));
+  g_source_set_callback (scheduler->timer, timer_dispatch, scheduler, NULL);
+  g_source_set_ready_time (scheduler->timer, scheduler->next_capture);
+  g_source_attach (scheduler->timer, NULL);
+}
+
+/**
+ * xdp_screenshot_scheduler_stop:
+ * @scheduler: a [class@ScreenshotScheduler]
+ *
+ * Stops taking screenshots. A pending request is closed, and its
+ * result is not reported.
+ */
+void
+xdp_screenshot_scheduler_stop (XdpScreenshotScheduler *scheduler)
+{
+  g_return_if_fail (XDP_IS_SCREENSHOT_SCHEDULER (scheduler));
+
+  /* Replies to requests sent so far are ignored */
+  scheduler->generation++;
+
+  if (scheduler->timer)
+    {
+      g_source_destroy (scheduler->timer);
+      g_clear_pointer (&scheduler->timer, g_source_unref);
+    }
+
+  if (scheduler->request_path)
+    {
+      g_dbus_connection_call (scheduler->portal->bus,
+                              PORTAL_BUS_NAME,
+                              scheduler->request_path,
+                              REQUEST_INTERFACE,
+                              "Close",
+                              NULL,
+                              NULL,
+                              G_DBUS_CALL_FLAGS_NONE,
+                              -1,
+                              NULL, NULL, NULL);
+      g_clear_pointer (&scheduler->request_path, g_free);
+    }
+}
+
+/**
+ * xdp_screenshot_scheduler_set_remove_files:
+ * @scheduler: a [class@ScreenshotScheduler]
+ * @remove_files: whether to remove the screenshot files
+ *
+ * Sets whether each screenshot file is removed right after it has been
+ * opened, before [signal@ScreenshotScheduler::captured] is emitted. The
+ * image can then only be read through the file descriptor passed to the
+ * signal handlers.
+ *
+ * The default is to keep the files.
+ */
+void
+xdp_screenshot_scheduler_set_remove_files (XdpScreenshotScheduler *scheduler,
+                                           gboolean                remove_files)
+{
+  g_return_if_fail (XDP_IS_SCREENSHOT_SCHEDULER (scheduler));
+
+  scheduler->remove_files = !!remove_files;
+}
+
+/**
+ * xdp_screenshot_scheduler_get_remove_files:
+ * @scheduler: a [class@ScreenshotScheduler]
+ *
+ * Gets whether screenshot files are removed after they have been
+ * opened. See [method@ScreenshotScheduler.set_remove_files].
+ *
+ * Returns: `TRUE` if the screenshot files are removed
+ */
+gboolean
+xdp_screenshot_scheduler_get_remove_files (XdpScreenshotScheduler *scheduler)
+{
+  g_return_val_if_fail (XDP_IS_SCREENSHOT_SCHEDULER (scheduler), FALSE);
+
+  return scheduler->remove_files;
+}
+
+/**
+ * xdp_screenshot_scheduler_get_stats:
+ * @scheduler: a [class@ScreenshotScheduler]
+ * @n_captured: (out) (optional): return location for the number of
+ *   screenshots taken
+ * @n_skipped: (out) (optional): return location for the number of
+ *   captures that were skipped because a request was still pending
+ * @n_failed: (out) (optional): return location for the number of
+ *   failed captures
+ * @last_latency: (out) (optional): return location for the latency
+ *   of the last screenshot, in microseconds
+ * @mean_latency: (out) (optional): return location for the mean
+ *   latency, in microseconds
+ * @max_latency: (out) (optional): return location for the largest
+ *   latency, in microseconds
+ *
+ * Gets statistics about the screenshots taken so far. The latency is
+ * the time between sending a request and receiving the screenshot.
+ */
+void
+xdp_screenshot_scheduler_get_stats (XdpScreenshotScheduler *scheduler,
+                                    guint                  *n_captured,
+                                    guint                  *n_skipped,
+                                    guint                  *n_failed,
+                                    gint64                 *last_latency,
+                                    gint64                 *mean_latency,
+                                    gint64                 *max_latency)
+{
+  g_return_if_fail (XDP_IS_SCREENSHOT_SCHEDULER (scheduler));
+
+  if (n_captured)
+    *n_captured = scheduler->n_captured;
+  if (n_skipped)
+    *n_skipped = scheduler->n_skipped;
+  if (n_failed)
+    *n_failed = scheduler->n_failed;
+  if (last_latency)
+    *last_latency = scheduler->last_latency;
+  if (mean_latency)
+    *mean_latency = scheduler->n_captured > 0 ? scheduler->total_latency / scheduler->n_captured : 0;
+  if (max_latency)
+    *max_latency = scheduler->max_latency;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/types.h>
+
+G_BEGIN_DECLS
+
+#define XDP_TYPE_SCREENSHOT_SCHEDULER (xdp_screenshot_scheduler_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpScreenshotScheduler, xdp_screenshot_scheduler, XDP, SCREENSHOT_SCHEDULER, GObject)
+
+XDP_PUBLIC
+XdpScreenshotScheduler * xdp_screenshot_scheduler_new              (XdpPortal              *portal,
+                                                                    guint                   interval);
+
+XDP_PUBLIC
+void                     xdp_screenshot_scheduler_start            (XdpScreenshotScheduler *scheduler);
+
+XDP_PUBLIC
+void                     xdp_screenshot_scheduler_stop             (XdpScreenshotScheduler *scheduler);
+
+XDP_PUBLIC
+void                     xdp_screenshot_scheduler_set_remove_files (XdpScreenshotScheduler *scheduler,
+                                                                    gboolean                remove_files);
+
+XDP_PUBLIC
+gboolean                 xdp_screenshot_scheduler_get_remove_files (XdpScreenshotScheduler *scheduler);
+
+XDP_PUBLIC
+void                     xdp_screenshot_scheduler_get_stats        (XdpScreenshotScheduler *scheduler,
+                                                                    guint                  *n_captured,
+                                                                    guint                  *n_skipped,
+                                                                    guint                  *n_failed,
+                                                                    gint64                 *last_latency,
+                                                                    gint64                 *mean_latency,
+                                                                    gint64                 *max_latency);
+
+G_END_DECLS
@@ -19,6 +19,10 @@
 
 #include "config.h"
 
+#include <errno.h>
+
+#include <glib/gstdio.h>
+
 #include "screenshot.h"
 #include "portal-private.h"
 
@@ -28,6 +32,9 @@ typedef struct {
   char *parent_handle;
   gboolean color;
   gboolean interactive;
+  gboolean to_memory;
+  gboolean unlink;
+  gint64 start_time;
   guint signal_id;
   GTask *task;
   char *request_path;
@@ -57,6 +64,68 @@ screenshot_call_free (ScreenshotCall *call)
   g_free (call);
 }
 
+typedef struct {
+  char *uri;
+  gboolean unlink;
+  GBytes *bytes;
+  gint64 capture_time;
+  gint64 map_time;
+} ScreenshotMapping;
+
+static void
+screenshot_mapping_free (ScreenshotMapping *mapping)
+{
+  g_free (mapping->uri);
+  g_clear_pointer (&mapping->bytes, g_bytes_unref);
+  g_free (mapping);
+}
+
+static void
+map_screenshot_in_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  ScreenshotMapping *mapping = task_data;
+  g_autoptr(GMappedFile) mapped_file = NULL;
+  g_autoptr(GFile) file = NULL;
+  g_autofree char *path = NULL;
+  GError *error = NULL;
+  gint64 start_time;
+
+  /* Once the file is removed, the mapping is the only copy of the
+   * screenshot, so it must not be thrown away by a late cancellation */
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  start_time = g_get_monotonic_time ();
+
+  file = g_file_new_for_uri (mapping->uri);
+  path = g_file_get_path (file);
+  if (!path)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               "Screenshot '%s' is not a local file", mapping->uri);
+      return;
+    }
+
+  mapped_file = g_mapped_file_new (path, FALSE, &error);
+  if (!mapped_file)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* The mapping stays valid after the file is removed */
+  if (mapping->unlink && g_unlink (path) != 0)
+    g_warning ("Failed to remove screenshot '%s': %s", path, g_strerror (errno));
+
+  mapping->bytes = g_mapped_file_get_bytes (mapped_file);
+  mapping->map_time = g_get_monotonic_time () - start_time;
+
+  g_task_return_boolean (task, TRUE);
+}
+
 static void
 response_received (GDBusConnection *bus,
                    const char *sender_name,
@@ -87,9 +156,23 @@ response_received (GDBusConnection *bus,
         }
       else
         {
-          const char *uri;
+          const char *uri = NULL;
           g_variant_lookup (ret, "uri", "&s", &uri);
-          if (uri)
+          if (uri && call->to_memory)
+            {
+              ScreenshotMapping *mapping;
+
+              mapping = g_new0 (ScreenshotMapping, 1);
+              mapping->uri = g_strdup (uri);
+              mapping->unlink = call->unlink;
+              mapping->capture_time = g_get_monotonic_time () - call->start_time;
+
+              g_task_set_task_data (call->task, mapping, (GDestroyNotify) screenshot_mapping_free);
+              if (call->unlink)
+                g_task_set_check_cancellable (call->task, FALSE);
+              g_task_run_in_thread (call->task, map_screenshot_in_thread);
+            }
+          else if (uri)
             g_task_return_pointer (call->task, g_strdup (uri), g_free);
           else
             g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "Screenshot not received");
@@ -190,6 +273,8 @@ take_screenshot (ScreenshotCall *call)
   if (!call->color)
     g_variant_builder_add (&options, "{sv}", "interactive", g_variant_new_boolean (call->interactive));
 
+  call->start_time = g_get_monotonic_time ();
+
   g_dbus_connection_call (call->portal->bus,
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
@@ -269,6 +354,98 @@ xdp_portal_take_screenshot_finish (XdpPortal *portal,
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+/**
+ * xdp_portal_take_screenshot_to_memory:
+ * @portal: a [class@Portal]
+ * @parent: (nullable): parent window information
+ * @flags: options for this call
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Takes a screenshot, and maps the resulting image file into memory.
+ *
+ * This works like [method@Portal.take_screenshot], but saves callers
+ * from opening and reading the file themselves: the image is mapped
+ * read-only, without copying it. If @flags contains
+ * %XDP_SCREENSHOT_FLAG_UNLINK, the file is removed once it is mapped.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Portal.take_screenshot_to_memory_finish] to get the results.
+ */
+void
+xdp_portal_take_screenshot_to_memory (XdpPortal           *portal,
+                                      XdpParent           *parent,
+                                      XdpScreenshotFlags   flags,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             data)
+{
+  ScreenshotCall *call;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail ((flags & ~(XDP_SCREENSHOT_FLAG_INTERACTIVE |
+                               XDP_SCREENSHOT_FLAG_UNLINK)) == 0);
+
+  call = g_new0 (ScreenshotCall, 1);
+  call->color = FALSE;
+  call->to_memory = TRUE;
+  call->portal = g_object_ref (portal);
+  if (parent)
+    call->parent = xdp_parent_copy (parent);
+  else
+    call->parent_handle = g_strdup ("");
+  call->interactive = (flags & XDP_SCREENSHOT_FLAG_INTERACTIVE) != 0;
+  call->unlink = (flags & XDP_SCREENSHOT_FLAG_UNLINK) != 0;
+  call->task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (call->task, xdp_portal_take_screenshot_to_memory);
+
+  take_screenshot (call);
+}
+
+/**
+ * xdp_portal_take_screenshot_to_memory_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @capture_time: (out) (optional): return location for the time between
+ *   sending the request and receiving the screenshot, in microseconds
+ * @map_time: (out) (optional): return location for the time it took to
+ *   map the image file, in microseconds
+ * @error: return location for an error
+ *
+ * Finishes a screenshot-to-memory request.
+ *
+ * The capture time includes the time the user spent in the
+ * screenshot dialog for interactive screenshots.
+ *
+ * Returns: (transfer full): the contents of the image file
+ */
+GBytes *
+xdp_portal_take_screenshot_to_memory_finish (XdpPortal     *portal,
+                                             GAsyncResult  *result,
+                                             gint64        *capture_time,
+                                             gint64        *map_time,
+                                             GError       **error)
+{
+  ScreenshotMapping *mapping;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_take_screenshot_to_memory, NULL);
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return NULL;
+
+  mapping = g_task_get_task_data (G_TASK (result));
+
+  if (capture_time)
+    *capture_time = mapping->capture_time;
+  if (map_time)
+    *map_time = mapping->map_time;
+
+  return g_bytes_ref (mapping->bytes);
+}
+
 /**
  * xdp_portal_pick_color:
  * @portal: a [class@Portal]
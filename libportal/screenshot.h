@@ -25,7 +25,8 @@ G_BEGIN_DECLS
 
 typedef enum {
   XDP_SCREENSHOT_FLAG_NONE        = 0,
-  XDP_SCREENSHOT_FLAG_INTERACTIVE = 1 << 0
+  XDP_SCREENSHOT_FLAG_INTERACTIVE = 1 << 0,
+  XDP_SCREENSHOT_FLAG_UNLINK      = 1 << 1
 } XdpScreenshotFlags;
 
 XDP_PUBLIC
@@ -41,6 +42,21 @@ char *     xdp_portal_take_screenshot_finish (XdpPortal           *portal,
                                               GAsyncResult        *result,
                                               GError             **error);
 
+XDP_PUBLIC
+void       xdp_portal_take_screenshot_to_memory        (XdpPortal           *portal,
+                                                        XdpParent           *parent,
+                                                        XdpScreenshotFlags   flags,
+                                                        GCancellable        *cancellable,
+                                                        GAsyncReadyCallback  callback,
+                                                        gpointer             data);
+
+XDP_PUBLIC
+GBytes *   xdp_portal_take_screenshot_to_memory_finish (XdpPortal           *portal,
+                                                        GAsyncResult        *result,
+                                                        gint64              *capture_time,
+                                                        gint64              *map_time,
+                                                        GError             **error);
+
 XDP_PUBLIC
 void       xdp_portal_pick_color             (XdpPortal           *portal,
                                               XdpParent           *parent,
@@ -0,0 +1,674 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include "portal-private.h"
+#include "session-pool-private.h"
+#include "session-private.h"
+
+/**
+ * XdpSessionPool
+ *
+ * A pool of screencast or remote desktop sessions that are set up ahead
+ * of time.
+ *
+ * Setting up a session takes several round trips to the portal. A
+ * [class@SessionPool] does that in the background, so that a session is
+ * ready when it is needed. By default, the pooled sessions are created
+ * and have their sources and devices selected, but are not started;
+ * starting them is left to [method@Session.start]. When the sessions
+ * can be restored without user interaction, the pool can also start
+ * them; see [method@SessionPool.set_start_sessions].
+ *
+ * The pool creates one session at a time until it holds the requested
+ * number. Sessions that the portal closes while they are in the pool
+ * are dropped and replaced, with a growing delay if that keeps
+ * happening; after a few of them in a row, the pool waits for the next
+ * acquisition. When the pool is destroyed, the sessions it still holds
+ * are closed.
+ *
+ * Restore tokens are single-use. Unless the pool starts the sessions
+ * itself, a restore token is given to one pooled session only, and the
+ * pool sets up the next one once that session has been started and has
+ * been handed a new token, or has been closed without using it.
+ */
+
+/* Number of pooled sessions closed in a row after which the pool stops
+ * replacing them until the next acquisition */
+#define MAX_POOLED_SESSION_CLOSES 5
+
+/* Delay before replacing a closed session, in ms; doubled for each
+ * further one closed in a row */
+#define REFILL_BACKOFF_MIN 500
+#define REFILL_BACKOFF_MAX 30000
+
+typedef struct {
+  GTask *task;
+  gulong cancelled_id;
+} Waiter;
+
+/* Outlives the pool if it is destroyed while a session is being set up */
+typedef struct {
+  GWeakRef pool;
+  XdpSessionType type;
+  gboolean started;
+  char *restore_token; /* lent to the session, if not started */
+} Creation;
+
+struct _XdpSessionPool {
+  GObject parent_instance;
+
+  XdpPortal *portal;
+  XdpSessionType type;
+  XdpDeviceType devices;
+  XdpOutputType outputs;
+  XdpCursorMode cursor_mode;
+  XdpPersistMode persist_mode;
+  char *restore_token; /* for the next session */
+  char *lent_restore_token;
+  GWeakRef lent_to; /* XdpSession that has not used lent_restore_token yet */
+  guint size;
+  gboolean start_sessions;
+
+  GQueue ready; /* XdpSession */
+  GQueue waiters; /* Waiter */
+  gboolean creating;
+  gboolean paused;
+  guint n_sessions_closed; /* in a row, while pooled */
+  guint refill_backoff_id;
+
+  guint n_hits;
+  guint n_misses;
+  guint n_created;
+  guint n_closed;
+};
+
+G_DEFINE_TYPE (XdpSessionPool, xdp_session_pool, G_TYPE_OBJECT)
+
+static void fill_pool (XdpSessionPool *pool);
+
+static void
+waiter_free (Waiter *waiter)
+{
+  g_clear_signal_handler (&waiter->cancelled_id, g_task_get_cancellable (waiter->task));
+  g_object_unref (waiter->task);
+  g_free (waiter);
+}
+
+static void
+waiter_cancelled_cb (GCancellable *cancellable,
+                     gpointer      data)
+{
+  Waiter *waiter = data;
+  XdpSessionPool *pool = g_task_get_source_object (waiter->task);
+
+  /* Only called while the waiter is still queued */
+  g_queue_remove (&pool->waiters, waiter);
+  g_task_return_new_error (waiter->task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                           "Session acquisition canceled by caller");
+  waiter_free (waiter);
+}
+
+static gboolean
+refill_backoff_cb (gpointer data)
+{
+  XdpSessionPool *pool = data;
+
+  pool->refill_backoff_id = 0;
+  fill_pool (pool);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+pooled_session_closed (XdpSession *session,
+                       gpointer    data)
+{
+  XdpSessionPool *pool = data;
+  guint delay;
+
+  if (!g_queue_remove (&pool->ready, session))
+    return;
+
+  g_signal_handlers_disconnect_by_func (session, pooled_session_closed, pool);
+  g_object_unref (session);
+  pool->n_closed++;
+
+  /* Don't keep replacing sessions that the portal closes right away */
+  pool->n_sessions_closed++;
+  if (pool->n_sessions_closed >= MAX_POOLED_SESSION_CLOSES)
+    {
+      pool->paused = TRUE;
+      return;
+    }
+
+  delay = MIN (REFILL_BACKOFF_MIN << (pool->n_sessions_closed - 1), REFILL_BACKOFF_MAX);
+  g_clear_handle_id (&pool->refill_backoff_id, g_source_remove);
+  pool->refill_backoff_id = g_timeout_add (delay, refill_backoff_cb, pool);
+}
+
+static void
+lent_session_closed (XdpSession *session,
+                     gpointer    data)
+{
+  XdpSessionPool *pool = data;
+  g_autoptr(XdpSession) lent_to = g_weak_ref_get (&pool->lent_to);
+
+  if (lent_to != session)
+    return;
+
+  /* The token was not used, so it is still good, unless a newer one
+   * came in meanwhile */
+  g_weak_ref_set (&pool->lent_to, NULL);
+  if (pool->restore_token == NULL)
+    pool->restore_token = g_steal_pointer (&pool->lent_restore_token);
+  g_clear_pointer (&pool->lent_restore_token, g_free);
+
+  /* Sessions closed while pooled are replaced after a delay */
+  if (!g_queue_find (&pool->ready, session))
+    fill_pool (pool);
+}
+
+/* Sessions that were lent a token are not reachable once they are gone
+ * without having been closed */
+static void
+reclaim_lent_restore_token (XdpSessionPool *pool)
+{
+  g_autoptr(XdpSession) lent_to = NULL;
+
+  if (pool->lent_restore_token == NULL)
+    return;
+
+  lent_to = g_weak_ref_get (&pool->lent_to);
+  if (lent_to)
+    return;
+
+  if (pool->restore_token == NULL)
+    pool->restore_token = g_steal_pointer (&pool->lent_restore_token);
+  g_clear_pointer (&pool->lent_restore_token, g_free);
+}
+
+/* Called when a session that was set up by the pool, but not started,
+ * gets started */
+void
+_xdp_session_pool_restore_token_used (XdpSessionPool *pool,
+                                      XdpSession     *session)
+{
+  g_autoptr(XdpSession) lent_to = g_weak_ref_get (&pool->lent_to);
+
+  g_weak_ref_set (&session->restore_token_pool, NULL);
+
+  if (lent_to == session)
+    {
+      g_signal_handlers_disconnect_by_func (session, lent_session_closed, pool);
+      g_weak_ref_set (&pool->lent_to, NULL);
+      g_clear_pointer (&pool->lent_restore_token, g_free);
+    }
+
+  /* Restore tokens are single-use; the session was handed a new one */
+  if (session->persist_mode != XDP_PERSIST_MODE_NONE && session->restore_token)
+    {
+      g_free (pool->restore_token);
+      pool->restore_token = g_strdup (session->restore_token);
+    }
+
+  fill_pool (pool);
+}
+
+static XdpSession *
+take_ready_session (XdpSessionPool *pool)
+{
+  XdpSession *session;
+
+  session = g_queue_pop_head (&pool->ready);
+  if (session)
+    g_signal_handlers_disconnect_by_func (session, pooled_session_closed, pool);
+
+  return session;
+}
+
+static void
+session_created (GObject      *object,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  Creation *creation = data;
+  g_autoptr(XdpSessionPool) pool = NULL;
+  XdpPortal *portal = XDP_PORTAL (object);
+  GError *error = NULL;
+  g_autofree char *restore_token = NULL;
+  gboolean creation_started;
+  XdpSession *session;
+  Waiter *waiter;
+
+  if (creation->started)
+    session = xdp_portal_establish_session_finish (portal, result, &error);
+  else if (creation->type == XDP_SESSION_REMOTE_DESKTOP)
+    session = xdp_portal_create_remote_desktop_session_finish (portal, result, &error);
+  else
+    session = xdp_portal_create_screencast_session_finish (portal, result, &error);
+
+  creation_started = creation->started;
+  pool = g_weak_ref_get (&creation->pool);
+  g_weak_ref_clear (&creation->pool);
+  restore_token = g_steal_pointer (&creation->restore_token);
+  g_free (creation);
+
+  /* The pool went away while the session was being set up */
+  if (pool == NULL)
+    {
+      if (session)
+        {
+          xdp_session_close (session);
+          g_object_unref (session);
+        }
+      g_clear_error (&error);
+      return;
+    }
+
+  pool->creating = FALSE;
+
+  if (session == NULL)
+    {
+      /* The token was not used */
+      if (restore_token && pool->restore_token == NULL)
+        pool->restore_token = g_steal_pointer (&restore_token);
+
+      /* Don't keep retrying in the background; the next acquisition
+       * tries again */
+      pool->paused = TRUE;
+
+      while ((waiter = g_queue_pop_head (&pool->waiters)) != NULL)
+        {
+          g_task_return_error (waiter->task, g_error_copy (error));
+          waiter_free (waiter);
+        }
+
+      g_clear_error (&error);
+      return;
+    }
+
+  pool->n_created++;
+
+  /* The new token of a session that is started later on is used for
+   * the sessions after it */
+  if (!creation_started)
+    g_weak_ref_set (&session->restore_token_pool, pool);
+
+  if (restore_token)
+    {
+      pool->lent_restore_token = g_steal_pointer (&restore_token);
+      g_weak_ref_set (&pool->lent_to, session);
+      g_signal_connect_object (session, "closed", G_CALLBACK (lent_session_closed), pool, 0);
+    }
+
+  /* Restore tokens are single-use, so the next session needs the one
+   * this session was handed when it started */
+  if (xdp_session_get_session_state (session) == XDP_SESSION_ACTIVE)
+    {
+      char *new_token = xdp_session_get_restore_token (session);
+
+      if (new_token)
+        {
+          g_free (pool->restore_token);
+          pool->restore_token = new_token;
+        }
+    }
+
+  waiter = g_queue_pop_head (&pool->waiters);
+  if (waiter)
+    {
+      g_task_return_pointer (waiter->task, session, g_object_unref);
+      waiter_free (waiter);
+    }
+  else
+    {
+      g_signal_connect (session, "closed", G_CALLBACK (pooled_session_closed), pool);
+      g_queue_push_tail (&pool->ready, session);
+    }
+
+  fill_pool (pool);
+}
+
+static void
+fill_pool (XdpSessionPool *pool)
+{
+  Creation *creation;
+  const char *restore_token;
+
+  if (pool->creating || pool->paused || pool->refill_backoff_id != 0)
+    return;
+
+  if (g_queue_get_length (&pool->ready) >= pool->size &&
+      g_queue_is_empty (&pool->waiters))
+    return;
+
+  reclaim_lent_restore_token (pool);
+
+  /* Sessions that are not started by the pool get their token when the
+   * user starts them, so only one of them can be set up per token. A
+   * waiting acquisition gets a session without a token instead. */
+  if (!pool->start_sessions &&
+      pool->lent_restore_token != NULL &&
+      g_queue_is_empty (&pool->waiters))
+    return;
+
+  creation = g_new0 (Creation, 1);
+  g_weak_ref_init (&creation->pool, pool);
+  creation->type = pool->type;
+  creation->started = pool->start_sessions;
+
+  if (!creation->started)
+    creation->restore_token = g_steal_pointer (&pool->restore_token);
+
+  restore_token = creation->started ? pool->restore_token : creation->restore_token;
+
+  pool->creating = TRUE;
+
+  if (creation->started && pool->type == XDP_SESSION_REMOTE_DESKTOP)
+    xdp_portal_establish_remote_desktop_session (pool->portal,
+                                                 NULL,
+                                                 pool->devices,
+                                                 pool->outputs,
+                                                 XDP_REMOTE_DESKTOP_FLAG_NONE,
+                                                 pool->cursor_mode,
+                                                 pool->persist_mode,
+                                                 restore_token,
+                                                 NULL,
+                                                 session_created,
+                                                 creation);
+  else if (creation->started)
+    xdp_portal_establish_screencast_session (pool->portal,
+                                             NULL,
+                                             pool->outputs,
+                                             XDP_SCREENCAST_FLAG_NONE,
+                                             pool->cursor_mode,
+                                             pool->persist_mode,
+                                             restore_token,
+                                             NULL,
+                                             session_created,
+                                             creation);
+  else if (pool->type == XDP_SESSION_REMOTE_DESKTOP)
+    xdp_portal_create_remote_desktop_session_full (pool->portal,
+                                                   pool->devices,
+                                                   pool->outputs,
+                                                   XDP_REMOTE_DESKTOP_FLAG_NONE,
+                                                   pool->cursor_mode,
+                                                   pool->persist_mode,
+                                                   restore_token,
+                                                   NULL,
+                                                   session_created,
+                                                   creation);
+  else
+    xdp_portal_create_screencast_session (pool->portal,
+                                          pool->outputs,
+                                          XDP_SCREENCAST_FLAG_NONE,
+                                          pool->cursor_mode,
+                                          pool->persist_mode,
+                                          restore_token,
+                                          NULL,
+                                          session_created,
+                                          creation);
+}
+
+static void
+xdp_session_pool_dispose (GObject *object)
+{
+  XdpSessionPool *pool = XDP_SESSION_POOL (object);
+  XdpSession *session;
+
+  /* Waiters keep the pool alive */
+  g_assert (g_queue_is_empty (&pool->waiters));
+
+  g_clear_handle_id (&pool->refill_backoff_id, g_source_remove);
+
+  while ((session = take_ready_session (pool)) != NULL)
+    {
+      xdp_session_close (session);
+      g_object_unref (session);
+    }
+
+  G_OBJECT_CLASS (xdp_session_pool_parent_class)->dispose (object);
+}
+
+static void
+xdp_session_pool_finalize (GObject *object)
+{
+  XdpSessionPool *pool = XDP_SESSION_POOL (object);
+
+  g_clear_object (&pool->portal);
+  g_free (pool->restore_token);
+  g_free (pool->lent_restore_token);
+  g_weak_ref_clear (&pool->lent_to);
+
+  G_OBJECT_CLASS (xdp_session_pool_parent_class)->finalize (object);
+}
+
+static void
+xdp_session_pool_class_init (XdpSessionPoolClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = xdp_session_pool_dispose;
+  object_class->finalize = xdp_session_pool_finalize;
+}
+
+static void
+xdp_session_pool_init (XdpSessionPool *pool)
+{
+  g_queue_init (&pool->ready);
+  g_queue_init (&pool->waiters);
+  g_weak_ref_init (&pool->lent_to, NULL);
+}
+
+/**
+ * xdp_session_pool_new:
+ * @portal: a [class@Portal]
+ * @type: the type of the sessions, either %XDP_SESSION_SCREENCAST or
+ *   %XDP_SESSION_REMOTE_DESKTOP
+ * @devices: which kinds of input devices to offer, for remote desktop sessions
+ * @outputs: which kinds of source to offer
+ * @cursor_mode: the cursor mode of the sessions
+ * @persist_mode: the persist mode of the sessions
+ * @restore_token: (nullable): the token of a previous session to restore
+ * @size: the number of sessions to keep ready
+ *
+ * Creates a new [class@SessionPool] and starts setting up its sessions.
+ *
+ * If the restore token vault of @portal is enabled, it is used for the
+ * pooled sessions like for any other session; see
+ * [method@Portal.set_restore_token_vault_enabled].
+ *
+ * Returns: (transfer full): the new [class@SessionPool]
+ */
+XdpSessionPool *
+xdp_session_pool_new (XdpPortal      *portal,
+                      XdpSessionType  type,
+                      XdpDeviceType   devices,
+                      XdpOutputType   outputs,
+                      XdpCursorMode   cursor_mode,
+                      XdpPersistMode  persist_mode,
+                      const char     *restore_token,
+                      guint           size)
+{
+  XdpSessionPool *pool;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (type == XDP_SESSION_SCREENCAST || type == XDP_SESSION_REMOTE_DESKTOP, NULL);
+  g_return_val_if_fail (size > 0, NULL);
+
+  pool = g_object_new (XDP_TYPE_SESSION_POOL, NULL);
+  pool->portal = g_object_ref (portal);
+  pool->type = type;
+  pool->devices = type == XDP_SESSION_REMOTE_DESKTOP ? devices : XDP_DEVICE_NONE;
+  pool->outputs = outputs;
+  pool->cursor_mode = cursor_mode;
+  pool->persist_mode = persist_mode;
+  pool->restore_token = g_strdup (restore_token);
+  pool->size = size;
+
+  fill_pool (pool);
+
+  return pool;
+}
+
+/**
+ * xdp_session_pool_set_start_sessions:
+ * @pool: a [class@SessionPool]
+ * @start_sessions: whether to start the pooled sessions
+ *
+ * Sets whether the sessions in the pool are started before they are
+ * handed out.
+ *
+ * Only enable this when the sessions can be restored, i.e. when a
+ * restore token is available; otherwise the user is asked to select
+ * the sources of each pooled session. When the portal hands out a new
+ * restore token for a started session, it is used for the next one.
+ *
+ * Sessions that are already in the pool are not affected.
+ */
+void
+xdp_session_pool_set_start_sessions (XdpSessionPool *pool,
+                                     gboolean        start_sessions)
+{
+  g_return_if_fail (XDP_IS_SESSION_POOL (pool));
+
+  pool->start_sessions = !!start_sessions;
+}
+
+/**
+ * xdp_session_pool_acquire:
+ * @pool: a [class@SessionPool]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Takes a session from the pool.
+ *
+ * If the pool has a session ready, it is handed out right away and
+ * counted as a hit. Otherwise, the request is counted as a miss and
+ * waits for the next session to be set up. The pool is refilled in
+ * either case.
+ */
+void
+xdp_session_pool_acquire (XdpSessionPool      *pool,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+  XdpSession *session;
+  Waiter *waiter;
+
+  g_return_if_fail (XDP_IS_SESSION_POOL (pool));
+
+  task = g_task_new (pool, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_session_pool_acquire);
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  pool->paused = FALSE;
+  pool->n_sessions_closed = 0;
+
+  session = take_ready_session (pool);
+  if (session)
+    {
+      pool->n_hits++;
+      g_task_return_pointer (task, session, g_object_unref);
+      fill_pool (pool);
+      return;
+    }
+
+  pool->n_misses++;
+
+  /* Don't make the caller wait out the delay of a refill */
+  g_clear_handle_id (&pool->refill_backoff_id, g_source_remove);
+
+  waiter = g_new0 (Waiter, 1);
+  waiter->task = g_steal_pointer (&task);
+  if (cancellable)
+    waiter->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (waiter_cancelled_cb), waiter);
+
+  g_queue_push_tail (&pool->waiters, waiter);
+  fill_pool (pool);
+}
+
+/**
+ * xdp_session_pool_acquire_finish:
+ * @pool: a [class@SessionPool]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes taking a session from the pool. The session belongs to the
+ * caller from now on, and is no longer replaced by the pool when it is
+ * closed.
+ *
+ * Returns: (transfer full): a [class@Session], or `NULL`
+ */
+XdpSession *
+xdp_session_pool_acquire_finish (XdpSessionPool  *pool,
+                                 GAsyncResult    *result,
+                                 GError         **error)
+{
+  g_return_val_if_fail (XDP_IS_SESSION_POOL (pool), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, pool), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_session_pool_acquire, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * xdp_session_pool_get_stats:
+ * @pool: a [class@SessionPool]
+ * @n_ready: (out) (optional): return location for the number of sessions
+ *   ready to be handed out
+ * @n_hits: (out) (optional): return location for the number of
+ *   acquisitions that were served right away
+ * @n_misses: (out) (optional): return location for the number of
+ *   acquisitions that had to wait for a session
+ * @n_created: (out) (optional): return location for the number of
+ *   sessions set up over the lifetime of the pool
+ * @n_closed: (out) (optional): return location for the number of pooled
+ *   sessions that were closed before being handed out
+ *
+ * Gets statistics about the pool.
+ */
+void
+xdp_session_pool_get_stats (XdpSessionPool *pool,
+                            guint          *n_ready,
+                            guint          *n_hits,
+                            guint          *n_misses,
+                            guint          *n_created,
+                            guint          *n_closed)
+{
+  g_return_if_fail (XDP_IS_SESSION_POOL (pool));
+
+  if (n_ready)
+    *n_ready = g_queue_get_length (&pool->ready);
+  if (n_hits)
+    *n_hits = pool->n_hits;
+  if (n_misses)
+    *n_misses = pool->n_misses;
+  if (n_created)
+    *n_created = pool->n_created;
+  if (n_closed)
+    *n_closed = pool->n_closed;
+}
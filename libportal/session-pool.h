@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/types.h>
+#include <libportal/remote.h>
+
+G_BEGIN_DECLS
+
+#define XDP_TYPE_SESSION_POOL (xdp_session_pool_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpSessionPool, xdp_session_pool, XDP, SESSION_POOL, GObject)
+
+XDP_PUBLIC
+XdpSessionPool * xdp_session_pool_new                (XdpPortal            *portal,
+                                                      XdpSessionType        type,
+                                                      XdpDeviceType         devices,
+                                                      XdpOutputType         outputs,
+                                                      XdpCursorMode         cursor_mode,
+                                                      XdpPersistMode        persist_mode,
+                                                      const char           *restore_token,
+                                                      guint                 size);
+
+XDP_PUBLIC
+void             xdp_session_pool_set_start_sessions (XdpSessionPool       *pool,
+                                                      gboolean              start_sessions);
+
+XDP_PUBLIC
+void             xdp_session_pool_acquire            (XdpSessionPool       *pool,
+                                                      GCancellable         *cancellable,
+                                                      GAsyncReadyCallback   callback,
+                                                      gpointer              data);
+
+XDP_PUBLIC
+XdpSession *     xdp_session_pool_acquire_finish     (XdpSessionPool       *pool,
+                                                      GAsyncResult         *result,
+                                                      GError              **error);
+
+XDP_PUBLIC
+void             xdp_session_pool_get_stats          (XdpSessionPool       *pool,
+                                                      guint                *n_ready,
+                                                      guint                *n_hits,
+                                                      guint                *n_misses,
+                                                      guint                *n_created,
+                                                      guint                *n_closed);
+
+G_END_DECLS
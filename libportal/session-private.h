@@ -36,14 +36,28 @@ struct _XdpSession {
   gboolean is_clipboard_enabled;
   gboolean is_selection_owned_by_session;
   GStrv selection_mime_types;
+  GHashTable *selection_contents; /* mime type -> SelectionContent */
+  GHashTable *selection_transfers; /* serial -> SelectionTransfer */
+  GQueue selection_transfer_queue;
+  unsigned int max_selection_transfers;
+  unsigned int n_active_selection_transfers;
+  unsigned int selection_transfer_timeout; /* ms, 0 for none */
+  unsigned int n_selection_transfers_completed;
+  unsigned int n_selection_transfers_failed;
+  guint64 selection_bytes_transferred;
+  gint64 selection_busy_since;
+  gint64 selection_busy_time;
 
   /* RemoteDesktop/ScreenCast */
   XdpSessionState state;
   XdpDeviceType devices;
   GVariant *streams;
+  GVariant *setup_timings;
 
   XdpPersistMode persist_mode;
   char *restore_token;
+  char *restore_token_vault_key;
+  GWeakRef restore_token_pool; /* XdpSessionPool that lent the restore token */
 
   gboolean uses_eis;
 
@@ -65,3 +79,7 @@ void         _xdp_session_set_streams (XdpSession *session,
                                        GVariant   *streams);
 
 void         _xdp_session_close (XdpSession *session);
+
+void         _xdp_session_clear_selection_contents (XdpSession *session);
+
+void         _xdp_session_drop_selection_transfers (XdpSession *session);
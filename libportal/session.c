@@ -60,12 +60,19 @@ xdp_session_finalize (GObject *object)
 
   g_clear_object (&session->portal);
   g_clear_pointer (&session->restore_token, g_free);
+  g_clear_pointer (&session->restore_token_vault_key, g_free);
+  g_weak_ref_clear (&session->restore_token_pool);
   g_clear_pointer (&session->id, g_free);
   g_clear_pointer (&session->streams, g_variant_unref);
+  g_clear_pointer (&session->setup_timings, g_variant_unref);
   if (session->input_capture_session != NULL)
     g_critical ("XdpSession destroyed before XdpInputCaptureSesssion, you lost count of your session refs");
   session->input_capture_session = NULL;
   g_clear_pointer (&session->selection_mime_types, g_strfreev);
+  _xdp_session_clear_selection_contents (session);
+  _xdp_session_drop_selection_transfers (session);
+  g_clear_pointer (&session->selection_contents, g_hash_table_unref);
+  g_clear_pointer (&session->selection_transfers, g_hash_table_unref);
 
   G_OBJECT_CLASS (xdp_session_parent_class)->finalize (object);
 }
@@ -131,6 +138,9 @@ xdp_session_class_init (XdpSessionClass *klass)
 static void
 xdp_session_init (XdpSession *session)
 {
+  g_queue_init (&session->selection_transfer_queue);
+  session->max_selection_transfers = 4;
+  g_weak_ref_init (&session->restore_token_pool, NULL);
 }
 
 static void
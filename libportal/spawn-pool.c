@@ -0,0 +1,862 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gio/gunixfdlist.h>
+
+#include "portal-private.h"
+#include "spawn-private.h"
+#include "spawn-pool.h"
+
+/**
+ * XdpSpawnPool
+ *
+ * A pool of long-lived sandboxed worker processes.
+ *
+ * Creating a new sandbox with [method@Portal.spawn] is expensive compared
+ * to the run time of short jobs. A [class@SpawnPool] keeps a number of
+ * worker processes running and hands jobs to idle ones, so that the cost
+ * of creating a sandbox is only paid when the pool grows.
+ *
+ * Each worker gets one end of a stream socket as file descriptor
+ * `worker_fd`. Jobs and results are exchanged over it as frames made of
+ * a 32-bit big-endian length followed by that many bytes of payload. A
+ * worker reads a request frame, writes exactly one response frame, and
+ * repeats until it reads end-of-file, at which point it should exit.
+ *
+ * The pool grows up to its maximum size while jobs are waiting, and
+ * shrinks back to its minimum size when workers stay idle. Workers can
+ * also be replaced after a number of jobs, to limit the impact of leaks
+ * in the worker.
+ *
+ * When workers fail to start, the pool waits increasingly long before
+ * trying again. After several failures in a row it gives up, and the
+ * queued jobs fail with the error of the last attempt, unless a running
+ * worker is left to handle them. The next job submitted to the pool
+ * starts over.
+ */
+
+/* Guard against allocating absurd amounts for a corrupt frame */
+#define MAX_FRAME_SIZE (256 * 1024 * 1024)
+
+/* Consecutive failures to start a worker after which the pool gives up */
+#define MAX_SPAWN_FAILURES 5
+
+/* Delay before starting a worker again after a failure, doubled for
+ * every further failure, in milliseconds */
+#define SPAWN_BACKOFF_MIN 100
+#define SPAWN_BACKOFF_MAX 5000
+
+typedef enum {
+  WORKER_STARTING,
+  WORKER_IDLE,
+  WORKER_BUSY,
+} WorkerState;
+
+typedef struct {
+  GTask *task;
+  GBytes *request;
+  gulong cancelled_id;
+} Job;
+
+typedef struct {
+  XdpSpawnPool *pool; /* NULL once retired */
+  WorkerState state;
+  pid_t pid;
+  GIOStream *stream;
+  guint n_jobs;
+  guint idle_timeout_id;
+  Job *job;
+  guint8 header[4];
+  guint8 *response;
+  gsize response_size;
+} Worker;
+
+struct _XdpSpawnPool {
+  GObject parent_instance;
+
+  XdpPortal *portal;
+  char *cwd;
+  char **argv;
+  char **env;
+  XdpSpawnFlags flags;
+  char **sandbox_expose;
+  char **sandbox_expose_ro;
+  int worker_fd;
+
+  guint min_workers;
+  guint max_workers;
+  guint idle_timeout;
+  guint max_jobs;
+
+  GPtrArray *workers;
+  GQueue queue; /* Job */
+  guint n_spawned;
+
+  guint n_spawn_failures;
+  guint spawn_backoff_id;
+  gboolean spawn_given_up;
+  GError *spawn_error;
+};
+
+G_DEFINE_TYPE (XdpSpawnPool, xdp_spawn_pool, G_TYPE_OBJECT)
+
+static void dispatch_jobs (XdpSpawnPool *pool);
+
+static void
+job_free (Job *job)
+{
+  g_clear_signal_handler (&job->cancelled_id, g_task_get_cancellable (job->task));
+  g_object_unref (job->task);
+  g_bytes_unref (job->request);
+  g_free (job);
+}
+
+static void
+worker_clear (Worker *worker)
+{
+  g_clear_handle_id (&worker->idle_timeout_id, g_source_remove);
+  g_clear_object (&worker->stream);
+  g_clear_pointer (&worker->response, g_free);
+  g_assert (worker->job == NULL);
+}
+
+static Worker *
+worker_ref (Worker *worker)
+{
+  return g_rc_box_acquire (worker);
+}
+
+static void
+worker_unref (Worker *worker)
+{
+  g_rc_box_release_full (worker, (GDestroyNotify) worker_clear);
+}
+
+static void
+fail_job (Job    *job,
+          GError *error)
+{
+  g_task_return_error (job->task, error);
+  job_free (job);
+}
+
+/* Takes the worker out of the pool. Closing our end of the socket makes
+ * the worker see end-of-file and exit. */
+static void
+retire_worker (Worker *worker,
+               GError *error)
+{
+  XdpSpawnPool *pool = worker->pool;
+
+  if (pool == NULL)
+    {
+      g_clear_error (&error);
+      return;
+    }
+
+  worker->pool = NULL;
+  g_clear_handle_id (&worker->idle_timeout_id, g_source_remove);
+
+  if (worker->stream)
+    g_io_stream_close (worker->stream, NULL, NULL);
+
+  if (worker->job)
+    {
+      if (error == NULL)
+        error = g_error_new (G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE, "Worker exited during the job");
+      fail_job (g_steal_pointer (&worker->job), error);
+    }
+  else
+    g_clear_error (&error);
+
+  g_ptr_array_remove_fast (pool->workers, worker);
+
+  dispatch_jobs (pool);
+}
+
+static gboolean
+idle_timeout_cb (gpointer data)
+{
+  Worker *worker = data;
+  XdpSpawnPool *pool = worker->pool;
+
+  worker->idle_timeout_id = 0;
+
+  if (worker->state == WORKER_IDLE && pool->workers->len > pool->min_workers)
+    retire_worker (worker, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+set_worker_idle (Worker *worker)
+{
+  XdpSpawnPool *pool = worker->pool;
+
+  worker->state = WORKER_IDLE;
+
+  if (pool->idle_timeout > 0 && pool->workers->len > pool->min_workers)
+    worker->idle_timeout_id = g_timeout_add_seconds (pool->idle_timeout, idle_timeout_cb, worker);
+}
+
+static void
+response_read (GObject      *object,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  Worker *worker = data;
+  GError *error = NULL;
+  gsize bytes_read;
+  Job *job;
+
+  if (!g_input_stream_read_all_finish (G_INPUT_STREAM (object), result, &bytes_read, &error) ||
+      bytes_read < worker->response_size)
+    {
+      if (!error)
+        error = g_error_new (G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE, "Worker closed the connection");
+      retire_worker (worker, error);
+      worker_unref (worker);
+      return;
+    }
+
+  if (worker->pool == NULL)
+    {
+      worker_unref (worker);
+      return;
+    }
+
+  job = g_steal_pointer (&worker->job);
+  g_task_return_pointer (job->task,
+                         g_bytes_new_take (g_steal_pointer (&worker->response), worker->response_size),
+                         (GDestroyNotify) g_bytes_unref);
+  job_free (job);
+
+  worker->n_jobs++;
+  if (worker->pool->max_jobs > 0 && worker->n_jobs >= worker->pool->max_jobs)
+    retire_worker (worker, NULL);
+  else
+    {
+      set_worker_idle (worker);
+      dispatch_jobs (worker->pool);
+    }
+
+  worker_unref (worker);
+}
+
+static void
+header_read (GObject      *object,
+             GAsyncResult *result,
+             gpointer      data)
+{
+  Worker *worker = data;
+  GError *error = NULL;
+  gsize bytes_read;
+  guint32 length;
+
+  if (!g_input_stream_read_all_finish (G_INPUT_STREAM (object), result, &bytes_read, &error) ||
+      bytes_read < sizeof (worker->header))
+    {
+      if (!error)
+        error = g_error_new (G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE, "Worker closed the connection");
+      retire_worker (worker, error);
+      worker_unref (worker);
+      return;
+    }
+
+  if (worker->pool == NULL)
+    {
+      worker_unref (worker);
+      return;
+    }
+
+  memcpy (&length, worker->header, sizeof (length));
+  worker->response_size = GUINT32_FROM_BE (length);
+  if (worker->response_size > MAX_FRAME_SIZE)
+    {
+      retire_worker (worker, g_error_new (G_IO_ERROR, G_IO_ERROR_MESSAGE_TOO_LARGE,
+                                          "Worker response of %" G_GSIZE_FORMAT " bytes is too large",
+                                          worker->response_size));
+      worker_unref (worker);
+      return;
+    }
+
+  worker->response = g_malloc (MAX (worker->response_size, 1));
+  g_input_stream_read_all_async (g_io_stream_get_input_stream (worker->stream),
+                                 worker->response,
+                                 worker->response_size,
+                                 G_PRIORITY_DEFAULT,
+                                 g_task_get_cancellable (worker->job->task),
+                                 response_read,
+                                 worker);
+}
+
+static void
+request_written (GObject      *object,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  Worker *worker = data;
+  GError *error = NULL;
+
+  if (!g_output_stream_writev_all_finish (G_OUTPUT_STREAM (object), result, NULL, &error))
+    {
+      retire_worker (worker, error);
+      worker_unref (worker);
+      return;
+    }
+
+  if (worker->pool == NULL)
+    {
+      worker_unref (worker);
+      return;
+    }
+
+  g_input_stream_read_all_async (g_io_stream_get_input_stream (worker->stream),
+                                 worker->header,
+                                 sizeof (worker->header),
+                                 G_PRIORITY_DEFAULT,
+                                 g_task_get_cancellable (worker->job->task),
+                                 header_read,
+                                 worker);
+}
+
+static void
+start_job (Worker *worker,
+           Job    *job)
+{
+  GOutputVector vectors[2];
+  guint32 length;
+  gsize size;
+
+  g_clear_handle_id (&worker->idle_timeout_id, g_source_remove);
+  g_clear_signal_handler (&job->cancelled_id, g_task_get_cancellable (job->task));
+
+  worker->state = WORKER_BUSY;
+  worker->job = job;
+
+  vectors[1].buffer = g_bytes_get_data (job->request, &size);
+  vectors[1].size = size;
+  length = GUINT32_TO_BE ((guint32) size);
+  memcpy (worker->header, &length, sizeof (length));
+  vectors[0].buffer = worker->header;
+  vectors[0].size = sizeof (worker->header);
+
+  /* A job cancelled in the middle of the exchange leaves the worker in
+   * an unknown state, so it gets retired through the error path. */
+  g_output_stream_writev_all_async (g_io_stream_get_output_stream (worker->stream),
+                                    vectors, G_N_ELEMENTS (vectors),
+                                    G_PRIORITY_DEFAULT,
+                                    g_task_get_cancellable (job->task),
+                                    request_written,
+                                    worker_ref (worker));
+}
+
+static void
+worker_exited (GObject      *object,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  Worker *worker = data;
+  g_autoptr(GError) error = NULL;
+  guint exit_status = 0;
+
+  if (xdp_portal_spawn_wait_finish (XDP_PORTAL (object), result, &exit_status, &error))
+    retire_worker (worker, g_error_new (G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE,
+                                        "Worker exited with status %u",
+                                        exit_status));
+  else
+    retire_worker (worker, g_steal_pointer (&error));
+
+  worker_unref (worker);
+}
+
+static gboolean
+spawn_backoff_cb (gpointer data)
+{
+  XdpSpawnPool *pool = data;
+
+  pool->spawn_backoff_id = 0;
+  dispatch_jobs (pool);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+record_spawn_failure (XdpSpawnPool *pool,
+                      GError       *error)
+{
+  guint delay;
+
+  g_clear_error (&pool->spawn_error);
+  pool->spawn_error = error;
+  pool->n_spawn_failures++;
+
+  if (pool->n_spawn_failures >= MAX_SPAWN_FAILURES)
+    {
+      pool->spawn_given_up = TRUE;
+      return;
+    }
+
+  delay = MIN (SPAWN_BACKOFF_MIN << (pool->n_spawn_failures - 1), SPAWN_BACKOFF_MAX);
+  g_clear_handle_id (&pool->spawn_backoff_id, g_source_remove);
+  pool->spawn_backoff_id = g_timeout_add (delay, spawn_backoff_cb, pool);
+}
+
+static void
+fail_queued_jobs (XdpSpawnPool *pool)
+{
+  Job *job;
+
+  while ((job = g_queue_pop_head (&pool->queue)) != NULL)
+    fail_job (job, g_error_copy (pool->spawn_error));
+}
+
+static void
+worker_spawned (GObject      *object,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  Worker *worker = data;
+  GError *error = NULL;
+  gssize pid;
+
+  pid = g_task_propagate_int (G_TASK (result), &error);
+  if (error)
+    {
+      g_autoptr(XdpSpawnPool) pool = NULL;
+
+      g_warning ("Failed to spawn pool worker: %s", error->message);
+
+      if (worker->pool == NULL)
+        {
+          g_clear_error (&error);
+          worker_unref (worker);
+          return;
+        }
+
+      /* Failing the last job may drop the last reference on the pool */
+      pool = g_object_ref (worker->pool);
+
+      /* Record the failure first, so that retiring the worker doesn't
+       * start a replacement right away */
+      record_spawn_failure (pool, error);
+      retire_worker (worker, NULL);
+
+      if (pool->spawn_given_up && pool->workers->len == 0)
+        fail_queued_jobs (pool);
+
+      worker_unref (worker);
+      return;
+    }
+
+  worker->pid = pid;
+
+  /* Our end of the socket is already closed if the worker was retired
+   * while starting, so the worker exits on its own. */
+  if (worker->pool == NULL)
+    {
+      worker_unref (worker);
+      return;
+    }
+
+  worker->pool->n_spawned++;
+  worker->pool->n_spawn_failures = 0;
+  worker->pool->spawn_given_up = FALSE;
+  g_clear_error (&worker->pool->spawn_error);
+  xdp_portal_spawn_wait (worker->pool->portal, pid, NULL,
+                         worker_exited, worker_ref (worker));
+
+  set_worker_idle (worker);
+  dispatch_jobs (worker->pool);
+
+  worker_unref (worker);
+}
+
+static void
+spawn_worker (XdpSpawnPool *pool)
+{
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  g_autoptr(GSocket) socket = NULL;
+  g_autoptr(GTask) task = NULL;
+  g_autoptr(GError) error = NULL;
+  Worker *worker;
+  int fds[2];
+
+  if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1)
+    {
+      g_warning ("Failed to create pool worker socket: %s", g_strerror (errno));
+      return;
+    }
+
+  fd_list = g_unix_fd_list_new ();
+  if (g_unix_fd_list_append (fd_list, fds[1], &error) == -1)
+    {
+      g_warning ("Failed to create pool worker socket: %s", error->message);
+      close (fds[0]);
+      close (fds[1]);
+      return;
+    }
+  close (fds[1]);
+
+  socket = g_socket_new_from_fd (fds[0], &error);
+  if (!socket)
+    {
+      g_warning ("Failed to create pool worker socket: %s", error->message);
+      close (fds[0]);
+      return;
+    }
+
+  worker = g_rc_box_new0 (Worker);
+  worker->pool = pool;
+  worker->state = WORKER_STARTING;
+  worker->stream = G_IO_STREAM (g_socket_connection_factory_create_connection (socket));
+  g_ptr_array_add (pool->workers, worker);
+
+  task = g_task_new (NULL, NULL, worker_spawned, worker_ref (worker));
+  _xdp_portal_spawn_full (pool->portal,
+                          pool->cwd,
+                          (const char * const *) pool->argv,
+                          fd_list,
+                          &pool->worker_fd,
+                          (const char * const *) pool->env,
+                          pool->flags,
+                          (const char * const *) pool->sandbox_expose,
+                          (const char * const *) pool->sandbox_expose_ro,
+                          NULL,
+                          task);
+}
+
+static void
+dispatch_jobs (XdpSpawnPool *pool)
+{
+  guint n_starting = 0;
+  guint i;
+
+  for (i = 0; i < pool->workers->len && !g_queue_is_empty (&pool->queue); i++)
+    {
+      Worker *worker = g_ptr_array_index (pool->workers, i);
+
+      if (worker->state == WORKER_IDLE)
+        start_job (worker, g_queue_pop_head (&pool->queue));
+    }
+
+  /* Wait for the backoff after a failed start before trying again */
+  if (pool->spawn_backoff_id != 0 || pool->spawn_given_up)
+    return;
+
+  for (i = 0; i < pool->workers->len; i++)
+    {
+      Worker *worker = g_ptr_array_index (pool->workers, i);
+
+      if (worker->state == WORKER_STARTING)
+        n_starting++;
+    }
+
+  /* Grow while jobs are waiting for workers that don't exist yet */
+  while (g_queue_get_length (&pool->queue) > n_starting &&
+         pool->workers->len < pool->max_workers)
+    {
+      guint n_workers = pool->workers->len;
+
+      spawn_worker (pool);
+      if (pool->workers->len == n_workers)
+        break;
+      n_starting++;
+    }
+
+  while (pool->workers->len < pool->min_workers)
+    {
+      guint n_workers = pool->workers->len;
+
+      spawn_worker (pool);
+      if (pool->workers->len == n_workers)
+        break;
+    }
+}
+
+static void
+job_cancelled_cb (GCancellable *cancellable,
+                  gpointer      data)
+{
+  Job *job = data;
+  XdpSpawnPool *pool = g_task_get_source_object (job->task);
+
+  /* Only called while the job is still queued */
+  g_queue_remove (&pool->queue, job);
+  fail_job (job, g_error_new (G_IO_ERROR, G_IO_ERROR_CANCELLED, "Job canceled by caller"));
+}
+
+static void
+xdp_spawn_pool_dispose (GObject *object)
+{
+  XdpSpawnPool *pool = XDP_SPAWN_POOL (object);
+
+  /* Jobs keep the pool alive, so only idle or starting workers are left */
+  g_assert (g_queue_is_empty (&pool->queue));
+
+  /* Don't let retiring the workers spawn replacements */
+  pool->min_workers = 0;
+  g_clear_handle_id (&pool->spawn_backoff_id, g_source_remove);
+
+  while (pool->workers && pool->workers->len > 0)
+    retire_worker (g_ptr_array_index (pool->workers, 0), NULL);
+
+  G_OBJECT_CLASS (xdp_spawn_pool_parent_class)->dispose (object);
+}
+
+static void
+xdp_spawn_pool_finalize (GObject *object)
+{
+  XdpSpawnPool *pool = XDP_SPAWN_POOL (object);
+
+  g_clear_pointer (&pool->workers, g_ptr_array_unref);
+  g_clear_error (&pool->spawn_error);
+  g_clear_object (&pool->portal);
+  g_free (pool->cwd);
+  g_strfreev (pool->argv);
+  g_strfreev (pool->env);
+  g_strfreev (pool->sandbox_expose);
+  g_strfreev (pool->sandbox_expose_ro);
+
+  G_OBJECT_CLASS (xdp_spawn_pool_parent_class)->finalize (object);
+}
+
+static void
+xdp_spawn_pool_class_init (XdpSpawnPoolClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = xdp_spawn_pool_dispose;
+  object_class->finalize = xdp_spawn_pool_finalize;
+}
+
+static void
+xdp_spawn_pool_init (XdpSpawnPool *pool)
+{
+  pool->workers = g_ptr_array_new_with_free_func ((GDestroyNotify) worker_unref);
+  g_queue_init (&pool->queue);
+
+  pool->min_workers = 1;
+  pool->max_workers = MAX (g_get_num_processors (), 1);
+  pool->idle_timeout = 30;
+}
+
+/**
+ * xdp_spawn_pool_new:
+ * @portal: a [class@Portal]
+ * @cwd: the cwd for the workers
+ * @argv: (array zero-terminated): the argv for the workers
+ * @env: (array zero-terminated) (nullable): an array of KEY=VALUE environment settings, or `NULL`
+ * @flags: flags influencing the spawn operation
+ * @sandbox_expose: (array zero-terminated) (nullable): paths to expose rw in the sandboxes, or `NULL`
+ * @sandbox_expose_ro: (array zero-terminated) (nullable): paths to expose ro in the sandboxes, or `NULL`
+ * @worker_fd: the file descriptor number the workers receive their socket as
+ *
+ * Creates a new [class@SpawnPool] and starts its first worker.
+ *
+ * By default, the pool keeps one worker running, grows up to one worker
+ * per CPU, retires extra workers after 30 seconds of idleness, and never
+ * replaces workers because of their job count. Use
+ * [method@SpawnPool.set_limits] to change that.
+ *
+ * Returns: (transfer full): the new [class@SpawnPool]
+ */
+XdpSpawnPool *
+xdp_spawn_pool_new (XdpPortal          *portal,
+                    const char         *cwd,
+                    const char * const *argv,
+                    const char * const *env,
+                    XdpSpawnFlags       flags,
+                    const char * const *sandbox_expose,
+                    const char * const *sandbox_expose_ro,
+                    int                 worker_fd)
+{
+  XdpSpawnPool *pool;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (argv != NULL && argv[0] != NULL, NULL);
+  g_return_val_if_fail (worker_fd > STDERR_FILENO, NULL);
+
+  pool = g_object_new (XDP_TYPE_SPAWN_POOL, NULL);
+  pool->portal = g_object_ref (portal);
+  pool->cwd = g_strdup (cwd);
+  pool->argv = g_strdupv ((char **) argv);
+  pool->env = g_strdupv ((char **) env);
+  pool->flags = flags;
+  pool->sandbox_expose = g_strdupv ((char **) sandbox_expose);
+  pool->sandbox_expose_ro = g_strdupv ((char **) sandbox_expose_ro);
+  pool->worker_fd = worker_fd;
+
+  dispatch_jobs (pool);
+
+  return pool;
+}
+
+/**
+ * xdp_spawn_pool_set_limits:
+ * @pool: a [class@SpawnPool]
+ * @min_workers: the number of workers to keep running at all times
+ * @max_workers: the largest number of workers to run
+ * @idle_timeout: seconds after which an idle worker beyond @min_workers
+ *   is retired, or 0 to never retire idle workers
+ * @max_jobs: number of jobs after which a worker is replaced, or 0
+ *
+ * Sets the size limits of the pool.
+ */
+void
+xdp_spawn_pool_set_limits (XdpSpawnPool *pool,
+                           guint         min_workers,
+                           guint         max_workers,
+                           guint         idle_timeout,
+                           guint         max_jobs)
+{
+  g_return_if_fail (XDP_IS_SPAWN_POOL (pool));
+  g_return_if_fail (max_workers > 0);
+  g_return_if_fail (min_workers <= max_workers);
+
+  pool->min_workers = min_workers;
+  pool->max_workers = max_workers;
+  pool->idle_timeout = idle_timeout;
+  pool->max_jobs = max_jobs;
+
+  dispatch_jobs (pool);
+}
+
+/**
+ * xdp_spawn_pool_run:
+ * @pool: a [class@SpawnPool]
+ * @request: the request to send to a worker
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the job is done
+ * @data: data to pass to @callback
+ *
+ * Sends @request to an idle worker, and waits for its response.
+ *
+ * If no worker is idle, the job is queued until one becomes available.
+ * Jobs that are cancelled while a worker handles them cause that worker
+ * to be replaced. If no worker can be started, the job fails with the
+ * error of the last attempt.
+ */
+void
+xdp_spawn_pool_run (XdpSpawnPool        *pool,
+                    GBytes              *request,
+                    GCancellable        *cancellable,
+                    GAsyncReadyCallback  callback,
+                    gpointer             data)
+{
+  Job *job;
+
+  g_return_if_fail (XDP_IS_SPAWN_POOL (pool));
+  g_return_if_fail (request != NULL);
+  g_return_if_fail (g_bytes_get_size (request) <= MAX_FRAME_SIZE);
+
+  job = g_new0 (Job, 1);
+  job->task = g_task_new (pool, cancellable, callback, data);
+  g_task_set_source_tag (job->task, xdp_spawn_pool_run);
+  job->request = g_bytes_ref (request);
+
+  if (g_task_return_error_if_cancelled (job->task))
+    {
+      job_free (job);
+      return;
+    }
+
+  if (cancellable)
+    job->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (job_cancelled_cb), job);
+
+  /* Give starting workers another chance after the pool gave up */
+  if (pool->spawn_given_up)
+    {
+      pool->spawn_given_up = FALSE;
+      pool->n_spawn_failures = 0;
+    }
+
+  g_queue_push_tail (&pool->queue, job);
+  dispatch_jobs (pool);
+}
+
+/**
+ * xdp_spawn_pool_run_finish:
+ * @pool: a [class@SpawnPool]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes a job.
+ *
+ * Returns: (transfer full): the response of the worker, or `NULL`
+ */
+GBytes *
+xdp_spawn_pool_run_finish (XdpSpawnPool  *pool,
+                           GAsyncResult  *result,
+                           GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_SPAWN_POOL (pool), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, pool), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_spawn_pool_run, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * xdp_spawn_pool_get_stats:
+ * @pool: a [class@SpawnPool]
+ * @n_workers: (out) (optional): return location for the number of workers
+ * @n_busy: (out) (optional): return location for the number of busy workers
+ * @n_queued: (out) (optional): return location for the number of queued jobs
+ * @n_spawned: (out) (optional): return location for the number of workers
+ *   spawned over the lifetime of the pool
+ *
+ * Gets statistics about the pool.
+ */
+void
+xdp_spawn_pool_get_stats (XdpSpawnPool *pool,
+                          guint        *n_workers,
+                          guint        *n_busy,
+                          guint        *n_queued,
+                          guint        *n_spawned)
+{
+  guint busy = 0;
+  guint i;
+
+  g_return_if_fail (XDP_IS_SPAWN_POOL (pool));
+
+  for (i = 0; i < pool->workers->len; i++)
+    {
+      Worker *worker = g_ptr_array_index (pool->workers, i);
+
+      if (worker->state == WORKER_BUSY)
+        busy++;
+    }
+
+  if (n_workers)
+    *n_workers = pool->workers->len;
+  if (n_busy)
+    *n_busy = busy;
+  if (n_queued)
+    *n_queued = g_queue_get_length (&pool->queue);
+  if (n_spawned)
+    *n_spawned = pool->n_spawned;
+}
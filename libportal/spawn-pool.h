@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/types.h>
+#include <libportal/spawn.h>
+
+G_BEGIN_DECLS
+
+#define XDP_TYPE_SPAWN_POOL (xdp_spawn_pool_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpSpawnPool, xdp_spawn_pool, XDP, SPAWN_POOL, GObject)
+
+XDP_PUBLIC
+XdpSpawnPool * xdp_spawn_pool_new         (XdpPortal            *portal,
+                                           const char           *cwd,
+                                           const char * const   *argv,
+                                           const char * const   *env,
+                                           XdpSpawnFlags         flags,
+                                           const char * const   *sandbox_expose,
+                                           const char * const   *sandbox_expose_ro,
+                                           int                   worker_fd);
+
+XDP_PUBLIC
+void           xdp_spawn_pool_set_limits  (XdpSpawnPool         *pool,
+                                           guint                 min_workers,
+                                           guint                 max_workers,
+                                           guint                 idle_timeout,
+                                           guint                 max_jobs);
+
+XDP_PUBLIC
+void           xdp_spawn_pool_run         (XdpSpawnPool         *pool,
+                                           GBytes               *request,
+                                           GCancellable         *cancellable,
+                                           GAsyncReadyCallback   callback,
+                                           gpointer              data);
+
+XDP_PUBLIC
+GBytes *       xdp_spawn_pool_run_finish  (XdpSpawnPool         *pool,
+                                           GAsyncResult         *result,
+                                           GError              **error);
+
+XDP_PUBLIC
+void           xdp_spawn_pool_get_stats   (XdpSpawnPool         *pool,
+                                           guint                *n_workers,
+                                           guint                *n_busy,
+                                           guint                *n_queued,
+                                           guint                *n_spawned);
+
+G_END_DECLS
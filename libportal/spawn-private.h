@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <gio/gunixfdlist.h>
+#include <libportal/spawn.h>
+#include <libportal/subprocess.h>
+
+G_BEGIN_DECLS
+
+void _xdp_portal_spawn_full (XdpPortal          *portal,
+                             const char         *cwd,
+                             const char * const *argv,
+                             GUnixFDList        *fd_list,
+                             const int          *map_to,
+                             const char * const *env,
+                             XdpSpawnFlags       flags,
+                             const char * const *sandbox_expose,
+                             const char * const *sandbox_expose_ro,
+                             XdpSubprocess      *subprocess,
+                             GTask              *task);
+
+G_END_DECLS
@@ -30,7 +30,20 @@
 #include <glib/gstdio.h>
 #include <gio/gunixfdlist.h>
 
+#include "batch-private.h"
 #include "portal-private.h"
+#include "spawn-private.h"
+#include "subprocess-private.h"
+
+/* Number of exit statuses remembered for processes nobody waited for yet */
+#define MAX_SPAWN_EXIT_STATUSES 128
+
+typedef struct {
+  XdpPortal *portal;
+  GTask *task;
+  pid_t pid;
+  gulong cancelled_id;
+} SpawnWaiter;
 
 typedef struct {
   XdpPortal *portal;
@@ -38,13 +51,14 @@ typedef struct {
 
   char *cwd;
   char **argv;
-  int *fds;
+  GUnixFDList *fd_list;
   int *map_to;
-  int n_fds;
   char **env;
   char **sandbox_expose;
   char **sandbox_expose_ro;
   XdpSpawnFlags flags;
+
+  XdpSubprocess *subprocess;
 } SpawnCall;
 
 static void
@@ -54,13 +68,29 @@ spawn_call_free (SpawnCall *call)
   g_object_unref (call->task);
 
   g_free (call->cwd);
+  g_strfreev (call->argv);
+  g_clear_object (&call->fd_list);
+  g_free (call->map_to);
   g_strfreev (call->env);
   g_strfreev (call->sandbox_expose);
   g_strfreev (call->sandbox_expose_ro);
+  g_clear_object (&call->subprocess);
 
   g_free (call);
 }
 
+static void
+track_spawned_pid (XdpPortal *portal,
+                   pid_t      pid)
+{
+  /* A remembered exit status for this pid belongs to an earlier process
+   * that had the same pid */
+  if (g_hash_table_remove (portal->spawn_exit_statuses, GUINT_TO_POINTER (pid)))
+    g_queue_remove (&portal->spawn_exit_order, GUINT_TO_POINTER (pid));
+
+  g_hash_table_add (portal->spawn_pids, GUINT_TO_POINTER (pid));
+}
+
 static void
 spawned (GObject      *bus,
          GAsyncResult *result,
@@ -79,12 +109,48 @@ spawned (GObject      *bus,
       pid_t pid;
 
       g_variant_get (ret, "(u)", &pid);
-      g_task_return_int (call->task, (gssize)pid);
+      track_spawned_pid (call->portal, pid);
+
+      if (call->subprocess)
+        {
+          /* The portal keeps the subprocess alive until it exits, like
+           * GSubprocess, so the exit status is always available on it */
+          g_hash_table_insert (call->portal->spawn_subprocesses,
+                               GUINT_TO_POINTER (pid), g_object_ref (call->subprocess));
+          _xdp_subprocess_started (call->subprocess, pid);
+          g_task_return_pointer (call->task, g_object_ref (call->subprocess), g_object_unref);
+        }
+      else
+        g_task_return_int (call->task, (gssize)pid);
     }
 
   spawn_call_free (call);
 }
 
+static void
+spawn_waiter_free (SpawnWaiter *waiter)
+{
+  g_object_unref (waiter->task);
+  g_free (waiter);
+}
+
+static void
+spawn_wait_cancelled_cb (GCancellable *cancellable,
+                         gpointer      data)
+{
+  SpawnWaiter *waiter = data;
+  GPtrArray *waiters;
+
+  waiters = g_hash_table_lookup (waiter->portal->spawn_waiters, GUINT_TO_POINTER (waiter->pid));
+  g_ptr_array_remove_fast (waiters, waiter);
+  if (waiters->len == 0)
+    g_hash_table_remove (waiter->portal->spawn_waiters, GUINT_TO_POINTER (waiter->pid));
+
+  g_clear_signal_handler (&waiter->cancelled_id, cancellable);
+  g_task_return_new_error (waiter->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Spawn wait canceled by caller");
+  spawn_waiter_free (waiter);
+}
+
 static void
 spawn_exited (GDBusConnection *bus,
               const char *sender_name,
@@ -95,10 +161,53 @@ spawn_exited (GDBusConnection *bus,
               gpointer data)
 {
   XdpPortal *portal = data;
+  GPtrArray *waiters;
+  XdpSubprocess *subprocess;
   guint pid;
   guint exit_status;
 
   g_variant_get (parameters, "(uu)", &pid, &exit_status);
+
+  if (g_hash_table_steal_extended (portal->spawn_subprocesses, GUINT_TO_POINTER (pid),
+                                   NULL, (gpointer *) &subprocess))
+    {
+      _xdp_subprocess_exited (subprocess, exit_status);
+      g_object_unref (subprocess);
+    }
+
+  if (g_hash_table_remove (portal->spawn_pids, GUINT_TO_POINTER (pid)))
+    {
+      waiters = g_hash_table_lookup (portal->spawn_waiters, GUINT_TO_POINTER (pid));
+      if (waiters)
+        {
+          g_autoptr(GPtrArray) resolved = NULL;
+          guint i;
+
+          g_hash_table_steal_extended (portal->spawn_waiters, GUINT_TO_POINTER (pid),
+                                       NULL, (gpointer *) &resolved);
+
+          for (i = 0; i < resolved->len; i++)
+            {
+              SpawnWaiter *waiter = g_ptr_array_index (resolved, i);
+
+              g_clear_signal_handler (&waiter->cancelled_id, g_task_get_cancellable (waiter->task));
+              g_task_return_int (waiter->task, exit_status);
+              spawn_waiter_free (waiter);
+            }
+        }
+      else
+        {
+          /* Nobody is waiting yet; keep the status around for a while */
+          g_hash_table_insert (portal->spawn_exit_statuses,
+                               GUINT_TO_POINTER (pid), GUINT_TO_POINTER (exit_status));
+          g_queue_push_tail (&portal->spawn_exit_order, GUINT_TO_POINTER (pid));
+
+          if (g_queue_get_length (&portal->spawn_exit_order) > MAX_SPAWN_EXIT_STATUSES)
+            g_hash_table_remove (portal->spawn_exit_statuses,
+                                 g_queue_pop_head (&portal->spawn_exit_order));
+        }
+    }
+
   g_signal_emit_by_name (portal, "spawn-exited", pid, exit_status);
 }
 
@@ -121,70 +230,111 @@ ensure_spawn_exited_connection (XdpPortal *portal)
     }
 }
 
-void
-do_spawn (SpawnCall *call)
+static GVariant *
+build_env (const char * const *env)
 {
-  g_autoptr(GUnixFDList) fd_list = NULL;
-  GVariantBuilder fds_builder;
   GVariantBuilder env_builder;
-  GVariantBuilder opt_builder;
+  int i;
 
-  ensure_spawn_exited_connection (call->portal);
+  g_variant_builder_init (&env_builder, G_VARIANT_TYPE ("a{ss}"));
+  for (i = 0; env && env[i]; i++)
+    {
+      g_auto(GStrv) s = g_strsplit (env[i], "=", 2);
+      if (s[0] && s[1])
+        g_variant_builder_add (&env_builder, "{ss}", s[0], s[1]);
+    }
 
-  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  return g_variant_builder_end (&env_builder);
+}
 
-  g_variant_builder_init (&fds_builder, G_VARIANT_TYPE ("a{uh}"));
-  if (call->n_fds > 0)
-    {
-      int i;
+static GVariant *
+build_options (const char * const *sandbox_expose,
+               const char * const *sandbox_expose_ro)
+{
+  GVariantBuilder opt_builder;
 
-      fd_list = g_unix_fd_list_new_from_array (call->fds, call->n_fds);
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  if (sandbox_expose)
+    g_variant_builder_add (&opt_builder, "{sv}", "sandbox-expose",
+                           g_variant_new_strv (sandbox_expose, -1));
+  if (sandbox_expose_ro)
+    g_variant_builder_add (&opt_builder, "{sv}", "sandbox-expose-ro",
+                           g_variant_new_strv (sandbox_expose_ro, -1));
+
+  return g_variant_builder_end (&opt_builder);
+}
 
-      for (i = 0; i < call->n_fds; i++)
-        g_variant_builder_add (&fds_builder,"{uh}", call->map_to[i], i);
-    }
+static void
+do_spawn (SpawnCall *call)
+{
+  GVariantBuilder fds_builder;
+  int n_fds;
+  int i;
 
-  g_variant_builder_init (&env_builder, G_VARIANT_TYPE ("a{ss}"));
-  if (call->env != NULL)
-    {
-      int i;
+  ensure_spawn_exited_connection (call->portal);
 
-      for (i = 0; call->env[i]; i++)
-        {
-          g_auto(GStrv) s = g_strsplit (call->env[i], "=", 2);
-          if (s[0] && s[1])
-            g_variant_builder_add (&env_builder, "{ss}", s[0], s[1]);
-        }
-    }
-  g_variant_builder_init (&env_builder, G_VARIANT_TYPE_VARDICT);
-  if (call->sandbox_expose)
-    g_variant_builder_add (&env_builder, "{sv}", "sandbox-expose",
-                           g_variant_new_strv ((const char *const*)call->sandbox_expose, -1));
-  if (call->sandbox_expose_ro)
-    g_variant_builder_add (&env_builder, "{sv}", "sandbox-expose-ro",
-                           g_variant_new_strv ((const char *const*)call->sandbox_expose_ro, -1));
+  g_variant_builder_init (&fds_builder, G_VARIANT_TYPE ("a{uh}"));
+  n_fds = g_unix_fd_list_get_length (call->fd_list);
+  for (i = 0; i < n_fds; i++)
+    g_variant_builder_add (&fds_builder, "{uh}", call->map_to[i], i);
 
   g_dbus_connection_call_with_unix_fd_list (call->portal->bus,
                                             FLATPAK_PORTAL_BUS_NAME,
                                             FLATPAK_PORTAL_OBJECT_PATH,
                                             FLATPAK_PORTAL_INTERFACE,
                                             "Spawn",
-                                            g_variant_new ("(ay^aaya{uh}a{ss}ua{sv})",
+                                            g_variant_new ("(^ay^aaya{uh}@a{ss}u@a{sv})",
                                                            call->cwd,
                                                            call->argv,
-                                                           fds_builder,
-                                                           env_builder,
+                                                           &fds_builder,
+                                                           build_env ((const char * const *) call->env),
                                                            call->flags,
-                                                           opt_builder),
+                                                           build_options ((const char * const *) call->sandbox_expose,
+                                                                          (const char * const *) call->sandbox_expose_ro)),
                                             G_VARIANT_TYPE ("(u)"),
                                             G_DBUS_CALL_FLAGS_NONE,
                                             -1,
-                                            fd_list,
+                                            call->fd_list,
                                             NULL,
                                             spawned,
                                             call);
 }
 
+void
+_xdp_portal_spawn_full (XdpPortal          *portal,
+                        const char         *cwd,
+                        const char * const *argv,
+                        GUnixFDList        *fd_list,
+                        const int          *map_to,
+                        const char * const *env,
+                        XdpSpawnFlags       flags,
+                        const char * const *sandbox_expose,
+                        const char * const *sandbox_expose_ro,
+                        XdpSubprocess      *subprocess,
+                        GTask              *task)
+{
+  SpawnCall *call;
+  int n_fds;
+
+  n_fds = g_unix_fd_list_get_length (fd_list);
+
+  call = g_new0 (SpawnCall, 1);
+  call->portal = g_object_ref (portal);
+  call->cwd = g_strdup (cwd);
+  call->argv = g_strdupv ((char **)argv);
+  call->fd_list = g_object_ref (fd_list);
+  call->map_to = g_memdup2 (map_to, n_fds * sizeof (int));
+  call->env = g_strdupv ((char **)env);
+  call->flags = flags;
+  call->sandbox_expose = g_strdupv ((char **)sandbox_expose);
+  call->sandbox_expose_ro = g_strdupv ((char **)sandbox_expose_ro);
+  if (subprocess)
+    call->subprocess = g_object_ref (subprocess);
+  call->task = g_object_ref (task);
+
+  do_spawn (call);
+}
+
 /**
  * xdp_portal_spawn:
  * @portal: a [class@Portal]
@@ -205,8 +355,11 @@ do_spawn (SpawnCall *call)
  * Creates a new copy of the applications sandbox, and runs
  * a process in, with the given arguments.
  *
+ * Ownership of the fds in @fds is taken, they are closed once the
+ * request is done.
+ *
  * The learn when the spawned process exits, connect to the
- * [signal@Portal::spawn-exited] signal.
+ * [signal@Portal::spawn-exited] signal, or use [method@Portal.spawn_wait].
  */
 void
 xdp_portal_spawn (XdpPortal            *portal,
@@ -223,30 +376,28 @@ xdp_portal_spawn (XdpPortal            *portal,
                   GAsyncReadyCallback   callback,
                   gpointer              data)
 {
-  SpawnCall *call;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  g_autoptr(GTask) task = NULL;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
-  g_return_if_fail ((flags & !(XDP_SPAWN_FLAG_CLEARENV |
+  g_return_if_fail ((flags & ~(XDP_SPAWN_FLAG_CLEARENV |
                                XDP_SPAWN_FLAG_LATEST |
                                XDP_SPAWN_FLAG_SANDBOX |
                                XDP_SPAWN_FLAG_NO_NETWORK |
                                XDP_SPAWN_FLAG_WATCH)) == 0);
+  g_return_if_fail (n_fds == 0 || (fds != NULL && map_to != NULL));
 
-  call = g_new (SpawnCall, 1);
-  call->portal = g_object_ref (portal);
-  call->cwd = g_strdup (cwd);
-  call->argv = g_strdupv ((char **)argv);
-  call->fds = fds;
-  call->map_to = map_to;
-  call->n_fds = n_fds;
-  call->env = g_strdupv ((char **)env);
-  call->flags = flags;
-  call->sandbox_expose = g_strdupv ((char **)sandbox_expose);
-  call->sandbox_expose_ro = g_strdupv ((char **)sandbox_expose_ro);
-  call->task = g_task_new (portal, cancellable, callback, data);
-  g_task_set_source_tag (call->task, xdp_portal_spawn);
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_portal_spawn);
 
-  do_spawn (call);
+  /* The fds are owned by the list from here on, and closed with it */
+  if (n_fds > 0)
+    fd_list = g_unix_fd_list_new_from_array (fds, n_fds);
+  else
+    fd_list = g_unix_fd_list_new ();
+
+  _xdp_portal_spawn_full (portal, cwd, argv, fd_list, map_to, env, flags,
+                          sandbox_expose, sandbox_expose_ro, NULL, task);
 }
 
 /**
@@ -274,6 +425,355 @@ xdp_portal_spawn_finish (XdpPortal     *portal,
   return (pid_t) g_task_propagate_int (G_TASK (result), error);
 }
 
+/**
+ * xdp_portal_spawn_wait:
+ * @portal: a [class@Portal]
+ * @pid: the pid of a process spawned with [method@Portal.spawn]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the process exits
+ * @data: data to pass to @callback
+ *
+ * Waits for a process spawned by [method@Portal.spawn] to exit.
+ *
+ * Unlike the [signal@Portal::spawn-exited] signal, only the callers
+ * waiting for @pid are notified. The exit status of processes that
+ * exit before anyone waits for them is remembered for a while, so it
+ * is safe to call this after the process might already have exited.
+ */
+void
+xdp_portal_spawn_wait (XdpPortal           *portal,
+                       pid_t                pid,
+                       GCancellable        *cancellable,
+                       GAsyncReadyCallback  callback,
+                       gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+  SpawnWaiter *waiter;
+  GPtrArray *waiters;
+  gpointer exit_status;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (pid > 0);
+
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_portal_spawn_wait);
+
+  if (g_hash_table_lookup_extended (portal->spawn_exit_statuses, GUINT_TO_POINTER (pid),
+                                    NULL, &exit_status))
+    {
+      g_task_return_int (task, GPOINTER_TO_UINT (exit_status));
+      return;
+    }
+
+  if (!g_hash_table_contains (portal->spawn_pids, GUINT_TO_POINTER (pid)))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                               "Process %d was not spawned by this portal, or its exit status is no longer known",
+                               pid);
+      return;
+    }
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  waiter = g_new0 (SpawnWaiter, 1);
+  waiter->portal = portal;
+  waiter->pid = pid;
+  waiter->task = g_steal_pointer (&task);
+
+  waiters = g_hash_table_lookup (portal->spawn_waiters, GUINT_TO_POINTER (pid));
+  if (!waiters)
+    {
+      waiters = g_ptr_array_new ();
+      g_hash_table_insert (portal->spawn_waiters, GUINT_TO_POINTER (pid), waiters);
+    }
+  g_ptr_array_add (waiters, waiter);
+
+  if (cancellable)
+    waiter->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (spawn_wait_cancelled_cb), waiter);
+}
+
+/**
+ * xdp_portal_spawn_wait_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @exit_status: (out) (optional): return location for the exit status,
+ *   as returned by waitpid(2)
+ * @error: return location for an error
+ *
+ * Finishes a wait request.
+ *
+ * Returns: `TRUE` if the process exited
+ */
+gboolean
+xdp_portal_spawn_wait_finish (XdpPortal     *portal,
+                              GAsyncResult  *result,
+                              guint         *exit_status,
+                              GError       **error)
+{
+  GError *local_error = NULL;
+  gssize status;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_spawn_wait, FALSE);
+
+  status = g_task_propagate_int (G_TASK (result), &local_error);
+  if (local_error)
+    {
+      g_propagate_error (error, local_error);
+      return FALSE;
+    }
+
+  if (exit_status)
+    *exit_status = (guint) status;
+
+  return TRUE;
+}
+
+typedef struct {
+  XdpPortal *portal;
+  GTask *task;
+  XdpBatch *batch;
+
+  char *cwd;
+  GPtrArray *argvs;
+  XdpSpawnFlags flags;
+  GVariant *fds;
+  GVariant *env;
+  GVariant *options;
+
+  GArray *pids;
+} SpawnManyCall;
+
+typedef struct {
+  SpawnManyCall *call;
+  guint index;
+} SpawnManyJob;
+
+typedef struct {
+  GArray *pids;
+  GPtrArray *errors;
+} SpawnManyResult;
+
+static void
+spawn_many_result_free (SpawnManyResult *result)
+{
+  g_clear_pointer (&result->pids, g_array_unref);
+  g_clear_pointer (&result->errors, g_ptr_array_unref);
+  g_free (result);
+}
+
+static void
+spawn_many_call_free (SpawnManyCall *call)
+{
+  g_object_unref (call->portal);
+  g_object_unref (call->task);
+
+  g_free (call->cwd);
+  g_ptr_array_unref (call->argvs);
+  g_variant_unref (call->fds);
+  g_variant_unref (call->env);
+  g_variant_unref (call->options);
+  g_clear_pointer (&call->pids, g_array_unref);
+
+  g_free (call);
+}
+
+static void
+spawn_many_returned (GObject      *object,
+                     GAsyncResult *result,
+                     gpointer      data)
+{
+  SpawnManyJob *job = data;
+  SpawnManyCall *call = job->call;
+  guint index = job->index;
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+
+  g_free (job);
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (ret)
+    {
+      guint pid;
+
+      g_variant_get (ret, "(u)", &pid);
+      track_spawned_pid (call->portal, pid);
+      g_array_index (call->pids, pid_t, index) = pid;
+    }
+
+  _xdp_batch_entry_done (call->batch, index, error);
+}
+
+static gboolean
+spawn_many_send (XdpBatch  *batch,
+                 guint      index,
+                 gpointer   data,
+                 GError   **error)
+{
+  SpawnManyCall *call = data;
+  SpawnManyJob *job;
+
+  job = g_new0 (SpawnManyJob, 1);
+  job->call = call;
+  job->index = index;
+
+  /* Spawn calls are not cancelled once sent; the portal may already
+   * have started the process, and its pid must not get lost */
+  g_dbus_connection_call (call->portal->bus,
+                          FLATPAK_PORTAL_BUS_NAME,
+                          FLATPAK_PORTAL_OBJECT_PATH,
+                          FLATPAK_PORTAL_INTERFACE,
+                          "Spawn",
+                          g_variant_new ("(^ay^aay@a{uh}@a{ss}u@a{sv})",
+                                         call->cwd,
+                                         g_ptr_array_index (call->argvs, index),
+                                         call->fds,
+                                         call->env,
+                                         call->flags,
+                                         call->options),
+                          G_VARIANT_TYPE ("(u)"),
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          spawn_many_returned,
+                          job);
+
+  return TRUE;
+}
+
+static void
+spawn_many_done (GPtrArray *errors,
+                 gpointer   data)
+{
+  SpawnManyCall *call = data;
+  SpawnManyResult *result;
+
+  result = g_new0 (SpawnManyResult, 1);
+  result->pids = g_steal_pointer (&call->pids);
+  result->errors = errors;
+
+  g_task_return_pointer (call->task, result, (GDestroyNotify) spawn_many_result_free);
+  spawn_many_call_free (call);
+}
+
+/**
+ * xdp_portal_spawn_many:
+ * @portal: a [class@Portal]
+ * @cwd: the cwd for the new processes
+ * @argvs: (element-type GStrv): the argv for each new process
+ * @env: (array zero-terminated) (nullable): an array of KEY=VALUE environment settings, or `NULL`
+ * @flags: flags influencing the spawn operation
+ * @sandbox_expose: (array zero-terminated) (nullable): paths to expose rw in the new sandboxes, or `NULL`
+ * @sandbox_expose_ro: (array zero-terminated) (nullable): paths to expose ro in the new sandboxes, or `NULL`
+ * @max_in_flight: the largest number of Spawn calls to have pending at once, or 0
+ *   for a default
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Spawns one process for each element of @argvs, like calling
+ * [method@Portal.spawn] repeatedly with the same @cwd, @env, @flags and
+ * sandbox paths.
+ *
+ * The shared arguments are serialized once, and at most @max_in_flight
+ * spawn requests are sent to the portal at a time. The processes are
+ * spawned in order; the request completes when all of them have been
+ * handled. Cancelling it stops starting new processes, but reports the
+ * ones that were already spawned.
+ */
+void
+xdp_portal_spawn_many (XdpPortal           *portal,
+                       const char          *cwd,
+                       GPtrArray           *argvs,
+                       const char * const  *env,
+                       XdpSpawnFlags        flags,
+                       const char * const  *sandbox_expose,
+                       const char * const  *sandbox_expose_ro,
+                       guint                max_in_flight,
+                       GCancellable        *cancellable,
+                       GAsyncReadyCallback  callback,
+                       gpointer             data)
+{
+  SpawnManyCall *call;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (argvs != NULL);
+  g_return_if_fail ((flags & ~(XDP_SPAWN_FLAG_CLEARENV |
+                               XDP_SPAWN_FLAG_LATEST |
+                               XDP_SPAWN_FLAG_SANDBOX |
+                               XDP_SPAWN_FLAG_NO_NETWORK |
+                               XDP_SPAWN_FLAG_WATCH)) == 0);
+
+  ensure_spawn_exited_connection (portal);
+
+  call = g_new0 (SpawnManyCall, 1);
+  call->portal = g_object_ref (portal);
+  call->cwd = g_strdup (cwd);
+  call->argvs = g_ptr_array_ref (argvs);
+  call->flags = flags;
+  call->fds = g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE ("{uh}"), NULL, 0));
+  call->env = g_variant_ref_sink (build_env (env));
+  call->options = g_variant_ref_sink (build_options (sandbox_expose, sandbox_expose_ro));
+
+  call->pids = g_array_sized_new (FALSE, TRUE, sizeof (pid_t), argvs->len);
+  g_array_set_size (call->pids, argvs->len);
+
+  call->task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (call->task, xdp_portal_spawn_many);
+  /* Per-process errors are reported in the result, including cancellation */
+  g_task_set_check_cancellable (call->task, FALSE);
+
+  call->batch = _xdp_batch_new (argvs->len,
+                                max_in_flight > 0 ? max_in_flight : 8,
+                                cancellable,
+                                spawn_many_send,
+                                spawn_many_done,
+                                call);
+  _xdp_batch_start (call->batch);
+}
+
+/**
+ * xdp_portal_spawn_many_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @errors: (out) (optional) (transfer full) (element-type GError): return
+ *   location for the errors; the element for each process that could not
+ *   be spawned holds the reason, the others are `NULL`
+ * @error: return location for an error
+ *
+ * Finishes the spawn request.
+ *
+ * Returns: (transfer full) (element-type gint): the pids of the spawned
+ *   processes in the order of the argvs, with 0 for each process that
+ *   could not be spawned
+ */
+GArray *
+xdp_portal_spawn_many_finish (XdpPortal     *portal,
+                              GAsyncResult  *result,
+                              GPtrArray    **errors,
+                              GError       **error)
+{
+  SpawnManyResult *spawn_result;
+  GArray *pids;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_spawn_many, NULL);
+
+  spawn_result = g_task_propagate_pointer (G_TASK (result), error);
+  if (!spawn_result)
+    return NULL;
+
+  pids = g_steal_pointer (&spawn_result->pids);
+  if (errors)
+    *errors = g_steal_pointer (&spawn_result->errors);
+  spawn_many_result_free (spawn_result);
+
+  return pids;
+}
+
 /**
  * xdp_portal_spawn_signal:
  * @portal: a [class@Portal]
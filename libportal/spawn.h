@@ -64,6 +64,38 @@ pid_t        xdp_portal_spawn_finish          (XdpPortal            *portal,
                                                GAsyncResult         *result,
                                                GError              **error);
 
+XDP_PUBLIC
+void         xdp_portal_spawn_many            (XdpPortal            *portal,
+                                               const char           *cwd,
+                                               GPtrArray            *argvs,
+                                               const char * const   *env,
+                                               XdpSpawnFlags         flags,
+                                               const char * const   *sandbox_expose,
+                                               const char * const   *sandbox_expose_ro,
+                                               guint                 max_in_flight,
+                                               GCancellable         *cancellable,
+                                               GAsyncReadyCallback   callback,
+                                               gpointer              data);
+
+XDP_PUBLIC
+GArray *     xdp_portal_spawn_many_finish     (XdpPortal            *portal,
+                                               GAsyncResult         *result,
+                                               GPtrArray           **errors,
+                                               GError              **error);
+
+XDP_PUBLIC
+void         xdp_portal_spawn_wait            (XdpPortal            *portal,
+                                               pid_t                 pid,
+                                               GCancellable         *cancellable,
+                                               GAsyncReadyCallback   callback,
+                                               gpointer              data);
+
+XDP_PUBLIC
+gboolean     xdp_portal_spawn_wait_finish     (XdpPortal            *portal,
+                                               GAsyncResult         *result,
+                                               guint                *exit_status,
+                                               GError              **error);
+
 XDP_PUBLIC
 void        xdp_portal_spawn_signal           (XdpPortal            *portal,
                                                pid_t                 pid,
@@ -0,0 +1,577 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <glib-unix.h>
+#include <gio/gunixfdlist.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+
+#include "portal-private.h"
+#include "spawn-private.h"
+#include "subprocess-private.h"
+
+/**
+ * XdpSubprocess
+ *
+ * A process spawned in a new sandbox.
+ *
+ * [class@Subprocess] wraps [method@Portal.spawn] for the common case of
+ * talking to a helper over its standard streams. The pipes requested with
+ * [flags@SubprocessFlags] are created and mapped into the new process
+ * automatically, and are available as [class@Gio.InputStream] and
+ * [class@Gio.OutputStream] for asynchronous use, or as plain file
+ * descriptors for splice(2) and similar.
+ *
+ * A [class@Subprocess] is created with [method@Portal.spawn_subprocess].
+ */
+struct _XdpSubprocess {
+  GObject parent_instance;
+
+  XdpPortal *portal;
+  pid_t pid;
+
+  GOutputStream *stdin_pipe;
+  GInputStream *stdout_pipe;
+  GInputStream *stderr_pipe;
+
+  gboolean exited;
+  guint exit_status;
+  GPtrArray *waiters; /* SubprocessWaiter */
+};
+
+typedef struct {
+  XdpSubprocess *subprocess;
+  GTask *task;
+  gulong cancelled_id;
+} SubprocessWaiter;
+
+G_DEFINE_TYPE (XdpSubprocess, xdp_subprocess, G_TYPE_OBJECT)
+
+static void
+xdp_subprocess_finalize (GObject *object)
+{
+  XdpSubprocess *subprocess = XDP_SUBPROCESS (object);
+
+  g_clear_object (&subprocess->stdin_pipe);
+  g_clear_object (&subprocess->stdout_pipe);
+  g_clear_object (&subprocess->stderr_pipe);
+  g_clear_object (&subprocess->portal);
+  g_clear_pointer (&subprocess->waiters, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (xdp_subprocess_parent_class)->finalize (object);
+}
+
+static void
+xdp_subprocess_class_init (XdpSubprocessClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = xdp_subprocess_finalize;
+}
+
+static void
+xdp_subprocess_init (XdpSubprocess *subprocess)
+{
+  subprocess->waiters = g_ptr_array_new ();
+}
+
+static void
+subprocess_waiter_free (SubprocessWaiter *waiter)
+{
+  g_object_unref (waiter->task);
+  g_free (waiter);
+}
+
+void
+_xdp_subprocess_started (XdpSubprocess *subprocess,
+                         pid_t          pid)
+{
+  subprocess->pid = pid;
+}
+
+/* Called by the portal when the process exits. The exit status is kept
+ * on the object, so that it is available no matter how long the caller
+ * waits before asking for it. */
+void
+_xdp_subprocess_exited (XdpSubprocess *subprocess,
+                        guint          exit_status)
+{
+  g_autoptr(GPtrArray) waiters = NULL;
+  guint i;
+
+  subprocess->exited = TRUE;
+  subprocess->exit_status = exit_status;
+
+  waiters = g_steal_pointer (&subprocess->waiters);
+  subprocess->waiters = g_ptr_array_new ();
+
+  for (i = 0; i < waiters->len; i++)
+    {
+      SubprocessWaiter *waiter = g_ptr_array_index (waiters, i);
+
+      g_clear_signal_handler (&waiter->cancelled_id, g_task_get_cancellable (waiter->task));
+      g_task_return_int (waiter->task, exit_status);
+      subprocess_waiter_free (waiter);
+    }
+}
+
+static gboolean
+add_pipe (GUnixFDList  *fd_list,
+          GArray       *map_to,
+          int           child_fd,
+          gboolean      child_reads,
+          int          *parent_fd,
+          GError      **error)
+{
+  int fds[2];
+  int child_end;
+
+  if (!g_unix_open_pipe (fds, O_CLOEXEC, error))
+    return FALSE;
+
+  child_end = child_reads ? fds[0] : fds[1];
+  *parent_fd = child_reads ? fds[1] : fds[0];
+
+  /* The fd list holds its own copy, so ours can go right away; the
+   * parent end then sees EOF as soon as the child closes its copy. */
+  if (g_unix_fd_list_append (fd_list, child_end, error) == -1)
+    {
+      close (child_end);
+      g_clear_fd (parent_fd, NULL);
+      return FALSE;
+    }
+  close (child_end);
+
+  g_array_append_val (map_to, child_fd);
+
+  return TRUE;
+}
+
+/**
+ * xdp_portal_spawn_subprocess:
+ * @portal: a [class@Portal]
+ * @cwd: the cwd for the new process
+ * @argv: (array zero-terminated): the argv for the new process
+ * @env: (array zero-terminated) (nullable): an array of KEY=VALUE environment settings, or `NULL`
+ * @spawn_flags: flags influencing the spawn operation
+ * @flags: flags controlling the standard streams of the new process
+ * @sandbox_expose: (array zero-terminated) (nullable): paths to expose rw in the new sandbox, or `NULL`
+ * @sandbox_expose_ro: (array zero-terminated) (nullable): paths to expose ro in the new sandbox, or `NULL`
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Like [method@Portal.spawn], but sets up pipes for the standard
+ * streams of the new process according to @flags, and returns a
+ * [class@Subprocess] to access them.
+ */
+void
+xdp_portal_spawn_subprocess (XdpPortal            *portal,
+                             const char           *cwd,
+                             const char * const   *argv,
+                             const char * const   *env,
+                             XdpSpawnFlags         spawn_flags,
+                             XdpSubprocessFlags    flags,
+                             const char * const   *sandbox_expose,
+                             const char * const   *sandbox_expose_ro,
+                             GCancellable         *cancellable,
+                             GAsyncReadyCallback   callback,
+                             gpointer              data)
+{
+  g_autoptr(XdpSubprocess) subprocess = NULL;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  g_autoptr(GArray) map_to = NULL;
+  g_autoptr(GTask) task = NULL;
+  GError *error = NULL;
+  int fd;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (argv != NULL);
+  g_return_if_fail ((flags & XDP_SUBPROCESS_FLAG_STDERR_PIPE) == 0 ||
+                    (flags & XDP_SUBPROCESS_FLAG_STDERR_MERGE) == 0);
+  g_return_if_fail ((flags & XDP_SUBPROCESS_FLAG_STDERR_MERGE) == 0 ||
+                    (flags & XDP_SUBPROCESS_FLAG_STDOUT_PIPE) != 0);
+
+  subprocess = g_object_new (XDP_TYPE_SUBPROCESS, NULL);
+  subprocess->portal = g_object_ref (portal);
+
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_portal_spawn_subprocess);
+
+  fd_list = g_unix_fd_list_new ();
+  map_to = g_array_new (FALSE, FALSE, sizeof (int));
+
+  if (flags & XDP_SUBPROCESS_FLAG_STDIN_PIPE)
+    {
+      if (!add_pipe (fd_list, map_to, STDIN_FILENO, TRUE, &fd, &error))
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+      subprocess->stdin_pipe = g_unix_output_stream_new (fd, TRUE);
+    }
+
+  if (flags & XDP_SUBPROCESS_FLAG_STDOUT_PIPE)
+    {
+      if (!add_pipe (fd_list, map_to, STDOUT_FILENO, FALSE, &fd, &error))
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+      subprocess->stdout_pipe = g_unix_input_stream_new (fd, TRUE);
+
+      if (flags & XDP_SUBPROCESS_FLAG_STDERR_MERGE)
+        {
+          int stderr_fd = STDERR_FILENO;
+
+          /* Map the write end of the stdout pipe a second time */
+          if (g_unix_fd_list_append (fd_list,
+                                     g_unix_fd_list_peek_fds (fd_list, NULL)[map_to->len - 1],
+                                     &error) == -1)
+            {
+              g_task_return_error (task, error);
+              return;
+            }
+          g_array_append_val (map_to, stderr_fd);
+        }
+    }
+
+  if (flags & XDP_SUBPROCESS_FLAG_STDERR_PIPE)
+    {
+      if (!add_pipe (fd_list, map_to, STDERR_FILENO, FALSE, &fd, &error))
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+      subprocess->stderr_pipe = g_unix_input_stream_new (fd, TRUE);
+    }
+
+  _xdp_portal_spawn_full (portal, cwd, argv, fd_list,
+                          (const int *) map_to->data, env, spawn_flags,
+                          sandbox_expose, sandbox_expose_ro,
+                          subprocess, task);
+}
+
+/**
+ * xdp_portal_spawn_subprocess_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes the spawn request.
+ *
+ * Returns: (transfer full): the new [class@Subprocess], or `NULL`
+ */
+XdpSubprocess *
+xdp_portal_spawn_subprocess_finish (XdpPortal     *portal,
+                                    GAsyncResult  *result,
+                                    GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_spawn_subprocess, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * xdp_subprocess_get_pid:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the pid of the process, as used by [method@Portal.spawn_signal].
+ *
+ * Returns: the pid
+ */
+pid_t
+xdp_subprocess_get_pid (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), 0);
+
+  return subprocess->pid;
+}
+
+/**
+ * xdp_subprocess_get_stdin_pipe:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the stream connected to the stdin of the process.
+ *
+ * Returns: (transfer none) (nullable): the stream, or `NULL` if
+ *   %XDP_SUBPROCESS_FLAG_STDIN_PIPE was not used
+ */
+GOutputStream *
+xdp_subprocess_get_stdin_pipe (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), NULL);
+
+  return subprocess->stdin_pipe;
+}
+
+/**
+ * xdp_subprocess_get_stdout_pipe:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the stream connected to the stdout of the process.
+ *
+ * Returns: (transfer none) (nullable): the stream, or `NULL` if
+ *   %XDP_SUBPROCESS_FLAG_STDOUT_PIPE was not used
+ */
+GInputStream *
+xdp_subprocess_get_stdout_pipe (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), NULL);
+
+  return subprocess->stdout_pipe;
+}
+
+/**
+ * xdp_subprocess_get_stderr_pipe:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the stream connected to the stderr of the process.
+ *
+ * Returns: (transfer none) (nullable): the stream, or `NULL` if
+ *   %XDP_SUBPROCESS_FLAG_STDERR_PIPE was not used
+ */
+GInputStream *
+xdp_subprocess_get_stderr_pipe (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), NULL);
+
+  return subprocess->stderr_pipe;
+}
+
+/**
+ * xdp_subprocess_get_stdin_fd:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the file descriptor of the stream returned by
+ * [method@Subprocess.get_stdin_pipe], for use with splice(2) or
+ * sendfile(2). It is owned by the stream; don't close it.
+ *
+ * Returns: the file descriptor, or -1
+ */
+int
+xdp_subprocess_get_stdin_fd (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), -1);
+
+  if (!subprocess->stdin_pipe)
+    return -1;
+
+  return g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (subprocess->stdin_pipe));
+}
+
+/**
+ * xdp_subprocess_get_stdout_fd:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the file descriptor of the stream returned by
+ * [method@Subprocess.get_stdout_pipe], for use with splice(2).
+ * It is owned by the stream; don't close it.
+ *
+ * Returns: the file descriptor, or -1
+ */
+int
+xdp_subprocess_get_stdout_fd (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), -1);
+
+  if (!subprocess->stdout_pipe)
+    return -1;
+
+  return g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (subprocess->stdout_pipe));
+}
+
+/**
+ * xdp_subprocess_get_stderr_fd:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the file descriptor of the stream returned by
+ * [method@Subprocess.get_stderr_pipe], for use with splice(2).
+ * It is owned by the stream; don't close it.
+ *
+ * Returns: the file descriptor, or -1
+ */
+int
+xdp_subprocess_get_stderr_fd (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), -1);
+
+  if (!subprocess->stderr_pipe)
+    return -1;
+
+  return g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (subprocess->stderr_pipe));
+}
+
+/**
+ * xdp_subprocess_send_signal:
+ * @subprocess: a [class@Subprocess]
+ * @signal: the Unix signal to send (see signal(7))
+ * @to_process_group: whether to send the signal to the process
+ *     group of the process
+ *
+ * Sends a Unix signal to the process. Nothing happens if the
+ * process already exited.
+ */
+void
+xdp_subprocess_send_signal (XdpSubprocess *subprocess,
+                            int            signal,
+                            gboolean       to_process_group)
+{
+  g_return_if_fail (XDP_IS_SUBPROCESS (subprocess));
+
+  if (subprocess->exited)
+    return;
+
+  xdp_portal_spawn_signal (subprocess->portal, subprocess->pid, signal, to_process_group);
+}
+
+static void
+subprocess_wait_cancelled_cb (GCancellable *cancellable,
+                              gpointer      data)
+{
+  SubprocessWaiter *waiter = data;
+
+  g_ptr_array_remove_fast (waiter->subprocess->waiters, waiter);
+
+  g_clear_signal_handler (&waiter->cancelled_id, cancellable);
+  g_task_return_new_error (waiter->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Wait canceled by caller");
+  subprocess_waiter_free (waiter);
+}
+
+/**
+ * xdp_subprocess_wait:
+ * @subprocess: a [class@Subprocess]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the process exits
+ * @data: data to pass to @callback
+ *
+ * Waits for the process to exit.
+ */
+void
+xdp_subprocess_wait (XdpSubprocess       *subprocess,
+                     GCancellable        *cancellable,
+                     GAsyncReadyCallback  callback,
+                     gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+  SubprocessWaiter *waiter;
+
+  g_return_if_fail (XDP_IS_SUBPROCESS (subprocess));
+
+  task = g_task_new (subprocess, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_subprocess_wait);
+
+  if (subprocess->exited)
+    {
+      g_task_return_int (task, subprocess->exit_status);
+      return;
+    }
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  waiter = g_new0 (SubprocessWaiter, 1);
+  waiter->subprocess = subprocess;
+  waiter->task = g_steal_pointer (&task);
+  g_ptr_array_add (subprocess->waiters, waiter);
+
+  if (cancellable)
+    waiter->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (subprocess_wait_cancelled_cb), waiter);
+}
+
+/**
+ * xdp_subprocess_wait_finish:
+ * @subprocess: a [class@Subprocess]
+ * @result: a [iface@Gio.AsyncResult]
+ * @exit_status: (out) (optional): return location for the exit status,
+ *   as returned by waitpid(2)
+ * @error: return location for an error
+ *
+ * Finishes a wait request.
+ *
+ * Returns: `TRUE` if the process exited
+ */
+gboolean
+xdp_subprocess_wait_finish (XdpSubprocess  *subprocess,
+                            GAsyncResult   *result,
+                            guint          *exit_status,
+                            GError        **error)
+{
+  GError *local_error = NULL;
+  gssize status;
+
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, subprocess), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_subprocess_wait, FALSE);
+
+  status = g_task_propagate_int (G_TASK (result), &local_error);
+  if (local_error)
+    {
+      g_propagate_error (error, local_error);
+      return FALSE;
+    }
+
+  if (exit_status)
+    *exit_status = (guint) status;
+
+  return TRUE;
+}
+
+/**
+ * xdp_subprocess_get_if_exited:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Returns whether the process is known to have exited.
+ *
+ * Returns: `TRUE` if the process exited
+ */
+gboolean
+xdp_subprocess_get_if_exited (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), FALSE);
+
+  return subprocess->exited;
+}
+
+/**
+ * xdp_subprocess_get_exit_status:
+ * @subprocess: a [class@Subprocess]
+ *
+ * Gets the exit status of the process, as returned by waitpid(2).
+ *
+ * This is only valid after the process exited, see
+ * [method@Subprocess.get_if_exited].
+ *
+ * Returns: the exit status
+ */
+guint
+xdp_subprocess_get_exit_status (XdpSubprocess *subprocess)
+{
+  g_return_val_if_fail (XDP_IS_SUBPROCESS (subprocess), 0);
+  g_return_val_if_fail (subprocess->exited, 0);
+
+  return subprocess->exit_status;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/types.h>
+#include <libportal/spawn.h>
+
+G_BEGIN_DECLS
+
+/**
+ * XdpSubprocessFlags:
+ * @XDP_SUBPROCESS_FLAG_NONE: No flags
+ * @XDP_SUBPROCESS_FLAG_STDIN_PIPE: Create a pipe for the stdin of the process
+ * @XDP_SUBPROCESS_FLAG_STDOUT_PIPE: Create a pipe for the stdout of the process
+ * @XDP_SUBPROCESS_FLAG_STDERR_PIPE: Create a pipe for the stderr of the process
+ * @XDP_SUBPROCESS_FLAG_STDERR_MERGE: Send stderr to the same pipe as stdout
+ *
+ * Flags controlling how the standard streams of a [class@Subprocess]
+ * are set up. Streams without a pipe are inherited from the portal.
+ */
+typedef enum {
+  XDP_SUBPROCESS_FLAG_NONE         = 0,
+  XDP_SUBPROCESS_FLAG_STDIN_PIPE   = 1 << 0,
+  XDP_SUBPROCESS_FLAG_STDOUT_PIPE  = 1 << 1,
+  XDP_SUBPROCESS_FLAG_STDERR_PIPE  = 1 << 2,
+  XDP_SUBPROCESS_FLAG_STDERR_MERGE = 1 << 3,
+} XdpSubprocessFlags;
+
+#define XDP_TYPE_SUBPROCESS (xdp_subprocess_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpSubprocess, xdp_subprocess, XDP, SUBPROCESS, GObject)
+
+XDP_PUBLIC
+void            xdp_portal_spawn_subprocess        (XdpPortal            *portal,
+                                                    const char           *cwd,
+                                                    const char * const   *argv,
+                                                    const char * const   *env,
+                                                    XdpSpawnFlags         spawn_flags,
+                                                    XdpSubprocessFlags    flags,
+                                                    const char * const   *sandbox_expose,
+                                                    const char * const   *sandbox_expose_ro,
+                                                    GCancellable         *cancellable,
+                                                    GAsyncReadyCallback   callback,
+                                                    gpointer              data);
+
+XDP_PUBLIC
+XdpSubprocess * xdp_portal_spawn_subprocess_finish (XdpPortal            *portal,
+                                                    GAsyncResult         *result,
+                                                    GError              **error);
+
+XDP_PUBLIC
+pid_t           xdp_subprocess_get_pid             (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+GOutputStream * xdp_subprocess_get_stdin_pipe      (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+GInputStream *  xdp_subprocess_get_stdout_pipe     (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+GInputStream *  xdp_subprocess_get_stderr_pipe     (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+int             xdp_subprocess_get_stdin_fd        (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+int             xdp_subprocess_get_stdout_fd       (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+int             xdp_subprocess_get_stderr_fd       (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+void            xdp_subprocess_send_signal         (XdpSubprocess        *subprocess,
+                                                    int                   signal,
+                                                    gboolean              to_process_group);
+
+XDP_PUBLIC
+void            xdp_subprocess_wait                (XdpSubprocess        *subprocess,
+                                                    GCancellable         *cancellable,
+                                                    GAsyncReadyCallback   callback,
+                                                    gpointer              data);
+
+XDP_PUBLIC
+gboolean        xdp_subprocess_wait_finish         (XdpSubprocess        *subprocess,
+                                                    GAsyncResult         *result,
+                                                    guint                *exit_status,
+                                                    GError              **error);
+
+XDP_PUBLIC
+gboolean        xdp_subprocess_get_if_exited       (XdpSubprocess        *subprocess);
+
+XDP_PUBLIC
+guint           xdp_subprocess_get_exit_status     (XdpSubprocess        *subprocess);
+
+G_END_DECLS
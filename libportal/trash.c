@@ -25,11 +25,14 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <glib/gstdio.h>
 #include <gio/gunixfdlist.h>
 
+#include "batch-private.h"
 #include "portal-private.h"
 
 typedef struct {
@@ -174,3 +177,331 @@ xdp_portal_trash_file_finish (XdpPortal *portal,
 
   return g_task_propagate_boolean (G_TASK (result), error);
 }
+
+/* Number of files opened by each worker thread run */
+#define TRASH_FILES_CHUNK 64
+
+/* Largest number of TrashFile calls to have pending at once */
+#define MAX_TRASH_CALLS_IN_FLIGHT 16
+
+typedef struct {
+  XdpPortal *portal;
+  GTask *task;
+  XdpBatch *batch;
+
+  char **paths;
+  guint n_paths;
+  int *fds;
+  GError **open_errors;
+
+  gboolean opening;
+  guint n_opened;
+  guint n_sent;
+} TrashFilesCall;
+
+typedef struct {
+  TrashFilesCall *call;
+  guint index;
+} TrashFilesJob;
+
+typedef struct {
+  TrashFilesCall *call;
+  guint start;
+  guint end;
+} OpenChunk;
+
+static void
+trash_files_call_free (TrashFilesCall *call)
+{
+  guint i;
+
+  for (i = 0; i < call->n_paths; i++)
+    {
+      if (call->fds[i] != -1)
+        close (call->fds[i]);
+      g_clear_error (&call->open_errors[i]);
+    }
+
+  g_object_unref (call->portal);
+  g_object_unref (call->task);
+  g_strfreev (call->paths);
+  g_free (call->fds);
+  g_free (call->open_errors);
+
+  g_free (call);
+}
+
+static void chunk_opened (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      data);
+
+/* Runs in a worker thread; the main thread doesn't touch the elements
+ * of the chunk until it is done. */
+static void
+open_chunk_in_thread (GTask        *task,
+                      gpointer      source_object,
+                      gpointer      task_data,
+                      GCancellable *cancellable)
+{
+  OpenChunk *chunk = task_data;
+  TrashFilesCall *call = chunk->call;
+  guint i;
+
+  for (i = chunk->start; i < chunk->end; i++)
+    {
+      int fd;
+
+      /* The batch fails the remaining files */
+      if (g_cancellable_is_cancelled (cancellable))
+        break;
+
+      fd = g_open (call->paths[i], O_PATH | O_CLOEXEC);
+      if (fd == -1)
+        {
+          int saved_errno = errno;
+
+          call->open_errors[i] =
+            g_error_new (G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                         "Failed to open '%s': %s", call->paths[i], g_strerror (saved_errno));
+          continue;
+        }
+
+      call->fds[i] = fd;
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+/* Lets the batch send the files opened so far, or fail all the others
+ * once it is cancelled. May finish the batch and free @call, unless a
+ * trash request is pending. */
+static void
+trash_files_update_ready (TrashFilesCall *call)
+{
+  GCancellable *cancellable = g_task_get_cancellable (call->task);
+
+  if (!call->opening && g_cancellable_is_cancelled (cancellable))
+    _xdp_batch_set_n_ready (call->batch, call->n_paths);
+  else
+    _xdp_batch_set_n_ready (call->batch, call->n_opened);
+}
+
+/* Opens the next chunk while the previous one is being trashed, but
+ * doesn't keep more than one chunk of unused fds around */
+static void
+trash_files_open_more (TrashFilesCall *call)
+{
+  GCancellable *cancellable = g_task_get_cancellable (call->task);
+  g_autoptr(GTask) task = NULL;
+  OpenChunk *chunk;
+
+  if (call->opening ||
+      call->n_opened == call->n_paths ||
+      call->n_opened - call->n_sent >= TRASH_FILES_CHUNK ||
+      g_cancellable_is_cancelled (cancellable))
+    return;
+
+  chunk = g_new0 (OpenChunk, 1);
+  chunk->call = call;
+  chunk->start = call->n_opened;
+  chunk->end = MIN (call->n_opened + TRASH_FILES_CHUNK, call->n_paths);
+
+  call->opening = TRUE;
+  task = g_task_new (call->portal, cancellable, chunk_opened, call);
+  g_task_set_source_tag (task, trash_files_open_more);
+  g_task_set_task_data (task, chunk, g_free);
+  g_task_set_check_cancellable (task, FALSE);
+  g_task_run_in_thread (task, open_chunk_in_thread);
+}
+
+static void
+chunk_opened (GObject      *object,
+              GAsyncResult *result,
+              gpointer      data)
+{
+  TrashFilesCall *call = data;
+  OpenChunk *chunk = g_task_get_task_data (G_TASK (result));
+
+  call->n_opened = chunk->end;
+  call->opening = FALSE;
+
+  trash_files_open_more (call);
+  trash_files_update_ready (call);
+}
+
+static void
+trash_files_returned (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      data)
+{
+  TrashFilesJob *job = data;
+  TrashFilesCall *call = job->call;
+  guint index = job->index;
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+
+  g_free (job);
+
+  ret = g_dbus_connection_call_with_unix_fd_list_finish (G_DBUS_CONNECTION (object),
+                                                         NULL,
+                                                         result,
+                                                         &error);
+  if (ret)
+    {
+      guint retval;
+
+      g_variant_get (ret, "(u)", &retval);
+      if (retval != 1)
+        error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to trash");
+    }
+
+  trash_files_open_more (call);
+  trash_files_update_ready (call);
+  _xdp_batch_entry_done (call->batch, index, error);
+}
+
+static gboolean
+trash_files_send (XdpBatch  *batch,
+                  guint      index,
+                  gpointer   data,
+                  GError   **error)
+{
+  TrashFilesCall *call = data;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  TrashFilesJob *job;
+
+  call->n_sent = index + 1;
+  trash_files_open_more (call);
+  trash_files_update_ready (call);
+
+  /* Failed to open */
+  if (call->fds[index] == -1)
+    {
+      if (call->open_errors[index])
+        g_propagate_error (error, g_steal_pointer (&call->open_errors[index]));
+      else
+        g_cancellable_set_error_if_cancelled (g_task_get_cancellable (call->task), error);
+      return FALSE;
+    }
+
+  /* Every fd in the list is sent along with the message, so each
+   * call gets a list of its own */
+  fd_list = g_unix_fd_list_new_from_array (&call->fds[index], 1);
+  call->fds[index] = -1;
+
+  job = g_new0 (TrashFilesJob, 1);
+  job->call = call;
+  job->index = index;
+
+  /* Not cancelled once sent, so that the result reports whether the
+   * file ended up in the trash */
+  g_dbus_connection_call_with_unix_fd_list (call->portal->bus,
+                                            PORTAL_BUS_NAME,
+                                            PORTAL_OBJECT_PATH,
+                                            "org.freedesktop.portal.Trash",
+                                            "TrashFile",
+                                            g_variant_new ("(h)", 0),
+                                            NULL,
+                                            G_DBUS_CALL_FLAGS_NONE,
+                                            -1,
+                                            fd_list,
+                                            NULL,
+                                            trash_files_returned,
+                                            job);
+
+  return TRUE;
+}
+
+static void
+trash_files_done (GPtrArray *errors,
+                  gpointer   data)
+{
+  TrashFilesCall *call = data;
+
+  g_task_return_pointer (call->task, errors, (GDestroyNotify) g_ptr_array_unref);
+  trash_files_call_free (call);
+}
+
+/**
+ * xdp_portal_trash_files:
+ * @portal: a [class@Portal]
+ * @paths: (array zero-terminated): the paths of local files
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Sends the files at @paths to the trash can, like calling
+ * [method@Portal.trash_file] for each of them.
+ *
+ * The files are opened in a worker thread, while the files opened so
+ * far are being trashed. Several trash requests are kept pending at
+ * once, instead of waiting for each file to be trashed before sending
+ * the next one. The request completes when all files have been handled.
+ * Cancelling it stops trashing further files; the files for which a
+ * trash request was already sent are reported as usual.
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@Portal.trash_files_finish] to get the results.
+ */
+void
+xdp_portal_trash_files (XdpPortal           *portal,
+                        const char * const  *paths,
+                        GCancellable        *cancellable,
+                        GAsyncReadyCallback  callback,
+                        gpointer             data)
+{
+  TrashFilesCall *call;
+  guint i;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (paths != NULL);
+
+  call = g_new0 (TrashFilesCall, 1);
+  call->portal = g_object_ref (portal);
+  call->paths = g_strdupv ((char **) paths);
+  call->n_paths = g_strv_length (call->paths);
+  call->fds = g_new (int, call->n_paths);
+  for (i = 0; i < call->n_paths; i++)
+    call->fds[i] = -1;
+  call->open_errors = g_new0 (GError *, call->n_paths);
+
+  call->task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (call->task, xdp_portal_trash_files);
+  /* Per-file errors are reported in the result, including cancellation */
+  g_task_set_check_cancellable (call->task, FALSE);
+
+  /* Files are sent as they get opened */
+  call->batch = _xdp_batch_new (call->n_paths,
+                                MAX_TRASH_CALLS_IN_FLIGHT,
+                                cancellable,
+                                trash_files_send,
+                                trash_files_done,
+                                call);
+  trash_files_open_more (call);
+  trash_files_update_ready (call);
+  _xdp_batch_start (call->batch);
+}
+
+/**
+ * xdp_portal_trash_files_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes the trash-files request.
+ *
+ * Returns: (transfer full) (element-type GError): the result for each
+ *   file, in the order of the paths; the element for each file that
+ *   could not be trashed holds the reason, the others are `NULL`
+ */
+GPtrArray *
+xdp_portal_trash_files_finish (XdpPortal     *portal,
+                               GAsyncResult  *result,
+                               GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_portal_trash_files, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
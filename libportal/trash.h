@@ -35,4 +35,16 @@ gboolean  xdp_portal_trash_file_finish            (XdpPortal            *portal,
                                                    GAsyncResult         *result,
                                                    GError              **error);
 
+XDP_PUBLIC
+void      xdp_portal_trash_files                  (XdpPortal            *portal,
+                                                   const char * const   *paths,
+                                                   GCancellable         *cancellable,
+                                                   GAsyncReadyCallback   callback,
+                                                   gpointer              data);
+
+XDP_PUBLIC
+GPtrArray *xdp_portal_trash_files_finish          (XdpPortal            *portal,
+                                                   GAsyncResult         *result,
+                                                   GError              **error);
+
 G_END_DECLS
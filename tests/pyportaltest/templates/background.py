@@ -0,0 +1,67 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import MockParams
+from gi.repository import GLib
+from itertools import count
+
+import dbus
+import dbus.service
+import logging
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Background"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until SetStatus returns, in ms
+    params.delay = parameters.get("delay", 0)
+    # The first this many SetStatus calls fail
+    params.fail = parameters.get("fail", 0)
+    params.n_calls = count()
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary({"version": dbus.UInt32(parameters.get("version", 2))}),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="a{sv}",
+    out_signature="",
+    async_callbacks=("ok_cb", "err_cb"),
+)
+def SetStatus(self, options, ok_cb, err_cb):
+    try:
+        logger.debug(f"SetStatus: {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+        n = next(params.n_calls)
+
+        def reply():
+            if n < params.fail:
+                err_cb(
+                    dbus.exceptions.DBusException(
+                        f"SetStatus {n} failed",
+                        name="org.freedesktop.DBus.Error.Failed",
+                    )
+                )
+            else:
+                ok_cb()
+            return False
+
+        if params.delay > 0:
+            GLib.timeout_add(params.delay, reply)
+        else:
+            reply()
+    except Exception as e:
+        logger.critical(e)
+        err_cb(e)
@@ -0,0 +1,113 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import MockParams
+from gi.repository import GLib
+
+import dbus
+import dbus.service
+import logging
+import os
+import threading
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Clipboard"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # The pipes of SelectionWrite calls for these serials are never
+    # read, like for a stuck reader
+    params.stalled = parameters.get("stalled", [])
+    params.stalled_fds = []
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 1)),
+                # Not part of the portal: the session that requested the
+                # clipboard and the bus name it was requested from, so
+                # that tests can send SelectionTransfer to it
+                "ClipboardSession": dbus.String(""),
+                "ClipboardSender": dbus.String(""),
+                # Not part of the portal: what was written to the pipes
+                # handed out by SelectionWrite, by serial
+                "Written": dbus.Dictionary({}, signature="uay"),
+            }
+        ),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="oa{sv}",
+    out_signature="",
+)
+def RequestClipboard(self, session_handle, options, sender):
+    logger.debug(f"RequestClipboard: {session_handle}, {options}")
+    self.props[MAIN_IFACE]["ClipboardSession"] = dbus.String(session_handle)
+    self.props[MAIN_IFACE]["ClipboardSender"] = dbus.String(sender)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="oa{sv}",
+    out_signature="",
+)
+def SetSelection(self, session_handle, options):
+    logger.debug(f"SetSelection: {session_handle}, {options}")
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="ou",
+    out_signature="h",
+)
+def SelectionWrite(self, session_handle, serial):
+    try:
+        logger.debug(f"SelectionWrite: {session_handle}, {serial}")
+        params = MockParams.get(self, MAIN_IFACE)
+
+        read_fd, write_fd = os.pipe()
+        fd = dbus.types.UnixFd(write_fd)
+        os.close(write_fd)
+
+        if serial in params.stalled:
+            params.stalled_fds.append(read_fd)
+            return fd
+
+        def written(data):
+            self.props[MAIN_IFACE]["Written"][dbus.UInt32(serial)] = dbus.ByteArray(data)
+            return False
+
+        def read():
+            data = b""
+            while chunk := os.read(read_fd, 65536):
+                data += chunk
+            os.close(read_fd)
+            GLib.idle_add(written, data)
+
+        threading.Thread(target=read, daemon=True).start()
+
+        return fd
+    except Exception as e:
+        logger.critical(e)
+        raise
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="oub",
+    out_signature="",
+)
+def SelectionWriteDone(self, session_handle, serial, success):
+    logger.debug(f"SelectionWriteDone: {session_handle}, {serial}, {success}")
@@ -0,0 +1,92 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import MockParams
+from gi.repository import GLib
+
+import dbus
+import dbus.service
+import logging
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.DynamicLauncher"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until Install and Uninstall return, in ms
+    params.delay = parameters.get("delay", 0)
+    # Install and Uninstall fail for these desktop file ids
+    params.fail = parameters.get("fail", [])
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 1)),
+                "SupportedLauncherTypes": dbus.UInt32(
+                    parameters.get("supported-launcher-types", 3)
+                ),
+            }
+        ),
+    )
+
+
+def reply_later(self, desktop_file_id, ok_cb, err_cb):
+    params = MockParams.get(self, MAIN_IFACE)
+
+    def reply():
+        if desktop_file_id in params.fail:
+            err_cb(
+                dbus.exceptions.DBusException(
+                    f"Failed to handle {desktop_file_id}",
+                    name="org.freedesktop.DBus.Error.Failed",
+                )
+            )
+        else:
+            ok_cb()
+        return False
+
+    if params.delay > 0:
+        GLib.timeout_add(params.delay, reply)
+    else:
+        reply()
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="sssa{sv}",
+    out_signature="",
+    async_callbacks=("ok_cb", "err_cb"),
+)
+def Install(self, token, desktop_file_id, desktop_entry, options, sender, ok_cb, err_cb):
+    try:
+        logger.debug(f"Install: {token}, {desktop_file_id}, {options}")
+        reply_later(self, desktop_file_id, ok_cb, err_cb)
+    except Exception as e:
+        logger.critical(e)
+        err_cb(e)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="sa{sv}",
+    out_signature="",
+    async_callbacks=("ok_cb", "err_cb"),
+)
+def Uninstall(self, desktop_file_id, options, sender, ok_cb, err_cb):
+    try:
+        logger.debug(f"Uninstall: {desktop_file_id}, {options}")
+        reply_later(self, desktop_file_id, ok_cb, err_cb)
+    except Exception as e:
+        logger.critical(e)
+        err_cb(e)
@@ -0,0 +1,80 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import Request, Response, MockParams
+
+import dbus
+import dbus.service
+import fcntl
+import logging
+import os
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Email"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until the Response is sent, in ms
+    params.delay = parameters.get("delay", 0)
+    params.response = parameters.get("response", 0)
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 4)),
+                # Not part of the portal: the files behind the attachment
+                # fds, their contents and their seals, in order. Files
+                # passed as O_PATH fds have empty contents.
+                "AttachmentNames": dbus.Array([], signature="s"),
+                "Attachments": dbus.Array([], signature="ay"),
+                "AttachmentSeals": dbus.Array([], signature="u"),
+            }
+        ),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="sa{sv}",
+    out_signature="o",
+)
+def ComposeEmail(self, parent_window, options, sender):
+    try:
+        logger.debug(f"ComposeEmail: {parent_window}, {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+
+        for attachment_fd in options.get("attachment_fds", []):
+            fd = attachment_fd.take()
+            try:
+                name = os.readlink(f"/proc/self/fd/{fd}")
+                try:
+                    contents = os.pread(fd, os.fstat(fd).st_size, 0)
+                except OSError:
+                    contents = b""
+                try:
+                    seals = fcntl.fcntl(fd, fcntl.F_GET_SEALS)
+                except OSError:
+                    seals = 0
+            finally:
+                os.close(fd)
+
+            self.props[MAIN_IFACE]["AttachmentNames"].append(dbus.String(name))
+            self.props[MAIN_IFACE]["Attachments"].append(dbus.ByteArray(contents))
+            self.props[MAIN_IFACE]["AttachmentSeals"].append(dbus.UInt32(seals))
+
+        request = Request(bus_name=self.bus_name, sender=sender, options=options)
+        request.respond(Response(params.response, {}), delay=params.delay)
+
+        return request.handle
+    except Exception as e:
+        logger.critical(e)
@@ -0,0 +1,139 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import MockParams
+from typing import Dict, List, Tuple, Iterator
+from itertools import count
+from gi.repository import GLib
+
+import dbus
+import dbus.service
+import logging
+import os
+import threading
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Flatpak"
+MAIN_OBJ = "/org/freedesktop/portal/Flatpak"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Flatpak"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until Spawn returns, in ms
+    params.spawn_delay = parameters.get("spawn-delay", 0)
+    # The pids handed out by Spawn, in order; afterwards pids are counted
+    # up from 1000
+    params.pids = list(parameters.get("pids", []))
+    params.next_pid = count(1000)
+    # Per spawned process, the time until SpawnExited is sent, in ms, and
+    # the exit status; a negative delay means the process keeps running
+    params.exit_delays = list(parameters.get("exit-delays", []))
+    params.exit_statuses = list(parameters.get("exit-statuses", []))
+    # Spawn fails for processes whose argv[0] is in this list
+    params.fail = parameters.get("fail", [])
+    # Whether spawned processes act like "cat" on the fds mapped to 0 and
+    # 1, and write "error\n" to the one mapped to 2
+    params.echo = parameters.get("echo", False)
+    params.n_spawns = count()
+    params.in_flight = 0
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 7)),
+                "supports": dbus.UInt32(parameters.get("supports", 1)),
+                # Not part of the portal: the largest number of Spawn calls
+                # that were pending at the same time
+                "MaxInFlight": dbus.UInt32(0),
+            }
+        ),
+    )
+
+
+def echo(fds):
+    data = b""
+    if 0 in fds:
+        while chunk := os.read(fds[0], 4096):
+            data += chunk
+    if 1 in fds:
+        os.write(fds[1], data)
+    if 2 in fds:
+        os.write(fds[2], b"error\n")
+    for fd in fds.values():
+        os.close(fd)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="ayaaya{uh}a{ss}ua{sv}",
+    out_signature="u",
+    async_callbacks=("ok_cb", "err_cb"),
+)
+def Spawn(self, cwd, argv, fds, env, flags, options, sender, ok_cb, err_cb):
+    try:
+        argv = [bytes(arg).rstrip(b"\0").decode("utf-8") for arg in argv]
+        logger.debug(f"Spawn: {argv} {flags} {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+
+        fds = {int(child_fd): fd.take() for child_fd, fd in fds.items()}
+        if params.echo:
+            threading.Thread(target=echo, args=(fds,), daemon=True).start()
+        else:
+            for fd in fds.values():
+                os.close(fd)
+
+        n = next(params.n_spawns)
+        params.in_flight += 1
+        self.props[MAIN_IFACE]["MaxInFlight"] = dbus.UInt32(
+            max(self.props[MAIN_IFACE]["MaxInFlight"], params.in_flight)
+        )
+
+        def reply():
+            params.in_flight -= 1
+
+            if argv[0] in params.fail:
+                err_cb(
+                    dbus.exceptions.DBusException(
+                        f"Failed to spawn {argv[0]}",
+                        name="org.freedesktop.DBus.Error.Failed",
+                    )
+                )
+                return False
+
+            pid = params.pids.pop(0) if params.pids else next(params.next_pid)
+            ok_cb(dbus.UInt32(pid))
+
+            delay = params.exit_delays[n] if n < len(params.exit_delays) else -1
+            status = params.exit_statuses[n] if n < len(params.exit_statuses) else 0
+
+            def exited():
+                logger.debug(f"SpawnExited: {pid} {status}")
+                self.EmitSignalDetailed(
+                    MAIN_IFACE,
+                    "SpawnExited",
+                    "uu",
+                    [dbus.UInt32(pid), dbus.UInt32(status)],
+                    details={"destination": sender},
+                )
+                return False
+
+            if delay >= 0:
+                GLib.timeout_add(delay, exited)
+
+            return False
+
+        if params.spawn_delay > 0:
+            GLib.timeout_add(params.spawn_delay, reply)
+        else:
+            reply()
+    except Exception as e:
+        logger.critical(e)
+        err_cb(e)
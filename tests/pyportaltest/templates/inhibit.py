@@ -0,0 +1,119 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import Request, Response, Session, MockParams
+from gi.repository import GLib
+
+import dbus
+import dbus.service
+import logging
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Inhibit"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until the Response is sent, in ms
+    params.delay = parameters.get("delay", 0)
+    params.response = parameters.get("response", 0)
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 3)),
+                # Not part of the portal: "Inhibit <flags>" when an
+                # inhibition takes effect and "Close <flags>" when it is
+                # removed, in order
+                "Events": dbus.Array([], signature="s"),
+                # Not part of the portal: the session handle of the last
+                # monitor and the bus name it was created for, so that
+                # tests can send StateChanged to it
+                "MonitorHandle": dbus.String(""),
+                "MonitorSender": dbus.String(""),
+            }
+        ),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="sua{sv}",
+    out_signature="o",
+)
+def Inhibit(self, parent_window, flags, options, sender):
+    try:
+        logger.debug(f"Inhibit: {parent_window}, {flags}, {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+        request = Request(bus_name=self.bus_name, sender=sender, options=options)
+
+        events = self.props[MAIN_IFACE]["Events"]
+        if params.response == 0:
+            # The request stays around for as long as the inhibition
+            # does, and closing it removes the inhibition
+            request.mock.inhibit_events = events
+            request.mock.inhibit_flags = int(flags)
+            request.mock.AddMethod(
+                "",
+                "Close",
+                "",
+                "",
+                "self.inhibit_events.append(dbus.String(f'Close {self.inhibit_flags}'));"
+                "self.RemoveObject(self.path)",
+            )
+
+        def respond():
+            if params.response == 0:
+                events.append(dbus.String(f"Inhibit {flags}"))
+            request.respond(Response(params.response, {}))
+            return False
+
+        if params.delay > 0:
+            GLib.timeout_add(params.delay, respond)
+        else:
+            respond()
+
+        return request.handle
+    except Exception as e:
+        logger.critical(e)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="sa{sv}",
+    out_signature="o",
+)
+def CreateMonitor(self, parent_window, options, sender):
+    try:
+        logger.debug(f"CreateMonitor: {parent_window}, {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+        request = Request(bus_name=self.bus_name, sender=sender, options=options)
+        session = Session(bus_name=self.bus_name, sender=sender, options=options)
+
+        self.props[MAIN_IFACE]["MonitorHandle"] = dbus.String(session.handle)
+        self.props[MAIN_IFACE]["MonitorSender"] = dbus.String(sender)
+
+        request.respond(Response(params.response, {}), delay=params.delay)
+
+        return request.handle
+    except Exception as e:
+        logger.critical(e)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="o",
+    out_signature="",
+)
+def QueryEndResponse(self, session_handle):
+    logger.debug(f"QueryEndResponse: {session_handle}")
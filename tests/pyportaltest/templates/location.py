@@ -0,0 +1,108 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import Request, Response, Session, ASVType, MockParams
+from typing import Dict, List, Tuple, Iterator
+from gi.repository import GLib
+
+import dbus
+import dbus.service
+import logging
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Location"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    params.delay = 200
+    params.response = parameters.get("response", 0)
+    # Locations sent with LocationUpdated after Start, as dicts with
+    # "latitude", "longitude" and optionally "accuracy"
+    params.fixes = parameters.get("fixes", [])
+    # Whether the locations carry a Timestamp; the n-th one is sent with
+    # a timestamp of n seconds
+    params.timestamps = parameters.get("timestamps", True)
+    # Time between two LocationUpdated signals, in ms
+    params.fix_interval = parameters.get("fix-interval", 100)
+    params.sessions: Dict[str, Session] = {}
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary({"version": dbus.UInt32(parameters.get("version", 1))}),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="a{sv}",
+    out_signature="o",
+)
+def CreateSession(self, options, sender):
+    try:
+        logger.debug(f"CreateSession: {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+
+        session = Session(bus_name=self.bus_name, sender=sender, options=options)
+        params.sessions[session.handle] = session
+
+        return session.handle
+    except Exception as e:
+        logger.critical(e)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="osa{sv}",
+    out_signature="o",
+)
+def Start(self, session_handle, parent_window, options, sender):
+    try:
+        logger.debug(f"Start: {session_handle} {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+        request = Request(bus_name=self.bus_name, sender=sender, options=options)
+
+        response = Response(params.response, {})
+
+        request.respond(response, delay=params.delay)
+
+        if params.response != 0:
+            return request.handle
+
+        def send_fix(fix, timestamp):
+            location = {
+                "Latitude": dbus.Double(fix["latitude"]),
+                "Longitude": dbus.Double(fix["longitude"]),
+                "Accuracy": dbus.Double(fix.get("accuracy", 10.0)),
+            }
+            if params.timestamps:
+                location["Timestamp"] = dbus.Struct(
+                    (dbus.UInt64(timestamp), dbus.UInt64(0)), signature="tt"
+                )
+            logger.debug(f"LocationUpdated on {session_handle}: {location}")
+            self.EmitSignalDetailed(
+                MAIN_IFACE,
+                "LocationUpdated",
+                "oa{sv}",
+                [dbus.ObjectPath(session_handle), dbus.Dictionary(location, "sv")],
+                details={"destination": sender},
+            )
+            return False
+
+        for i, fix in enumerate(params.fixes):
+            GLib.timeout_add(
+                params.delay + (i + 1) * params.fix_interval, send_fix, fix, i + 1
+            )
+
+        return request.handle
+    except Exception as e:
+        logger.critical(e)
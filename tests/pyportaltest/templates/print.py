@@ -0,0 +1,76 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import Request, Response, MockParams
+
+import dbus
+import dbus.service
+import fcntl
+import logging
+import os
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Print"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until the Response is sent, in ms
+    params.delay = parameters.get("delay", 0)
+    params.response = parameters.get("response", 0)
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 1)),
+                # Not part of the portal: the contents of the documents
+                # passed to Print and the seals on their fds, in order
+                "Documents": dbus.Array([], signature="ay"),
+                "Seals": dbus.Array([], signature="u"),
+            }
+        ),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="ssha{sv}",
+    out_signature="o",
+)
+def Print(self, parent_window, title, fd, options, sender):
+    try:
+        logger.debug(f"Print: {parent_window}, {title}, {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+
+        fd = fd.take()
+        try:
+            try:
+                document = os.pread(fd, os.fstat(fd).st_size, 0)
+            except OSError:
+                # print_file passes an O_PATH fd
+                document = b""
+            try:
+                seals = fcntl.fcntl(fd, fcntl.F_GET_SEALS)
+            except OSError:
+                seals = 0
+        finally:
+            os.close(fd)
+
+        self.props[MAIN_IFACE]["Documents"].append(dbus.ByteArray(document))
+        self.props[MAIN_IFACE]["Seals"].append(dbus.UInt32(seals))
+
+        request = Request(bus_name=self.bus_name, sender=sender, options=options)
+        request.respond(Response(params.response, {}), delay=params.delay)
+
+        return request.handle
+    except Exception as e:
+        logger.critical(e)
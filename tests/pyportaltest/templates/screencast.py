@@ -25,13 +25,15 @@ def load(mock, parameters):
     logger.debug(f"loading {MAIN_IFACE} template")
 
     params = MockParams.get(mock, MAIN_IFACE)
-    params.delay = 500
+    params.delay = parameters.get("delay", 500)
     params.version = parameters.get("version", 4)
     params.response = parameters.get("response", 0)
     # streams returned in Start
     params.streams = parameters.get("streams", [])
     # persist_mode returned in Start
     params.persist_mode = parameters.get("persist-mode", 0)
+    # If set, sessions are closed this many ms after SelectSources returned
+    params.close_after_select = parameters.get("close-after-select", -1)
     params.sessions: Dict[str, Session] = {}
 
     mock.AddProperties(
@@ -90,6 +92,10 @@ def SelectSources(self, session_handle, options, sender):
 
         request.respond(response, delay=params.delay)
 
+        session = params.sessions.get(session_handle)
+        if session is not None and params.close_after_select >= 0:
+            session.close({}, delay=params.delay + params.close_after_select)
+
         return request.handle
     except Exception as e:
         logger.critical(e)
@@ -0,0 +1,107 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import Request, Response, MockParams
+from gi.repository import GLib
+from itertools import count
+
+import dbus
+import dbus.service
+import logging
+import os
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Screenshot"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until the Response is sent, in ms
+    params.delay = parameters.get("delay", 0)
+    params.response = parameters.get("response", 0)
+    # If set, the Screenshot calls themselves fail after these many ms,
+    # one entry per call with the last one repeated
+    params.fail_delays = parameters.get("fail-delays", [])
+    # The directory the screenshots are saved to
+    params.directory = parameters.get("directory", None)
+    params.n_screenshots = count()
+    params.n_calls = count()
+    params.pending = 0
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 2)),
+                # Not part of the portal: the largest number of screenshot
+                # requests that were pending at the same time, and the
+                # numbers of the failed calls, in the order they failed
+                "MaxPending": dbus.UInt32(0),
+                "Failed": dbus.Array([], signature="u"),
+            }
+        ),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="sa{sv}",
+    out_signature="o",
+    async_callbacks=("ok_cb", "err_cb"),
+)
+def Screenshot(self, parent_window, options, sender, ok_cb, err_cb):
+    try:
+        logger.debug(f"Screenshot: {parent_window}, {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+        n = next(params.n_calls)
+
+        if params.fail_delays:
+
+            def fail():
+                self.props[MAIN_IFACE]["Failed"].append(dbus.UInt32(n))
+                err_cb(
+                    dbus.exceptions.DBusException(
+                        f"Screenshot {n} failed",
+                        name="org.freedesktop.DBus.Error.Failed",
+                    )
+                )
+                return False
+
+            GLib.timeout_add(params.fail_delays[min(n, len(params.fail_delays) - 1)], fail)
+            return
+
+        request = Request(bus_name=self.bus_name, sender=sender, options=options)
+
+        params.pending += 1
+        self.props[MAIN_IFACE]["MaxPending"] = dbus.UInt32(
+            max(self.props[MAIN_IFACE]["MaxPending"], params.pending)
+        )
+
+        results = {}
+        if params.directory is not None:
+            path = os.path.join(
+                params.directory, f"Screenshot{next(params.n_screenshots)}.png"
+            )
+            with open(path, "wb") as f:
+                f.write(b"\x89PNG\r\n\x1a\n")
+            results["uri"] = dbus.String(GLib.filename_to_uri(path, None))
+
+        def respond():
+            params.pending -= 1
+            request.respond(Response(params.response, results))
+            return False
+
+        GLib.timeout_add(params.delay, respond)
+
+        ok_cb(request.handle)
+    except Exception as e:
+        logger.critical(e)
+        err_cb(e)
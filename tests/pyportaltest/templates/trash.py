@@ -0,0 +1,74 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import MockParams
+from gi.repository import GLib
+
+import dbus
+import dbus.service
+import logging
+import os
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Trash"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    # Time until TrashFile returns, in ms
+    params.delay = parameters.get("delay", 0)
+    # TrashFile fails for files with these names
+    params.fail = parameters.get("fail", [])
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 1)),
+                # Not part of the portal: the paths of the files passed to
+                # TrashFile, in order
+                "Trashed": dbus.Array([], signature="s"),
+            }
+        ),
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="h",
+    out_signature="u",
+    async_callbacks=("ok_cb", "err_cb"),
+)
+def TrashFile(self, fd, sender, ok_cb, err_cb):
+    try:
+        fd = fd.take()
+        try:
+            path = os.readlink(f"/proc/self/fd/{fd}")
+        finally:
+            os.close(fd)
+
+        logger.debug(f"TrashFile: {path}")
+        params = MockParams.get(self, MAIN_IFACE)
+
+        self.props[MAIN_IFACE]["Trashed"].append(dbus.String(path))
+
+        def reply():
+            failed = os.path.basename(path) in params.fail
+            ok_cb(dbus.UInt32(0 if failed else 1))
+            return False
+
+        if params.delay > 0:
+            GLib.timeout_add(params.delay, reply)
+        else:
+            reply()
+    except Exception as e:
+        logger.critical(e)
+        err_cb(e)
@@ -0,0 +1,161 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Gio, GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestBackground(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(2)
+
+    def run_until(self, condition, timeout=2000):
+        timed_out = False
+
+        def on_timeout():
+            nonlocal timed_out
+            timed_out = True
+            return False
+
+        source = GLib.timeout_add(timeout, on_timeout)
+        context = GLib.MainContext.default()
+        while not condition() and not timed_out:
+            context.iteration(True)
+        if not timed_out:
+            GLib.source_remove(source)
+        assert condition()
+
+    def run_for(self, ms):
+        loop = GLib.MainLoop()
+        GLib.timeout_add(ms, loop.quit)
+        loop.run()
+
+    def set_status(self, xdp, message, results):
+        def status_set(portal, task, data):
+            try:
+                results[message].append(portal.set_background_status_finish(task))
+            except GLib.Error as e:
+                results[message].append(e)
+
+        results.setdefault(message, [])
+        xdp.set_background_status(message, None, status_set, None)
+
+    def get_messages(self):
+        return [
+            str(args[0]["message"])
+            for _, args in self.mock_interface.GetMethodCalls("SetStatus")
+        ]
+
+    def test_status_interval(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+        xdp.set_background_status_interval(500)
+
+        # The first update goes out right away, the ones made within the
+        # interval replace each other
+        results = {}
+        for message in ["one", "two", "three", "four"]:
+            self.set_status(xdp, message, results)
+        self.run_until(lambda: len(results["one"]) == 1)
+        assert self.get_messages() == ["one"]
+        assert results["four"] == []
+
+        self.run_until(lambda: all(len(r) == 1 for r in results.values()))
+        assert self.get_messages() == ["one", "four"]
+        assert all(r == [True] for r in results.values())
+        assert xdp.get_background_status_suppressed() == 2
+
+    def test_status_dedup(self):
+        params = {"delay": 300}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+        xdp.set_background_status_interval(100)
+
+        # A repeat of the status that is being sent completes along with
+        # that call, not before
+        results = {}
+        self.set_status(xdp, "busy", results)
+        self.run_for(50)
+        self.set_status(xdp, "busy", results)
+        self.run_for(50)
+        assert results["busy"] == []
+
+        self.run_until(lambda: len(results["busy"]) == 2)
+        assert results["busy"] == [True, True]
+
+        # Once the portal has it, repeats complete right away
+        self.set_status(xdp, "busy", results)
+        self.run_until(lambda: len(results["busy"]) == 3)
+
+        assert self.get_messages() == ["busy"]
+        assert xdp.get_background_status_suppressed() == 2
+
+    def test_status_dedup_after_failure(self):
+        params = {"fail": 1, "delay": 100}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+        xdp.set_background_status_interval(1000)
+
+        # The repeat is chained onto the call that fails, and fails with it
+        results = {}
+        self.set_status(xdp, "busy", results)
+        self.set_status(xdp, "busy", results)
+        self.run_until(lambda: len(results["busy"]) == 2)
+        for result in results["busy"]:
+            assert isinstance(result, GLib.Error)
+            assert result.matches(Gio.dbus_error_quark(), Gio.DBusError.FAILED)
+
+        # The portal doesn't have the status, so it is sent again, without
+        # waiting for the interval
+        self.set_status(xdp, "busy", results)
+        self.run_until(lambda: len(results["busy"]) == 3)
+        assert results["busy"][2] is True
+        assert self.get_messages() == ["busy", "busy"]
+
+    def test_status_without_interval(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        results = {}
+        for _ in range(3):
+            self.set_status(xdp, "busy", results)
+        self.run_until(lambda: len(results["busy"]) == 3)
+
+        # Every update is sent
+        assert results["busy"] == [True] * 3
+        assert self.get_messages() == ["busy"] * 3
+        assert xdp.get_background_status_suppressed() == 0
+
+    def test_status_version_1(self):
+        params = {"version": 1}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        results = {}
+        self.set_status(xdp, "busy", results)
+        self.run_until(lambda: results["busy"])
+
+        error = results["busy"][0]
+        assert isinstance(error, GLib.Error)
+        assert error.matches(Gio.dbus_error_quark(), Gio.DBusError.FAILED)
+        assert self.get_messages() == []
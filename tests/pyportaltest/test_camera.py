@@ -0,0 +1,118 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import dbus
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestCamera(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def run_until(self, condition, timeout=2000):
+        timed_out = False
+
+        def on_timeout():
+            nonlocal timed_out
+            timed_out = True
+            return False
+
+        source = GLib.timeout_add(timeout, on_timeout)
+        context = GLib.MainContext.default()
+        while not condition() and not timed_out:
+            context.iteration(True)
+        if not timed_out:
+            GLib.source_remove(source)
+        assert condition()
+
+    def watch_camera_present(self, xdp):
+        notifications = []
+        xdp.connect(
+            "notify::camera-present",
+            lambda portal, pspec: notifications.append(portal.props.camera_present),
+        )
+        return notifications
+
+    def fetch_camera_present(self, xdp):
+        present, error = None, None
+
+        def fetch_done(portal, task, data):
+            nonlocal present, error
+            try:
+                present = portal.fetch_camera_present_finish(task)
+            except GLib.Error as e:
+                error = e
+            self.mainloop.quit()
+
+        xdp.fetch_camera_present(None, fetch_done, None)
+        self.mainloop.run()
+
+        assert error is None
+        return present
+
+    def test_fetch(self):
+        params = {"present": True}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        notifications = self.watch_camera_present(xdp)
+        assert self.fetch_camera_present(xdp)
+        assert notifications == [True]
+        assert xdp.props.camera_present
+
+    def test_notify_on_change(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        assert not xdp.is_camera_present()
+        notifications = self.watch_camera_present(xdp)
+
+        self.mock_interface.UpdateProperties(
+            self.INTERFACE_NAME, {"IsCameraPresent": dbus.Boolean(True)}
+        )
+        self.run_until(lambda: notifications == [True])
+        assert xdp.is_camera_present()
+
+        self.mock_interface.UpdateProperties(
+            self.INTERFACE_NAME, {"IsCameraPresent": dbus.Boolean(False)}
+        )
+        self.run_until(lambda: notifications == [True, False])
+        assert not xdp.is_camera_present()
+
+    def test_notify_on_invalidate(self):
+        params = {"present": True}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        assert self.fetch_camera_present(xdp)
+        notifications = self.watch_camera_present(xdp)
+
+        # Only announce that the value changed, without the new value, so
+        # it has to be fetched again
+        self.properties_interface.Set(
+            self.INTERFACE_NAME, "IsCameraPresent", dbus.Boolean(False)
+        )
+        self.mock_interface.EmitSignal(
+            dbus.PROPERTIES_IFACE,
+            "PropertiesChanged",
+            "sa{sv}as",
+            [self.INTERFACE_NAME, dbus.Dictionary({}, signature="sv"), ["IsCameraPresent"]],
+        )
+        self.run_until(lambda: notifications == [False])
+        assert not xdp.is_camera_present()
@@ -0,0 +1,252 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import dbus
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestClipboard(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def run_until(self, condition, timeout=5000):
+        timed_out = False
+
+        def on_timeout():
+            nonlocal timed_out
+            timed_out = True
+            return False
+
+        source = GLib.timeout_add(timeout, on_timeout)
+        context = GLib.MainContext.default()
+        while not condition() and not timed_out:
+            context.iteration(True)
+        if not timed_out:
+            GLib.source_remove(source)
+        assert condition()
+
+    def run_for(self, ms):
+        loop = GLib.MainLoop()
+        GLib.timeout_add(ms, loop.quit)
+        loop.run()
+
+    def create_session(self, params=None):
+        self.setup_daemon(params or {}, extra_templates=[("RemoteDesktop", {})])
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        session = None
+
+        def create_session_done(portal, task, data):
+            nonlocal session
+            session = portal.create_remote_desktop_session_finish(task)
+            self.mainloop.quit()
+
+        xdp.create_remote_desktop_session(
+            devices=Xdp.DeviceType.KEYBOARD,
+            outputs=Xdp.OutputType.NONE,
+            flags=Xdp.RemoteDesktopFlags.NONE,
+            cursor_mode=Xdp.CursorMode.HIDDEN,
+            cancellable=None,
+            callback=create_session_done,
+            data=None,
+        )
+        self.mainloop.run()
+        assert session is not None
+
+        session.request_clipboard()
+        self.run_until(
+            lambda: self.properties_interface.Get(self.INTERFACE_NAME, "ClipboardSender")
+        )
+
+        return xdp, session
+
+    def send_transfer(self, mime_type, serial):
+        session_handle = self.properties_interface.Get(
+            self.INTERFACE_NAME, "ClipboardSession"
+        )
+        sender = self.properties_interface.Get(self.INTERFACE_NAME, "ClipboardSender")
+        self.mock_interface.EmitSignalDetailed(
+            self.INTERFACE_NAME,
+            "SelectionTransfer",
+            "osu",
+            [dbus.ObjectPath(session_handle), mime_type, dbus.UInt32(serial)],
+            dbus.Dictionary({"destination": sender}, signature="sv"),
+        )
+
+    def get_write_done(self):
+        return {
+            int(args[1]): bool(args[2])
+            for _, args in self.mock_interface.GetMethodCalls("SelectionWriteDone")
+        }
+
+    def get_written(self):
+        written = self.properties_interface.Get(self.INTERFACE_NAME, "Written")
+        return {int(serial): bytes(data) for serial, data in written.items()}
+
+    def test_content_served(self):
+        _, session = self.create_session()
+
+        delegated = []
+        session.connect(
+            "selection-transfer",
+            lambda session, mime_type, serial: delegated.append(serial),
+        )
+
+        # Larger than a pipe buffer, so the writer has to wait for the
+        # reader
+        content = bytes(range(256)) * 1024
+        session.set_selection_content("text/plain", GLib.Bytes.new(content))
+        session.set_selection(["text/plain"])
+
+        for serial in [1, 2, 3]:
+            self.send_transfer("text/plain", serial)
+        self.run_until(lambda: len(self.get_write_done()) == 3)
+        self.run_until(lambda: len(self.get_written()) == 3)
+
+        # Stored content is served without bothering the application
+        assert delegated == []
+        assert self.get_write_done() == {1: True, 2: True, 3: True}
+        assert self.get_written() == {1: content, 2: content, 3: content}
+
+        n_queued, n_active, n_completed, n_failed, n_bytes, _ = (
+            session.get_selection_transfer_stats()
+        )
+        assert (n_queued, n_active) == (0, 0)
+        assert (n_completed, n_failed) == (3, 0)
+        assert n_bytes == 3 * len(content)
+
+    def test_content_func(self):
+        _, session = self.create_session()
+
+        requested = []
+
+        def produce(session, mime_type, data):
+            requested.append(mime_type)
+            return GLib.Bytes.new(mime_type.encode("utf-8"))
+
+        session.set_selection_content_func("text/html", produce, None)
+
+        self.send_transfer("text/html", 1)
+        self.send_transfer("text/html", 2)
+        self.run_until(lambda: len(self.get_written()) == 2)
+
+        # The content is produced once, on first use
+        assert requested == ["text/html"]
+        assert self.get_written() == {1: b"text/html", 2: b"text/html"}
+        self.run_until(lambda: self.get_write_done() == {1: True, 2: True})
+
+    def test_content_dropped_on_owner_change(self):
+        _, session = self.create_session()
+
+        delegated = []
+        session.connect(
+            "selection-transfer",
+            lambda session, mime_type, serial: delegated.append(serial),
+        )
+
+        session.set_selection_content("text/plain", GLib.Bytes.new(b"content"))
+
+        # Another client takes the selection, so requests for it go to
+        # the application again
+        session_handle = self.properties_interface.Get(
+            self.INTERFACE_NAME, "ClipboardSession"
+        )
+        sender = self.properties_interface.Get(self.INTERFACE_NAME, "ClipboardSender")
+        self.mock_interface.EmitSignalDetailed(
+            self.INTERFACE_NAME,
+            "SelectionOwnerChanged",
+            "oa{sv}",
+            [
+                dbus.ObjectPath(session_handle),
+                dbus.Dictionary(
+                    {
+                        "mime_types": dbus.Array(["text/plain"], signature="s"),
+                        "session_is_owner": dbus.Boolean(False),
+                    },
+                    signature="sv",
+                ),
+            ],
+            dbus.Dictionary({"destination": sender}, signature="sv"),
+        )
+        self.run_until(lambda: session.get_selection_mime_types() == ["text/plain"])
+
+        self.send_transfer("text/plain", 1)
+        self.run_until(lambda: delegated == [1])
+        assert (
+            session.get_selection_transfer_state(1)
+            == Xdp.SelectionTransferState.DELEGATED
+        )
+
+        session.selection_write_done(1, False)
+        self.run_until(lambda: self.get_write_done() == {1: False})
+        assert session.get_selection_transfer_state(1) == Xdp.SelectionTransferState.NONE
+
+    def test_delegated_timeout(self):
+        _, session = self.create_session()
+        session.set_selection_transfer_limits(1, 200)
+
+        delegated = []
+        session.connect(
+            "selection-transfer",
+            lambda session, mime_type, serial: delegated.append(serial),
+        )
+
+        self.send_transfer("text/plain", 1)
+        self.run_until(lambda: delegated == [1])
+        assert (
+            session.get_selection_transfer_state(1)
+            == Xdp.SelectionTransferState.DELEGATED
+        )
+
+        # The application never completes the transfer, so it is failed
+        # on its behalf
+        self.run_until(lambda: self.get_write_done() == {1: False})
+        assert session.get_selection_transfer_state(1) == Xdp.SelectionTransferState.NONE
+
+        # Completing it late doesn't reach the portal
+        session.selection_write_done(1, True)
+        self.run_for(100)
+        assert len(self.mock_interface.GetMethodCalls("SelectionWriteDone")) == 1
+
+        _, _, n_completed, n_failed, _, _ = session.get_selection_transfer_stats()
+        assert (n_completed, n_failed) == (0, 1)
+
+    def test_transfer_limits(self):
+        params = {"stalled": [1]}
+        _, session = self.create_session(params)
+        session.set_selection_transfer_limits(1, 500)
+
+        content = bytes(range(256)) * 1024
+        session.set_selection_content("text/plain", GLib.Bytes.new(content))
+
+        # Only one transfer runs at a time, the stuck one holds up the
+        # other until it times out
+        self.send_transfer("text/plain", 1)
+        self.send_transfer("text/plain", 2)
+        self.run_until(
+            lambda: len(self.mock_interface.GetMethodCalls("SelectionWrite")) == 1
+        )
+        self.run_for(100)
+        assert session.get_selection_transfer_state(1) == Xdp.SelectionTransferState.ACTIVE
+        assert session.get_selection_transfer_state(2) == Xdp.SelectionTransferState.QUEUED
+
+        n_queued, n_active, _, _, _, _ = session.get_selection_transfer_stats()
+        assert (n_queued, n_active) == (1, 1)
+
+        self.run_until(lambda: self.get_write_done() == {1: False, 2: True})
+        self.run_until(lambda: 2 in self.get_written())
+        assert self.get_written()[2] == content
+
+        _, _, n_completed, n_failed, _, _ = session.get_selection_transfer_stats()
+        assert (n_completed, n_failed) == (1, 1)
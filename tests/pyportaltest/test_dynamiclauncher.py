@@ -0,0 +1,65 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Xdp
+
+logger = logging.getLogger(__name__)
+
+DESKTOP_ENTRY = "[Desktop Entry]\nType=Application\nExec=true\n"
+
+
+class TestDynamicLauncher(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def install_many(self, xdp, n):
+        result = None
+
+        def install_many_done(portal, task, data):
+            nonlocal result
+            result = portal.dynamic_launcher_install_many_finish(task)
+            self.mainloop.quit()
+
+        xdp.dynamic_launcher_install_many(
+            [f"token{i}" for i in range(n)],
+            [f"org.example.App.Launcher{i}.desktop" for i in range(n)],
+            [DESKTOP_ENTRY] * n,
+            None,
+            install_many_done,
+            None,
+        )
+        self.mainloop.run()
+        return result
+
+    def test_install_many(self):
+        params = {
+            "delay": 50,
+            "fail": ["org.example.App.Launcher3.desktop"],
+        }
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        errors = self.install_many(xdp, 20)
+        assert len(errors) == 20
+        for i, error in enumerate(errors):
+            if i == 3:
+                assert error is not None
+            else:
+                assert error is None
+
+        method_calls = self.mock_interface.GetMethodCalls("Install")
+        assert len(method_calls) == 20
+        for i, (_, args) in enumerate(method_calls):
+            token, desktop_file_id, desktop_entry, options = args
+            assert token == f"token{i}"
+            assert desktop_file_id == f"org.example.App.Launcher{i}.desktop"
+            assert desktop_entry == DESKTOP_ENTRY
@@ -0,0 +1,174 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import fcntl
+import gi
+import logging
+import os
+import tempfile
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Gio, GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+SEALS = fcntl.F_SEAL_SHRINK | fcntl.F_SEAL_GROW | fcntl.F_SEAL_WRITE | fcntl.F_SEAL_SEAL
+
+
+class TestEmail(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(4)
+
+    def compose_email(
+        self,
+        xdp,
+        addresses=None,
+        attachments=None,
+        attachment_bytes=None,
+        attachment_streams=None,
+    ):
+        success, error = None, None
+
+        def compose_done(portal, task, data):
+            nonlocal success, error
+            try:
+                success = portal.compose_email_full_finish(task)
+            except GLib.Error as e:
+                error = e
+            self.mainloop.quit()
+
+        xdp.compose_email_full(
+            None,
+            addresses,
+            None,
+            None,
+            "Subject",
+            "Body",
+            attachments,
+            attachment_bytes,
+            attachment_streams,
+            Xdp.EmailFlags.NONE,
+            None,
+            compose_done,
+            None,
+        )
+        self.mainloop.run()
+
+        return success, error
+
+    def get_attachments(self):
+        names = self.properties_interface.Get(self.INTERFACE_NAME, "AttachmentNames")
+        contents = self.properties_interface.Get(self.INTERFACE_NAME, "Attachments")
+        seals = self.properties_interface.Get(self.INTERFACE_NAME, "AttachmentSeals")
+        return [str(n) for n in names], [bytes(c) for c in contents], list(seals)
+
+    def test_attachments(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        tmpdir = tempfile.TemporaryDirectory()
+        self.addCleanup(tmpdir.cleanup)
+        path = os.path.join(tmpdir.name, "attachment.txt")
+        with open(path, "wb") as f:
+            f.write(b"file")
+
+        # Larger than a single splice chunk
+        streamed = bytes(range(256)) * 1024
+        success, error = self.compose_email(
+            xdp,
+            attachments=[path, os.path.join(tmpdir.name, "missing.txt")],
+            attachment_bytes=[GLib.Bytes.new(b"bytes"), GLib.Bytes.new(b"")],
+            attachment_streams=[
+                Gio.MemoryInputStream.new_from_bytes(GLib.Bytes.new(streamed))
+            ],
+        )
+        assert error is None
+        assert success
+
+        # Attachments keep their order, files that can't be opened are
+        # skipped, and in-memory ones arrive in sealed memfds
+        names, contents, seals = self.get_attachments()
+        assert len(names) == 4
+        assert names[0] == os.path.realpath(path)
+        assert all(n.startswith("/memfd:libportal-attachment") for n in names[1:])
+        assert contents[1:] == [b"bytes", b"", streamed]
+        assert seals[1:] == [SEALS] * 3
+
+    def test_attachment_stream_error(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        stream = Gio.MemoryInputStream.new_from_bytes(GLib.Bytes.new(b"stream"))
+        stream.close(None)
+        success, error = self.compose_email(
+            xdp,
+            attachment_bytes=[GLib.Bytes.new(b"bytes")],
+            attachment_streams=[stream],
+        )
+        assert success is None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.CLOSED)
+
+        # A request with an unreadable in-memory attachment is not sent
+        assert self.mock_interface.GetMethodCalls("ComposeEmail") == []
+
+    def test_addresses(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        for _ in range(2):
+            success, error = self.compose_email(
+                xdp, addresses=["one@example.com", "two@example.com"]
+            )
+            assert error is None
+            assert success
+
+        method_calls = self.mock_interface.GetMethodCalls("ComposeEmail")
+        assert len(method_calls) == 2
+        for _, args in method_calls:
+            assert list(args[1]["addresses"]) == ["one@example.com", "two@example.com"]
+            assert "address" not in args[1]
+            assert args[1]["subject"] == "Subject"
+            assert args[1]["body"] == "Body"
+
+    def test_addresses_version_2(self):
+        params = {"version": 2}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        success, error = self.compose_email(
+            xdp, addresses=["one@example.com", "two@example.com"]
+        )
+        assert error is None
+        assert success
+
+        # Older portals only take a single address
+        _, args = self.mock_interface.GetMethodCalls("ComposeEmail")[0]
+        assert args[1]["address"] == "one@example.com"
+        assert "addresses" not in args[1]
+
+    def test_failed(self):
+        params = {"response": 2}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        success, error = self.compose_email(
+            xdp, attachment_bytes=[GLib.Bytes.new(b"bytes")]
+        )
+        assert success is None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.FAILED)
@@ -0,0 +1,335 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Gio, GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestFlatpak(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(7)
+
+    def run_for(self, ms):
+        loop = GLib.MainLoop()
+        GLib.timeout_add(ms, loop.quit)
+        loop.run()
+
+    def spawn(self, xdp, argv):
+        pid, spawn_error = None, None
+
+        def spawn_done(portal, task, data):
+            nonlocal pid, spawn_error
+            try:
+                pid = portal.spawn_finish(task)
+            except GLib.Error as e:
+                spawn_error = e
+            self.mainloop.quit()
+
+        xdp.spawn(
+            cwd="/",
+            argv=argv,
+            fds=[],
+            map_to=[],
+            env=None,
+            flags=Xdp.SpawnFlags.NONE,
+            sandbox_expose=None,
+            sandbox_expose_ro=None,
+            cancellable=None,
+            callback=spawn_done,
+            data=None,
+        )
+        self.mainloop.run()
+
+        assert spawn_error is None
+        return pid
+
+    def test_spawn_wait_pid_reuse(self):
+        params = {
+            "pids": [1234, 1234],
+            "exit-delays": [0, 300],
+            "exit-statuses": [0, 256],
+        }
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        # The first process exits before anyone waits for it
+        assert self.spawn(xdp, ["first"]) == 1234
+        self.run_for(100)
+
+        # The second one gets the same pid, and must not report the exit
+        # status of the first one
+        assert self.spawn(xdp, ["second"]) == 1234
+
+        wait_result = None
+
+        def wait_done(portal, task, data):
+            nonlocal wait_result
+            wait_result = portal.spawn_wait_finish(task)
+
+        xdp.spawn_wait(1234, None, wait_done, None)
+        self.run_for(100)
+        assert wait_result is None
+
+        self.run_for(400)
+        assert wait_result == (True, 256)
+
+    def test_spawn_wait_after_exit(self):
+        params = {
+            "pids": [4321],
+            "exit-delays": [0],
+            "exit-statuses": [256],
+        }
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        assert self.spawn(xdp, ["true"]) == 4321
+        self.run_for(100)
+
+        wait_result = None
+
+        def wait_done(portal, task, data):
+            nonlocal wait_result
+            wait_result = portal.spawn_wait_finish(task)
+
+        xdp.spawn_wait(4321, None, wait_done, None)
+        self.run_for(50)
+
+        assert wait_result == (True, 256)
+
+    def test_spawn_pool_spawn_failure(self):
+        params = {"fail": ["worker"]}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        pool = Xdp.SpawnPool.new(
+            xdp, "/", ["worker"], None, Xdp.SpawnFlags.NONE, None, None, 3
+        )
+
+        run_done_invoked = False
+        run_error = None
+
+        def run_done(pool, task, data):
+            nonlocal run_done_invoked, run_error
+            run_done_invoked = True
+            try:
+                pool.run_finish(task)
+            except GLib.Error as e:
+                run_error = e
+
+        pool.run(GLib.Bytes.new(b"job"), None, run_done, None)
+
+        # The pool retries with a growing delay, then gives up
+        self.run_for(3000)
+
+        assert run_done_invoked
+        assert run_error is not None
+        method_calls = self.mock_interface.GetMethodCalls("Spawn")
+        assert len(method_calls) == 5
+
+        # No more attempts after giving up
+        self.run_for(500)
+        method_calls = self.mock_interface.GetMethodCalls("Spawn")
+        assert len(method_calls) == 5
+
+    def spawn_many(self, xdp, argvs, max_in_flight, cancellable=None):
+        result = None
+
+        def spawn_many_done(portal, task, data):
+            nonlocal result
+            result = portal.spawn_many_finish(task)
+            self.mainloop.quit()
+
+        xdp.spawn_many(
+            "/",
+            argvs,
+            None,
+            Xdp.SpawnFlags.NONE,
+            None,
+            None,
+            max_in_flight,
+            cancellable,
+            spawn_many_done,
+            None,
+        )
+        return lambda: result
+
+    def test_spawn_many_window(self):
+        params = {"spawn-delay": 100, "pids": [11, 12, 13, 14, 15]}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        argvs = [[f"process{i}"] for i in range(5)]
+        result = self.spawn_many(xdp, argvs, 2)
+        self.mainloop.run()
+
+        pids, errors = result()
+        assert list(pids) == [11, 12, 13, 14, 15]
+        assert all(e is None for e in errors)
+
+        method_calls = self.mock_interface.GetMethodCalls("Spawn")
+        assert len(method_calls) == 5
+        assert self.properties_interface.Get(self.INTERFACE_NAME, "MaxInFlight") == 2
+
+    def test_spawn_many_cancel(self):
+        params = {"spawn-delay": 200, "pids": [21, 22, 23, 24]}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        cancellable = Gio.Cancellable()
+        argvs = [[f"process{i}"] for i in range(4)]
+        result = self.spawn_many(xdp, argvs, 2, cancellable)
+
+        # Cancel while the first two Spawn calls are pending; they were
+        # sent already, so their pids are still reported
+        GLib.timeout_add(50, cancellable.cancel)
+        self.mainloop.run()
+
+        pids, errors = result()
+        assert list(pids) == [21, 22, 0, 0]
+        assert errors[0] is None and errors[1] is None
+        assert errors[2].matches(Gio.io_error_quark(), Gio.IOErrorEnum.CANCELLED)
+        assert errors[3].matches(Gio.io_error_quark(), Gio.IOErrorEnum.CANCELLED)
+
+        method_calls = self.mock_interface.GetMethodCalls("Spawn")
+        assert len(method_calls) == 2
+
+    def spawn_subprocess(self, xdp, flags):
+        subprocess, spawn_error = None, None
+
+        def spawn_done(portal, task, data):
+            nonlocal subprocess, spawn_error
+            try:
+                subprocess = portal.spawn_subprocess_finish(task)
+            except GLib.Error as e:
+                spawn_error = e
+            self.mainloop.quit()
+
+        xdp.spawn_subprocess(
+            "/",
+            ["cat"],
+            None,
+            Xdp.SpawnFlags.NONE,
+            flags,
+            None,
+            None,
+            None,
+            spawn_done,
+            None,
+        )
+        self.mainloop.run()
+
+        assert spawn_error is None
+        return subprocess
+
+    def read_all(self, stream):
+        data = b""
+        while chunk := stream.read_bytes(4096, None).get_data():
+            data += chunk
+        return data
+
+    def wait_subprocess(self, subprocess):
+        result = None
+
+        def wait_done(subprocess, task, data):
+            nonlocal result
+            result = subprocess.wait_finish(task)
+            self.mainloop.quit()
+
+        subprocess.wait(None, wait_done, None)
+        self.mainloop.run()
+        return result
+
+    def test_subprocess_pipes(self):
+        params = {"pids": [3456], "exit-delays": [300], "exit-statuses": [256], "echo": True}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        subprocess = self.spawn_subprocess(
+            xdp,
+            Xdp.SubprocessFlags.STDIN_PIPE
+            | Xdp.SubprocessFlags.STDOUT_PIPE
+            | Xdp.SubprocessFlags.STDERR_PIPE,
+        )
+        assert subprocess.get_pid() == 3456
+        assert subprocess.get_stdin_fd() >= 0
+        assert subprocess.get_stdout_fd() >= 0
+        assert subprocess.get_stderr_fd() >= 0
+
+        # The fds mapped into the process are the other ends of the pipes
+        _, args = self.mock_interface.GetMethodCalls("Spawn")[0]
+        assert sorted(args[2].keys()) == [0, 1, 2]
+
+        stdin = subprocess.get_stdin_pipe()
+        stdin.write_all(b"hello", None)
+        stdin.close(None)
+
+        assert self.read_all(subprocess.get_stdout_pipe()) == b"hello"
+        assert self.read_all(subprocess.get_stderr_pipe()) == b"error\n"
+
+        assert not subprocess.get_if_exited()
+        assert self.wait_subprocess(subprocess) == (True, 256)
+        assert subprocess.get_if_exited()
+        assert subprocess.get_exit_status() == 256
+
+    def test_subprocess_stderr_merge(self):
+        params = {"echo": True}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        subprocess = self.spawn_subprocess(
+            xdp,
+            Xdp.SubprocessFlags.STDOUT_PIPE | Xdp.SubprocessFlags.STDERR_MERGE,
+        )
+        assert subprocess.get_stdin_pipe() is None
+        assert subprocess.get_stderr_pipe() is None
+        assert subprocess.get_stdin_fd() == -1
+
+        assert self.read_all(subprocess.get_stdout_pipe()) == b"error\n"
+
+    def test_subprocess_wait_after_exit(self):
+        params = {"pids": [5678], "exit-delays": [0], "exit-statuses": [512]}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        subprocess = self.spawn_subprocess(xdp, Xdp.SubprocessFlags.NONE)
+        self.run_for(100)
+
+        assert subprocess.get_if_exited()
+        assert self.wait_subprocess(subprocess) == (True, 512)
+
+        # The exit status is also known to the portal, for callers that
+        # only have the pid
+        wait_result = None
+
+        def wait_done(portal, task, data):
+            nonlocal wait_result
+            wait_result = portal.spawn_wait_finish(task)
+
+        xdp.spawn_wait(5678, None, wait_done, None)
+        self.run_for(50)
+
+        assert wait_result == (True, 512)
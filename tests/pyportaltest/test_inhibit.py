@@ -0,0 +1,249 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import dbus
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Gio, GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestInhibit(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(3)
+
+    def run_until(self, condition, timeout=2000):
+        timed_out = False
+
+        def on_timeout():
+            nonlocal timed_out
+            timed_out = True
+            return False
+
+        source = GLib.timeout_add(timeout, on_timeout)
+        context = GLib.MainContext.default()
+        while not condition() and not timed_out:
+            context.iteration(True)
+        if not timed_out:
+            GLib.source_remove(source)
+        assert condition()
+
+    def run_for(self, ms):
+        loop = GLib.MainLoop()
+        GLib.timeout_add(ms, loop.quit)
+        loop.run()
+
+    def get_events(self):
+        return [str(e) for e in self.properties_interface.Get(self.INTERFACE_NAME, "Events")]
+
+    def inhibit(self, xdp, flags, results):
+        def inhibit_done(portal, task, data):
+            try:
+                results[flags] = portal.session_inhibit_finish(task)
+            except GLib.Error as e:
+                results[flags] = e
+
+        xdp.session_inhibit(None, "Testing", flags, None, inhibit_done, None)
+
+    def test_coalescing_shared(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+        xdp.set_inhibit_coalescing(True)
+
+        ids = []
+        for _ in range(2):
+            results = {}
+            self.inhibit(xdp, Xdp.InhibitFlags.LOGOUT, results)
+            self.run_until(lambda: results)
+            ids.append(results[Xdp.InhibitFlags.LOGOUT])
+
+        # Callers get IDs of their own, but share one portal inhibition
+        assert all(id > 0 for id in ids)
+        assert ids[0] != ids[1]
+        assert len(self.mock_interface.GetMethodCalls("Inhibit")) == 1
+        assert self.get_events() == ["Inhibit 1"]
+
+        # The inhibition is kept until the last caller is gone
+        xdp.session_uninhibit(ids[0])
+        self.run_for(100)
+        assert self.get_events() == ["Inhibit 1"]
+
+        xdp.session_uninhibit(ids[1])
+        self.run_until(lambda: self.get_events() == ["Inhibit 1", "Close 1"])
+
+    def test_coalescing_union(self):
+        params = {"delay": 200}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+        xdp.set_inhibit_coalescing(True)
+
+        # The second request arrives while the first one is in flight,
+        # and is folded into a single follow-up request
+        results = {}
+        self.inhibit(xdp, Xdp.InhibitFlags.LOGOUT, results)
+        self.inhibit(xdp, Xdp.InhibitFlags.IDLE, results)
+        self.inhibit(xdp, Xdp.InhibitFlags.LOGOUT | Xdp.InhibitFlags.IDLE, results)
+        self.run_until(lambda: len(results) == 3)
+        assert all(id > 0 for id in results.values())
+
+        method_calls = self.mock_interface.GetMethodCalls("Inhibit")
+        assert [args[1] for _, args in method_calls] == [1, 9]
+
+        # The new inhibition is in place before the old one goes away
+        self.run_until(lambda: len(self.get_events()) == 3)
+        assert self.get_events() == ["Inhibit 1", "Inhibit 9", "Close 1"]
+
+        # Narrowing the union replaces the inhibition again, but removing
+        # a request whose flags are still covered doesn't
+        xdp.session_uninhibit(results[Xdp.InhibitFlags.LOGOUT | Xdp.InhibitFlags.IDLE])
+        self.run_for(100)
+        assert len(self.mock_interface.GetMethodCalls("Inhibit")) == 2
+
+        xdp.session_uninhibit(results[Xdp.InhibitFlags.IDLE])
+        self.run_until(lambda: len(self.get_events()) == 5)
+        assert self.get_events()[3:] == ["Inhibit 1", "Close 9"]
+
+    def test_coalescing_failure(self):
+        params = {"response": 2}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+        xdp.set_inhibit_coalescing(True)
+
+        results = {}
+        self.inhibit(xdp, Xdp.InhibitFlags.SUSPEND, results)
+        self.run_until(lambda: results)
+
+        error = results[Xdp.InhibitFlags.SUSPEND]
+        assert isinstance(error, GLib.Error)
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.FAILED)
+        assert self.get_events() == []
+
+        # Failed requests are not counted, so a later one is sent again
+        self.inhibit(xdp, Xdp.InhibitFlags.SUSPEND, results)
+        self.run_until(lambda: len(self.mock_interface.GetMethodCalls("Inhibit")) == 2)
+
+    def start_session_monitor(self, xdp):
+        success = None
+
+        def monitor_started(portal, task, data):
+            nonlocal success
+            success = portal.session_monitor_start_finish(task)
+            self.mainloop.quit()
+
+        xdp.session_monitor_start(
+            None, Xdp.SessionMonitorFlags.NONE, None, monitor_started, None
+        )
+        self.mainloop.run()
+        assert success
+
+    def send_state(self, screensaver_active, session_state):
+        handle = self.properties_interface.Get(self.INTERFACE_NAME, "MonitorHandle")
+        sender = self.properties_interface.Get(self.INTERFACE_NAME, "MonitorSender")
+        self.mock_interface.EmitSignalDetailed(
+            self.INTERFACE_NAME,
+            "StateChanged",
+            "oa{sv}",
+            [
+                dbus.ObjectPath(handle),
+                dbus.Dictionary(
+                    {
+                        "screensaver-active": dbus.Boolean(screensaver_active),
+                        "session-state": dbus.UInt32(session_state),
+                    },
+                    signature="sv",
+                ),
+            ],
+            dbus.Dictionary({"destination": sender}, signature="sv"),
+        )
+
+    def test_session_state(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        states = []
+        xdp.connect(
+            "session-state-changed",
+            lambda portal, active, state: states.append((active, state)),
+        )
+
+        # Nothing is known before the portal reports the state
+        assert xdp.get_session_state() == (False, False, Xdp.LoginSessionState.RUNNING)
+
+        self.start_session_monitor(xdp)
+        assert xdp.get_session_state() == (False, False, Xdp.LoginSessionState.RUNNING)
+
+        self.send_state(True, Xdp.LoginSessionState.QUERY_END)
+        self.run_until(lambda: len(states) == 1)
+        assert states == [(True, Xdp.LoginSessionState.QUERY_END)]
+        assert xdp.get_session_state() == (True, True, Xdp.LoginSessionState.QUERY_END)
+
+        xdp.session_monitor_query_end_response()
+        self.run_until(
+            lambda: len(self.mock_interface.GetMethodCalls("QueryEndResponse")) == 1
+        )
+
+        # The cached state is dropped once monitoring stops
+        xdp.session_monitor_stop()
+        assert xdp.get_session_state() == (False, False, Xdp.LoginSessionState.RUNNING)
+
+    def test_idle_scheduler(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        self.start_session_monitor(xdp)
+        scheduler = Xdp.IdleScheduler.new(xdp)
+        assert not scheduler.is_idle()
+
+        slices = []
+
+        def work(name, n_slices):
+            def run(data):
+                slices.append(name)
+                return slices.count(name) < n_slices
+
+            return run
+
+        scheduler.add(work("first", 3), None)
+        scheduler.add(work("second", 2), None)
+        assert scheduler.get_n_pending() == 2
+
+        # Nothing runs while the user is around
+        self.run_for(100)
+        assert slices == []
+
+        # Work items run one after another once the screensaver is on
+        self.send_state(True, Xdp.LoginSessionState.RUNNING)
+        self.run_until(lambda: scheduler.get_n_pending() == 0)
+        assert scheduler.is_idle()
+        assert slices == ["first"] * 3 + ["second"] * 2
+
+        # Work is not started while the session is ending
+        self.send_state(True, Xdp.LoginSessionState.ENDING)
+        self.run_until(lambda: not scheduler.is_idle())
+        id = scheduler.add(work("third", 1), None)
+        self.run_for(100)
+        assert slices.count("third") == 0
+        assert scheduler.get_n_pending() == 1
+
+        assert scheduler.remove(id)
+        assert not scheduler.remove(id)
+        assert scheduler.get_n_pending() == 0
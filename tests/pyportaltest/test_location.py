@@ -0,0 +1,220 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestLocation(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def start_location(self, fixes, fix_interval=100, timestamps=True):
+        params = {"fixes": fixes, "fix-interval": fix_interval, "timestamps": timestamps}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        start_result, start_error = None, None
+
+        def start_done(portal, task, data):
+            nonlocal start_result, start_error
+            try:
+                start_result = portal.location_monitor_start_finish(task)
+            except GLib.Error as e:
+                start_error = e
+
+        xdp.location_monitor_start(
+            parent=None,
+            distance_threshold=0,
+            time_threshold=0,
+            accuracy=Xdp.LocationAccuracy.EXACT,
+            flags=Xdp.LocationMonitorFlags.NONE,
+            cancellable=None,
+            callback=start_done,
+            data=None,
+        )
+
+        return xdp, lambda: (start_result, start_error)
+
+    def run_for(self, ms):
+        loop = GLib.MainLoop()
+        GLib.timeout_add(ms, loop.quit)
+        loop.run()
+
+    def connect_geofence(self, geofence):
+        events = []
+        for signal in ["entered", "exited", "dwell"]:
+            geofence.connect(
+                signal, lambda _, id, signal=signal: events.append((signal, id))
+            )
+        return events
+
+    def test_geofence_enter_exit_dwell(self):
+        fixes = [
+            {"latitude": 10.0, "longitude": 10.0},
+            {"latitude": 48.8566, "longitude": 2.3522},
+            {"latitude": 48.8570, "longitude": 2.3525},
+            {"latitude": 48.8566, "longitude": 2.3522},
+            {"latitude": 10.0, "longitude": 10.0},
+        ]
+        xdp, start_result = self.start_location(fixes, fix_interval=200)
+
+        geofence = Xdp.Geofence.new(xdp)
+        geofence.set_dwell_time(300)
+        paris = geofence.add_circle(48.8566, 2.3522, 1000)
+        events = self.connect_geofence(geofence)
+
+        self.run_for(200 + 2 * 200 + 100)
+
+        assert start_result() == (True, None)
+        assert events == [("entered", paris)]
+        assert geofence.is_inside(paris)
+
+        self.run_for(3 * 200)
+
+        # Stayed inside for longer than the dwell time, then left
+        assert events == [("entered", paris), ("dwell", paris), ("exited", paris)]
+        assert not geofence.is_inside(paris)
+
+    def test_geofence_antimeridian(self):
+        fixes = [
+            {"latitude": -17.0, "longitude": -179.999},
+            {"latitude": -17.0, "longitude": 179.0},
+        ]
+        xdp, start_result = self.start_location(fixes)
+
+        geofence = Xdp.Geofence.new(xdp)
+        fence = geofence.add_circle(-17.0, 179.999, 1000)
+        events = self.connect_geofence(geofence)
+
+        self.run_for(200 + 2 * 100 + 100)
+
+        assert start_result() == (True, None)
+        assert events == [("entered", fence), ("exited", fence)]
+
+    def test_geofence_remove_in_handler(self):
+        fixes = [
+            {"latitude": 48.8566, "longitude": 2.3522},
+        ]
+        xdp, start_result = self.start_location(fixes)
+
+        geofence = Xdp.Geofence.new(xdp)
+        first = geofence.add_circle(48.8566, 2.3522, 1000)
+        second = geofence.add_circle(48.8566, 2.3522, 2000)
+
+        entered = []
+
+        def on_entered(geofence, id):
+            entered.append(id)
+            # Remove the other region before it is looked at
+            geofence.remove(second if id == first else first)
+
+        geofence.connect("entered", on_entered)
+
+        self.run_for(200 + 100 + 100)
+
+        assert start_result() == (True, None)
+        assert len(entered) == 1
+
+    def test_last_known_location(self):
+        fixes = [
+            {"latitude": 48.8566, "longitude": 2.3522},
+        ]
+        xdp, start_result = self.start_location(fixes)
+        assert xdp.get_last_known_location_persisted()
+
+        self.run_for(200 + 100 + 100)
+
+        assert start_result() == (True, None)
+        fix = xdp.get_last_known_location()
+        assert fix is not None
+        assert fix.latitude == 48.8566
+        assert fix.longitude == 2.3522
+
+        xdp.set_last_known_location_persisted(False)
+        assert not xdp.get_last_known_location_persisted()
+        assert xdp.get_last_known_location() is not None
+
+        xdp.clear_last_known_location()
+        assert xdp.get_last_known_location() is None
+
+    def connect_fixes(self, xdp):
+        fixes = []
+        xdp.connect("location-fix", lambda _, fix: fixes.append(fix.latitude))
+        return fixes
+
+    def test_filter_accuracy_and_distance(self):
+        fixes = [
+            {"latitude": 48.8566, "longitude": 2.3522},
+            # Too inaccurate
+            {"latitude": 50.0, "longitude": 2.3522, "accuracy": 500.0},
+            # Less than 100 m away from the first
+            {"latitude": 48.8567, "longitude": 2.3522},
+            {"latitude": 49.0, "longitude": 2.3522},
+        ]
+        xdp, start_result = self.start_location(fixes)
+        xdp.location_monitor_set_filter(100.0, 0, 100.0)
+        received = self.connect_fixes(xdp)
+
+        self.run_for(200 + 4 * 100 + 100)
+
+        assert start_result() == (True, None)
+        assert received == [48.8566, 49.0]
+
+    def test_filter_interval(self):
+        fixes = [{"latitude": float(i), "longitude": 0.0} for i in range(5)]
+        xdp, start_result = self.start_location(fixes)
+        # The fixes are one second apart by their timestamps, no matter
+        # how quickly they arrive
+        xdp.location_monitor_set_filter(0.0, 1500, 0.0)
+        received = self.connect_fixes(xdp)
+
+        self.run_for(200 + 5 * 100 + 100)
+
+        assert start_result() == (True, None)
+        assert received == [0.0, 2.0, 4.0]
+
+    def test_filter_interval_without_timestamps(self):
+        fixes = [{"latitude": float(i), "longitude": 0.0} for i in range(5)]
+        xdp, start_result = self.start_location(
+            fixes, fix_interval=200, timestamps=False
+        )
+        # Without timestamps, the time the fixes were received counts
+        xdp.location_monitor_set_filter(0.0, 300, 0.0)
+        received = self.connect_fixes(xdp)
+
+        self.run_for(200 + 5 * 200 + 100)
+
+        assert start_result() == (True, None)
+        assert received == [0.0, 2.0, 4.0]
+        fix = xdp.get_last_known_location()
+        assert (fix.timestamp_s, fix.timestamp_us) == (0, 0)
+
+    def test_batch(self):
+        fixes = [{"latitude": float(i), "longitude": 0.0} for i in range(4)]
+        xdp, start_result = self.start_location(fixes)
+        xdp.location_monitor_set_batch_interval(1000)
+
+        single = self.connect_fixes(xdp)
+        batches = []
+        xdp.connect(
+            "location-fixes",
+            lambda _, fixes: batches.append([fix.latitude for fix in fixes]),
+        )
+
+        self.run_for(200 + 4 * 100 + 1000 + 100)
+
+        assert start_result() == (True, None)
+        # All fixes arrive within one interval, and are delivered at once
+        assert single == []
+        assert batches == [[0.0, 1.0, 2.0, 3.0]]
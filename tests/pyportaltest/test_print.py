@@ -0,0 +1,147 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import fcntl
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Gio, GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+SEALS = fcntl.F_SEAL_SHRINK | fcntl.F_SEAL_GROW | fcntl.F_SEAL_WRITE | fcntl.F_SEAL_SEAL
+
+
+class TestPrint(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def print_document(self, xdp, method, document, cancellable=None):
+        success, error = None, None
+
+        def print_done(portal, task, data):
+            nonlocal success, error
+            try:
+                success = getattr(portal, f"{method}_finish")(task)
+            except GLib.Error as e:
+                error = e
+            self.mainloop.quit()
+
+        getattr(xdp, method)(
+            None,
+            "Document",
+            1234,
+            document,
+            Xdp.PrintFlags.NONE,
+            cancellable,
+            print_done,
+            None,
+        )
+        self.mainloop.run()
+
+        return success, error
+
+    def get_documents(self):
+        documents = self.properties_interface.Get(self.INTERFACE_NAME, "Documents")
+        seals = self.properties_interface.Get(self.INTERFACE_NAME, "Seals")
+        return [bytes(d) for d in documents], list(seals)
+
+    def test_print_bytes(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        document = b"%PDF-1.4\n" + bytes(range(256)) * 64
+        success, error = self.print_document(
+            xdp, "print_bytes", GLib.Bytes.new(document)
+        )
+        assert error is None
+        assert success
+
+        # The document arrives in a memfd that can't be changed anymore
+        assert self.get_documents() == ([document], [SEALS])
+
+        method_calls = self.mock_interface.GetMethodCalls("Print")
+        assert len(method_calls) == 1
+        _, args = method_calls[0]
+        assert args[1] == "Document"
+        assert args[3]["token"] == 1234
+
+    def test_print_bytes_empty(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        success, error = self.print_document(xdp, "print_bytes", GLib.Bytes.new(b""))
+        assert error is None
+        assert success
+        assert self.get_documents() == ([b""], [SEALS])
+
+    def test_print_stream(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        # Larger than a single splice chunk
+        document = bytes(range(256)) * 1024
+        stream = Gio.MemoryInputStream.new_from_bytes(GLib.Bytes.new(document))
+        success, error = self.print_document(xdp, "print_stream", stream)
+        assert error is None
+        assert success
+        assert self.get_documents() == ([document], [SEALS])
+
+        # The stream is not closed
+        assert not stream.is_closed()
+
+    def test_print_stream_error(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        stream = Gio.MemoryInputStream.new_from_bytes(GLib.Bytes.new(b"document"))
+        stream.close(None)
+        success, error = self.print_document(xdp, "print_stream", stream)
+        assert success is None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.CLOSED)
+
+        # Nothing is sent to the portal
+        assert self.mock_interface.GetMethodCalls("Print") == []
+
+    def test_print_failed(self):
+        params = {"response": 2}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        success, error = self.print_document(
+            xdp, "print_bytes", GLib.Bytes.new(b"document")
+        )
+        assert success is None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.FAILED)
+
+    def test_print_file_missing(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        success, error = self.print_document(
+            xdp, "print_file", "/nonexistent/document.pdf"
+        )
+        assert success is None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.NOT_FOUND)
+        assert self.mock_interface.GetMethodCalls("Print") == []
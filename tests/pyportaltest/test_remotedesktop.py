@@ -410,6 +410,59 @@ class TestRemoteDesktop(PortalTest):
         assert key == 4
         assert state == 1
 
+    def test_type_text(self):
+        setup = self.create_session()
+        session = setup.session
+
+        type_done_invoked = False
+        type_result, type_error = None, None
+
+        def type_done(session, task):
+            nonlocal type_done_invoked
+            nonlocal type_result, type_error
+
+            type_done_invoked = True
+            try:
+                type_result = session.type_text_finish(task)
+            except GLib.Error as e:
+                type_error = e
+            self.mainloop.quit()
+
+        session.type_text("aBC\n\u00e9\u20ac", 5, None, type_done)
+        self.mainloop.run()
+
+        assert type_done_invoked
+        assert type_error is None
+        assert type_result is True
+
+        method_calls = self.mock_interface.GetMethodCalls("NotifyKeyboardKeysym")
+        keys = [(args[2], args[3]) for _, args in method_calls]
+        assert keys == [
+            (ord("a"), 1),
+            (ord("a"), 0),
+            (0xFFE1, 1),
+            (ord("B"), 1),
+            (ord("B"), 0),
+            (ord("C"), 1),
+            (ord("C"), 0),
+            (0xFFE1, 0),
+            (0xFF0D, 1),
+            (0xFF0D, 0),
+            (0xE9, 1),
+            (0xE9, 0),
+            (0x010020AC, 1),
+            (0x010020AC, 0),
+        ]
+
+        # Control characters can't be typed
+        type_done_invoked = False
+        session.type_text("a\x07", 0, None, type_done)
+        self.mainloop.run()
+
+        assert type_done_invoked
+        assert type_error is not None
+        assert type_error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.INVALID_ARGUMENT)
+
     def test_notify_motion(self):
         setup = self.create_session()
         session = setup.session
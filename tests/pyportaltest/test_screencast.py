@@ -6,8 +6,10 @@ from . import PortalTest
 
 import dbus
 import gi
+import glob
 import logging
 import os
+import time
 
 from typing import NamedTuple, TextIO
 
@@ -282,6 +284,141 @@ class TestScreenCast(PortalTest):
         assert parent_window == ""
         assert list(options.keys()) == ["handle_token"]
 
+    def test_restore_token_vault(self):
+        """
+        With the vault enabled, the token handed out by Start() is used by the
+        next session of the same kind, and replaced by the one after
+        """
+        params = {"persist-mode": Xdp.PersistMode.PERSISTENT}
+        self.setup_daemon(params=params, extra_templates=[("RemoteDesktop", {})])
+
+        xdp = Xdp.Portal.new()
+        xdp.set_restore_token_vault_enabled(True)
+        xdp.clear_restore_token_vault()
+
+        def create_and_start():
+            session = None
+
+            def create_session_done(portal, task, data):
+                nonlocal session
+                session = portal.create_screencast_session_finish(task)
+                self.mainloop.quit()
+
+            xdp.create_screencast_session(
+                outputs=Xdp.OutputType.MONITOR,
+                flags=Xdp.ScreencastFlags.NONE,
+                cursor_mode=Xdp.CursorMode.HIDDEN,
+                persist_mode=Xdp.PersistMode.PERSISTENT,
+                restore_token=None,
+                cancellable=None,
+                callback=create_session_done,
+                data=None,
+            )
+            self.mainloop.run()
+            assert session is not None
+
+            def start_done(session, task, data):
+                assert session.start_finish(task)
+                self.mainloop.quit()
+
+            session.start(parent=None, cancellable=None, callback=start_done, data=None)
+            self.mainloop.run()
+
+            _, args = self.mock_interface.GetMethodCalls("SelectSources").pop()
+            _, options = args
+
+            return session, options
+
+        first, options = create_and_start()
+        assert "restore_token" not in options
+        first_token = first.get_restore_token()
+        assert first_token is not None
+
+        second, options = create_and_start()
+        assert options["restore_token"] == first_token
+        second_token = second.get_restore_token()
+        assert second_token != first_token
+
+        third, options = create_and_start()
+        assert options["restore_token"] == second_token
+        third_token = third.get_restore_token()
+
+        # The vault is written in the background, to a directory of its
+        # own for this application
+        pattern = os.path.join(
+            GLib.get_user_data_dir(), "libportal", "*", "restore-tokens"
+        )
+
+        def vault_contents():
+            contents = ""
+            for path in glob.glob(pattern):
+                with open(path) as f:
+                    contents += f.read()
+            return contents
+
+        for _ in range(100):
+            GLib.MainContext.default().iteration(False)
+            if third_token in vault_contents():
+                break
+            time.sleep(0.01)
+        assert third_token in vault_contents()
+        assert second_token not in vault_contents()
+        assert not os.path.exists(
+            os.path.join(GLib.get_user_data_dir(), "libportal", "restore-tokens")
+        )
+
+        xdp.clear_restore_token_vault()
+
+    def test_establish_session(self):
+        """
+        Create and start a session in one call
+        """
+        params = {"persist-mode": Xdp.PersistMode.TRANSIENT}
+        self.setup_daemon(params=params, extra_templates=[("RemoteDesktop", {})])
+
+        xdp = Xdp.Portal.new()
+        session, session_error = None, None
+
+        def establish_done(portal, task, data):
+            nonlocal session, session_error
+            try:
+                session = portal.establish_session_finish(task)
+            except GLib.GError as e:
+                session_error = e
+            self.mainloop.quit()
+
+        xdp.establish_screencast_session(
+            parent=None,
+            outputs=Xdp.OutputType.MONITOR,
+            flags=Xdp.ScreencastFlags.NONE,
+            cursor_mode=Xdp.CursorMode.HIDDEN,
+            persist_mode=Xdp.PersistMode.TRANSIENT,
+            restore_token=None,
+            cancellable=None,
+            callback=establish_done,
+            data=None,
+        )
+        self.mainloop.run()
+
+        assert session_error is None
+        assert session is not None
+        assert session.get_session_type() == Xdp.SessionType.SCREENCAST
+        assert session.get_session_state() == Xdp.SessionState.ACTIVE
+        assert session.get_restore_token() is not None
+
+        for method in ["CreateSession", "SelectSources", "Start"]:
+            assert len(self.mock_interface.GetMethodCalls(method)) == 1
+
+        _, args = self.mock_interface.GetMethodCalls("SelectSources").pop()
+        _, options = args
+        assert options["types"] == Xdp.OutputType.MONITOR
+        assert options["persist_mode"] == Xdp.PersistMode.TRANSIENT
+
+        timings = session.get_setup_timings().unpack()
+        steps = [step for step, _ in timings]
+        assert steps[-4:] == ["CreateSession", "SelectSources", "Start", "total"]
+        assert all(duration >= 0 for _, duration in timings)
+
     def test_close_session(self):
         """
         Ensure that closing our session explicitly closes the session on DBus
@@ -309,3 +446,131 @@ class TestScreenCast(PortalTest):
         session.close()
         self.mainloop.run()
         assert was_closed is True
+
+    def run_until(self, condition, timeout_ms):
+        loop = GLib.MainLoop()
+        context = loop.get_context()
+        deadline = GLib.get_monotonic_time() + timeout_ms * 1000
+
+        while not condition() and GLib.get_monotonic_time() < deadline:
+            context.iteration(False)
+            time.sleep(0.005)
+
+        return condition()
+
+    def run_for(self, ms):
+        loop = GLib.MainLoop()
+        GLib.timeout_add(ms, loop.quit)
+        loop.run()
+
+    def new_session_pool(self, xdp, restore_token, size):
+        return Xdp.SessionPool.new(
+            xdp,
+            Xdp.SessionType.SCREENCAST,
+            Xdp.DeviceType.NONE,
+            Xdp.OutputType.MONITOR,
+            Xdp.CursorMode.HIDDEN,
+            Xdp.PersistMode.PERSISTENT,
+            restore_token,
+            size,
+        )
+
+    def acquire(self, pool):
+        session = None
+
+        def acquire_done(pool, task, data):
+            nonlocal session
+            session = pool.acquire_finish(task)
+            self.mainloop.quit()
+
+        pool.acquire(None, acquire_done, None)
+        self.mainloop.run()
+        assert session is not None
+        return session
+
+    def test_session_pool(self):
+        """
+        The pool fills up in the background, and is refilled when a
+        session is taken from it
+        """
+        params = {"delay": 20}
+        self.setup_daemon(params=params, extra_templates=[("RemoteDesktop", {})])
+
+        xdp = Xdp.Portal.new()
+        pool = self.new_session_pool(xdp, None, 2)
+
+        assert self.run_until(lambda: pool.get_stats()[0] == 2, 3000)
+        assert len(self.mock_interface.GetMethodCalls("CreateSession")) == 2
+
+        session = self.acquire(pool)
+        assert session.get_session_state() == Xdp.SessionState.INITIAL
+        n_ready, n_hits, n_misses, n_created, n_closed = pool.get_stats()
+        assert n_hits == 1 and n_misses == 0
+
+        assert self.run_until(lambda: pool.get_stats()[0] == 2, 3000)
+        n_ready, n_hits, n_misses, n_created, n_closed = pool.get_stats()
+        assert n_created == 3
+        assert n_closed == 0
+        assert len(self.mock_interface.GetMethodCalls("CreateSession")) == 3
+
+    def test_session_pool_restore_token(self):
+        """
+        A restore token is only given to one pooled session, and the token
+        that session gets when it is started goes to the next one
+        """
+        params = {"delay": 20, "persist-mode": Xdp.PersistMode.PERSISTENT}
+        self.setup_daemon(params=params, extra_templates=[("RemoteDesktop", {})])
+
+        xdp = Xdp.Portal.new()
+        pool = self.new_session_pool(xdp, "initial_token", 3)
+
+        assert self.run_until(lambda: pool.get_stats()[0] == 1, 3000)
+        self.run_for(300)
+        assert pool.get_stats()[0] == 1
+
+        select_sources = self.mock_interface.GetMethodCalls("SelectSources")
+        assert len(select_sources) == 1
+        _, (_, options) = select_sources[0]
+        assert options["restore_token"] == "initial_token"
+
+        session = self.acquire(pool)
+
+        def start_done(session, task, data):
+            assert session.start_finish(task)
+            self.mainloop.quit()
+
+        session.start(parent=None, cancellable=None, callback=start_done, data=None)
+        self.mainloop.run()
+        new_token = session.get_restore_token()
+        assert new_token is not None and new_token != "initial_token"
+
+        assert self.run_until(lambda: pool.get_stats()[0] == 1, 3000)
+        self.run_for(300)
+        assert pool.get_stats()[0] == 1
+
+        select_sources = self.mock_interface.GetMethodCalls("SelectSources")
+        assert len(select_sources) == 2
+        _, (_, options) = select_sources[1]
+        assert options["restore_token"] == new_token
+
+    def test_session_pool_refill_backoff(self):
+        """
+        Sessions that the portal closes while pooled are replaced with a
+        growing delay, not right away
+        """
+        params = {"delay": 20, "close-after-select": 100}
+        self.setup_daemon(params=params, extra_templates=[("RemoteDesktop", {})])
+
+        xdp = Xdp.Portal.new()
+        pool = self.new_session_pool(xdp, None, 1)
+
+        self.run_for(2500)
+
+        n_created = len(self.mock_interface.GetMethodCalls("CreateSession"))
+        assert 2 <= n_created <= 3
+        n_ready, n_hits, n_misses, n_created, n_closed = pool.get_stats()
+        assert n_closed >= 2
+
+        # An acquisition doesn't wait for the delay
+        session = self.acquire(pool)
+        assert pool.get_stats()[2] == 1
@@ -0,0 +1,248 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+import os
+import tempfile
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Gio, GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestScreenshot(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(2)
+
+    def run_until(self, condition, timeout=10000):
+        """
+        Runs the main loop until condition() is true. The timeout is only
+        there to fail the test instead of hanging, so it is generous.
+        """
+        timed_out = False
+
+        def on_timeout():
+            nonlocal timed_out
+            timed_out = True
+            return False
+
+        source = GLib.timeout_add(timeout, on_timeout)
+        context = GLib.MainContext.default()
+        while not condition() and not timed_out:
+            context.iteration(True)
+        if not timed_out:
+            GLib.source_remove(source)
+        assert condition()
+
+    def make_directory(self):
+        tmpdir = tempfile.TemporaryDirectory()
+        self.addCleanup(tmpdir.cleanup)
+        return tmpdir.name
+
+    def test_scheduler_tick_skip(self):
+        directory = self.make_directory()
+        params = {"delay": 250, "directory": directory}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        uris = []
+        failures = []
+
+        def captured(scheduler, fd, uri, latency):
+            assert fd >= 0
+            assert latency > 0
+            uris.append(uri)
+
+        scheduler = Xdp.ScreenshotScheduler.new(xdp, 50)
+        scheduler.connect("captured", captured)
+        scheduler.connect("failed", lambda s, e: failures.append(e))
+        scheduler.start()
+        self.run_until(lambda: len(uris) >= 3)
+        scheduler.stop()
+
+        n_captured, n_skipped, n_failed, _, mean, max_latency = scheduler.get_stats()
+        assert failures == []
+        assert n_failed == 0
+        assert n_captured == len(uris) == 3
+        # Each request spans about five ticks; ticks that are missed when
+        # the main loop is busy count as skipped as well
+        assert n_skipped >= n_captured
+        assert max_latency >= mean >= 250 * 1000
+
+        # Never more than one request at a time, each with its own token
+        method_calls = self.mock_interface.GetMethodCalls("Screenshot")
+        assert len(method_calls) in (n_captured, n_captured + 1)
+        tokens = [args[1]["handle_token"] for _, args in method_calls]
+        assert len(set(tokens)) == len(tokens)
+        assert all(not args[1]["interactive"] for _, args in method_calls)
+        assert self.properties_interface.Get(self.INTERFACE_NAME, "MaxPending") == 1
+
+        # The files are kept by default
+        for uri in uris:
+            assert os.path.exists(GLib.filename_from_uri(uri)[0])
+
+    def test_scheduler_remove_files(self):
+        directory = self.make_directory()
+        params = {"delay": 20, "directory": directory}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        contents = []
+        paths = []
+
+        def captured(scheduler, fd, uri, latency):
+            path = GLib.filename_from_uri(uri)[0]
+            assert not os.path.exists(path)
+            paths.append(path)
+            contents.append(os.pread(fd, 8, 0))
+
+        scheduler = Xdp.ScreenshotScheduler.new(xdp, 100)
+        assert not scheduler.get_remove_files()
+        scheduler.set_remove_files(True)
+        assert scheduler.get_remove_files()
+
+        scheduler.connect("captured", captured)
+        scheduler.start()
+        self.run_until(lambda: len(contents) >= 2)
+        scheduler.stop()
+
+        assert all(c == b"\x89PNG\r\n\x1a\n" for c in contents)
+        assert not any(os.path.exists(path) for path in paths)
+
+    def test_scheduler_stop_ignores_late_reply(self):
+        # The first call fails long after the scheduler was stopped,
+        # later ones fail right away
+        params = {"fail-delays": [300, 0]}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        failures = []
+
+        def get_failed():
+            return list(self.properties_interface.Get(self.INTERFACE_NAME, "Failed"))
+
+        scheduler = Xdp.ScreenshotScheduler.new(xdp, 50)
+        scheduler.connect("failed", lambda s, e: failures.append(e.message))
+        scheduler.start()
+        self.run_until(lambda: len(self.mock_interface.GetMethodCalls("Screenshot")) == 1)
+        scheduler.stop()
+        scheduler.start()
+
+        # Replies arrive in the order the portal sent them, so once a
+        # failure sent after the one of the first call is reported, the
+        # late reply has been seen and ignored
+        def late_reply_seen():
+            failed = get_failed()
+            if 0 not in failed:
+                return False
+            later = failed[failed.index(0) + 1 :]
+            return any(f"Screenshot {n} failed" in m for n in later for m in failures)
+
+        self.run_until(late_reply_seen)
+        scheduler.stop()
+
+        assert not any("Screenshot 0 failed" in m for m in failures)
+        _, _, n_failed, _, _, _ = scheduler.get_stats()
+        assert n_failed == len(failures)
+
+    def take_screenshot_to_memory(self, xdp, flags, cancellable=None):
+        result, error = None, None
+
+        def screenshot_done(portal, task, data):
+            nonlocal result, error
+            try:
+                result = portal.take_screenshot_to_memory_finish(task)
+            except GLib.Error as e:
+                error = e
+            self.mainloop.quit()
+
+        xdp.take_screenshot_to_memory(None, flags, cancellable, screenshot_done, None)
+        self.mainloop.run()
+
+        return result, error
+
+    def test_to_memory(self):
+        directory = self.make_directory()
+        params = {"delay": 100, "directory": directory}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        result, error = self.take_screenshot_to_memory(xdp, Xdp.ScreenshotFlags.NONE)
+        assert error is None
+        data, capture_time, map_time = result
+        assert data.get_data() == b"\x89PNG\r\n\x1a\n"
+        assert capture_time >= 100 * 1000
+        assert map_time >= 0
+
+        # Without the unlink flag, the file is kept
+        assert os.listdir(directory) == ["Screenshot0.png"]
+
+        method_calls = self.mock_interface.GetMethodCalls("Screenshot")
+        assert len(method_calls) == 1
+        _, args = method_calls[0]
+        assert not args[1]["interactive"]
+
+    def test_to_memory_unlink(self):
+        directory = self.make_directory()
+        params = {"directory": directory}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        result, error = self.take_screenshot_to_memory(
+            xdp, Xdp.ScreenshotFlags.UNLINK | Xdp.ScreenshotFlags.INTERACTIVE
+        )
+        assert error is None
+        data, _, _ = result
+        # The mapping outlives the file
+        assert data.get_data() == b"\x89PNG\r\n\x1a\n"
+        assert os.listdir(directory) == []
+
+        _, args = self.mock_interface.GetMethodCalls("Screenshot")[0]
+        assert args[1]["interactive"]
+
+    def test_to_memory_cancel(self):
+        directory = self.make_directory()
+        params = {"delay": 500, "directory": directory}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        cancellable = Gio.Cancellable()
+        GLib.timeout_add(50, cancellable.cancel)
+
+        result, error = self.take_screenshot_to_memory(
+            xdp, Xdp.ScreenshotFlags.UNLINK, cancellable
+        )
+        assert result is None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.CANCELLED)
+
+        # Cancelling before the screenshot was mapped leaves the file
+        # alone, so it is not lost
+        assert os.listdir(directory) == ["Screenshot0.png"]
+
+    def test_to_memory_failed(self):
+        params = {"response": 2}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        result, error = self.take_screenshot_to_memory(xdp, Xdp.ScreenshotFlags.NONE)
+        assert result is None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.FAILED)
@@ -0,0 +1,103 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import dbusmock
+import gi
+import logging
+import os
+import tempfile
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import Gio, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestTrash(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def make_files(self, n):
+        tmpdir = tempfile.TemporaryDirectory()
+        self.addCleanup(tmpdir.cleanup)
+
+        paths = []
+        for i in range(n):
+            path = os.path.join(tmpdir.name, f"file{i}")
+            with open(path, "w"):
+                pass
+            paths.append(path)
+        return tmpdir.name, paths
+
+    def trash_files(self, xdp, paths, cancellable=None):
+        result = None
+
+        def trash_files_done(portal, task, data):
+            nonlocal result
+            result = portal.trash_files_finish(task)
+            self.mainloop.quit()
+
+        xdp.trash_files(paths, cancellable, trash_files_done, None)
+        self.mainloop.run()
+        return result
+
+    def test_trash_files(self):
+        params = {"delay": 20, "fail": ["file5"]}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        # More files than fit into one chunk of opened fds, and one that
+        # doesn't exist
+        tmpdir, paths = self.make_files(100)
+        paths[7] = os.path.join(tmpdir, "missing")
+
+        errors = self.trash_files(xdp, paths)
+        assert len(errors) == 100
+        for i, error in enumerate(errors):
+            if i == 5:
+                assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.FAILED)
+            elif i == 7:
+                assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.NOT_FOUND)
+            else:
+                assert error is None
+
+        trashed = self.properties_interface.Get(self.INTERFACE_NAME, "Trashed")
+        assert list(trashed) == [p for i, p in enumerate(paths) if i != 7]
+
+    def test_trash_files_cancel(self):
+        params = {"delay": 300}
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        # More files than the first chunk that is opened, so that
+        # cancelling also has to stop opening files
+        _, paths = self.make_files(100)
+        cancellable = Gio.Cancellable()
+
+        def method_called(name, args):
+            if name == "TrashFile":
+                cancellable.cancel()
+
+        self.obj_portal.connect_to_signal(
+            "MethodCalled", method_called, dbus_interface=dbusmock.MOCK_IFACE
+        )
+
+        errors = self.trash_files(xdp, paths, cancellable)
+        assert len(errors) == 100
+
+        trashed = self.properties_interface.Get(self.INTERFACE_NAME, "Trashed")
+        n_sent = len(trashed)
+        assert 0 < n_sent < 100
+        assert list(trashed) == paths[:n_sent]
+
+        for error in errors[:n_sent]:
+            assert error is None
+        for error in errors[n_sent:]:
+            assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.CANCELLED)
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include "batch-private.h"
+
+typedef struct {
+  XdpBatch *batch;
+  GCancellable *cancellable;
+
+  /* Cancel the batch while sending this entry, or -1 */
+  int cancel_at;
+  /* Finish the entries from within send(), instead of from an idle */
+  gboolean sync;
+
+  GArray *sent;
+  GQueue pending;
+  guint in_flight;
+  guint max_in_flight;
+
+  GPtrArray *errors;
+  gboolean done;
+} BatchTest;
+
+static gboolean
+finish_entry (gpointer data)
+{
+  BatchTest *test = data;
+  guint index = GPOINTER_TO_UINT (g_queue_pop_head (&test->pending));
+
+  test->in_flight--;
+  _xdp_batch_entry_done (test->batch, index, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+batch_send (XdpBatch  *batch,
+            guint      index,
+            gpointer   user_data,
+            GError   **error)
+{
+  BatchTest *test = user_data;
+
+  g_assert_false (test->done);
+
+  /* Odd entries fail without a call being made */
+  if (test->sync && index % 2 == 1)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Entry %u failed", index);
+      return FALSE;
+    }
+
+  g_array_append_val (test->sent, index);
+
+  if (test->sync)
+    {
+      _xdp_batch_entry_done (batch, index, NULL);
+      return TRUE;
+    }
+
+  test->in_flight++;
+  test->max_in_flight = MAX (test->max_in_flight, test->in_flight);
+  g_queue_push_tail (&test->pending, GUINT_TO_POINTER (index));
+  g_idle_add (finish_entry, test);
+
+  if ((int) index == test->cancel_at)
+    g_cancellable_cancel (test->cancellable);
+
+  return TRUE;
+}
+
+static void
+batch_done (GPtrArray *errors,
+            gpointer   user_data)
+{
+  BatchTest *test = user_data;
+
+  g_assert_false (test->done);
+
+  test->errors = errors;
+  test->done = TRUE;
+}
+
+static void
+batch_test_init (BatchTest *test,
+                 guint      n_entries,
+                 guint      max_in_flight)
+{
+  test->cancellable = g_cancellable_new ();
+  test->cancel_at = -1;
+  test->sent = g_array_new (FALSE, FALSE, sizeof (guint));
+  g_queue_init (&test->pending);
+  test->batch = _xdp_batch_new (n_entries, max_in_flight, test->cancellable,
+                                batch_send, batch_done, test);
+}
+
+static void
+batch_test_run (BatchTest *test)
+{
+  while (!test->done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_true (g_queue_is_empty (&test->pending));
+}
+
+static void
+batch_test_clear (BatchTest *test)
+{
+  g_clear_object (&test->cancellable);
+  g_clear_pointer (&test->sent, g_array_unref);
+  g_clear_pointer (&test->errors, g_ptr_array_unref);
+}
+
+static void
+test_batch_window (void)
+{
+  BatchTest test = { 0, };
+  guint i;
+
+  batch_test_init (&test, 20, 4);
+  _xdp_batch_start (test.batch);
+  batch_test_run (&test);
+
+  /* Every entry is sent once, in order, with no more than the window
+   * pending at once */
+  g_assert_cmpuint (test.sent->len, ==, 20);
+  for (i = 0; i < test.sent->len; i++)
+    g_assert_cmpuint (g_array_index (test.sent, guint, i), ==, i);
+  g_assert_cmpuint (test.max_in_flight, ==, 4);
+
+  g_assert_cmpuint (test.errors->len, ==, 20);
+  for (i = 0; i < test.errors->len; i++)
+    g_assert_null (g_ptr_array_index (test.errors, i));
+
+  batch_test_clear (&test);
+}
+
+static void
+test_batch_cancel (void)
+{
+  BatchTest test = { 0, };
+  guint i;
+
+  batch_test_init (&test, 20, 4);
+  test.cancel_at = 6;
+  _xdp_batch_start (test.batch);
+  batch_test_run (&test);
+
+  /* Calls that were sent already run to completion and are reported,
+   * the others fail without being sent */
+  g_assert_cmpuint (test.sent->len, ==, 7);
+  g_assert_cmpuint (test.errors->len, ==, 20);
+  for (i = 0; i < test.errors->len; i++)
+    {
+      GError *error = g_ptr_array_index (test.errors, i);
+
+      if (i <= 6)
+        g_assert_no_error (error);
+      else
+        g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    }
+
+  batch_test_clear (&test);
+}
+
+static void
+test_batch_sync (void)
+{
+  BatchTest test = { 0, };
+  guint i;
+
+  batch_test_init (&test, 9, 2);
+  test.sync = TRUE;
+  _xdp_batch_start (test.batch);
+
+  /* Entries finished from within send() don't recurse into it */
+  g_assert_true (test.done);
+  g_assert_cmpuint (test.sent->len, ==, 5);
+  for (i = 0; i < test.errors->len; i++)
+    {
+      GError *error = g_ptr_array_index (test.errors, i);
+
+      if (i % 2 == 1)
+        g_assert_error (error, G_IO_ERROR, G_IO_ERROR_FAILED);
+      else
+        g_assert_no_error (error);
+    }
+
+  batch_test_clear (&test);
+}
+
+static void
+test_batch_n_ready (void)
+{
+  BatchTest test = { 0, };
+
+  batch_test_init (&test, 10, 4);
+  _xdp_batch_set_n_ready (test.batch, 0);
+  _xdp_batch_start (test.batch);
+  g_assert_cmpuint (test.sent->len, ==, 0);
+
+  _xdp_batch_set_n_ready (test.batch, 3);
+  g_assert_cmpuint (test.sent->len, ==, 3);
+
+  /* Nothing beyond the ready entries is sent, however long it runs */
+  while (test.in_flight > 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpuint (test.sent->len, ==, 3);
+  g_assert_false (test.done);
+
+  _xdp_batch_set_n_ready (test.batch, 10);
+  batch_test_run (&test);
+  g_assert_cmpuint (test.sent->len, ==, 10);
+
+  batch_test_clear (&test);
+}
+
+static void
+test_batch_empty (void)
+{
+  BatchTest test = { 0, };
+
+  batch_test_init (&test, 0, 4);
+  _xdp_batch_start (test.batch);
+
+  g_assert_true (test.done);
+  g_assert_cmpuint (test.errors->len, ==, 0);
+
+  batch_test_clear (&test);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/batch/window", test_batch_window);
+  g_test_add_func ("/batch/cancel", test_batch_cancel);
+  g_test_add_func ("/batch/sync", test_batch_sync);
+  g_test_add_func ("/batch/n-ready", test_batch_n_ready);
+  g_test_add_func ("/batch/empty", test_batch_empty);
+
+  return g_test_run ();
+}
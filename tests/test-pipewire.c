@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+/* The helpers under test are static, so the receiver is built into
+ * the test directly */
+#include "../libportal/portal-pipewire.c"
+
+#define FRAME_WIDTH 128
+#define FRAME_HEIGHT 100
+
+static void
+assert_rect (GArray *damage,
+             guint   index,
+             gint32  x,
+             gint32  y,
+             guint32 width,
+             guint32 height)
+{
+  XdpPipewireRect *rect;
+
+  g_assert_cmpuint (index, <, damage->len);
+
+  rect = &g_array_index (damage, XdpPipewireRect, index);
+  g_assert_cmpint (rect->x, ==, x);
+  g_assert_cmpint (rect->y, ==, y);
+  g_assert_cmpuint (rect->width, ==, width);
+  g_assert_cmpuint (rect->height, ==, height);
+}
+
+static void
+test_damage_merge (void)
+{
+  g_autoptr(GArray) damage = g_array_new (FALSE, FALSE, sizeof (XdpPipewireRect));
+
+  add_damage_rect (damage, 0, 0, 64, 64);
+  add_damage_rect (damage, 128, 0, 64, 64);
+
+  /* Continues the first rectangle past the second one */
+  add_damage_rect (damage, 0, 64, 64, 64);
+  g_assert_cmpuint (damage->len, ==, 2);
+  assert_rect (damage, 0, 0, 0, 64, 128);
+
+  /* Same row, other columns */
+  add_damage_rect (damage, 64, 64, 128, 64);
+  g_assert_cmpuint (damage->len, ==, 3);
+
+  /* Not adjacent to the row above */
+  add_damage_rect (damage, 0, 192, 64, 64);
+  g_assert_cmpuint (damage->len, ==, 4);
+  assert_rect (damage, 3, 0, 192, 64, 64);
+}
+
+static void
+test_damage_compact (void)
+{
+  g_autoptr(GArray) damage = g_array_new (FALSE, FALSE, sizeof (XdpPipewireRect));
+  guint i;
+
+  for (i = 0; i < MAX_DAMAGE_RECTS; i++)
+    {
+      XdpPipewireRect rect = { i * 20, 10 + i, 10, 5 };
+      g_array_append_val (damage, rect);
+    }
+
+  compact_damage (damage);
+  g_assert_cmpuint (damage->len, ==, MAX_DAMAGE_RECTS);
+
+  {
+    XdpPipewireRect rect = { 5, 400, 1, 1 };
+    g_array_append_val (damage, rect);
+  }
+
+  /* Replaced by the bounding box once over the limit */
+  compact_damage (damage);
+  g_assert_cmpuint (damage->len, ==, 1);
+  assert_rect (damage, 0, 0, 10, (MAX_DAMAGE_RECTS - 1) * 20 + 10, 391);
+}
+
+static void
+test_damage_compute (void)
+{
+  XdpPipewireReceiver receiver = { 0, };
+  XdpPipewireFrame frame = { 0, };
+  gint32 stride = FRAME_WIDTH * 4;
+  gsize size = (gsize) stride * FRAME_HEIGHT;
+  g_autofree guint8 *pixels = g_malloc0 (size);
+  GArray *damage;
+
+  frame.width = FRAME_WIDTH;
+  frame.height = FRAME_HEIGHT;
+  frame.format = SPA_VIDEO_FORMAT_BGRx;
+
+  /* Without a reference, the whole frame is damaged */
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_nonnull (damage);
+  g_assert_cmpuint (damage->len, ==, 1);
+  assert_rect (damage, 0, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+  g_array_unref (damage);
+
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_nonnull (damage);
+  g_assert_cmpuint (damage->len, ==, 0);
+  g_array_unref (damage);
+
+  /* One pixel in each tile of the right column, the lower one being
+   * cut short by the frame height */
+  pixels[10 * stride + 70 * 4] = 0xff;
+  pixels[90 * stride + 127 * 4 + 3] = 0xff;
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_nonnull (damage);
+  g_assert_cmpuint (damage->len, ==, 1);
+  assert_rect (damage, 0, 64, 0, 64, FRAME_HEIGHT);
+  g_array_unref (damage);
+
+  /* The reference was updated along the way */
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_cmpuint (damage->len, ==, 0);
+  g_array_unref (damage);
+
+  pixels[0] = 0xff;
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_cmpuint (damage->len, ==, 1);
+  assert_rect (damage, 0, 0, 0, 64, 64);
+  g_array_unref (damage);
+
+  /* A new format invalidates the reference */
+  frame.format = SPA_VIDEO_FORMAT_RGBx;
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_cmpuint (damage->len, ==, 1);
+  assert_rect (damage, 0, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+  g_array_unref (damage);
+
+  g_free (receiver.reference);
+}
+
+static void
+test_damage_compute_bounds (void)
+{
+  XdpPipewireReceiver receiver = { 0, };
+  XdpPipewireFrame frame = { 0, };
+  gint32 stride = FRAME_WIDTH * 4 + 64;
+  gsize size = (gsize) stride * (FRAME_HEIGHT - 1) + FRAME_WIDTH * 4;
+  g_autofree guint8 *pixels = g_malloc0 (size);
+  GArray *damage;
+
+  frame.width = FRAME_WIDTH;
+  frame.height = FRAME_HEIGHT;
+
+  /* Rows that don't fit in the stride */
+  g_assert_null (compute_damage (&receiver, &frame, pixels, size, FRAME_WIDTH * 4 - 4));
+  g_assert_null (compute_damage (&receiver, &frame, pixels, size, 0));
+  g_assert_null (compute_damage (&receiver, &frame, pixels, size, -stride));
+
+  /* A buffer that is too short */
+  g_assert_null (compute_damage (&receiver, &frame, pixels, size - 1, stride));
+  g_assert_null (receiver.reference);
+
+  /* The padding after the last row is not required */
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_nonnull (damage);
+  g_array_unref (damage);
+
+  pixels[size - 1] = 0xff;
+  damage = compute_damage (&receiver, &frame, pixels, size, stride);
+  g_assert_cmpuint (damage->len, ==, 1);
+  assert_rect (damage, 0, 64, 64, 64, FRAME_HEIGHT - 64);
+  g_array_unref (damage);
+
+  g_free (receiver.reference);
+}
+
+static void
+test_chunk_clamp (void)
+{
+  guint8 memory[256];
+  struct spa_chunk chunk = { 0, };
+  struct spa_data data = { 0, };
+  gsize size;
+
+  data.data = memory;
+  data.maxsize = sizeof (memory);
+  data.chunk = &chunk;
+
+  chunk.offset = 16;
+  chunk.size = 64;
+  g_assert_true (data_get_chunk (&data, &size) == memory + 16);
+  g_assert_cmpuint (size, ==, 64);
+
+  /* The size is cut at the end of the memory */
+  chunk.size = 1024;
+  g_assert_true (data_get_chunk (&data, &size) == memory + 16);
+  g_assert_cmpuint (size, ==, sizeof (memory) - 16);
+
+  /* The offset wraps around */
+  chunk.offset = sizeof (memory) + 8;
+  chunk.size = 32;
+  g_assert_true (data_get_chunk (&data, &size) == memory + 8);
+  g_assert_cmpuint (size, ==, 32);
+
+  data.data = NULL;
+  g_assert_null (data_get_chunk (&data, &size));
+  g_assert_cmpuint (size, ==, 0);
+}
+
+typedef struct {
+  guint8 *memory;
+  struct spa_meta meta;
+  struct spa_buffer spa_buffer;
+  struct pw_buffer buffer;
+  struct spa_meta_cursor *cursor;
+  struct spa_meta_bitmap *bitmap;
+} CursorBuffer;
+
+static void
+cursor_buffer_init (CursorBuffer *cursor_buffer,
+                    guint         width,
+                    guint         height)
+{
+  cursor_buffer->meta.type = SPA_META_Cursor;
+  cursor_buffer->meta.size = CURSOR_META_SIZE (width, height);
+  cursor_buffer->memory = g_malloc0 (cursor_buffer->meta.size);
+  cursor_buffer->meta.data = cursor_buffer->memory;
+
+  cursor_buffer->spa_buffer.n_metas = 1;
+  cursor_buffer->spa_buffer.metas = &cursor_buffer->meta;
+  cursor_buffer->buffer.buffer = &cursor_buffer->spa_buffer;
+
+  cursor_buffer->cursor = cursor_buffer->meta.data;
+  cursor_buffer->cursor->id = 1;
+  cursor_buffer->cursor->position.x = 100;
+  cursor_buffer->cursor->position.y = 50;
+  cursor_buffer->cursor->hotspot.x = 2;
+  cursor_buffer->cursor->hotspot.y = 3;
+  cursor_buffer->cursor->bitmap_offset = sizeof (struct spa_meta_cursor);
+
+  cursor_buffer->bitmap = SPA_PTROFF (cursor_buffer->cursor,
+                                      cursor_buffer->cursor->bitmap_offset,
+                                      struct spa_meta_bitmap);
+  cursor_buffer->bitmap->format = SPA_VIDEO_FORMAT_BGRA;
+  cursor_buffer->bitmap->size.width = width;
+  cursor_buffer->bitmap->size.height = height;
+  cursor_buffer->bitmap->stride = width * CURSOR_BYTES_PER_PIXEL;
+  cursor_buffer->bitmap->offset = sizeof (struct spa_meta_bitmap);
+}
+
+static void
+cursor_test_read (XdpPipewireReceiver *receiver,
+                  XdpPipewireFrame    *frame,
+                  CursorBuffer        *cursor_buffer)
+{
+  g_clear_pointer (&frame->cursor_bitmap, g_bytes_unref);
+  memset (frame, 0, sizeof (*frame));
+  read_cursor_meta (receiver, frame, &cursor_buffer->buffer);
+}
+
+static void
+test_cursor_bitmap (void)
+{
+  XdpPipewireReceiver receiver = { 0, };
+  XdpPipewireFrame frame = { 0, };
+  CursorBuffer cursor_buffer = { 0, };
+
+  cursor_buffer_init (&cursor_buffer, 16, 8);
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+
+  g_assert_true (frame.has_cursor);
+  g_assert_cmpint (frame.cursor_rect.x, ==, 98);
+  g_assert_cmpint (frame.cursor_rect.y, ==, 47);
+  g_assert_cmpuint (frame.cursor_rect.width, ==, 16);
+  g_assert_cmpuint (frame.cursor_rect.height, ==, 8);
+  g_assert_nonnull (frame.cursor_bitmap);
+  g_assert_cmpuint (g_bytes_get_size (frame.cursor_bitmap), ==, 16 * 8 * CURSOR_BYTES_PER_PIXEL);
+  g_assert_cmpint (frame.cursor_bitmap_stride, ==, 16 * CURSOR_BYTES_PER_PIXEL);
+  g_assert_cmpuint (frame.cursor_bitmap_format, ==, SPA_VIDEO_FORMAT_BGRA);
+
+  /* Position-only updates keep the last bitmap */
+  cursor_buffer.cursor->bitmap_offset = 0;
+  cursor_buffer.cursor->position.x = 200;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+
+  g_assert_true (frame.has_cursor);
+  g_assert_cmpint (frame.cursor_rect.x, ==, 198);
+  g_assert_true (frame.cursor_bitmap == receiver.cursor_bitmap);
+  g_assert_cmpuint (frame.cursor_bitmap_width, ==, 16);
+
+  /* An invalid cursor is hidden */
+  cursor_buffer.cursor->id = 0;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_false (frame.has_cursor);
+  g_assert_null (frame.cursor_bitmap);
+
+  g_clear_pointer (&receiver.cursor_bitmap, g_bytes_unref);
+  g_free (cursor_buffer.memory);
+}
+
+static void
+test_cursor_bounds (void)
+{
+  XdpPipewireReceiver receiver = { 0, };
+  XdpPipewireFrame frame = { 0, };
+  CursorBuffer cursor_buffer = { 0, };
+
+  cursor_buffer_init (&cursor_buffer, 16, 8);
+
+  /* Each of these would read past the end of the meta region; the
+   * cursor is still placed, without a bitmap */
+  cursor_buffer.cursor->bitmap_offset = cursor_buffer.meta.size - sizeof (struct spa_meta_bitmap) + 1;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_true (frame.has_cursor);
+  g_assert_null (frame.cursor_bitmap);
+
+  cursor_buffer.cursor->bitmap_offset = G_MAXUINT32;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_true (frame.has_cursor);
+  g_assert_null (frame.cursor_bitmap);
+
+  cursor_buffer.cursor->bitmap_offset = sizeof (struct spa_meta_cursor);
+  cursor_buffer.bitmap->size.height = 9;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_null (frame.cursor_bitmap);
+
+  cursor_buffer.bitmap->size.height = 8;
+  cursor_buffer.bitmap->offset = G_MAXUINT32;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_null (frame.cursor_bitmap);
+
+  cursor_buffer.bitmap->offset = sizeof (struct spa_meta_bitmap);
+  cursor_buffer.bitmap->stride = G_MAXINT32;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_null (frame.cursor_bitmap);
+
+  /* Rows that are shorter than the width */
+  cursor_buffer.bitmap->stride = 16 * CURSOR_BYTES_PER_PIXEL - 1;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_null (frame.cursor_bitmap);
+
+  cursor_buffer.bitmap->stride = -16 * CURSOR_BYTES_PER_PIXEL;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_null (frame.cursor_bitmap);
+
+  /* Overlapping the cursor header */
+  cursor_buffer.cursor->bitmap_offset = 4;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_null (frame.cursor_bitmap);
+  g_assert_null (receiver.cursor_bitmap);
+
+  /* A meta region too small for the cursor itself */
+  cursor_buffer.meta.size = sizeof (struct spa_meta_cursor) - 1;
+  cursor_test_read (&receiver, &frame, &cursor_buffer);
+  g_assert_false (frame.has_cursor);
+
+  g_free (cursor_buffer.memory);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/pipewire/damage/merge", test_damage_merge);
+  g_test_add_func ("/pipewire/damage/compact", test_damage_compact);
+  g_test_add_func ("/pipewire/damage/compute", test_damage_compute);
+  g_test_add_func ("/pipewire/damage/compute-bounds", test_damage_compute_bounds);
+  g_test_add_func ("/pipewire/chunk-clamp", test_chunk_clamp);
+  g_test_add_func ("/pipewire/cursor/bitmap", test_cursor_bitmap);
+  g_test_add_func ("/pipewire/cursor/bounds", test_cursor_bounds);
+
+  return g_test_run ();
+}